@@ -495,7 +495,16 @@ void icp_symbgen::RunEngine(hldsm* hm, result &)
       debug.stopIO();
     }
     expr** clist = nem->GetConstraintsAtLevel(k);
-    cbylevel[k] = ProcessConjunct(clist, k+1, ddlwrap);
+    try {
+      cbylevel[k] = ProcessConjunct(clist, k+1, ddlwrap);
+    }
+    catch (error e) {
+      for (int j=0; j<k; j++) Delete(cbylevel[j]);
+      delete[] cbylevel;
+      Delete(ddlwrap);
+      MEDDLY::destroyDomain(d);
+      throw e;
+    }
   } // for k
 
   if (debug.startReport()) {
@@ -566,8 +575,15 @@ shared_ddedge* icp_symbgen
 #endif
     COLL.get(i)->Traverse(x);
     if (x.answer->isNull()) {
-      em->cout() << "\t\tGot null result\n";
-      continue;
+      // Dropping the constraint would give wrong answers
+      if (em->startError()) {
+        em->causedBy(COLL.get(i));
+        em->cerr() << "Couldn't build decision diagram for constraint";
+        em->stopIO();
+      }
+      for (long j=0; j<i; j++) Delete(edgelist[j]);
+      delete[] edgelist;
+      throw Engine_Failed;
     }
 
     edgelist[i] = Share(dynamic_cast <shared_ddedge*> (x.answer->getPtr()));
@@ -7,11 +7,13 @@
 #include "../ExprLib/mod_inst.h"
 #include "../ExprLib/mod_vars.h"
 #include "../ExprLib/measures.h"
+#include "../ExprLib/vect_prog.h"
 
 #include "../Formlsms/stoch_llm.h"
 #include "../Formlsms/phase_hlm.h"
 
 #include "../Modules/statevects.h"
+#include "../Options/options.h"
 
 // external
 
@@ -19,6 +21,8 @@
 #include "../_LSLib/lslib.h"
 #include "../_Timer/timerlib.h"
 
+#include <vector>
+
 // **************************************************************************
 // *                                                                        *
 // *                           exact_mcmsr  class                           *
@@ -36,56 +40,85 @@ public:
   virtual bool AppliesToModelType(hldsm::model_type) const;
 protected:
 
-  class msr_visitor : public state_lldsm::state_visitor {
+  /**
+      Computes a list of REAL and BOOL measures, that use the same
+      probability vector, with a single pass over the states.
+      Each state is decoded once, and each measure's term for it
+      is added to that measure's accumulator.
+
+      If the reachable states allow it (e.g., decision diagrams),
+      measures are first computed symbolically, without visiting states.
+
+      Measures whose RHS compiles into a vector program (simple
+      arithmetic, comparisons, logic, and state variables) are instead
+      evaluated over blocks of states: the state variables they use
+      are decoded into columns, and the whole block is evaluated with
+      tight loops.  Everything else walks the expression per state.
+  */
+  class msrlist_visitor : public state_lldsm::state_visitor {
   protected:
-    measure *m;
     double* &p;
     // If proc is non-zero, then measure is infinity for recurrent states.
     const stochastic_lldsm::process* proc;
     result tmp;
-    result ans;
+    std::vector <measure*> msrs;
+    std::vector <bool> is_bool;
+    std::vector <result> ans;
+    // Number of measures whose answer is not yet null.
+    long live;
+
+    // Compiled measures share this program.
+    vector_program vp;
+    // Register for each measure, or -1 if not compiled.
+    std::vector <int> vreg;
+    // Number of compiled measures.
+    long compiled;
+    // Indexes of the states in the current block.
+    std::vector <long> blk_index;
+    long blk_used;
+    static const long block_states = 1024;
   public:
-    msr_visitor(const hldsm* mdl, double* &p);
+    msrlist_visitor(const hldsm* mdl, double* &p);
     void infinity_on_recurrent(const stochastic_lldsm::process* _proc) {
       proc = _proc;
     }
-    inline void newMsr(measure* _m) {
-      m = _m;
-      m->PrecomputeRHS();
-      ans.setReal(0);
-    }
-    inline void finish() {
-      m->SetValue(ans);
-    }
+    /// Add a measure to the list; returns false if it is not REAL or BOOL.
+    bool addMsr(measure* m);
+    /// Visit the states of \a proc, if needed, and set the measures.
+    long computeMsrs(const stochastic_lldsm* proc);
+
     virtual bool canSkipIndex() {
       return (0==p[x.current_state_index]);
     }
+    virtual bool visit();
 
-    inline bool infinitySubtract(measure* m) {
+  protected:
+    /// Add the term for the current state to a; true if it becomes null.
+    bool addRealTerm(measure* m, result &a);
+    /// Add the term for the current state to a; true if it becomes null.
+    bool addBoolTerm(measure* m, result &a);
+
+    /// Try to compile m into vp; returns its register or -1.
+    int compileMsr(measure* m);
+    /// Add the current state to the block; false if it cannot be decoded.
+    bool addToBlock();
+    /// Evaluate the block and add its terms to the compiled measures.
+    void flushBlock();
+    /// Compute what we can symbolically; returns the number computed.
+    long sumMeasures(const stochastic_lldsm* sp);
+
+    inline bool infinitySubtract(measure* m, result &a) {
       if (em->startError()) {
         em->causedBy(m);
         em->cerr() << "Undefined operation (infty-infty) while computing ";
         em->cerr() << m->Name();
         em->stopIO();
       }
-      ans.setNull();
+      a.setNull();
       return true;
     }
   };
 
-  class realmsr_visitor : public msr_visitor {
-  public:
-    realmsr_visitor(const hldsm* mdl, double* &p);
-    virtual bool visit();
-  };
-
-  class boolmsr_visitor : public msr_visitor {
-  public:
-    boolmsr_visitor(const hldsm* mdl, double* &p);
-    virtual bool visit();
-  };
-
-
   void GenerateProc(hldsm* m) const;
 
   inline bool startMsrs(const char* what, const char* name) { 
@@ -130,28 +163,84 @@ protected:
 named_msg exact_mcmsr::eng_debug;
 named_msg exact_mcmsr::eng_report;
 engtype* exact_mcmsr::ProcessGeneration = 0;
+const long exact_mcmsr::msrlist_visitor::block_states;
 
 // **************************************************************************
-// *                          msr_visitor  methods                          *
+// *                        msrlist_visitor  methods                        *
 // **************************************************************************
 
-exact_mcmsr::msr_visitor::msr_visitor(const hldsm* mdl, double* &_p)
+exact_mcmsr::msrlist_visitor::msrlist_visitor(const hldsm* mdl, double* &_p)
  : state_visitor(mdl), p(_p)
 {
   x.answer = &tmp;
   proc = 0;
+  live = 0;
+  compiled = 0;
+  blk_used = 0;
 }
 
-// **************************************************************************
-// *                        realmsr_visitor  methods                        *
-// **************************************************************************
+bool exact_mcmsr::msrlist_visitor::addMsr(measure* m)
+{
+  DCASSERT(m);
+  const type* mt = m->RHSType();
+  if (mt) mt = mt->getBaseType();
+  if (mt != em->REAL && mt != em->BOOL) return false;
+
+  m->PrecomputeRHS();
+  msrs.push_back(m);
+  is_bool.push_back(mt == em->BOOL);
+  ans.push_back(result());
+  ans.back().setReal(0);
+  vreg.push_back(compileMsr(m));
+  if (vreg.back() >= 0) compiled++;
+  live++;
+  return true;
+}
 
-exact_mcmsr::realmsr_visitor::realmsr_visitor(const hldsm* mdl, double* &_p)
- : msr_visitor(mdl, _p)
+long exact_mcmsr::msrlist_visitor::computeMsrs(const stochastic_lldsm* sp)
 {
+  DCASSERT(sp);
+  if (msrs.empty()) return 0;
+  long count = sumMeasures(sp);
+  if (!msrs.empty()) {
+    if (compiled) {
+      vp.setBlockSize(block_states);
+      blk_index.resize(block_states);
+      blk_used = 0;
+    }
+    sp->visitStates(*this);
+    if (blk_used) flushBlock();
+    for (size_t i=0; i<msrs.size(); i++) {
+      msrs[i]->SetValue(ans[i]);
+    }
+    count += msrs.size();
+  }
+  msrs.clear();
+  is_bool.clear();
+  ans.clear();
+  vreg.clear();
+  vp.clear();
+  compiled = 0;
+  live = 0;
+  return count;
 }
 
-bool exact_mcmsr::realmsr_visitor::visit()
+bool exact_mcmsr::msrlist_visitor::visit()
+{
+  // states we cannot decode (unknown values) are walked instead
+  bool blocked = compiled && addToBlock();
+  for (size_t i=0; i<msrs.size(); i++) {
+    if (blocked && vreg[i] >= 0) continue;
+    if (ans[i].isNull()) continue;
+    bool gone = is_bool[i] 
+      ? addBoolTerm(msrs[i], ans[i]) 
+      : addRealTerm(msrs[i], ans[i]);
+    if (gone) live--;
+  }
+  return 0==live;
+}
+
+bool exact_mcmsr::msrlist_visitor::addRealTerm(measure* m, result &a)
 {
   DCASSERT(m->RHSType());
   DCASSERT(m->RHSType()->getBaseType() == em->REAL);
@@ -162,21 +251,21 @@ bool exact_mcmsr::realmsr_visitor::visit()
 
     if (proc && !proc->isTransient(x.current_state_index)) {
       // this term is +/- infinity
-      if (ans.isInfinity()) {
+      if (a.isInfinity()) {
         // check if signs match
-        if (ans.signInfinity() != SIGN(term)) {
-          return infinitySubtract(m);
+        if (a.signInfinity() != SIGN(term)) {
+          return infinitySubtract(m, a);
         }
         // they match, we're fine
       } else {
-        ans.setInfinity(SIGN(term));
+        a.setInfinity(SIGN(term));
       }
     } else { 
       // this term is finite
-      if (ans.isInfinity()) {
+      if (a.isInfinity()) {
         // do nothing
       } else {
-        ans.setReal(ans.getReal() + term);
+        a.setReal(a.getReal() + term);
       }
     }
     return false;
@@ -184,31 +273,22 @@ bool exact_mcmsr::realmsr_visitor::visit()
     
   if (tmp.isInfinity()) {
     int termsign = SIGN(p[x.current_state_index] * tmp.signInfinity());
-    if (ans.isInfinity()) {
-      if (ans.signInfinity() != termsign) {
-        return infinitySubtract(m);
+    if (a.isInfinity()) {
+      if (a.signInfinity() != termsign) {
+        return infinitySubtract(m, a);
       }
     } else {
-      ans.setInfinity(termsign);
+      a.setInfinity(termsign);
     }
   }
 
   // abnormal result, deal with it
   DCASSERT(tmp.isNull());
-  ans.setNull();
+  a.setNull();
   return true;
 }
 
-// **************************************************************************
-// *                        boolmsr_visitor  methods                        *
-// **************************************************************************
-
-exact_mcmsr::boolmsr_visitor::boolmsr_visitor(const hldsm* mdl, double* &_p)
- : msr_visitor(mdl, _p)
-{
-}
-
-bool exact_mcmsr::boolmsr_visitor::visit()
+bool exact_mcmsr::msrlist_visitor::addBoolTerm(measure* m, result &a)
 {
   DCASSERT(m->RHSType());
   DCASSERT(m->RHSType()->getBaseType() == em->BOOL);
@@ -217,29 +297,117 @@ bool exact_mcmsr::boolmsr_visitor::visit()
     if (false == tmp.getBool()) return false;
     if (proc && !proc->isTransient(x.current_state_index)) {
       // this term is +/- infinity
-      if (ans.isInfinity()) {
-        if (ans.signInfinity() != SIGN(p[x.current_state_index])) {
-          return infinitySubtract(m);
+      if (a.isInfinity()) {
+        if (a.signInfinity() != SIGN(p[x.current_state_index])) {
+          return infinitySubtract(m, a);
         }
       } else {
-        ans.setInfinity(SIGN(p[x.current_state_index]));
+        a.setInfinity(SIGN(p[x.current_state_index]));
       }
     } else {
       // this term is finite
-      if (ans.isInfinity()) {
+      if (a.isInfinity()) {
         // do nothing
       } else {
-        ans.setReal(ans.getReal() + p[x.current_state_index]);
+        a.setReal(a.getReal() + p[x.current_state_index]);
       }
     }
     return false;
   }
 
   DCASSERT(tmp.isNull());
-  ans.setNull();
+  a.setNull();
   return true;
 }
 
+long exact_mcmsr::msrlist_visitor::sumMeasures(const stochastic_lldsm* sp)
+{
+  // Infinite terms need the per-state checks
+  if (proc) return 0;
+
+  std::vector <bool> done(msrs.size(), false);
+  if (0==sp->sumMeasures(p, msrs, ans, done)) return 0;
+
+  // Set those, and keep the rest for visiting
+  long count = 0;
+  size_t j = 0;
+  for (size_t i=0; i<msrs.size(); i++) {
+    if (done[i]) {
+      msrs[i]->SetValue(ans[i]);
+      if (vreg[i] >= 0) compiled--;
+      live--;
+      count++;
+      continue;
+    }
+    msrs[j] = msrs[i];
+    is_bool[j] = is_bool[i];
+    ans[j] = ans[i];
+    vreg[j] = vreg[i];
+    j++;
+  }
+  msrs.resize(j);
+  is_bool.resize(j);
+  ans.resize(j);
+  vreg.resize(j);
+  return count;
+}
+
+int exact_mcmsr::msrlist_visitor::compileMsr(measure* m)
+{
+  // Infinite terms need the per-state checks
+  if (proc) return -1;
+
+  traverse_data cx(traverse_data::BuildVectorProgram);
+  result foo;
+  cx.answer = &foo;
+  cx.current_state = x.current_state;
+  cx.vprog = &vp;
+  int start = vp.numInstructions();
+  int r = m->BuildVectorRHS(cx);
+  if (r<0) vp.rollback(start);
+  return r;
+}
+
+bool exact_mcmsr::msrlist_visitor::addToBlock()
+{
+  DCASSERT(x.current_state);
+  DCASSERT(blk_used < block_states);
+  const int nsv = vp.numStateVars();
+  for (int j=0; j<nsv; j++) {
+    if (x.current_state->unknown(vp.stateVarIndex(j))) return false;
+  }
+  for (int j=0; j<nsv; j++) {
+    vp.stateVarColumn(j)[blk_used] = x.current_state->get(vp.stateVarIndex(j));
+  }
+  blk_index[blk_used] = x.current_state_index;
+  blk_used++;
+  if (block_states == blk_used) flushBlock();
+  return true;
+}
+
+void exact_mcmsr::msrlist_visitor::flushBlock()
+{
+  vp.evaluate(blk_used);
+  for (size_t i=0; i<msrs.size(); i++) {
+    if (vreg[i] < 0) continue;
+    const double* v = vp.column(vreg[i]);
+    double sum = 0;
+    if (is_bool[i]) {
+      for (long k=0; k<blk_used; k++) {
+        if (v[k]) sum += p[blk_index[k]];
+      }
+    } else {
+      for (long k=0; k<blk_used; k++) {
+        sum += p[blk_index[k]] * v[k];
+      }
+    }
+    // some states may have been walked, and gone null
+    if (!ans[i].isNormal()) continue;
+    ans[i].setReal(ans[i].getReal() + sum);
+  }
+  blk_used = 0;
+}
+
 // **************************************************************************
 // *                          exact_mcmsr  methods                          *
 // **************************************************************************
@@ -320,8 +488,7 @@ void mcex_steady::SolveMeasures(hldsm* mdl, set_of_measures* list)
     ok = proc->computeSteadyState(p);
   }
   if (ok) {
-    realmsr_visitor rv(mdl, p);
-    boolmsr_visitor bv(mdl, p);
+    msrlist_visitor mv(mdl, p);
     long count = 0;
     timer w;
     if (startMsrs("steady-state", mdl->Name())) {
@@ -343,29 +510,15 @@ void mcex_steady::SolveMeasures(hldsm* mdl, set_of_measures* list)
         continue;
       }
       //
-      // Ordinary measure, compute it
+      // Ordinary measure, compute it with the others, below
       //
-      const type* mt = m->RHSType();
-      if (mt) mt = mt->getBaseType();
-      if (mt == em->REAL) {
-        rv.newMsr(m);
-        proc->visitStates(rv);
-        rv.finish();
-        count++;
-        continue;
-      }
-      if (mt == em->BOOL) {
-        bv.newMsr(m);
-        proc->visitStates(bv);
-        bv.finish();
-        count++;
-        continue;
-      }
+      if (mv.addMsr(m)) continue;
       //
       // Some kind of error, null failsafe
       //
       m->SetNull();
     } // for m
+    count += mv.computeMsrs(proc);
     if (stopMsrs(count, "steady-state", mdl->Name(), w)) {
       em->stopIO();
     }
@@ -385,11 +538,15 @@ void mcex_steady::SolveMeasures(hldsm* mdl, set_of_measures* list)
 // **************************************************************************
 
 class mcex_trans : public exact_mcmsr {
+  static long max_batch;
+  friend class init_exactengines;
 public:
   mcex_trans();
   virtual void SolveMeasures(hldsm* m, set_of_measures* list);
 };
 
+long mcex_trans::max_batch = 64;
+
 mcex_trans the_mcex_trans;
 
 // **************************************************************************
@@ -416,10 +573,31 @@ void mcex_trans::SolveMeasures(hldsm* mdl, set_of_measures* list)
   DCASSERT(proc->Type() == lldsm::DTMC || proc->Type() == lldsm::CTMC);
   long NS = proc->getNumStates();
   if (NS < 0) throw Engine_Failed;
-  statevect* dist = 0;
+
+  //
+  // Grab all the measures; they come out in time order.
+  // Count the distinct times, so we know how many
+  // distributions we could compute in one sweep.
+  //
+  std::vector <time_measure*> msrs;
+  long num_times = 0;
+  for (measure* m = list->popMeasure(); m; m=list->popMeasure()) {
+    time_measure* tm = smart_cast <time_measure*> (m);
+    DCASSERT(tm);
+    if (msrs.empty() || tm->GetTime() != msrs.back()->GetTime()) num_times++;
+    msrs.push_back(tm);
+  }
+
+  //
+  // Allocate vectors; one distribution per time point in a batch,
+  // with fewer time points per batch if memory is tight.
+  //
+  long batch = MIN(max_batch, num_times);
+  statedist* dist = 0;
   double* p = 0;
   double* aux1 = 0;
   double* aux2 = 0;
+  double** pt = 0;
   bool ok = true;
   if (NS) {
     p = (double*) malloc(NS * sizeof(double));
@@ -429,77 +607,109 @@ void mcex_trans::SolveMeasures(hldsm* mdl, set_of_measures* list)
       aux2 = (double*) malloc(NS * sizeof(double));
       ok = ok && aux2;
     }
+    if (ok && batch) {
+      pt = (double**) malloc(batch * sizeof(double*));
+      ok = pt;
+    }
+    for (long k=0; ok && k<batch; k++) {
+      pt[k] = (double*) malloc(NS * sizeof(double));
+      if (pt[k]) continue;
+      if (0==k) {
+        ok = false;
+      } else {
+        batch = k;
+      }
+    }
     if (!ok) {
       free(p);
       free(aux1);
       free(aux2);
+      if (pt) for (long k=0; k<batch; k++) free(pt[k]);
+      free(pt);
       throw Out_Of_Memory;
     }
+  } else {
+    batch = 0;
   }
-  double last_time = 0.0;
   statedist* initial = proc->getInitialDistribution();
   initial->ExportTo(p);
   Delete(initial);
-  realmsr_visitor rv(mdl, p);
-  boolmsr_visitor bv(mdl, p);
+  double* curr = p;
+  msrlist_visitor mv(mdl, curr);
 
-  // go through measures
-  for (measure* m = list->popMeasure(); m; m=list->popMeasure()) {
+  //
+  // Go through measures, one batch of time points at a time.
+  // Each batch continues from the distribution at the 
+  // last time point of the previous batch.
+  //
+  double last_time = 0.0;
+  double* times = batch ? new double[batch] : 0;
+  long nt = 0;
+  long k = -1;
+  for (size_t i=0; i<msrs.size(); i++) {
     if (!ok) break;
-    time_measure* tm = smart_cast <time_measure*> (m);
-    DCASSERT(tm);
-    double dt = tm->GetTime() - last_time;
-    DCASSERT(dt >= 0);
-    if (dt) {
+    time_measure* tm = msrs[i];
+    const bool new_time = (0==i) || (tm->GetTime() != msrs[i-1]->GetTime());
+    if (new_time) {
+      // Finish the measures for the previous time point
+      mv.computeMsrs(proc);
       dist = 0;
+      k++;
+    }
+    if (batch && new_time && (k >= nt)) {
+      //
+      // Compute the next batch of distributions
+      //
+      nt = 0;
+      for (size_t j=i; j<msrs.size() && nt<batch; j++) {
+        if (j>i && msrs[j]->GetTime() == msrs[j-1]->GetTime()) continue;
+        times[nt] = msrs[j]->GetTime() - last_time;
+        DCASSERT(times[nt] >= 0);
+        nt++;
+      }
       if (eng_debug.startReport()) {
-        eng_debug.report() << "time = " << tm->GetTime();
-        eng_debug.report() << ", delta = " << dt << "\n";
+        eng_debug.report() << "times " << last_time + times[0];
+        eng_debug.report() << " to " << last_time + times[nt-1];
+        eng_debug.report() << ", " << nt << " time points\n";
         eng_debug.stopIO();
       }
-      ok = proc->computeTransient(dt, p, aux1, aux2);
-      last_time = tm->GetTime();
+      ok = proc->computeTransients(times, nt, p, pt, aux1, aux2);
+      last_time += times[nt-1];
+      k = 0;
       if (!ok) break;
-    } // if dt
-    if (em->STATEDIST == m->Type()) {
+    }
+    if (batch) curr = pt[k];
+
+    if (em->STATEDIST == tm->Type()) {
         //
         // This is a distribution measure, just copy it!
         //
         result v;
         if (0==dist) {
-          dist = new statedist(proc, p, NS);
+          dist = new statedist(proc, curr, NS);
           v.setPtr(dist);
         } else {
           v.setPtr(Share(dist));
         }
-        m->SetValue(v);
+        tm->SetValue(v);
         continue;
     }
     //
-    // Ordinary measure, compute it
+    // Ordinary measure, compute it with the others at this time point
     //
-    const type* mt = tm->RHSType();
-    if (mt) mt = mt->getBaseType();
-    if (mt == em->REAL) {
-      rv.newMsr(m);
-      proc->visitStates(rv);
-      rv.finish();
-      continue;
-    }
-    if (mt == em->BOOL) {
-      bv.newMsr(m);
-      proc->visitStates(bv);
-      bv.finish();
-      continue;
-    }
+    if (mv.addMsr(tm)) continue;
     //
     // Some kind of error, null failsafe
     //
-    m->SetNull();
-  } // for m
+    tm->SetNull();
+  } // for i
+  if (ok) mv.computeMsrs(proc);
+  delete[] times;
   free(p);
   free(aux1);
   free(aux2);
+  for (long j=0; j<batch; j++) free(pt[j]);
+  free(pt);
   if (eng_debug.startReport()) {
     eng_debug.report() << "Finished exact transient engine\n";
     eng_debug.stopIO();
@@ -569,8 +779,7 @@ void mcex_acc::SolveMeasures(hldsm* mdl, set_of_measures* list)
   statedist* initial = proc->getInitialDistribution();
   initial->ExportTo(p0);
   Delete(initial);
-  realmsr_visitor rv(mdl, n);
-  boolmsr_visitor bv(mdl, n);
+  msrlist_visitor mv(mdl, n);
 
   // go through measures
   for (measure* m = list->popMeasure(); m; m=list->popMeasure()) {
@@ -579,6 +788,10 @@ void mcex_acc::SolveMeasures(hldsm* mdl, set_of_measures* list)
     DCASSERT(tm);
     double dt = tm->GetTime() - last_start;
     DCASSERT(dt >= 0);
+    if (dt || last_stop != tm->GetStopTime()) {
+      // Finish the measures for the previous interval
+      mv.computeMsrs(proc);
+    }
     if (dt) {
       if (eng_debug.startReport()) {
         eng_debug.report() << "time = " << tm->GetTime();
@@ -595,22 +808,10 @@ void mcex_acc::SolveMeasures(hldsm* mdl, set_of_measures* list)
       last_stop = tm->GetStopTime();
       ok = proc->computeAccumulated(last_stop-last_start, p0, n, aux1, aux2);
     } // if dt
-    const type* mt = tm->RHSType();
-    if (mt) mt = mt->getBaseType();
-    if (mt == em->REAL) {
-      rv.newMsr(m);
-      proc->visitStates(rv);
-      rv.finish();
-      continue;
-    }
-    if (mt == em->BOOL) {
-      bv.newMsr(m);
-      proc->visitStates(bv);
-      bv.finish();
-      continue;
-    }
+    if (mv.addMsr(m)) continue;
     m->SetNull();
   } // for m
+  if (ok) mv.computeMsrs(proc);
   free(p0);
   free(n);
   free(aux1);
@@ -687,10 +888,8 @@ void mcex_infacc::SolveMeasures(hldsm* mdl, set_of_measures* list)
   statedist* initial = proc->getInitialDistribution();
   initial->ExportTo(p0);
   Delete(initial);
-  realmsr_visitor rv(mdl, n);
-  rv.infinity_on_recurrent(proc->getPROC());
-  boolmsr_visitor bv(mdl, n);
-  bv.infinity_on_recurrent(proc->getPROC());
+  msrlist_visitor mv(mdl, n);
+  mv.infinity_on_recurrent(proc->getPROC());
 
   // go through measures
   for (measure* m = list->popMeasure(); m; m=list->popMeasure()) {
@@ -700,6 +899,8 @@ void mcex_infacc::SolveMeasures(hldsm* mdl, set_of_measures* list)
     double dt = tm->GetTime() - last_time;
     DCASSERT(dt >= 0);
     if (dt || not_computed) {
+      // Finish the measures for the previous time
+      mv.computeMsrs(proc);
       if (eng_debug.startReport()) {
         eng_debug.report() << "time = " << tm->GetTime();
         eng_debug.report() << ", delta = " << dt << "\n";
@@ -714,23 +915,11 @@ void mcex_infacc::SolveMeasures(hldsm* mdl, set_of_measures* list)
       if (!ok) break;
     } // if dt
 
-    // evaluate measure
-    const type* mt = tm->RHSType();
-    if (mt) mt = mt->getBaseType();
-    if (mt == em->REAL) {
-      rv.newMsr(m);
-      proc->visitStates(rv);
-      rv.finish();
-      continue;
-    }
-    if (mt == em->BOOL) {
-      bv.newMsr(m);
-      proc->visitStates(bv);
-      bv.finish();
-      continue;
-    }
+    // evaluate measure, with the others at this time
+    if (mv.addMsr(m)) continue;
     m->SetNull();
   } // for m
+  if (ok) mv.computeMsrs(proc);
   free(p0);
   free(n);
   free(aux1);
@@ -1028,6 +1217,14 @@ bool init_exactengines::execute()
   RegisterEngine(em, "AvgPh", exact, desc, &the_exact_ph_avg);
   RegisterEngine(em, "VarPh", exact, desc, &the_exact_ph_var);
 
+  em->addOption(
+    MakeIntOption(
+      "TransientBatchSize",
+      "Maximum number of time points whose distributions are computed together, with a single uniformization sweep, for exact transient measures.  Each time point in a batch requires a vector with one probability per state; if memory is tight, fewer time points are used.",
+      mcex_trans::max_batch, 1, 1000000
+    )
+  );
+
   exact_mcmsr::ProcessGeneration = em->findEngineType("ProcessGeneration");
 
   return true;
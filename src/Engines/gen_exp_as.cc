@@ -380,6 +380,15 @@ protected:
 	void generateMC(dsde_hlm* m, StateLib::state_db* ss, LS_Vector &s0,
 			MCLib::vanishing_chain* smp) const;
 
+	/// Should we use parallel generation for this model.
+	inline static bool useThreads(dsde_hlm* dsm) {
+		if (numThreads() < 2)
+			return false;
+		if (Debug().isActive())
+			return false;
+		return parallel_explorer::appliesTo(*dsm);
+	}
+
 	inline void initial_distro(const LS_Vector &init) const {
 		if (!Debug().startReport())
 			return;
@@ -599,12 +608,22 @@ void as_procgen::generateRG(dsde_hlm* dsm, StateLib::state_db* tandb,
 
 	if (rg) {
 		indexed_reachgraph myrg(*tandb, *vandb, *rg);
-		generateRGt<indexed_reachgraph, long>(Debug(), *dsm, myrg);
+		if (useThreads(dsm)) {
+			generateRGt_parallel<indexed_reachgraph, long>(Debug(), *dsm, myrg,
+					numThreads());
+		} else {
+			generateRGt<indexed_reachgraph, long>(Debug(), *dsm, myrg);
+		}
 		myrg.exportInitial(s0);
 		myrg.finish();
 	} else {
 		indexed_statedbs myrs(*tandb, *vandb);
-		generateRGt<indexed_statedbs, long>(Debug(), *dsm, myrs);
+		if (useThreads(dsm)) {
+			generateRGt_parallel<indexed_statedbs, long>(Debug(), *dsm, myrs,
+					numThreads());
+		} else {
+			generateRGt<indexed_statedbs, long>(Debug(), *dsm, myrs);
+		}
 	}
 
 	delete vandb;
@@ -624,7 +643,11 @@ void as_procgen::generateMC(dsde_hlm* dsm, StateLib::state_db* tandb,
 
 		indexed_smp mysmp(*dsm, *tandb, *vandb, vansolver, *smp);
 
-		switch (remove_vanishing) {
+		if (useThreads(dsm)) {
+			// No vanishing states, so nothing to remove
+			generateMCt_parallel<indexed_smp, long>(Debug(), *dsm, mysmp,
+					numThreads());
+		} else switch (remove_vanishing) {
 		case BY_PATH:
 			generateMCt<indexed_smp, long>(Debug(), *dsm, mysmp);
 			break;
@@ -643,7 +666,10 @@ void as_procgen::generateMC(dsde_hlm* dsm, StateLib::state_db* tandb,
 
 		indexed_statedbs myrs(*tandb, *vandb);
 
-		switch (remove_vanishing) {
+		if (useThreads(dsm)) {
+			generateMCt_parallel<indexed_statedbs, long>(Debug(), *dsm, myrs,
+					numThreads());
+		} else switch (remove_vanishing) {
 		case BY_PATH:
 			generateMCt<indexed_statedbs, long>(Debug(), *dsm, myrs);
 			break;
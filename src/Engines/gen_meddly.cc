@@ -8,6 +8,7 @@
 #include "../Modules/expl_states.h"
 #include "../Formlsms/dsde_hlm.h"
 #include "../Formlsms/rss_meddly.h"
+#include "../Formlsms/proc_meddly.h"
 #include<map>
 #include<vector>
 
@@ -185,6 +186,21 @@ MEDDLY::dd_edge meddly_varoption::buildPotentialDeadlockStates_IMPLICIT(named_ms
   return result;
 }
 
+void meddly_varoption::writeLocalStates(std::ostream &out) const
+{
+  const int head[2] = { LOCAL_STATES_MAGIC, 0 };
+  out.write((const char*) head, sizeof(head));
+}
+
+size_t meddly_varoption::readLocalStates(const unsigned char* data, size_t len)
+{
+  int head[2];
+  if (len < sizeof(head)) return 0;
+  memcpy(head, data, sizeof(head));
+  if (head[0] != LOCAL_STATES_MAGIC || head[1] != 0) return 0;
+  return sizeof(head);
+}
+
 // **************************************************************************
 // *                                                                        *
 // *                         bounded_encoder  class                         *
@@ -193,6 +209,7 @@ MEDDLY::dd_edge meddly_varoption::buildPotentialDeadlockStates_IMPLICIT(named_ms
 
 class bounded_encoder : public meddly_encoder {
   long* terms;
+  float* fterms;
   int maxbound;
   long lastcomputed;
   traverse_data tdx;
@@ -230,6 +247,7 @@ bounded_encoder
   DCASSERT(parent.hasPartInfo());
   maxbound = MAX(parent.getPartInfo().num_levels+1, max_var_size);
   terms = new long[maxbound];
+  fterms = 0;
   expl_state = new shared_state(&p);
   tdx.answer = &ans;
   tdx.current_state = expl_state;
@@ -238,6 +256,7 @@ bounded_encoder
 bounded_encoder::~bounded_encoder()
 {
   delete[] terms;
+  delete[] fterms;
   Delete(expl_state);
 }
 
@@ -262,7 +281,13 @@ void bounded_encoder
   FillTerms(mv, parent.getPartInfo().pointer[level], i, f);
 
   try {
-    F->createEdgeForVar(level, primed, terms, dd->E);
+    if (MEDDLY::forest::REAL == F->getRangeType()) {
+      if (0==fterms) fterms = new float[maxbound];
+      for (int j=0; j<i; j++) fterms[j] = terms[j];
+      F->createEdgeForVar(level, primed, fterms, dd->E);
+    } else {
+      F->createEdgeForVar(level, primed, terms, dd->E);
+    }
 
 #ifdef DEBUG_BUILD_SV
     fprintf(stderr, "%#010lx: ", (unsigned long)answer);
@@ -475,7 +500,21 @@ void bounded_varoption::updateEvents(named_msg &d, bool* cl)
     event_firing[i]->show(stdout, 2);
 #endif
 
-    (*event_firing[i]) *= mask;
+    try {
+      (*event_firing[i]) *= mask;
+    }
+    catch (error ce) {
+      if (getParent().StartError(0)) {
+        getParent().SendError("Meddly error ");
+        getParent().SendError(ce.getName());
+        getParent().SendError(" for firing of event ");
+        getParent().SendError(e->Name());
+        getParent().DoneError();
+      }
+      if (error::INSUFFICIENT_MEMORY == ce.getCode())
+        throw subengine::Out_Of_Memory;
+      throw subengine::Engine_Failed;
+    }
 
 #ifdef DEBUG_EVENT_OVERALL
     printf("Final next state for event %s:\n", e->Name());
@@ -528,11 +567,27 @@ void bounded_varoption
   x.ddlib = mtmxd_wrap;
 
   // First, build the expr as an MTMXD
-  e->Traverse(x);
+  try {
+    e->Traverse(x);
+  }
+  catch (sv_encoder::error se) {
+    if (getParent().StartError(0)) {
+      getParent().SendError("Couldn't build ");
+      getParent().SendError(what);
+      getParent().SendError(" ");
+      getParent().SendError(who);
+      getParent().SendError(": ");
+      getParent().SendError(sv_encoder::getNameOfError(se));
+      getParent().DoneError();
+    }
+    if (sv_encoder::Out_Of_Memory == se) throw subengine::Out_Of_Memory;
+    throw subengine::Engine_Failed;
+  }
   if (foo.isNull()) {
     if (getParent().StartError(0)) {
       getParent().SendError("Got null result for ");
       getParent().SendError(what);
+      getParent().SendError(" ");
       getParent().SendError(who);
       getParent().DoneError();
     }
@@ -561,6 +616,7 @@ void bounded_varoption
       getParent().SendError(ce.getName());
       getParent().SendError(" for ");
       getParent().SendError(what);
+      getParent().SendError(" ");
       getParent().SendError(who);
       getParent().DoneError();
     }
@@ -669,6 +725,18 @@ void bounded_varoption::buildNoChange(const model_event &e, dd_edge &dd)
       throw subengine::Engine_Failed;
     }
   } // catch
+  catch (sv_encoder::error e) {
+    Delete(x);
+    Delete(xp);
+    if (getParent().StartError(0)) {
+      getParent().SendError("Error ");
+      getParent().SendError(sv_encoder::getNameOfError(e));
+      getParent().SendError(" in buildNoChange");
+      getParent().DoneError();
+    }
+    if (sv_encoder::Out_Of_Memory == e) throw subengine::Out_Of_Memory;
+    throw subengine::Engine_Failed;
+  }
 }
 
 
@@ -1695,6 +1763,8 @@ public:
   virtual void initializeVars();
   virtual void initializeEvents(named_msg &d);
   virtual void reportStats(DisplayStream &out) const;
+  virtual void writeLocalStates(std::ostream &out) const;
+  virtual size_t readLocalStates(const unsigned char* data, size_t len);
 
   //
   // TBD - for now
@@ -2086,6 +2156,83 @@ void substate_varoption::reportStats(DisplayStream &out) const
   colls->Report(out);
 }
 
+void substate_varoption::writeLocalStates(std::ostream &out) const
+{
+  DCASSERT(colls);
+  const int head[2] = { LOCAL_STATES_MAGIC, num_levels };
+  out.write((const char*) head, sizeof(head));
+  for (int k=1; k<=num_levels; k++) {
+    const int ssz = tdcurr->readSubstateSize(k);
+    int* chunk = new int[ssz];
+    const int count = colls->getMaxIndex(k);
+    out.write((const char*) &count, sizeof(int));
+    for (int i=0; i<count; i++) {
+      // returns the next index, not a size; substates have size ssz
+      if (colls->getSubstate(k, i, chunk, ssz) < 0) {
+        delete[] chunk;
+        throw subengine::Engine_Failed;
+      }
+      out.write((const char*) &ssz, sizeof(int));
+      out.write((const char*) chunk, ssz * sizeof(int));
+    }
+    delete[] chunk;
+  }
+}
+
+size_t substate_varoption::readLocalStates(const unsigned char* data, size_t len)
+{
+  DCASSERT(colls);
+  const unsigned char* end = data + len;
+  const unsigned char* ptr = data;
+
+  int head[2];
+  if (end - ptr < long(sizeof(head))) return 0;
+  memcpy(head, ptr, sizeof(head));
+  ptr += sizeof(head);
+  if (head[0] != LOCAL_STATES_MAGIC || head[1] != num_levels) return 0;
+
+  expert_domain* d = static_cast<expert_domain*>(getMddForest()->useDomain());
+  bool ok = true;
+  for (int k=1; ok && k<=num_levels; k++) {
+    const int ssz = tdcurr->readSubstateSize(k);
+    int* chunk = new int[ssz];
+    int count;
+    if (end - ptr < long(sizeof(int))) {
+      ok = false;
+      count = 0;
+    } else {
+      memcpy(&count, ptr, sizeof(int));
+      ptr += sizeof(int);
+    }
+    for (int i=0; ok && i<count; i++) {
+      int sz;
+      ok = (end - ptr >= long(sizeof(int)));
+      if (!ok) break;
+      memcpy(&sz, ptr, sizeof(int));
+      ptr += sizeof(int);
+      ok = (sz == ssz && end - ptr >= long(sz * sizeof(int)));
+      if (!ok) break;
+      memcpy(chunk, ptr, sz * sizeof(int));
+      ptr += sz * sizeof(int);
+      // existing substates (initial ones) must keep their index
+      ok = (colls->addSubstate(k, chunk, sz) == i);
+    }
+    delete[] chunk;
+    if (!ok) break;
+
+    enlarge(confirmed[k], count);
+    enlarge(toBeExplored[k], count);
+    if (count > d->getVariableBound(k, false)) {
+      expert_variable* vh = d->getExpertVar(k);
+      if (vh->isExtensible())
+        vh->enlargeBound(false, -count);
+      else
+        vh->enlargeBound(false, count);
+    }
+  }
+  return ok ? ptr - data : 0;
+}
+
 
 satotf_opname::otf_relation* substate_varoption::buildNSF_OTF(named_msg &debug)
 {
@@ -3356,6 +3503,10 @@ int meddly_procgen::edge_style;
 int meddly_procgen::var_type;
 int meddly_procgen::nsf_ndp;
 int meddly_procgen::rss_ndp;
+long meddly_procgen::gc_increment;
+long meddly_procgen::gc_memory_trigger;
+long meddly_procgen::memory_limit;
+long meddly_procgen::saturation_threads;
 bool meddly_procgen::uses_xdds;
 
 meddly_procgen::meddly_procgen()
@@ -3367,6 +3518,25 @@ meddly_procgen::~meddly_procgen()
 {
 }
 
+void meddly_procgen::useSaturationThreads()
+{
+  if (saturation_threads == MEDDLY::getNumThreads()) return;
+  //
+  // Threads can share only the lossy compute table
+  //
+  if (saturation_threads > 1) {
+    MEDDLY::ct_initializer::setBuiltinStyle(
+      MEDDLY::ct_initializer::MonolithicLossyHash
+    );
+  } else {
+    MEDDLY::ct_initializer::setBuiltinStyle(
+      MEDDLY::ct_initializer::MonolithicUnchainedHash
+    );
+  }
+  MEDDLY::ct_initializer::rebuildTables();
+  MEDDLY::setNumThreads(saturation_threads);
+}
+
 meddly_varoption* 
 meddly_procgen::makeBounded(const dsde_hlm &m, meddly_reachset &ms) const
 {
@@ -3426,6 +3596,9 @@ meddly_procgen::buildNSFPolicies() const
       p.setPessimistic();
       break;
   } // switch
+  p.gcIncrement = gc_increment;
+  p.memoryTrigger = gc_memory_trigger;
+  p.memoryLimit = memory_limit;
 
   return p;
 }
@@ -3448,6 +3621,9 @@ meddly_procgen::buildRSSPolicies() const
       p.setPessimistic();
       break;
   } // switch
+  p.gcIncrement = gc_increment;
+  p.memoryTrigger = gc_memory_trigger;
+  p.memoryLimit = memory_limit;
 
   return p;
 }
@@ -3536,6 +3712,24 @@ bool init_genmeddly::execute()
     )
   );
 
+  meddly_process::hybrid_level = 0;
+  em->addOption(
+    MakeIntOption(
+      "MeddlyHybridLevel",
+      "If positive, numerical solution of Markov chains stored with Meddly uses a hybrid representation: the submatrices for this level and below are flattened once into sparse blocks, shared by identical submatrices, and each vector-matrix product runs over the blocks.  Much faster for iterative solvers, at the cost of memory for the blocks; a level at or above the number of state variables stores the whole matrix explicitly.  If 0, each product traverses the matrix diagram.",
+      meddly_process::hybrid_level, 0, 1000000
+    )
+  );
+
+  meddly_process::use_descriptor = false;
+  em->addOption(
+    MakeBoolOption(
+      "MeddlyDescriptorSolver",
+      "If true, numerical solution of Markov chains built with Meddly uses a Kronecker descriptor: the rate matrix of each event is kept separately, as a product of small local matrices per level when possible, and each vector-matrix product is computed level by level over the reachable states only.  Useful for structured models, with partitioned state variables, whose matrix is too large for other representations.  Events whose rates depend on several levels are multiplied using their matrix diagram.",
+      meddly_process::use_descriptor
+    )
+  );
+
   // variable type option
   styles = new radio_button*[4];
   styles[meddly_procgen::BOUNDED] = new radio_button(
@@ -3590,6 +3784,42 @@ bool init_genmeddly::execute()
     )
   );
 
+  meddly_procgen::gc_increment = 0;
+  em->addOption(
+    MakeIntOption(
+      "MeddlyGCIncrement",
+      "If positive, garbage collection in the next-state function and reachable state space forests in Meddly is incremental: each new node scans at most this many compute table slots for stale entries, until the whole table has been swept.  If 0, each collection sweeps the whole table at once.",
+      meddly_procgen::gc_increment, 0, 1000000000
+    )
+  );
+
+  meddly_procgen::gc_memory_trigger = 0;
+  em->addOption(
+    MakeIntOption(
+      "MeddlyGCMemoryTrigger",
+      "If positive, garbage collection in the next-state function and reachable state space forests in Meddly is triggered when the memory used for nodes in a forest exceeds this many bytes, instead of by the number of zombie or orphan nodes.  If the live nodes alone exceed it, the next collection waits until node memory grows by half.",
+      meddly_procgen::gc_memory_trigger, 0, 1000000000000L
+    )
+  );
+
+  meddly_procgen::memory_limit = 0;
+  em->addOption(
+    MakeIntOption(
+      "MeddlyMemoryLimit",
+      "If positive, a soft limit on the bytes of node memory in each next-state function and reachable state space forest in Meddly.  When a forest exceeds it, the compute tables are emptied and shrunk, then garbage is collected and memory compacted; if the forest is still over the limit, generation fails with an out of memory error.  If 0, there is no limit.",
+      meddly_procgen::memory_limit, 0, 1000000000000L
+    )
+  );
+
+  meddly_procgen::saturation_threads = 1;
+  em->addOption(
+    MakeIntOption(
+      "MeddlySaturationThreads",
+      "Number of threads for Meddly saturation (option MeddlyProcessGeneration set to SATURATION).  With more than one, events at the same level are fired in parallel, and the compute table switches to a fixed-size lossy hash table that the threads can share.  Other algorithms, including on-the-fly and implicit saturation, run on one thread.",
+      meddly_procgen::saturation_threads, 1, 1024
+    )
+  );
+
   meddly_varoption::vars_named = false;
   em->addOption(
     MakeBoolOption(
@@ -204,8 +204,34 @@ public:
     return ms.getMddForest();
   }
 
+  inline MEDDLY::forest* getMxdForest() {
+    return get_mxd_forest();
+  }
+
   virtual substate_colls* getSubstateStorage() { return 0; }
 
+  /** Write the local state spaces discovered so far,
+      so they can be restored with readLocalStates() in a later run
+      (as part of a checkpoint, for instance).
+      The default has no local state spaces to write.
+  */
+  virtual void writeLocalStates(std::ostream &out) const;
+
+  /** Restore local state spaces written by writeLocalStates(),
+      after initializeVars().  Substates get the same indexes
+      they had when written, and variable bounds are enlarged
+      to match.
+        @param  data  Start of the data.
+        @param  len   Bytes available at \a data.
+        @return Number of bytes used, or 0 if the data
+                does not match this model.
+  */
+  virtual size_t readLocalStates(const unsigned char* data, size_t len);
+
+protected:
+  /// Marks the start of the local state spaces, in files.
+  static const int LOCAL_STATES_MAGIC = 0x534c4d53;
+
 public:
   /// Any pre-processing for the next-state function goes here.
   virtual void initializeEvents(named_msg &debug) = 0;
@@ -300,6 +326,14 @@ class meddly_procgen : public process_generator {
   static const int OPTIMISTIC   = 1;
   static const int PESSIMISTIC  = 2;
 
+  // garbage collection options
+  static long gc_increment;
+  static long gc_memory_trigger;
+  static long memory_limit;
+
+  // parallel saturation option
+  static long saturation_threads;
+
   // Use extensible variables in decision diagrams for on-the-fly saturation
   static bool uses_xdds;
 
@@ -339,6 +373,11 @@ protected:
     return MTMXD == proc_storage;
   }
 
+  /** Set up Meddly for the number of threads given by
+      option MeddlySaturationThreads.  Call before saturation.
+  */
+  static void useSaturationThreads();
+
   /** Build a variable option class, according to option MeddlyVariables.
         @param  ms  meddly_reachset object, for final result (shared).
         @return     A new object of type meddly_varoption, or 0 on error.
@@ -6,6 +6,8 @@
 #include "../ExprLib/exprman.h"
 #include "../ExprLib/mod_inst.h"
 
+#include "../Formlsms/dsde_hlm.h"
+
 #include "../Options/options.h"
 
 #include "../_Timer/timerlib.h"
@@ -19,6 +21,7 @@
 named_msg process_generator::report;
 named_msg process_generator::debug;
 int process_generator::remove_vanishing;
+long process_generator::num_threads = 1;
 
 process_generator::process_generator()
  : subengine()
@@ -180,5 +183,13 @@ bool init_procgen::execute()
     )
   );
 
+  em->addOption(
+    MakeIntOption(
+      "ProcessGenerationThreads",
+      "Number of threads to use for explicit process generation.  With more than one thread, batches of unexplored states are explored in parallel, and the reached states are added afterwards in the same order as with one thread, so states are numbered the same either way.  Used only for models without immediate events, and when process generation debugging is off.",
+      process_generator::num_threads, 1, model_event::max_eval_slots
+    )
+  );
+
   return true;
 }
@@ -21,6 +21,7 @@ class process_generator : public subengine {
   static named_msg debug;
 protected:
   static int remove_vanishing;
+  static long num_threads;
 public:
   static const int BY_PATH = 0;
   static const int BY_SUBGRAPH = 1;
@@ -37,6 +38,11 @@ public:
   // returns true if the report stream is open
   static bool stopCompact(const char* name, const char* wp, const timer &w, const lldsm* proc);
 
+  /// Number of threads to use for explicit generation.
+  inline static int numThreads() {
+    return int(num_threads);
+  }
+
   inline static named_msg& Debug() {
     return debug;
   }
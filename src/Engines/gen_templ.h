@@ -5,6 +5,11 @@
  */
 #include "../_StateLib/lchild_rsiblingt.h"
 
+#include <string.h>
+#include <thread>
+#include <atomic>
+#include <vector>
+
 /**
  Generate reachability graph from a discrete-event high-level model.
  This is a template function, where parameter RG is a generic
@@ -1435,3 +1440,480 @@ void generateMCt(named_msg &debug, dsde_hlm &dsm, MC &mc) {
 	}
 
 }
+
+// **************************************************************************
+// *                                                                        *
+// *                        parallel_explorer class                         *
+// *                                                                        *
+// **************************************************************************
+
+/**
+ Parallel exploration of tangible states, for explicit generation.
+
+ The caller fills a batch of unexplored states (the frontier).
+ Worker threads then determine the enabled events, the reached states,
+ and (if needed) the firing rates, for each frontier state.  Each thread
+ uses its own traverse_data and its own evaluation slot for enabling
+ (see model_event::setEvalSlot()); the calling thread is worker 0.
+ The caller adds the reached states afterwards, in frontier order and
+ then event order, which is exactly the order used by sequential
+ generation; so states are numbered the same either way.
+
+ Only models without immediate events are handled, so every reached
+ state is tangible.  If anything goes wrong for a frontier state,
+ it is explored again by the calling thread, which reports the error.
+*/
+class parallel_explorer {
+	/// Per-thread data.
+	struct worker {
+		traverse_data x;
+		result answer;
+		List<model_event> enabled;
+		shared_state* next;
+
+		worker() : x(traverse_data::Compute) {
+			x.answer = &answer;
+			next = 0;
+		}
+	};
+	/// Results for one frontier state.
+	struct outcome {
+		bool ok;
+		/// Reached states, one after another.
+		std::vector<int> states;
+		std::vector<double> rates;
+		std::vector<const model_event*> events;
+
+		inline void clear() {
+			ok = false;
+			states.clear();
+			rates.clear();
+			events.clear();
+		}
+	};
+
+	dsde_hlm &dsm;
+	int num_threads;
+	bool skip_noops;
+	bool rates;
+	long batch_size;
+	int state_size;
+
+	worker* workers;
+	shared_state** frontier;
+	outcome* results;
+
+	/// Next frontier state to claim, while exploring.
+	std::atomic<long> next_item;
+	/// Number of frontier states, while exploring.
+	long num_items;
+
+	/// Frontier states are claimed this many at a time.
+	static const long CHUNK = 16;
+	/// Frontier states per thread, for each batch.
+	static const long PER_THREAD = 256;
+
+public:
+	/**
+	 Constructor.
+	 @param  dsm   High-level model.
+	 @param  nt    Number of threads, including the calling one.
+	 @param  skip  If true, events without a next-state expression
+	 are ignored; otherwise they give a self loop.
+	 @param  rt    Should we compute the firing rates.
+	 */
+	parallel_explorer(dsde_hlm &m, int nt, bool skip, bool rt) : dsm(m) {
+		num_threads = MIN(nt, model_event::max_eval_slots);
+		if (num_threads < 1)
+			num_threads = 1;
+		skip_noops = skip;
+		rates = rt;
+		batch_size = PER_THREAD * num_threads;
+		workers = new worker[num_threads];
+		for (int t = 0; t < num_threads; t++) {
+			workers[t].next = new shared_state(&dsm);
+		}
+		frontier = new shared_state*[batch_size];
+		for (long i = 0; i < batch_size; i++) {
+			frontier[i] = new shared_state(&dsm);
+		}
+		results = new outcome[batch_size];
+		state_size = frontier[0]->getStateSize();
+		num_items = 0;
+	}
+
+	~parallel_explorer() {
+		for (int t = 0; t < num_threads; t++) {
+			Delete(workers[t].next);
+		}
+		delete[] workers;
+		for (long i = 0; i < batch_size; i++) {
+			Delete(frontier[i]);
+		}
+		delete[] frontier;
+		delete[] results;
+		model_event::setEvalSlot(0);
+	}
+
+	/**
+	 Can we explore this model in parallel?
+	 Requires no immediate events, and fixed-size states.
+	 */
+	static bool appliesTo(dsde_hlm &dsm) {
+		for (int i = 0; i < dsm.getNumEvents(); i++) {
+			if (dsm.readEvent(i)->actsLikeImmediate())
+				return false;
+		}
+		shared_state* tmp = new shared_state(&dsm);
+		bool ok = tmp->isFixedSize();
+		Delete(tmp);
+		return ok;
+	}
+
+	inline long batchSize() const {
+		return batch_size;
+	}
+	inline shared_state* frontierState(long i) {
+		CHECK_RANGE(0, i, batch_size);
+		return frontier[i];
+	}
+	inline long numReached(long i) const {
+		CHECK_RANGE(0, i, num_items);
+		return long(results[i].events.size());
+	}
+	/// Copy the jth state reached from frontier state i.
+	inline void getReached(long i, long j, shared_state* st) const {
+		CHECK_RANGE(0, i, num_items);
+		memcpy(st->writeState(), &results[i].states[j * state_size],
+				state_size * sizeof(int));
+	}
+	inline double getRate(long i, long j) const {
+		CHECK_RANGE(0, i, num_items);
+		return rates ? results[i].rates[j] : 1.0;
+	}
+	inline const model_event* getEvent(long i, long j) const {
+		CHECK_RANGE(0, i, num_items);
+		return results[i].events[j];
+	}
+
+	/**
+	 Explore frontier states 0, ..., n-1.
+	 @throws An appropriate error code
+	 */
+	void explore(long n) {
+		CHECK_RANGE(0, n - 1, batch_size);
+		num_items = n;
+		next_item = 0;
+		std::vector<std::thread> threads;
+		int nt = int(MIN(long(num_threads), (n + CHUNK - 1) / CHUNK));
+		for (int t = 1; t < nt; t++) {
+			threads.push_back(std::thread(Work, this, t));
+		}
+		Work(this, 0);
+		for (unsigned t = 0; t < threads.size(); t++) {
+			threads[t].join();
+		}
+
+		//
+		// Explore again any failed states, in order, so that
+		// the first error is reported as in sequential generation.
+		//
+		for (long i = 0; i < n; i++) {
+			if (results[i].ok)
+				continue;
+			expand(workers[0], i, true);
+		}
+	}
+
+private:
+	static void Work(parallel_explorer* P, int t) {
+		model_event::setEvalSlot(t);
+		for (;;) {
+			long start = P->next_item.fetch_add(CHUNK);
+			if (start >= P->num_items)
+				break;
+			long stop = MIN(start + CHUNK, P->num_items);
+			for (long i = start; i < stop; i++) {
+				try {
+					P->expand(P->workers[t], i, false);
+				} catch (...) {
+					P->results[i].ok = false;
+				}
+			}
+		}
+		model_event::setEvalSlot(0);
+	}
+
+	/**
+	 Explore frontier state i.
+	 On problems: if report is true, display an error and throw;
+	 otherwise, mark the outcome as failed.
+	 */
+	void expand(worker &w, long i, bool report) {
+		outcome &out = results[i];
+		out.clear();
+		traverse_data &x = w.x;
+		x.current_state = frontier[i];
+		x.next_state = w.next;
+
+		//
+		// Make enabling list
+		//
+		dsm.makeTangibleEnabledList(x, &w.enabled);
+		if (!w.answer.isNormal()) {
+			if (!report)
+				return;
+			DCASSERT(1 == w.enabled.Length());
+			if (dsm.StartError(0)) {
+				dsm.SendError("Bad enabling expression for event ");
+				dsm.SendError(w.enabled.Item(0)->Name());
+				dsm.SendError(" during process generation");
+				dsm.DoneError();
+			}
+			throw subengine::Engine_Failed;
+		}
+
+		//
+		// Traverse enabled events
+		//
+		for (int e = 0; e < w.enabled.Length(); e++) {
+			model_event* t = w.enabled.Item(e);
+			DCASSERT(t);
+			if (skip_noops && 0 == t->getNextstate())
+				continue;
+
+			//
+			// t is enabled, fire and get new state
+			//
+			w.next->fillFrom(x.current_state);
+			if (t->getNextstate()) {
+				t->getNextstate()->Compute(x);
+			}
+			if (!w.answer.isNormal()) {
+				if (!report)
+					return;
+				if (dsm.StartError(0)) {
+					dsm.SendError("Bad next-state expression for event ");
+					dsm.SendError(t->Name());
+					dsm.SendError(" during process generation");
+					dsm.OutOfBoundsError(w.answer);
+					dsm.DoneError();
+				}
+				throw subengine::Engine_Failed;
+			}
+
+			//
+			// get the firing rate (if necessary)
+			//
+			if (rates) {
+				x.which = traverse_data::ComputeExpoRate;
+				SafeComputeExpoRate(t->getDistribution(), x);
+				x.which = traverse_data::Compute;
+				if (!w.answer.isNormal() || w.answer.getReal() <= 0.0) {
+					if (!report)
+						return;
+					if (dsm.StartError(0)) {
+						dsm.SendError("Bad value ");
+						dsm.SendRealError(w.answer);
+						dsm.SendError(" for rate of event ");
+						dsm.SendError(t->Name());
+						dsm.DoneError();
+					}
+					throw subengine::Engine_Failed;
+				}
+				out.rates.push_back(w.answer.getReal());
+			}
+
+			//
+			// The reached state must be tangible
+			//
+			SWAP(x.current_state, x.next_state);
+			dsm.checkVanishing(x);
+			SWAP(x.current_state, x.next_state);
+			if (!w.answer.isNormal() || w.answer.getBool()) {
+				if (!report)
+					return;
+				if (dsm.StartError(0)) {
+					dsm.SendError("Couldn't determine vanishing / tangible");
+					dsm.DoneError();
+				}
+				throw subengine::Engine_Failed;
+			}
+
+			const int* st = w.next->readState();
+			out.states.insert(out.states.end(), st, st + state_size);
+			out.events.push_back(t);
+		} // for e
+
+		out.ok = true;
+	}
+};
+
+/**
+ Generate reachability graph from a discrete-event high-level model,
+ using several threads.  Same requirements as generateRGt();
+ the model must satisfy parallel_explorer::appliesTo().
+ The states are numbered exactly as with generateRGt().
+
+ @throws An appropriate error code
+ */
+template<class RG, typename UID>
+void generateRGt_parallel(named_msg &debug, dsde_hlm &dsm, RG &rg,
+		int nthreads) {
+	parallel_explorer P(dsm, nthreads, false, false);
+	std::vector<UID> from(P.batchSize());
+
+	shared_state* st = new shared_state(&dsm);
+	traverse_data x(traverse_data::Compute);
+	result xans;
+	x.answer = &xans;
+	x.current_state = st;
+
+	try {
+		//
+		// Find and insert the initial states
+		//
+		for (int i = 0; i < dsm.NumInitialStates(); i++) {
+			dsm.GetInitialState(i, st);
+			UID id;
+			bool newinit = rg.add(false, st, id);
+			rg.addInitial(id);
+			if (!newinit)
+				continue;
+			dsm.checkAssertions(x);
+			if (0 == xans.getBool()) {
+				throw subengine::Assertion_Failure;
+			}
+		} // for i
+
+		//
+		// Explore in batches
+		//
+		while (rg.hasUnexploredTangible()) {
+			if (debug.caughtTerm()) {
+				if (dsm.StartError(0)) {
+					dsm.SendError(
+							"Process construction prematurely terminated");
+					dsm.DoneError();
+				}
+				throw subengine::Terminated;
+			}
+
+			long n = 0;
+			for (; n < P.batchSize() && rg.hasUnexploredTangible(); n++) {
+				from[n] = rg.getUnexploredTangible(P.frontierState(n));
+			}
+			P.explore(n);
+
+			//
+			// Add reached states and edges, in order
+			//
+			for (long i = 0; i < n; i++) {
+				for (long j = 0; j < P.numReached(i); j++) {
+					P.getReached(i, j, st);
+					UID to;
+					if (rg.add(false, st, to)) {
+						dsm.checkAssertions(x);
+						if (0 == xans.getBool()) {
+							throw subengine::Assertion_Failure;
+						}
+					}
+					if (rg.statesOnly())
+						continue;
+					rg.addEdge(from[i], to);
+				} // for j
+			} // for i
+		} // while
+
+		Delete(st);
+	} // try
+
+	catch (subengine::error e) {
+		Delete(st);
+		throw e;
+	}
+}
+
+/**
+ Generate a Markov chain from a discrete-event high-level model,
+ using several threads.  Same requirements as generateMCt();
+ the model must satisfy parallel_explorer::appliesTo(),
+ so there are no vanishing states.
+ The states are numbered exactly as with generateMCt().
+
+ @throws An appropriate error code
+ */
+template<class MC, typename UID>
+void generateMCt_parallel(named_msg &debug, dsde_hlm &dsm, MC &mc,
+		int nthreads) {
+	parallel_explorer P(dsm, nthreads, true, !mc.statesOnly());
+	std::vector<UID> from(P.batchSize());
+
+	shared_state* st = new shared_state(&dsm);
+	traverse_data x(traverse_data::Compute);
+	result xans;
+	x.answer = &xans;
+	x.current_state = st;
+
+	try {
+		//
+		// Find and insert the initial states
+		//
+		for (int i = 0; i < dsm.NumInitialStates(); i++) {
+			double wt = dsm.GetInitialState(i, st);
+			dsm.checkAssertions(x);
+			if (0 == xans.getBool()) {
+				throw subengine::Assertion_Failure;
+			}
+			UID id;
+			mc.add(false, st, id);
+			mc.addInitial(false, id, wt);
+		} // for i
+
+		//
+		// Explore in batches
+		//
+		while (mc.hasUnexploredTangible()) {
+			if (debug.caughtTerm()) {
+				if (dsm.StartError(0)) {
+					dsm.SendError(
+							"Process construction prematurely terminated");
+					dsm.DoneError();
+				}
+				throw subengine::Terminated;
+			}
+
+			long n = 0;
+			for (; n < P.batchSize() && mc.hasUnexploredTangible(); n++) {
+				from[n] = mc.getUnexploredTangible(P.frontierState(n));
+			}
+			P.explore(n);
+
+			//
+			// Add reached states and edges, in order
+			//
+			for (long i = 0; i < n; i++) {
+				for (long j = 0; j < P.numReached(i); j++) {
+					P.getReached(i, j, st);
+					UID to;
+					if (mc.add(false, st, to)) {
+						dsm.checkAssertions(x);
+						if (0 == xans.getBool()) {
+							throw subengine::Assertion_Failure;
+						}
+					}
+					if (mc.statesOnly())
+						continue;
+					mc.addTTEdge(from[i], to, P.getRate(i, j));
+				} // for j
+			} // for i
+		} // while
+
+		Delete(st);
+	} // try
+
+	catch (subengine::error e) {
+		Delete(st);
+		throw e;
+	}
+}
@@ -84,6 +84,7 @@ void user_varorder::RunEngine(hldsm* hm, result &)
     debug.stopIO();
   }
   dm->useDefaultVarOrder();
+  reportOrder(dm, "user-defined");
 }
 
 // **************************************************************************
@@ -110,9 +111,39 @@ heuristic_varorder the_force_0625_varorder(0, 0.625);
 heuristic_varorder the_force_075_varorder(0, 0.75);
 heuristic_varorder the_force_0875_varorder(0, 0.875);
 heuristic_varorder the_force_100_varorder(0, 1.0);
-heuristic_varorder the_noack_varorder(1, 0);
 heuristic_varorder the_force_param(0, 0.0);
 double heuristic_varorder::alphaParameter = -1.0;
+
+// **************************************************************************
+// *                                                                        *
+// *                       locality_varorder  class                         *
+// *                                                                        *
+// **************************************************************************
+
+/**
+    Orders built from the event dependencies alone,
+    one variable per level.
+*/
+class locality_varorder : public user_varorder {
+public:
+  enum method {
+    /// Greedy: next variable is the one most tied to those placed.
+    NOACK,
+    /// Sloan profile (bandwidth) reduction on the variable graph.
+    SLOAN,
+    /// Local search (sifting) for the smallest sum of event spans.
+    MIN_SPANS
+  };
+  locality_varorder(method m);
+  virtual ~locality_varorder();
+  virtual void RunEngine(hldsm* m, result &);
+private:
+  method which;
+};
+locality_varorder the_noack_varorder(locality_varorder::NOACK);
+locality_varorder the_sloan_varorder(locality_varorder::SLOAN);
+locality_varorder the_minspans_varorder(locality_varorder::MIN_SPANS);
+
 // ******************************************************************
 // *                                                                *
 // *                                                                *
@@ -245,9 +276,23 @@ bool init_static_varorder::execute()
   RegisterEngine(em,
                  "VariableOrdering",
                  "NOACK",
-                 "Variable order is determined by calls to partition() in the model",
+                 "Variable order is built greedily from the event dependencies: each next level gets the variable most tied, by shared events, to the variables already placed",
                  &the_noack_varorder
                  );
+
+  RegisterEngine(em,
+                 "VariableOrdering",
+                 "SLOAN",
+                 "Variable order is built by Sloan profile reduction on the graph of variables that share an event",
+                 &the_sloan_varorder
+                 );
+
+  RegisterEngine(em,
+                 "VariableOrdering",
+                 "MIN_SPANS",
+                 "Variable order is found by a local search (sifting) for the smallest sum of event spans, starting from the best of the given, NOACK and SLOAN orders",
+                 &the_minspans_varorder
+                 );
   
   return true;
 }
@@ -770,6 +815,7 @@ std::map<int, std::set<int> > getTDot(MODEL theModel) {
 // OrderPair format in case this ordering is used as input to force|other algorithms
 std::vector<OrderPair> noackParam(MODEL theModel, double param) {
   std::vector<OrderPair> resultOrder;
+  if (0 == theModel.numPlaces) return resultOrder;
   const double PARAM_W = param;
   // get the model information organized
   std::map<int, std::set<int> > dotPs = getDotP(theModel);
@@ -834,7 +880,7 @@ std::vector<OrderPair> noackParam(MODEL theModel, double param) {
     adders[*p] = totals;
   }
   
-  double * currentWeights = new double[theModel.numPlaces];
+  double * currentWeights = new double[theModel.numPlaces]();
   int current = start;
   int count = 0;
   OrderPair op;
@@ -843,7 +889,7 @@ std::vector<OrderPair> noackParam(MODEL theModel, double param) {
   resultOrder.push_back(op);
   count++;
   
-  do {
+  while (unused.size() > 1) {
     // keep track of best weight so far
     double maxWeight = -1.0;
     int best = -1;
@@ -870,7 +916,7 @@ std::vector<OrderPair> noackParam(MODEL theModel, double param) {
     theNext.item = best;
     count++;
     resultOrder.push_back(theNext);
-  } while (unused.size() > 1);
+  }
   
   delete [] currentWeights;
   return resultOrder;
@@ -1520,6 +1566,7 @@ double getSpanTopParam(MODEL & theModel, std::vector<int> & theOrder, double par
   }
   u64 spans = 0LL;
   for (int index = theModel.numPlaces; index < count; index++) {
+    if (eventMax[index] < eventMin[index]) continue;  // no arcs
     spans += eventMax[index] - eventMin[index] + 1;
   }
   delete [] eventMax;
@@ -1566,6 +1613,7 @@ double getSpanTopParam(MODEL & theModel, std::vector<OrderPair> & theOrder,
   }
   u64 spans = 0LL;
   for (int index = theModel.numPlaces; index < count; index++) {
+    if (eventMax[index] < eventMin[index]) continue;  // no arcs
     spans += eventMax[index] - eventMin[index] + 1;
   }
   delete [] eventMax;
@@ -1862,6 +1910,35 @@ MODEL translateModelOLD(dsde_hlm& smartModel) {
 }
 
 
+// **************************************************************************
+// *                      static_varorder  reporting                        *
+// **************************************************************************
+
+void static_varorder::reportOrder(dsde_hlm* dm, const char* how)
+{
+  if (!report.isActive()) return;
+
+  DCASSERT(dm);
+  DCASSERT(dm->hasPartInfo());
+  const hldsm::partinfo &part = dm->getPartInfo();
+  std::vector<int> order(part.num_vars);
+  for (int v=0; v<part.num_vars; v++) {
+    order[v] = dm->readStateVar(v)->GetPart() - 1;
+  }
+  MODEL model = translateModel(*dm);
+  double spans = getSpanTopParam(model, order, 1.0);
+  double tops = getSpanTopParam(model, order, 0.0);
+  delete[] model.theArcs;
+
+  if (!report.startReport()) return;
+  report.report() << "Variable order (" << how << "): ";
+  report.report() << part.num_vars << " variables on ";
+  report.report() << part.num_levels << " levels\n";
+  report.report() << "\t" << long(spans) << " sum of event spans\n";
+  report.report() << "\t" << long(tops) << " sum of event tops\n";
+  report.stopIO();
+}
+
 // **************************************************************************
 // *                    heuristic_varorder  methods                         *
 // **************************************************************************
@@ -1922,6 +1999,7 @@ void heuristic_varorder::RunEngine(hldsm* hm, result &)
     dm->getStateVar(j)->SetPart(order[j]+1);
   }
   dm->useHeuristicVarOrder();
+  reportOrder(dm, "force");
   
   if (debug.startReport()) {
     debug.report() << "Generated Order: \n";
@@ -1934,3 +2012,384 @@ void heuristic_varorder::RunEngine(hldsm* hm, result &)
 }
 
 
+
+// **************************************************************************
+// *                                                                        *
+// *                     Dependency-based  orders                           *
+// *                                                                        *
+// **************************************************************************
+
+/*
+  Orders below are sequences: seq[i] is the variable at level i+1.
+  The FORCE code instead wants the position of each variable.
+*/
+
+static double seqSpanTop(MODEL &theModel, const std::vector<int> &seq,
+  double param)
+{
+  std::vector<int> order(seq.size());
+  for (unsigned i=0; i<seq.size(); i++) order[seq[i]] = i;
+  return getSpanTopParam(theModel, order, param);
+}
+
+/*
+  Spans do not care which end is the top, but saturation does:
+  flip the order if that lowers the sum of event tops.
+*/
+static void orientOrder(MODEL &theModel, std::vector<int> &seq)
+{
+  std::vector<int> rev(seq.rbegin(), seq.rend());
+  if (seqSpanTop(theModel, rev, 0.0) < seqSpanTop(theModel, seq, 0.0)) {
+    seq.swap(rev);
+  }
+}
+
+/// Places each transition has an arc with, either way.
+static void transPlaces(MODEL &theModel,
+  std::vector< std::vector<int> > &places)
+{
+  std::map<int, std::set<int> > dotTs = getDotT(theModel);
+  std::map<int, std::set<int> > tDots = getTDot(theModel);
+  places.assign(theModel.numTrans, std::vector<int>());
+  for (int t=0; t<theModel.numTrans; t++) {
+    std::set<int> &both = dotTs[t + theModel.numPlaces];
+    std::set<int> &out = tDots[t + theModel.numPlaces];
+    both.insert(out.begin(), out.end());
+    places[t].assign(both.begin(), both.end());
+  }
+}
+
+static void eventsOfVars(int nv, const std::vector< std::vector<int> > &places,
+  std::vector< std::vector<int> > &events)
+{
+  events.assign(nv, std::vector<int>());
+  for (unsigned t=0; t<places.size(); t++) {
+    for (unsigned i=0; i<places[t].size(); i++) {
+      events[places[t][i]].push_back(t);
+    }
+  }
+}
+
+/*
+  Breadth-first search from root; dist must be -1 for unvisited.
+  Fills visited in BFS order and returns the depth reached.
+*/
+static int bfsDepth(const std::vector< std::vector<int> > &adj, int root,
+  std::vector<int> &dist, std::vector<int> &visited)
+{
+  visited.clear();
+  visited.push_back(root);
+  dist[root] = 0;
+  int depth = 0;
+  for (unsigned h=0; h<visited.size(); h++) {
+    int v = visited[h];
+    for (unsigned i=0; i<adj[v].size(); i++) {
+      int w = adj[v][i];
+      if (dist[w] >= 0) continue;
+      dist[w] = dist[v]+1;
+      depth = MAX(depth, dist[w]);
+      visited.push_back(w);
+    }
+  }
+  return depth;
+}
+
+/*
+  Sloan's profile reduction, on the graph where two variables are
+  adjacent if some event depends on both.  Each connected component
+  is numbered from a pseudo-peripheral start towards its far end.
+*/
+static void sloanOrder(int nv, const std::vector< std::vector<int> > &places,
+  std::vector<int> &seq)
+{
+  const long W1 = 2;    // weight of the degree increase
+  const long W2 = 1;    // weight of the distance to the end
+
+  std::vector< std::vector<int> > adj(nv);
+  for (unsigned t=0; t<places.size(); t++) {
+    for (unsigned i=0; i<places[t].size(); i++) {
+      for (unsigned j=0; j<places[t].size(); j++) {
+        if (i != j) adj[places[t][i]].push_back(places[t][j]);
+      }
+    }
+  }
+  for (int v=0; v<nv; v++) {
+    std::sort(adj[v].begin(), adj[v].end());
+    adj[v].erase(std::unique(adj[v].begin(), adj[v].end()), adj[v].end());
+  }
+
+  enum { INACTIVE, PREACTIVE, ACTIVE, POSTACTIVE };
+  std::vector<int> status(nv, INACTIVE);
+  std::vector<long> prio(nv, 0);
+  std::vector<int> dist(nv, -1);
+  std::vector<int> comp, other;
+
+  seq.clear();
+  for (;;) {
+    // Start a component at its unnumbered variable of least degree
+    int start = -1;
+    for (int v=0; v<nv; v++) {
+      if (status[v] != INACTIVE) continue;
+      if (start < 0 || adj[v].size() < adj[start].size()) start = v;
+    }
+    if (start < 0) break;
+
+    // Pseudo-peripheral pair: repeat from the far end while it is deeper
+    int depth = bfsDepth(adj, start, dist, comp);
+    int end;
+    for (;;) {
+      end = -1;
+      for (unsigned i=0; i<comp.size(); i++) {
+        int v = comp[i];
+        if (dist[v] != depth) continue;
+        if (end < 0 || adj[v].size() < adj[end].size()) end = v;
+      }
+      for (unsigned i=0; i<comp.size(); i++) dist[comp[i]] = -1;
+      int far = bfsDepth(adj, end, dist, other);
+      if (far <= depth) break;
+      start = end;
+      depth = far;
+      comp.swap(other);
+    }
+    // dist now holds distances from end
+
+    std::priority_queue< std::pair<long, int> > queue;
+    for (unsigned i=0; i<comp.size(); i++) {
+      int v = comp[i];
+      prio[v] = W2 * dist[v] - W1 * long(adj[v].size() + 1);
+    }
+    status[start] = PREACTIVE;
+    queue.push(std::make_pair(prio[start], start));
+
+    while (!queue.empty()) {
+      int v = queue.top().second;
+      long p = queue.top().first;
+      queue.pop();
+      if (POSTACTIVE == status[v] || p != prio[v]) continue;   // stale
+
+      if (PREACTIVE == status[v]) {
+        for (unsigned i=0; i<adj[v].size(); i++) {
+          int w = adj[v][i];
+          if (POSTACTIVE == status[w]) continue;
+          prio[w] += W1;
+          if (INACTIVE == status[w]) status[w] = PREACTIVE;
+          queue.push(std::make_pair(prio[w], w));
+        }
+      }
+      status[v] = POSTACTIVE;
+      seq.push_back(v);
+
+      for (unsigned i=0; i<adj[v].size(); i++) {
+        int w = adj[v][i];
+        if (PREACTIVE != status[w]) continue;
+        status[w] = ACTIVE;
+        prio[w] += W1;
+        queue.push(std::make_pair(prio[w], w));
+        for (unsigned j=0; j<adj[w].size(); j++) {
+          int x = adj[w][j];
+          if (POSTACTIVE == status[x]) continue;
+          prio[x] += W1;
+          if (INACTIVE == status[x]) status[x] = PREACTIVE;
+          queue.push(std::make_pair(prio[x], x));
+        }
+      }
+    }
+    for (unsigned i=0; i<comp.size(); i++) dist[comp[i]] = -1;
+  }
+}
+
+/*
+  Sum of event spans under an order, kept up to date
+  across swaps of adjacent levels.
+*/
+class span_tracker {
+  const std::vector< std::vector<int> > &places;
+  std::vector< std::vector<int> > events;
+  std::vector<int> &seq;
+  std::vector<int> level;   // 0-based
+  std::vector<int> span;
+  long total;
+
+  int spanOf(int e) const {
+    if (places[e].empty()) return 0;
+    int top = 0;
+    int bottom = std::numeric_limits<int>::max();
+    for (unsigned i=0; i<places[e].size(); i++) {
+      int k = level[places[e][i]];
+      top = MAX(top, k);
+      bottom = MIN(bottom, k);
+    }
+    return top - bottom + 1;
+  }
+  void update(int v) {
+    for (unsigned j=0; j<events[v].size(); j++) {
+      int e = events[v][j];
+      total -= span[e];
+      span[e] = spanOf(e);
+      total += span[e];
+    }
+  }
+public:
+  span_tracker(const std::vector< std::vector<int> > &p, std::vector<int> &q)
+  : places(p), seq(q)
+  {
+    eventsOfVars(seq.size(), places, events);
+    level.resize(seq.size());
+    for (unsigned i=0; i<seq.size(); i++) level[seq[i]] = i;
+    span.resize(places.size());
+    total = 0;
+    for (unsigned e=0; e<places.size(); e++) {
+      span[e] = spanOf(e);
+      total += span[e];
+    }
+  }
+  inline long sum() const { return total; }
+  inline int levelOf(int v) const { return level[v]; }
+  inline int numEventsOf(int v) const { return events[v].size(); }
+
+  /// Swap the variables at levels k and k+1.
+  void swap(int k) {
+    int a = seq[k];
+    int b = seq[k+1];
+    seq[k] = b;
+    seq[k+1] = a;
+    level[a] = k+1;
+    level[b] = k;
+    update(a);
+    update(b);
+  }
+};
+
+/*
+  Sift each variable, busiest first, to the level giving the smallest
+  sum of event spans; repeat while a pass improves it.
+*/
+static void minimizeSpans(const std::vector< std::vector<int> > &places,
+  std::vector<int> &seq, named_msg &out)
+{
+  const int maxPasses = 10;
+  const int nv = seq.size();
+  span_tracker T(places, seq);
+
+  std::vector< std::pair<int, int> > busiest(nv);
+  for (int v=0; v<nv; v++) busiest[v] = std::make_pair(-T.numEventsOf(v), v);
+  std::sort(busiest.begin(), busiest.end());
+
+  for (int pass=0; pass<maxPasses; pass++) {
+    const long before = T.sum();
+    for (int i=0; i<nv; i++) {
+      int v = busiest[i].second;
+      int k = T.levelOf(v);
+      long best = T.sum();
+      int bestk = k;
+      // down to the bottom, then up to the top
+      for (; k>0; k--) {
+        T.swap(k-1);
+        if (T.sum() < best) { best = T.sum(); bestk = k-1; }
+      }
+      for (; k+1<nv; k++) {
+        T.swap(k);
+        if (T.sum() < best) { best = T.sum(); bestk = k+1; }
+      }
+      for (; k>bestk; k--) T.swap(k-1);
+    }
+    if (out.startReport()) {
+      out.report() << "Span search pass " << pass << ": sum of spans ";
+      out.report() << before << " -> " << T.sum() << "\n";
+      out.stopIO();
+    }
+    if (T.sum() >= before) break;
+  }
+}
+
+// **************************************************************************
+// *                     locality_varorder  methods                         *
+// **************************************************************************
+
+locality_varorder::locality_varorder(method m)
+{
+  which = m;
+}
+
+locality_varorder::~locality_varorder()
+{
+}
+
+void locality_varorder::RunEngine(hldsm* hm, result &)
+{
+  DCASSERT(hm);
+  DCASSERT(AppliesToModelType(hm->Type()));
+  
+  if (hm->hasPartInfo()) return;  // already done!
+  
+  dsde_hlm* dm = dynamic_cast <dsde_hlm*> (hm);
+  DCASSERT(dm);
+
+  const char* how = 0;
+  switch (which) {
+    case NOACK:     how = "noack";      break;
+    case SLOAN:     how = "sloan";      break;
+    case MIN_SPANS: how = "min spans";  break;
+  }
+  if (debug.startReport()) {
+    debug.report() << "using " << how << " variable order\n";
+    debug.stopIO();
+  }
+
+  const int nv = dm->getNumStateVars();
+
+  // The given order, by partition then index, to start the search from
+  std::vector< std::pair<int, int> > given(nv);
+  for (int v=0; v<nv; v++) given[v] = std::make_pair(dm->readStateVar(v)->GetPart(), v);
+  std::sort(given.begin(), given.end());
+
+  MODEL model = translateModel(*dm);
+  std::vector< std::vector<int> > places;
+  transPlaces(model, places);
+
+  std::vector<int> seq;
+  switch (which) {
+    case NOACK:
+        seq = primaryOrder(model, 1, 0.0);
+        break;
+
+    case SLOAN:
+        sloanOrder(nv, places, seq);
+        break;
+
+    case MIN_SPANS: {
+        seq.resize(nv);
+        for (int v=0; v<nv; v++) seq[v] = given[v].second;
+        double best = seqSpanTop(model, seq, 1.0);
+        std::vector<int> other = primaryOrder(model, 1, 0.0);
+        if (seqSpanTop(model, other, 1.0) < best) {
+          best = seqSpanTop(model, other, 1.0);
+          seq.swap(other);
+        }
+        sloanOrder(nv, places, other);
+        if (seqSpanTop(model, other, 1.0) < best) {
+          seq.swap(other);
+        }
+        minimizeSpans(places, seq, debug);
+        break;
+    }
+  }
+  DCASSERT(int(seq.size()) == nv);
+  orientOrder(model, seq);
+  delete[] model.theArcs;
+
+  for (int i=0; i<nv; i++) {
+    dm->getStateVar(seq[i])->SetPart(i+1);
+  }
+  dm->useHeuristicVarOrder();
+  reportOrder(dm, how);
+
+  if (debug.startReport()) {
+    debug.report() << "Generated Order: \n";
+    for (int i = 0; i < nv; i++) {
+      model_statevar* var = dm->getStateVar(i);
+      debug.report() << "var: " << i << (i < 10? "  ": " ") << "part: " << var->GetPart() << (var->GetPart() < 10? "  ": " ") << var->Name() << "\n";
+    }
+    debug.stopIO();
+  }
+}
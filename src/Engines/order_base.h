@@ -4,6 +4,8 @@
 
 #include "../ExprLib/engine.h"
 
+class dsde_hlm;
+
 // **************************************************************************
 // *                                                                        *
 // *                         static_varorder  class                         *
@@ -20,7 +22,15 @@ public:
   static_varorder();
   virtual ~static_varorder();
 
-  // Any useful helpers?
+
+protected:
+  /** Report, on the varorder report stream, how local the events are
+      under the model's current variable order: the sums of event spans
+      and event tops, in levels.
+        @param  dm    Model, with partition info already set.
+        @param  how   Name of the ordering method, for the report.
+  */
+  static void reportOrder(dsde_hlm* dm, const char* how);
 };
 
 #endif
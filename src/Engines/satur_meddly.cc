@@ -21,7 +21,15 @@
 #include "../_Timer/timerlib.h"
 #include "../_LSLib/lslib.h"
 #include <iostream>
+#include <fstream>
 #include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <cstdio>
+#include <cstring>
+#include <string>
 
 #if 1
 #include <unordered_map>
@@ -218,6 +226,8 @@ void mxd_mc_finish::RunEngine(hldsm* hm, result &states_only)
   shared_ddedge* R = smart_cast<shared_ddedge*>(procmxd->makeEdge(0));
   DCASSERT(R);
   procmxd->buildSymbolicConst(0.0, R);
+  meddly_process* PROC = new meddly_process(procmxd);
+  long kronecker_terms = 0;
 
   //
   //  Add rates for each event to CTMC.
@@ -248,6 +258,11 @@ void mxd_mc_finish::RunEngine(hldsm* hm, result &states_only)
     // Add to overall rate matrix
     R->E += r_e->E;
 
+    // Keep it as a descriptor term, if requested
+    if (meddly_process::use_descriptor) {
+      if (PROC->addDescriptorTerm(r_e->E)) kronecker_terms++;
+    }
+
     // Cleanup
     Delete(r_e);
   } // for e
@@ -256,7 +271,6 @@ void mxd_mc_finish::RunEngine(hldsm* hm, result &states_only)
   // Finalize process
   //
 
-  meddly_process* PROC = new meddly_process(procmxd);
   PROC->setActual(R);
   // TBD!  NEED an actual initial vector!
   LS_Vector initial;
@@ -265,6 +279,10 @@ void mxd_mc_finish::RunEngine(hldsm* hm, result &states_only)
   if (Report().startReport()) {
     Report().report() << "Finished  CTMC using Meddly, took ";
     Report().report() << watch.elapsed_seconds() << " seconds\n";
+    if (meddly_process::use_descriptor) {
+      Report().report() << "\tDescriptor has " << kronecker_terms << " of ";
+      Report().report() << m->getNumEvents() << " events in Kronecker form\n";
+    }
     Report().stopIO();
   }
 
@@ -290,10 +308,36 @@ protected:
   static const int ORDER_HIGH_TO_LOW = 0;
   static const int ORDER_LOW_TO_HIGH = 1;
   static const int ORDER_MODEL = 2;
+  static char* save_file;
+  static char* load_file;
+  static char* ckpt_file;
+  static long ckpt_interval;
+  static bool ckpt_resume;
+  static long reorder_trigger;
   friend class init_saturmeddly;
 
+  /// Marks the variable order, in files.
+  static const int VAR_ORDER_MAGIC = 0x4f524456;
+
   int* event_order;
   int event_order_size;
+
+  /// Partial reachability set read from a checkpoint, or null.
+  shared_ddedge* resumed;
+
+  /** Writes the partially built reachability set to ckpt_file,
+      whenever ckpt_interval seconds have passed since the last one.
+      Attached to the MDD forest while the reachability set is built.
+  */
+  class checkpoint_writer : public MEDDLY::forest::checkpointer {
+      const meddly_implicitgen &gen;
+      meddly_varoption &x;
+      timer watch;
+    public:
+      checkpoint_writer(const meddly_implicitgen &g, meddly_varoption &v);
+      virtual bool due();
+      virtual void save(const MEDDLY::dd_edge &partial);
+  };
 public:
   meddly_implicitgen();
   virtual ~meddly_implicitgen();
@@ -311,6 +355,52 @@ protected:
     NSF = nsf;
   }
 
+  inline bool hasNSF() const {
+    return NSF;
+  }
+
+  /// States to start generation from: the resumed set, if any.
+  inline const MEDDLY::dd_edge& getStart(const meddly_varoption &x) const {
+    return resumed ? resumed->E : x.getInitial();
+  }
+
+  inline static bool usingCheckpoints() {
+    return ckpt_file && ckpt_file[0];
+  }
+
+  /// Give the checkpointer (if any) a chance to save set S.
+  inline static void offerCheckpoint(meddly_varoption &x,
+                                     const MEDDLY::dd_edge &S)
+  {
+    MEDDLY::forest::checkpointer* cp = x.getMddForest()->getCheckpointer();
+    if (cp && cp->due()) cp->save(S);
+  }
+
+  /// Read the checkpoint, if we were asked to resume from one.
+  void resumeRSS(meddly_varoption &x);
+
+  inline static bool usingReordering() {
+    return reorder_trigger > 0;
+  }
+
+  /// Arm the reordering trigger on both forests, if enabled.
+  void startReordering(meddly_varoption &x) const;
+
+  /** If automatic reordering is due, sift the variables of the
+      forest that is due, and give the other forest the same order.
+      Must be called between Meddly operations.
+        @return true, if the variables were reordered.
+  */
+  bool reorderIfDue(meddly_varoption &x) const;
+
+  /** Put both forests back in the model order (the rest of Smart
+      assumes level k holds variable k), and stop reordering.
+  */
+  void restoreModelOrder(meddly_varoption &x) const;
+
+  /// Run generateRSS() with the checkpointer attached.
+  void generateWithCheckpoints(meddly_varoption &x, timer &w);
+
   virtual void generateRSS(meddly_varoption &x, timer &w) = 0;
   virtual const char* getAlgName() const = 0;
 
@@ -367,11 +457,31 @@ protected:
 
   virtual void buildRSS(meddly_varoption &x);
 
+  /** Write the local state spaces, set S, and the next-state
+      function (if it has been built) to a file.
+      The file is written under a temporary name and then renamed,
+      so an interrupted write never destroys an older copy.
+  */
+  void saveRSS(meddly_varoption &x, const char* file,
+                const MEDDLY::dd_edge &S) const;
+
+  /** Read a file written by saveRSS().
+      The local state spaces and the next-state function (if present)
+      are restored; the set is returned.
+  */
+  shared_ddedge* loadRSS(meddly_varoption &x, const char* file);
+
 private:
   void radix_sort(const hldsm::partinfo &p, const dsde_hlm &m, int a, int b, int k, bool dec);
 };
 
 int meddly_implicitgen::order_policy;
+char* meddly_implicitgen::save_file;
+char* meddly_implicitgen::load_file;
+char* meddly_implicitgen::ckpt_file;
+long meddly_implicitgen::ckpt_interval;
+bool meddly_implicitgen::ckpt_resume;
+long meddly_implicitgen::reorder_trigger;
 
 // **************************************************************************
 // *                       meddly_implicitgen methods                       *
@@ -382,12 +492,14 @@ meddly_implicitgen::meddly_implicitgen() : meddly_procgen()
   event_order = 0;
   event_order_size = 0;
   NSF = 0;
+  resumed = 0;
 }
 
 meddly_implicitgen::~meddly_implicitgen()
 {
   free(event_order);
   Delete(NSF);
+  Delete(resumed);
 }
 
 bool meddly_implicitgen::AppliesToModelType(hldsm::model_type mt) const
@@ -427,8 +539,8 @@ void meddly_implicitgen::RunEngine(hldsm* hm, result &states_only)
   }
   catch (subengine::error e) {
     doneGen();
-    Delete(rss);
     delete mvo;
+    Delete(rss);
     hm->SetProcess(MakeErrorModel());
     throw e;
   }
@@ -495,23 +607,31 @@ void meddly_implicitgen::buildNextStateFunc(meddly_varoption &x)
 
     // TBD: deal with priority
 
-    // "AND" together the enabling and next state.
-    firing *= enable;
+    try {
+      // "AND" together the enabling and next state.
+      firing *= enable;
 
 #ifdef DEBUG_EVENT_NSFS
-    if (Debug().startReport()) {
-      Debug().report() << "(final) next-state DD for event ";
-      Debug().report() << m.readEvent(e)->Name();
-      Debug().report() << " DD edge: " << firing.getNode() << "\n";
-      Debug().report().flush();
-      smart_output Drep(Debug().report());
-      firing.show(Drep, 2);
-      Debug().stopIO();
-    }
+      if (Debug().startReport()) {
+        Debug().report() << "(final) next-state DD for event ";
+        Debug().report() << m.readEvent(e)->Name();
+        Debug().report() << " DD edge: " << firing.getNode() << "\n";
+        Debug().report().flush();
+        smart_output Drep(Debug().report());
+        firing.show(Drep, 2);
+        Debug().stopIO();
+      }
 #endif
 
-    // Add this to overall next-state function  
-    N->E += firing;
+      // Add this to overall next-state function  
+      N->E += firing;
+    }
+    catch (MEDDLY::error ce) {
+      Delete(N);
+      convert(ce, "Building next-state function failed", x.getParent());
+    }
+
+    reorderIfDue(x);
   } // for e
  
   Delete(NSF);
@@ -692,54 +812,92 @@ void meddly_implicitgen::buildRSS(meddly_varoption &x)
     }
 
     x.initializeEvents(Debug());
+    startReordering(x);
 
-    // 
-    // Build next-state function
-    //
-    if (Report().startReport()) {
-      Report().report() << "Building next-state function\n";
-      subwatch.reset();
-      Report().stopIO();
-    }
+    // Engines are shared; drop the previous model's next-state function
+    Delete(NSF);
+    NSF = 0;
+
+    shared_ddedge* loaded = 0;
+    if (load_file && load_file[0]) {
+      //
+      // Read next-state function and reachability set
+      //
+      if (Report().startReport()) {
+        Report().report() << "Loading reachability set from " << load_file << "\n";
+        subwatch.reset();
+        Report().stopIO();
+      }
 
-    buildNextStateFunc(x);
+      loaded = loadRSS(x, load_file);
 
-    if (Report().startReport()) {
-      Report().report() << "Built    next-state function, took ";
-      Report().report() << subwatch.elapsed_seconds() << " seconds\n";
-  #ifdef DEBUG_FINAL_NSF
-      Report().report() << "DD edge: " << getNSF().getNode() << "\n";
-      Report().report().flush();
-      smart_output Rrep(Report().report());
-      getNSF().show(Rrep, 2);
-      Report().report() << "Initial state: " << x.getInitial().getNode() << "\n";
-      Report().report().flush();
-      x.getInitial().show(Rrep, 2);
-  #endif
-  #ifdef DEBUG_REFCOUNTS
-      Report().report() << "Forest:\n";
-      Report().report().flush();
-      getNSF().getForest()->showInfo(Rrep, 1);
-      fflush(Report().Freport());
-  #endif
-      Report().stopIO();
+      if (Report().startReport()) {
+        Report().report() << "Loaded   reachability set, took ";
+        Report().report() << subwatch.elapsed_seconds() << " seconds\n";
+        Report().stopIO();
+      }
+    } else {
+      resumeRSS(x);
     }
 
-    //
-    // Generate reachability set
-    //
-    if (Report().startReport()) {
-      Report().report() << "Building reachability set\n";
-      Report().stopIO();
-      subwatch.reset();
+    if (!hasNSF()) {
+      // 
+      // Build next-state function
+      //
+      if (Report().startReport()) {
+        Report().report() << "Building next-state function\n";
+        subwatch.reset();
+        Report().stopIO();
+      }
+
+      buildNextStateFunc(x);
+
+      if (Report().startReport()) {
+        Report().report() << "Built    next-state function, took ";
+        Report().report() << subwatch.elapsed_seconds() << " seconds\n";
+    #ifdef DEBUG_FINAL_NSF
+        Report().report() << "DD edge: " << getNSF().getNode() << "\n";
+        Report().report().flush();
+        smart_output Rrep(Report().report());
+        getNSF().show(Rrep, 2);
+        Report().report() << "Initial state: " << x.getInitial().getNode() << "\n";
+        Report().report().flush();
+        x.getInitial().show(Rrep, 2);
+    #endif
+    #ifdef DEBUG_REFCOUNTS
+        Report().report() << "Forest:\n";
+        Report().report().flush();
+        getNSF().getForest()->showInfo(Rrep, 1);
+        fflush(Report().Freport());
+    #endif
+        Report().stopIO();
+      }
     }
 
-    generateRSS(x, subwatch);
+    if (loaded) {
+      x.setStates(loaded);
+    } else {
+      //
+      // Generate reachability set
+      //
+      if (Report().startReport()) {
+        Report().report() << "Building reachability set\n";
+        Report().stopIO();
+        subwatch.reset();
+      }
 
-    if (Report().startReport()) {
-      Report().report() << "Built    reachability set, took ";
-      Report().report() << subwatch.elapsed_seconds() << " seconds\n";
-      Report().stopIO();
+      generateWithCheckpoints(x, subwatch);
+
+      if (Report().startReport()) {
+        Report().report() << "Built    reachability set, took ";
+        Report().report() << subwatch.elapsed_seconds() << " seconds\n";
+        Report().stopIO();
+      }
+    }
+    restoreModelOrder(x);
+
+    if (save_file && save_file[0]) {
+      saveRSS(x, save_file, x.getStates());
     }
 
     if (stopGen(false, x.getParent(), watch)) {
@@ -755,6 +913,322 @@ void meddly_implicitgen::buildRSS(meddly_varoption &x)
   }
 }
 
+void meddly_implicitgen::resumeRSS(meddly_varoption &x)
+{
+  if (!ckpt_resume || !usingCheckpoints()) return;
+
+  timer watch;
+  if (Report().startReport()) {
+    Report().report() << "Resuming from checkpoint " << ckpt_file << "\n";
+    Report().stopIO();
+  }
+
+  Delete(resumed);
+  resumed = loadRSS(x, ckpt_file);
+
+  if (Report().startReport()) {
+    Report().report() << "Read     checkpoint, took ";
+    Report().report() << watch.elapsed_seconds() << " seconds\n";
+    Report().stopIO();
+  }
+}
+
+void meddly_implicitgen::generateWithCheckpoints(meddly_varoption &x, timer &w)
+{
+  checkpoint_writer cp(*this, x);
+  if (usingCheckpoints()) {
+    x.getMddForest()->setCheckpointer(&cp);
+  }
+  try {
+    generateRSS(x, w);
+  }
+  catch (subengine::error status) {
+    x.getMddForest()->setCheckpointer(0);
+    Delete(resumed);
+    resumed = 0;
+    throw status;
+  }
+  x.getMddForest()->setCheckpointer(0);
+  Delete(resumed);
+  resumed = 0;
+}
+
+void meddly_implicitgen::startReordering(meddly_varoption &x) const
+{
+  if (!usingReordering()) return;
+  smart_cast<MEDDLY::expert_forest*>(x.getMddForest())
+    ->setReorderTrigger(reorder_trigger);
+  if (x.getMxdForest()) {
+    smart_cast<MEDDLY::expert_forest*>(x.getMxdForest())
+      ->setReorderTrigger(reorder_trigger);
+  }
+}
+
+bool meddly_implicitgen::reorderIfDue(meddly_varoption &x) const
+{
+  if (!usingReordering()) return false;
+  MEDDLY::expert_forest* mdd 
+    = smart_cast<MEDDLY::expert_forest*>(x.getMddForest());
+  MEDDLY::expert_forest* mxd 
+    = smart_cast<MEDDLY::expert_forest*>(x.getMxdForest());
+  DCASSERT(mdd);
+
+  MEDDLY::expert_forest* lead;
+  MEDDLY::expert_forest* other;
+  if (mdd->reorderingDue()) {
+    lead = mdd;
+    other = mxd;
+  } else if (mxd && mxd->reorderingDue()) {
+    lead = mxd;
+    other = mdd;
+  } else {
+    return false;
+  }
+
+  timer watch;
+  if (Report().startReport()) {
+    Report().report() << "Reordering variables, ";
+    Report().report() << lead->getCurrentNumNodes() << " nodes in ";
+    Report().report() << (lead == mdd ? "MDD" : "MxD") << " forest\n";
+    Report().stopIO();
+  }
+  try {
+    lead->autoReorderVariables();
+    if (other) {
+      int* order = new int[lead->getNumVariables()+1];
+      lead->getVariableOrder(order);
+      other->reorderVariables(order);
+      delete[] order;
+    }
+  }
+  catch (MEDDLY::error ce) {
+    convert(ce, "Variable reordering failed", x.getParent());
+  }
+  if (Report().startReport()) {
+    Report().report() << "Reordered  variables, took ";
+    Report().report() << watch.elapsed_seconds() << " seconds, ";
+    Report().report() << lead->getCurrentNumNodes() << " nodes remain\n";
+    Report().stopIO();
+  }
+  return true;
+}
+
+void meddly_implicitgen::restoreModelOrder(meddly_varoption &x) const
+{
+  MEDDLY::expert_forest* f[2];
+  f[0] = smart_cast<MEDDLY::expert_forest*>(x.getMddForest());
+  f[1] = smart_cast<MEDDLY::expert_forest*>(x.getMxdForest());
+  DCASSERT(f[0]);
+  const int nv = f[0]->getNumVariables();
+  int* order = new int[nv+1];
+  try {
+    for (int i=0; i<2; i++) {
+      if (0==f[i]) continue;
+      f[i]->setReorderTrigger(0);
+      f[i]->getVariableOrder(order);
+      int k;
+      for (k=nv; k; k--) {
+        if (order[k] != k) break;
+      }
+      if (0==k) continue;
+      for (k=nv; k>=0; k--) order[k] = k;
+      f[i]->reorderVariables(order);
+    }
+  }
+  catch (MEDDLY::error ce) {
+    delete[] order;
+    convert(ce, "Restoring the variable order failed", x.getParent());
+  }
+  delete[] order;
+}
+
+void meddly_implicitgen::saveRSS(meddly_varoption &x, const char* file,
+  const MEDDLY::dd_edge &S) const
+{
+  std::string tmpname(file);
+  tmpname += ".tmp";
+  std::ofstream out(tmpname.c_str(), std::ios::out | std::ios::binary);
+  if (!out) {
+    if (x.getParent().StartError(0)) {
+      em->cerr() << "Couldn't open file " << tmpname.c_str() << " for writing";
+      x.getParent().DoneError();
+    }
+    throw Engine_Failed;
+  }
+  try {
+    x.writeLocalStates(out);
+
+    // Variable order: the forests may have been reordered
+    const MEDDLY::expert_forest* f 
+      = smart_cast<const MEDDLY::expert_forest*>(S.getForest());
+    const int nv = f->getNumVariables();
+    int* order = new int[nv+2];
+    f->getVariableOrder(order+1);
+    order[0] = VAR_ORDER_MAGIC;
+    order[1] = nv;
+    out.write((const char*) order, (nv+2) * sizeof(int));
+    delete[] order;
+
+    MEDDLY::ostream_output s(out);
+    S.getForest()->writeEdgesBinary(s, &S, 1);
+    if (NSF) {
+      getNSF().getForest()->writeEdgesBinary(s, &getNSF(), 1);
+    }
+    out.close();
+    if (!out) {
+      throw MEDDLY::error(MEDDLY::error::COULDNT_WRITE, __FILE__, __LINE__);
+    }
+  }
+  catch (MEDDLY::error ce) {
+    convert(ce, "Saving reachability set failed", x.getParent());
+  }
+  if (rename(tmpname.c_str(), file)) {
+    if (x.getParent().StartError(0)) {
+      em->cerr() << "Couldn't rename " << tmpname.c_str() << " to " << file;
+      x.getParent().DoneError();
+    }
+    throw Engine_Failed;
+  }
+}
+
+shared_ddedge* meddly_implicitgen::loadRSS(meddly_varoption &x, const char* file)
+{
+  //
+  // Map the whole file; the forests read their nodes from it directly
+  //
+  int fd = open(file, O_RDONLY);
+  struct stat st;
+  void* data = MAP_FAILED;
+  size_t len = 0;
+  if (fd >= 0 && 0==fstat(fd, &st) && st.st_size > 0) {
+    len = st.st_size;
+    data = mmap(0, len, PROT_READ, MAP_PRIVATE, fd, 0);
+  }
+  if (fd >= 0) close(fd);
+  if (MAP_FAILED == data) {
+    if (x.getParent().StartError(0)) {
+      em->cerr() << "Couldn't read file " << file;
+      x.getParent().DoneError();
+    }
+    throw Engine_Failed;
+  }
+
+  const unsigned char* block = (const unsigned char*) data;
+  size_t used = x.readLocalStates(block, len);
+  if (0==used) {
+    munmap(data, len);
+    if (x.getParent().StartError(0)) {
+      em->cerr() << "File " << file << " does not match the model";
+      x.getParent().DoneError();
+    }
+    throw Engine_Failed;
+  }
+
+  //
+  // Variable order, if present (older files do not have one)
+  //
+  MEDDLY::expert_forest* mdd 
+    = smart_cast<MEDDLY::expert_forest*>(x.getMddForest());
+  const int nv = mdd->getNumVariables();
+  int head[2];
+  if (len - used >= (nv+2) * sizeof(int)) {
+    memcpy(head, block+used, sizeof(head));
+  } else {
+    head[0] = 0;
+  }
+  if (VAR_ORDER_MAGIC == head[0] && nv == head[1]) {
+    int* order = new int[nv+1];
+    memcpy(order+1, block+used+sizeof(head), nv * sizeof(int));
+    order[0] = 0;
+    used += (nv+2) * sizeof(int);
+    // must be a permutation
+    bool* seen = new bool[nv+1];
+    for (int k=nv; k>=0; k--) seen[k] = false;
+    bool ok = true;
+    for (int k=nv; ok && k; k--) {
+      ok = order[k] >= 1 && order[k] <= nv && !seen[order[k]];
+      if (ok) seen[order[k]] = true;
+    }
+    delete[] seen;
+    if (!ok) {
+      delete[] order;
+      munmap(data, len);
+      if (x.getParent().StartError(0)) {
+        em->cerr() << "File " << file << " does not match the model";
+        x.getParent().DoneError();
+      }
+      throw Engine_Failed;
+    }
+    try {
+      mdd->reorderVariables(order);
+      if (x.getMxdForest()) {
+        smart_cast<MEDDLY::expert_forest*>(x.getMxdForest())
+          ->reorderVariables(order);
+      }
+    }
+    catch (MEDDLY::error ce) {
+      delete[] order;
+      munmap(data, len);
+      convert(ce, "Loading reachability set failed", x.getParent());
+    }
+    delete[] order;
+  }
+
+  shared_ddedge* S = x.newMddEdge();
+  shared_ddedge* N = 0;
+  try {
+    used += S->E.getForest()->readEdgesBinary(block+used, len-used, &S->E, 1);
+    if (used < len) {
+      N = smart_cast<shared_ddedge*>(x.make_mxd_constant(false));
+      DCASSERT(N);
+      N->E.getForest()->readEdgesBinary(block+used, len-used, &N->E, 1);
+    }
+  }
+  catch (MEDDLY::error ce) {
+    munmap(data, len);
+    Delete(S);
+    Delete(N);
+    convert(ce, "Loading reachability set failed", x.getParent());
+  }
+  munmap(data, len);
+
+  if (N) {
+    Delete(NSF);
+    NSF = N;
+  }
+  return S;
+}
+
+// **************************************************************************
+// *                meddly_implicitgen::checkpoint_writer                   *
+// **************************************************************************
+
+meddly_implicitgen::checkpoint_writer
+::checkpoint_writer(const meddly_implicitgen &g, meddly_varoption &v)
+ : gen(g), x(v)
+{
+}
+
+bool meddly_implicitgen::checkpoint_writer::due()
+{
+  return watch.elapsed_seconds() >= ckpt_interval;
+}
+
+void meddly_implicitgen::checkpoint_writer::save(const MEDDLY::dd_edge &partial)
+{
+  if (gen.Report().startReport()) {
+    gen.Report().report() << "Writing checkpoint " << ckpt_file << "\n";
+    gen.Report().stopIO();
+  }
+  try {
+    gen.saveRSS(x, ckpt_file, partial);
+  }
+  catch (subengine::error) {
+    // Already reported; losing a checkpoint should not end the run.
+  }
+  watch.reset();
+}
+
 // **************************************************************************
 // *                                                                        *
 // *                        meddly_saturation  class                        *
@@ -789,13 +1263,18 @@ meddly_saturation::~meddly_saturation()
 void meddly_saturation::generateRSS(meddly_varoption &x, timer&)
 {
   try {
+    useSaturationThreads();
     shared_ddedge* S = x.newMddEdge();
-    MEDDLY::apply(
-      MEDDLY::REACHABLE_STATES_DFS,
-      x.getInitial(), 
-      getNSF(),
-      S->E
-    );
+    S->E = getStart(x);
+    do {
+      // Returns early, with a subset, if reordering becomes due
+      MEDDLY::apply(
+        MEDDLY::REACHABLE_STATES_DFS,
+        S->E, 
+        getNSF(),
+        S->E
+      );
+    } while (reorderIfDue(x));
     x.setStates(S);
     checkTerm("Generation failed", x.getParent());
   }
@@ -1118,6 +1597,10 @@ void meddly_otfsat::buildRSS(meddly_varoption &x)
 
     x.initializeEvents(Debug());
 
+    // Restores the local state spaces, before the relation is built
+    resumeRSS(x);
+    restoreModelOrder(x);
+
     // 
     // Build next-state function
     //
@@ -1130,7 +1613,7 @@ void meddly_otfsat::buildRSS(meddly_varoption &x)
     MEDDLY::satotf_opname::otf_relation* NSF = buildNSF(x);
     DCASSERT(NSF);
 
-    NSF->confirm(x.getInitial());
+    NSF->confirm(getStart(x));
 
     if (Report().startReport()) {
       Report().report() << "Initialized  next-state function builder, took ";
@@ -1297,7 +1780,14 @@ void meddly_otfsat::generateRSS(meddly_varoption &x,
     DCASSERT(satop);
 
     shared_ddedge* S = x.newMddEdge();
-    satop->compute(x.getInitial(), S->E);
+    checkpoint_writer cp(*this, x);
+    if (usingCheckpoints()) {
+      x.getMddForest()->setCheckpointer(&cp);
+    }
+    satop->compute(getStart(x), S->E);
+    x.getMddForest()->setCheckpointer(0);
+    Delete(resumed);
+    resumed = 0;
 
     // TBD - reindex?
     // TBD - grab NSF for model checking
@@ -1307,6 +1797,7 @@ void meddly_otfsat::generateRSS(meddly_varoption &x,
     checkTerm("Generation failed", x.getParent());
   }
   catch (MEDDLY::error ce) {
+    x.getMddForest()->setCheckpointer(0);
     convert(ce, "Generation failed", x.getParent());
   }
 }
@@ -1428,6 +1919,9 @@ void meddly_otfimplsat::buildRSS(meddly_varoption &x)
     }
     
     x.initializeEvents(Debug());
+
+    // Restores the local state spaces, before the relation is built
+    resumeRSS(x);
     
     //
     // Build next-state function
@@ -1441,7 +1935,7 @@ void meddly_otfimplsat::buildRSS(meddly_varoption &x)
     MEDDLY::satimpl_opname::implicit_relation* IMPL_NSF = buildNSF(x);
     DCASSERT(IMPL_NSF);
     
-    IMPL_NSF->setConfirmedStates(x.getInitial());
+    IMPL_NSF->setConfirmedStates(getStart(x));
     
     if (Report().startReport()) {
       Report().report() << "Initialized  next-state function builder, took ";
@@ -1637,11 +2131,19 @@ void meddly_otfimplsat::generateRSS(meddly_varoption &x,
     DCASSERT(satop);
     
     shared_ddedge* S = x.newMddEdge();
-    satop->compute(x.getInitial(), S->E);
+    checkpoint_writer cp(*this, x);
+    if (usingCheckpoints()) {
+      x.getMddForest()->setCheckpointer(&cp);
+    }
+    satop->compute(getStart(x), S->E);
+    x.getMddForest()->setCheckpointer(0);
+    Delete(resumed);
+    resumed = 0;
     x.setStates(S);
     checkTerm("Generation failed", x.getParent());
   }
   catch (MEDDLY::error ce) {
+    x.getMddForest()->setCheckpointer(0);
     convert(ce, "Generation failed", x.getParent());
   }
 }
@@ -2078,12 +2580,16 @@ void meddly_traditional::generateRSS(meddly_varoption &x, timer&)
 {
   try {
     shared_ddedge* S = x.newMddEdge();
-    MEDDLY::apply(
-      MEDDLY::REACHABLE_STATES_BFS,
-      x.getInitial(), 
-      getNSF(),
-      S->E
-    );
+    S->E = getStart(x);
+    do {
+      // Returns early, with a subset, if reordering becomes due
+      MEDDLY::apply(
+        MEDDLY::REACHABLE_STATES_BFS,
+        S->E, 
+        getNSF(),
+        S->E
+      );
+    } while (reorderIfDue(x));
     x.setStates(S);
     return checkTerm("Generation failed", x.getParent());
   }
@@ -2177,9 +2683,9 @@ meddly_frontier::~meddly_frontier()
 
 void meddly_frontier::generateRSS(meddly_varoption &x, timer &w)
 {
-  MEDDLY::dd_edge F = x.getInitial();
+  MEDDLY::dd_edge F = getStart(x);
   shared_ddedge* S = x.newMddEdge();
-  S->E = x.getInitial();
+  S->E = getStart(x);
   while (F.getNode()) {
     iterations++;
     if (Debug().startReport()) {
@@ -2236,6 +2742,8 @@ void meddly_frontier::generateRSS(meddly_varoption &x, timer &w)
       Debug().report() << w.elapsed_seconds() << " seconds total time\n";
       Debug().stopIO();
     }
+    offerCheckpoint(x, S->E);
+    reorderIfDue(x);
   } // while F
   x.setStates(S);
 }
@@ -2277,7 +2785,7 @@ void meddly_nextall::generateRSS(meddly_varoption &x, timer &w)
   MEDDLY::dd_edge Old(x.getMddForest());
   x.getMddForest()->createEdge(false, Old);
   shared_ddedge* S = x.newMddEdge();
-  S->E = x.getInitial();
+  S->E = getStart(x);
   while (S->E != Old) {
     iterations++;
     if (Debug().startReport()) {
@@ -2320,6 +2828,8 @@ void meddly_nextall::generateRSS(meddly_varoption &x, timer &w)
       Debug().report() << w.elapsed_seconds() << " seconds total time\n";
       Debug().stopIO();
     }
+    offerCheckpoint(x, S->E);
+    reorderIfDue(x);
   } // while F
   x.setStates(S);
 }
@@ -2419,6 +2929,60 @@ bool init_saturmeddly::execute()
     )
   );
 
+  meddly_implicitgen::save_file = 0;
+  em->addOption(
+    MakeStringOption(
+      "MeddlySaveStateSpace",
+      "If set, the reachability set and next-state function built by an implicit generation algorithm using Meddly are written to this file, in Meddly's binary format.  Ignored by the on-the-fly algorithms.",
+      meddly_implicitgen::save_file
+    )
+  );
+
+  meddly_implicitgen::load_file = 0;
+  em->addOption(
+    MakeStringOption(
+      "MeddlyLoadStateSpace",
+      "If set, implicit generation algorithms using Meddly read the reachability set and next-state function from this file (written using option MeddlySaveStateSpace, for the same model and variable style) instead of building them.  Ignored by the on-the-fly algorithms.",
+      meddly_implicitgen::load_file
+    )
+  );
+
+  meddly_implicitgen::ckpt_file = 0;
+  em->addOption(
+    MakeStringOption(
+      "MeddlyCheckpointFile",
+      "If set, every MeddlyProcessGeneration algorithm periodically writes the reachability set built so far, with the local state spaces and next-state function, to this file; see options MeddlyCheckpointInterval and MeddlyResumeFromCheckpoint.  Saturation and the on-the-fly algorithms write a checkpoint only when they are working on the top variable; the on-the-fly algorithms do not write their next-state function, which is rebuilt when resuming.",
+      meddly_implicitgen::ckpt_file
+    )
+  );
+
+  meddly_implicitgen::ckpt_interval = 3600;
+  em->addOption(
+    MakeIntOption(
+      "MeddlyCheckpointInterval",
+      "Minimum number of seconds between checkpoints, if option MeddlyCheckpointFile is set.",
+      meddly_implicitgen::ckpt_interval, 1, 1000000000
+    )
+  );
+
+  meddly_implicitgen::ckpt_resume = false;
+  em->addOption(
+    MakeBoolOption(
+      "MeddlyResumeFromCheckpoint",
+      "If true, and option MeddlyCheckpointFile is set, implicit generation algorithms using Meddly continue from the reachability set saved in the checkpoint file (written for the same model and variable style) instead of from the initial states.",
+      meddly_implicitgen::ckpt_resume
+    )
+  );
+
+  meddly_implicitgen::reorder_trigger = 0;
+  em->addOption(
+    MakeIntOption(
+      "MeddlyReorderTrigger",
+      "If positive, implicit generation algorithms using Meddly (other than the on-the-fly ones) reorder the state variables by sifting whenever the reachability set or next-state function forest grows past this many nodes; the trigger is then raised to twice the number of nodes left.  The model order is restored once generation is done.  If 0, variables are never reordered.",
+      meddly_implicitgen::reorder_trigger, 0, 1000000000
+    )
+  );
+
   return true;
 }
 
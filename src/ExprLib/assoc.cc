@@ -3,6 +3,7 @@
 #include "../Streams/streams.h"
 #include "result.h"
 #include "dd_front.h"
+#include "vect_prog.h"
 
 #include <string.h>  // for memcpy
 
@@ -110,6 +111,10 @@ void assoc::Traverse(traverse_data &x)
       x.answer->setNull();
       return;
 
+    case traverse_data::BuildVectorProgram:
+      buildVectorProgram(x, 0);
+      return;
+
     case traverse_data::GetProducts:
       if (x.elist)  x.elist->Append(this);
       DCASSERT(x.answer);
@@ -143,6 +148,37 @@ expr* assoc::MakeAnother(expr **newx, int newn)
   return buildAnother(newx, newn);
 }
 
+void assoc::buildVectorProgram(traverse_data &x, const bool* f)
+{
+  DCASSERT(x.vprog);
+  vector_program::opcode op;
+  switch (opcode) {
+    case exprman::aop_and:    op = vector_program::AND;   break;
+    case exprman::aop_or:     op = vector_program::OR;    break;
+    case exprman::aop_plus:   op = vector_program::ADD;   break;
+    case exprman::aop_times:  op = vector_program::MUL;   break;
+    default:                  return;
+  }
+  int acc = -1;
+  for (int i=0; i<opnd_count; i++) {
+    if (0==operands[i]) return;
+    operands[i]->Traverse(x);
+    int r = x.vprog->resultOf(operands[i]);
+    if (r<0) return;
+    bool flipped = f ? f[i] : false;
+    if (flipped) {
+      // subtraction is fine, division is not (yet)
+      if (exprman::aop_plus != opcode) return;
+      if (0==i) return;
+      acc = x.vprog->addBinary(vector_program::SUB, acc, r);
+    } else {
+      acc = (0==i) ? r : x.vprog->addBinary(op, acc, r);
+    }
+    if (acc<0) return;
+  }
+  x.vprog->setResult(this, acc);
+}
+
 // ******************************************************************
 // *                                                                *
 // *                       flipassoc  methods                       *
@@ -183,6 +219,10 @@ void flipassoc::Traverse(traverse_data &x)
       return;
     }
 
+    case traverse_data::BuildVectorProgram:
+      buildVectorProgram(x, flip);
+      return;
+
     case traverse_data::BuildDD: {
       DCASSERT(x.answer);
       DCASSERT(x.ddlib);
@@ -133,6 +133,10 @@ public:
   expr* MakeAnother(expr **newx, int newn);
 protected:
   virtual expr* buildAnother(expr **newx, int newn) const = 0;
+  /** Compile into x.vprog, if possible.
+        @param  f   Which operands are flipped (subtracted), or null.
+  */
+  void buildVectorProgram(traverse_data &x, const bool* f);
 };
 
 
@@ -1,6 +1,7 @@
 
 #include "binary.h"
 #include "dd_front.h"
+#include "vect_prog.h"
 
 // ******************************************************************
 // *                                                                *
@@ -90,6 +91,29 @@ void binary::Traverse(traverse_data &x)
       x.answer->setNull();
       return;
 
+    case traverse_data::BuildVectorProgram: {
+      DCASSERT(x.vprog);
+      vector_program::opcode op;
+      switch (opcode) {
+        case exprman::bop_equals:   op = vector_program::EQ;  break;
+        case exprman::bop_nequal:   op = vector_program::NE;  break;
+        case exprman::bop_gt:       op = vector_program::GT;  break;
+        case exprman::bop_ge:       op = vector_program::GE;  break;
+        case exprman::bop_lt:       op = vector_program::LT;  break;
+        case exprman::bop_le:       op = vector_program::LE;  break;
+        default:                    return;
+      }
+      left->Traverse(x);
+      int lr = x.vprog->resultOf(left);
+      if (lr<0) return;
+      right->Traverse(x);
+      int rr = x.vprog->resultOf(right);
+      if (rr<0) return;
+      int r = x.vprog->addBinary(op, lr, rr);
+      if (r>=0) x.vprog->setResult(this, r);
+      return;
+    }
+
     default:
       left->Traverse(x);
       right->Traverse(x);
@@ -39,6 +39,10 @@ bool traverse_data::Print(OutputStream &s) const
         s << "BuildExpoRateDD";
         return true;
 
+    case BuildVectorProgram:
+        s << "BuildVectorProgram";
+        return true;
+
     case FindRange:
         s << "FindRange";
         return true;
@@ -341,6 +345,7 @@ void expr::Traverse(traverse_data &x)
   switch (x.which) {
     case traverse_data::None:
     case traverse_data::Block:
+    case traverse_data::BuildVectorProgram:
         return;
 
     case traverse_data::GetProducts:
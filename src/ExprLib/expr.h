@@ -24,6 +24,8 @@ class sv_encoder;  // defined in dd_front.h
 
 class shared_state; // defined in mod_vars.h
 
+class vector_program; // defined in vect_prog.h
+
 class expr;    // defined below
 class symbol;  // defined in symbols.h
 
@@ -49,6 +51,8 @@ struct traverse_data {
     BuildDD,
     /// Construct a decision diagram encoding of the expo rate expression.
     BuildExpoRateDD,
+    /// Compile into a vector program, to evaluate over blocks of states.
+    BuildVectorProgram,
     /// For random values, determine the range of possible values.
     FindRange,
     /// Pre-compute values in const to rand promotions.
@@ -103,6 +107,12 @@ struct traverse_data {
   /// Interface for building decision diagrams.
   sv_encoder* ddlib;
 
+  /// Input: don't report decision diagram build errors (caller has a fallback).
+  bool quiet;
+
+  /// Program being built, for vector programs.
+  vector_program* vprog;
+
   /// Parent (calling) expression, if any.
   const expr* parent;
 
@@ -147,6 +157,8 @@ public:
     next_state = 0;
     answer = 0;
     ddlib = 0;
+    quiet = false;
+    vprog = 0;
     parent = 0;
     model = 0;
     elist = 0;
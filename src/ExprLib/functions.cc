@@ -432,6 +432,38 @@ bool formal_param::PrintHeader(OutputStream &s, bool hide)
   return true;
 }
 
+// ******************************************************************
+// *                                                                *
+// *                        call_stack struct                       *
+// *                                                                *
+// ******************************************************************
+
+/** Run-time stack for top-level user-defined function calls.
+    There is one per thread, so that expressions may be
+    evaluated by several threads at once (e.g., during
+    parallel process generation).  The stack for the main thread
+    is allocated at startup; other threads allocate theirs on demand.
+*/
+struct call_stack {
+  /// Stack space.
+  result* base;
+  /// Top of stack.
+  long top;
+  /// Parameters for the current function call.
+  result* frame;
+
+  call_stack() {
+    base = 0;
+    top = 0;
+    frame = 0;
+  }
+  ~call_stack() {
+    delete[] base;
+  }
+};
+
+static thread_local call_stack calls;
+
 // ******************************************************************
 // *                                                                *
 // *                        fp_onstack class                        *
@@ -444,6 +476,7 @@ bool formal_param::PrintHeader(OutputStream &s, bool hide)
 class fp_onstack : public formal_param {
   /** Pointer to the current stack space for the function call.
       Used only for user-defined function calls.
+      If null, we use the calling thread's call stack frame.
    */
   result** stack;
   /// Position in the stack for the formal parameter.
@@ -502,9 +535,9 @@ fp_onstack::~fp_onstack()
 void fp_onstack::Compute(traverse_data &x)
 {
   DCASSERT(x.answer);
-  DCASSERT(stack);
-  DCASSERT(*stack);
-  *(x.answer) = (*stack)[offset];
+  const result* frame = stack ? *stack : calls.frame;
+  DCASSERT(frame);
+  *(x.answer) = frame[offset];
 }
 
 
@@ -1381,10 +1414,7 @@ int user_func
       Note the new, static stack used for function calls.
 */  
 class top_user_func : public user_func {
-  static result* stack;
   static long stack_size;
-  static long stack_top;
-  static result* stackptr;
 public:
   top_user_func(function* f, formal_param** pl, int np);
   top_user_func(const char* fn, int line, const type* t, char* n, 
@@ -1399,22 +1429,19 @@ public:
   friend class stack_size_option;
 };
 
-result* top_user_func::stack;
-result* top_user_func::stackptr;
 long top_user_func::stack_size;
-long top_user_func::stack_top;
 
 
 top_user_func::top_user_func(function* f, formal_param** pl, int np)
  : user_func(f, pl, np)
 {
-  formals.setStack(&stackptr);
+  formals.setStack(0);
 }
 
 top_user_func::top_user_func(const char* fn, int line, const type* t, char* n, 
   formal_param **pl, int np) : user_func(fn, line, t, n, pl, np)
 {
-  formals.setStack(&stackptr);
+  formals.setStack(0);
 }
 
 void top_user_func::ResetFormals(formal_param** newformal, int nfp) 
@@ -1422,7 +1449,7 @@ void top_user_func::ResetFormals(formal_param** newformal, int nfp)
   DCASSERT(!isDefined());
   DCASSERT(nfp == formals.getLength());
   formals.setAll(nfp, newformal, false);
-  formals.setStack(&stackptr);
+  formals.setStack(0);
 }
 
 void top_user_func::Compute(traverse_data &x, expr** pass, int np)
@@ -1437,7 +1464,10 @@ void top_user_func::Compute(traverse_data &x, expr** pass, int np)
   }
 
   // first... make sure there is enough room on the stack to save params
-  if (stack_top+np > stack_size) {
+  if (0==calls.base) {
+    calls.base = new result[stack_size];
+  }
+  if (calls.top+np > stack_size) {
     if (em->startError()) {
       em->cerr() << " in function " << Name() << " called ";
       em->causedBy(x.parent);
@@ -1449,13 +1479,13 @@ void top_user_func::Compute(traverse_data &x, expr** pass, int np)
   }
 
   // Compute the passed parameters.
-  result* startpos = stack + stack_top;
-  stack_top += np;
+  result* startpos = calls.base + calls.top;
+  calls.top += np;
   formals.compute(x, pass, startpos);
 
   // Re-align the formal parameters.
-  result* old_stackptr = stackptr;
-  stackptr = startpos;
+  result* old_frame = calls.frame;
+  calls.frame = startpos;
 
   // "call" function
   DCASSERT(return_expr);
@@ -1464,10 +1494,10 @@ void top_user_func::Compute(traverse_data &x, expr** pass, int np)
   
   // Clear and pop the parameters
   for (int i=0; i<np; i++) {
-    stack_top--;
-    stack[stack_top].deletePtr(); 
+    calls.top--;
+    calls.base[calls.top].deletePtr(); 
   }
-  stackptr = old_stackptr;
+  calls.frame = old_frame;
 }
 
 int top_user_func::Traverse(traverse_data &x, expr** pass, int np)
@@ -1666,12 +1696,16 @@ option::error stack_size_option::SetValue(long s)
   if (s == top_user_func::stack_size) {
     return Success;
   }
+  if (calls.top > s) return RangeError;
   result* newstack = new result[s];
-  for (long i=0; i<top_user_func::stack_top; i++) {
-    newstack[i] = top_user_func::stack[i];
+  for (long i=0; i<calls.top; i++) {
+    newstack[i] = calls.base[i];
+  }
+  if (calls.frame) {
+    calls.frame = newstack + (calls.frame - calls.base);
   }
-  delete[] top_user_func::stack;
-  top_user_func::stack = newstack;
+  delete[] calls.base;
+  calls.base = newstack;
   top_user_func::stack_size = s;
   return Success;
 }
@@ -1922,10 +1956,10 @@ expr* DefineUserFunction(const exprman* em, const char* fn, int ln,
 
 void InitFunctions(exprman* em)
 {
-  top_user_func::stack = new result[init_stack_size];
-  top_user_func::stackptr = top_user_func::stack;
+  calls.base = new result[init_stack_size];
+  calls.frame = calls.base;
+  calls.top = 0;
   top_user_func::stack_size = init_stack_size;
-  top_user_func::stack_top = 0;
 
   DCASSERT(em);
   em->addOption(
@@ -6,6 +6,7 @@
 #include "casting.h"
 #include "sets.h"
 #include "intervals.h"
+#include "vect_prog.h"
 
 #include "ops_bool.h"
 #include "ops_int.h"
@@ -666,6 +667,26 @@ void precomp_add::converter::Traverse(traverse_data &x)
         return;
     }
 
+    case traverse_data::BuildVectorProgram: {
+        DCASSERT(x.vprog);
+        if (!precomputed) {
+          DCASSERT(opnd);
+          opnd->Traverse(x);
+          int r = x.vprog->resultOf(opnd);
+          if (r>=0) x.vprog->setResult(this, r);
+          return;
+        }
+        if (!cached.isNormal()) return;
+        const type* bt = Type();
+        if (bt) bt = bt->getBaseType();
+        int r = -1;
+        if (em->REAL == bt)       r = x.vprog->addConst(cached.getReal());
+        else if (em->INT == bt)   r = x.vprog->addConst(cached.getInt());
+        else if (em->BOOL == bt)  r = x.vprog->addConst(cached.getBool());
+        if (r>=0) x.vprog->setResult(this, r);
+        return;
+    }
+
     default:
         typecast::Traverse(x);
         return;
@@ -767,6 +788,7 @@ class int2real : public specific_conv {
     public:
       converter(const char* fn, int line, const type* nt, expr* x);
       virtual void Compute(traverse_data &x);
+      virtual void Traverse(traverse_data &x);
     protected:
       virtual expr* buildAnother(expr* x) const {
         return new converter(Filename(), Linenumber(), Type(), x);
@@ -826,6 +848,20 @@ void int2real::converter::Compute(traverse_data &x)
   }
 }
 
+void int2real::converter::Traverse(traverse_data &x)
+{
+  if (traverse_data::BuildVectorProgram != x.which) {
+    typecast::Traverse(x);
+    return;
+  }
+  // vector programs hold doubles already
+  DCASSERT(x.vprog);
+  DCASSERT(opnd);
+  opnd->Traverse(x);
+  int r = x.vprog->resultOf(opnd);
+  if (r>=0) x.vprog->setResult(this, r);
+}
+
 int2real::setconv::setconv(const char* fn, int ln, const type* nt, expr* x)
  : typecast(fn, ln, nt, x) 
 { 
@@ -5,6 +5,7 @@
 
 #include "exprman.h"
 #include "engine.h"
+#include "vect_prog.h"
 
 #include "strings.h"
 #include "../include/heap.h"
@@ -47,6 +48,15 @@ measure::~measure()
   delete solve_deps;
 }
 
+int measure::BuildVectorRHS(traverse_data &x)
+{
+  DCASSERT(x.vprog);
+  DCASSERT(traverse_data::BuildVectorProgram == x.which);
+  if (0==rhs) return -1;
+  rhs->Traverse(x);
+  return x.vprog->resultOf(rhs);
+}
+
 void measure::Solve(traverse_data &x)
 {
   DCASSERT(owner);
@@ -85,6 +85,11 @@ public:
   inline void TraverseRHS(traverse_data &x) {
     if (rhs)  rhs->Traverse(x);
   }
+  /** Compile the RHS into vector program x.vprog.
+        @return The register holding the RHS,
+                or -1 if the RHS cannot be compiled.
+  */
+  int BuildVectorRHS(traverse_data &x);
   inline const type* RHSType() const { 
     return rhs ? rhs->Type() : 0;
   }
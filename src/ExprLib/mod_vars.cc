@@ -79,8 +79,6 @@ void model_var::SetNextUnknown(traverse_data &x, shared_state* ns) const {
 // *                                                                *
 // ******************************************************************
 
-result model_statevar::tempresult;
-
 model_statevar::model_statevar(const symbol* wrapper, const model_instance* p,
 		shared_object* bnds) :
 		model_var(wrapper, p) {
@@ -162,8 +160,8 @@ void model_statevar::AddToState(traverse_data &x, long delta) const {
 	long newst = x.current_state->get(GetIndex()) + delta;
 
 	if (bounds) {
-		tempresult.setInt(newst);
-		if (bounds->IndexOf(tempresult) < 0)
+		result tmp(newst);
+		if (bounds->IndexOf(tmp) < 0)
 			boundsError(x, newst);
 	} else {
 		if (newst < 0)
@@ -178,8 +176,8 @@ void model_statevar::SetNextState(traverse_data &x, shared_state* ns,
 	DCASSERT(x.answer); DCASSERT(x.current_state);
 
 	if (bounds) {
-		tempresult.setInt(rhs);
-		if (bounds->IndexOf(tempresult) < 0)
+		result tmp(rhs);
+		if (bounds->IndexOf(tmp) < 0)
 			boundsError(x, rhs);
 	} else {
 		if (rhs < 0)
@@ -118,9 +118,6 @@ public:
  These are model variables that are part of the model's state.
  */
 class model_statevar: public model_var {
-private:
-	static result tempresult; // used for checking bounds
-
 protected:
 	/** Linkage between state and variables.
 	 If this variable requires state, then this is the index
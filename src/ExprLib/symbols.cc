@@ -101,7 +101,7 @@ void symbol::Traverse(traverse_data &x)
           x.answer->setPtr(dd);
         }
         catch (sv_encoder::error e) {
-          if (em->startError()) {
+          if (!x.quiet && em->startError()) {
             em->causedBy(this);
             em->cerr() << "Error while building state variable ";
             em->cerr() << Name() << ": ";
@@ -3,6 +3,7 @@
 #include "exprman.h"
 #include "result.h"
 #include "dd_front.h"
+#include "vect_prog.h"
 
 // ******************************************************************
 // *                                                                *
@@ -111,6 +112,20 @@ void negop::Traverse(traverse_data &x)
       return;
     }
 
+    case traverse_data::BuildVectorProgram: {
+      DCASSERT(x.vprog);
+      vector_program::opcode op;
+      switch (opcode) {
+        case exprman::uop_not:  op = vector_program::NOT;   break;
+        case exprman::uop_neg:  op = vector_program::NEG;   break;
+        default:                return;
+      }
+      opnd->Traverse(x);
+      int r = x.vprog->addUnary(op, x.vprog->resultOf(opnd));
+      if (r>=0) x.vprog->setResult(this, r);
+      return;
+    }
+
     default:
       unary::Traverse(x);
   }
@@ -4,6 +4,7 @@
 #include "exprman.h"
 #include "intervals.h"
 #include "dd_front.h"
+#include "vect_prog.h"
 
 // #define SHOW_IMPLICIT_CAST
 
@@ -98,6 +99,19 @@ void value::Traverse(traverse_data &x)
         x.answer->setNull();
         return;
 
+    case traverse_data::BuildVectorProgram: {
+        DCASSERT(x.vprog);
+        if (!val.isNormal()) return;
+        const type* bt = Type();
+        if (bt) bt = bt->getBaseType();
+        int r = -1;
+        if (em->REAL == bt)       r = x.vprog->addConst(val.getReal());
+        else if (em->INT == bt)   r = x.vprog->addConst(val.getInt());
+        else if (em->BOOL == bt)  r = x.vprog->addConst(val.getBool());
+        if (r>=0) x.vprog->setResult(this, r);
+        return;
+    }
+
     case traverse_data::BuildDD: {
         DCASSERT(x.answer);
         DCASSERT(x.ddlib);
@@ -122,7 +136,7 @@ void value::Traverse(traverse_data &x)
           x.answer->setPtr(dd);
         } // try
         catch (sv_encoder::error e) {
-          if (em->startError()) {
+          if (!x.quiet && em->startError()) {
             em->causedBy(this);
             em->cerr() << "Error while building constant: ";
             em->cerr() << sv_encoder::getNameOfError(e);
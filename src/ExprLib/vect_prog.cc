@@ -0,0 +1,193 @@
+#include "vect_prog.h"
+#include "../include/defines.h"
+
+#include <stdlib.h>
+
+// ******************************************************************
+// *                                                                *
+// *                    vector_program  methods                     *
+// *                                                                *
+// ******************************************************************
+
+vector_program::vector_program()
+{
+  code = 0;
+  code_size = 0;
+  code_alloc = 0;
+  regs = 0;
+  block = 0;
+  svregs = 0;
+  num_svars = 0;
+  last_expr = 0;
+  last_reg = -1;
+}
+
+vector_program::~vector_program()
+{
+  freeRegisters();
+  free(code);
+  free(svregs);
+}
+
+void vector_program::clear()
+{
+  freeRegisters();
+  code_size = 0;
+  num_svars = 0;
+  last_expr = 0;
+  last_reg = -1;
+}
+
+void vector_program::rollback(int n)
+{
+  DCASSERT(0==regs);
+  if (n >= code_size) return;
+  code_size = n;
+  while (num_svars && svregs[num_svars-1] >= n) num_svars--;
+  last_expr = 0;
+  last_reg = -1;
+}
+
+int vector_program::addConst(double c)
+{
+  return addInstruction(CONST, -1, -1, c);
+}
+
+int vector_program::addStateVar(int index)
+{
+  for (int i=0; i<num_svars; i++) {
+    if (int(code[svregs[i]].c) == index) return svregs[i];
+  }
+  int r = addInstruction(STATEVAR, -1, -1, index);
+  if (r<0) return -1;
+  // there are never more state variables than instructions
+  int* nsv = (int*) realloc(svregs, code_alloc*sizeof(int));
+  if (0==nsv) return -1;
+  svregs = nsv;
+  svregs[num_svars] = r;
+  num_svars++;
+  return r;
+}
+
+int vector_program::addUnary(opcode op, int a)
+{
+  DCASSERT(op == NEG || op == NOT);
+  if (a<0) return -1;
+  return addInstruction(op, a, -1, 0);
+}
+
+int vector_program::addBinary(opcode op, int a, int b)
+{
+  DCASSERT(op >= ADD);
+  if (a<0 || b<0) return -1;
+  return addInstruction(op, a, b, 0);
+}
+
+void vector_program::setBlockSize(long n)
+{
+  DCASSERT(n>0);
+  freeRegisters();
+  block = n;
+  regs = new double* [code_size];
+  for (int r=0; r<code_size; r++) {
+    regs[r] = new double[n];
+    if (CONST == code[r].op) {
+      for (long i=0; i<n; i++) regs[r][i] = code[r].c;
+    }
+  }
+}
+
+void vector_program::evaluate(long n)
+{
+  DCASSERT(n <= block);
+  for (int r=0; r<code_size; r++) {
+    double* d = regs[r];
+    const double* a = (code[r].a < 0) ? 0 : regs[code[r].a];
+    const double* b = (code[r].b < 0) ? 0 : regs[code[r].b];
+    long i;
+    switch (code[r].op) {
+      case CONST:
+      case STATEVAR:
+          continue;
+
+      case NEG:
+          for (i=0; i<n; i++) d[i] = -a[i];
+          continue;
+
+      case NOT:
+          for (i=0; i<n; i++) d[i] = (0==a[i]);
+          continue;
+
+      case ADD:
+          for (i=0; i<n; i++) d[i] = a[i] + b[i];
+          continue;
+
+      case SUB:
+          for (i=0; i<n; i++) d[i] = a[i] - b[i];
+          continue;
+
+      case MUL:
+          for (i=0; i<n; i++) d[i] = a[i] * b[i];
+          continue;
+
+      case EQ:
+          for (i=0; i<n; i++) d[i] = (a[i] == b[i]);
+          continue;
+
+      case NE:
+          for (i=0; i<n; i++) d[i] = (a[i] != b[i]);
+          continue;
+
+      case GT:
+          for (i=0; i<n; i++) d[i] = (a[i] > b[i]);
+          continue;
+
+      case GE:
+          for (i=0; i<n; i++) d[i] = (a[i] >= b[i]);
+          continue;
+
+      case LT:
+          for (i=0; i<n; i++) d[i] = (a[i] < b[i]);
+          continue;
+
+      case LE:
+          for (i=0; i<n; i++) d[i] = (a[i] <= b[i]);
+          continue;
+
+      case AND:
+          for (i=0; i<n; i++) d[i] = (a[i] != 0) && (b[i] != 0);
+          continue;
+
+      case OR:
+          for (i=0; i<n; i++) d[i] = (a[i] != 0) || (b[i] != 0);
+          continue;
+    }
+  }
+}
+
+int vector_program::addInstruction(opcode op, int a, int b, double c)
+{
+  DCASSERT(0==regs);
+  if (code_size >= code_alloc) {
+    int na = code_alloc ? 2*code_alloc : 16;
+    instruction* nc = (instruction*) realloc(code, na*sizeof(instruction));
+    if (0==nc) return -1;
+    code = nc;
+    code_alloc = na;
+  }
+  code[code_size].op = op;
+  code[code_size].a = a;
+  code[code_size].b = b;
+  code[code_size].c = c;
+  return code_size++;
+}
+
+void vector_program::freeRegisters()
+{
+  if (regs) {
+    for (int r=0; r<code_size; r++) delete[] regs[r];
+    delete[] regs;
+  }
+  regs = 0;
+  block = 0;
+}
@@ -0,0 +1,143 @@
+#ifndef VECT_PROG_H
+#define VECT_PROG_H
+
+class expr;
+
+// ******************************************************************
+// *                                                                *
+// *                     vector_program  class                      *
+// *                                                                *
+// ******************************************************************
+
+/** Straight-line programs over blocks of states.
+    Simple expressions (constants, state variables, arithmetic,
+    comparisons and logic) can be compiled into one of these,
+    using the BuildVectorProgram traversal.
+    Each instruction writes its own register, which is a column
+    of doubles with one entry per state in the block;
+    booleans are stored as 0 or 1.
+    The caller fills the state variable columns for a block of
+    states, and then evaluates everything with tight loops,
+    instead of walking the expression tree once per state.
+
+    Expressions add instructions bottom up, and then announce
+    the register holding their value with setResult().
+    A parent checks resultOf() for each child; expressions
+    that do not know this traversal never announce anything,
+    so the parent (and the whole compilation) gives up.
+*/
+class vector_program {
+public:
+  enum opcode {
+    /// Constant value.
+    CONST,
+    /// Value of a state variable; filled in by the caller.
+    STATEVAR,
+    NEG,
+    NOT,
+    ADD,
+    SUB,
+    MUL,
+    EQ,
+    NE,
+    GT,
+    GE,
+    LT,
+    LE,
+    AND,
+    OR
+  };
+
+private:
+  struct instruction {
+    opcode op;
+    int a;
+    int b;
+    double c;
+  };
+  instruction* code;
+  int code_size;
+  int code_alloc;
+
+  /// Registers, one column per instruction.
+  double** regs;
+  /// Dimension of each register.
+  long block;
+
+  /// Registers holding state variables.
+  int* svregs;
+  int num_svars;
+
+  const expr* last_expr;
+  int last_reg;
+
+public:
+  vector_program();
+  ~vector_program();
+
+  /// Remove all instructions.
+  void clear();
+
+  inline int numInstructions() const { return code_size; }
+
+  /** Remove instructions, back to the first n.
+      Used to discard a partially compiled expression.
+  */
+  void rollback(int n);
+
+  /// Add a constant; returns its register.
+  int addConst(double c);
+
+  /** Add a state variable; returns its register.
+      Each state variable is loaded only once.
+  */
+  int addStateVar(int index);
+
+  /// Add "op a"; returns the destination register.
+  int addUnary(opcode op, int a);
+
+  /// Add "a op b"; returns the destination register.
+  int addBinary(opcode op, int a, int b);
+
+  /// Expression e has its value in register r.
+  inline void setResult(const expr* e, int r) {
+    last_expr = e;
+    last_reg = r;
+  }
+
+  /// Register holding the value of e, just compiled, or -1.
+  inline int resultOf(const expr* e) const {
+    return (e == last_expr) ? last_reg : -1;
+  }
+
+  /** Allocate registers for blocks of (up to) n states.
+      Must be called after the last instruction is added,
+      and before the columns are filled.
+  */
+  void setBlockSize(long n);
+
+  inline long blockSize() const { return block; }
+
+  inline int numStateVars() const { return num_svars; }
+
+  /// State index of the ith state variable loaded.
+  inline int stateVarIndex(int i) const {
+    return int(code[svregs[i]].c);
+  }
+
+  /// Column for the ith state variable loaded.
+  inline double* stateVarColumn(int i) {
+    return regs[svregs[i]];
+  }
+
+  /// Evaluate every instruction over the first n states of the block.
+  void evaluate(long n);
+
+  inline const double* column(int r) const { return regs[r]; }
+
+private:
+  int addInstruction(opcode op, int a, int b, double c);
+  void freeRegisters();
+};
+
+#endif
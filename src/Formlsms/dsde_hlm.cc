@@ -18,6 +18,8 @@
 // *                                                                *
 // ******************************************************************
 
+thread_local int model_event::eval_slot = 0;
+
 const char* model_event::nameOf(firing_type t)
 {
   switch (t) {
@@ -83,6 +85,7 @@ void model_event::Init()
   enabling_variable_dependencies = 0;
   nextstate_level_dependencies = 0;
   nextstate_variable_dependencies = 0;
+  for (int i=0; i<max_eval_slots; i++) enable_data[i] = unknown;
 }
 
 model_event::~model_event()
@@ -245,17 +248,17 @@ void model_event::decideEnabled(traverse_data &x)
   fprintf(stderr, "IN  decideEnabled for event %s\n", Name());
 #endif
   DCASSERT(x.answer);
-  DCASSERT(unknown == enable_data);
+  DCASSERT(unknown == enable_data[eval_slot]);
   for (int i = prio_length-1; i>=0; i--) {
     DCASSERT(prio_list[i]);
     if (prio_list[i]->unknownIfEnabled()) prio_list[i]->decideEnabled(x);
     if (!x.answer->isNormal()) return;
     if (prio_list[i]->isEnabled()) {
-      enable_data = disabled;
+      enable_data[eval_slot] = disabled;
       x.answer->setBool(false);
 #ifdef DEBUG_ENABLED
       fprintf(stderr, "OUT, priority disabled event %s, enable_data is %d\n",
-              Name(), enable_data);
+              Name(), enable_data[eval_slot]);
 #endif
       return;
     }
@@ -268,12 +271,12 @@ void model_event::decideEnabled(traverse_data &x)
     enabling->Compute(x);
   }
   if (x.answer->isNormal() && x.answer->getBool()) {
-    enable_data = enabled;
+    enable_data[eval_slot] = enabled;
   } else {
-    enable_data = disabled;
+    enable_data[eval_slot] = disabled;
   }
 #ifdef DEBUG_ENABLED
-  fprintf(stderr, "OUT decideEnabled for event %s, enable_data is %d\n", Name(), enable_data);
+  fprintf(stderr, "OUT decideEnabled for event %s, enable_data is %d\n", Name(), enable_data[eval_slot]);
 #endif
 }
 
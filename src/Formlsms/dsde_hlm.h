@@ -72,12 +72,23 @@ private:
   /// Number of events that have priority over us.
   int prio_length;
 
-  enum {
+public:
+  /// Maximum number of threads that may evaluate events at once.
+  static const int max_eval_slots = 64;
+private:
+  enum enable_status {
     disabled = -1,
     unknown = 0,
     enabled = 1,
     omega=OOmega
-  } enable_data;
+  };
+  /** Enabling status, one per evaluation slot.
+      Each thread that decides enabling uses its own slot,
+      so that process generation may run in parallel.
+  */
+  enable_status enable_data[max_eval_slots];
+  /// Evaluation slot for the calling thread; 0 for the main thread.
+  static thread_local int eval_slot;
 
   intset* enabling_level_dependencies;
   intset* enabling_variable_dependencies;
@@ -250,20 +261,29 @@ public:
   */
   void finishPriorityInfo(List <model_event> &tmp, List <model_event> *ignored);
 
+  /** Set the evaluation slot for the calling thread.
+      Threads evaluating events at the same time
+      must use different slots.
+  */
+  static inline void setEvalSlot(int s) {
+    CHECK_RANGE(0, s, max_eval_slots);
+    eval_slot = s;
+  }
+
   void decideEnabled(traverse_data &x);
-  inline void clearEnabled() { enable_data = unknown; }
-  inline void setDisabled() { enable_data = disabled; }
-  inline bool unknownIfEnabled() const { return unknown == enable_data; }
-  inline bool knownEnabled() const { return enabled == enable_data; }
-  inline bool omegaIfEnabled() const { bool res=(omega == enable_data);printf("REEES is %i\n",res);return res; }
-  inline void setOmega() { enable_data = omega; printf("SET!!,%d\n",enable_data);}
+  inline void clearEnabled() { enable_data[eval_slot] = unknown; }
+  inline void setDisabled() { enable_data[eval_slot] = disabled; }
+  inline bool unknownIfEnabled() const { return unknown == enable_data[eval_slot]; }
+  inline bool knownEnabled() const { return enabled == enable_data[eval_slot]; }
+  inline bool omegaIfEnabled() const { bool res=(omega == enable_data[eval_slot]);printf("REEES is %i\n",res);return res; }
+  inline void setOmega() { enable_data[eval_slot] = omega; printf("SET!!,%d\n",enable_data[eval_slot]);}
   inline bool isEnabled() const {
-    DCASSERT(unknown != enable_data);
-    return enabled == enable_data;
+    DCASSERT(unknown != enable_data[eval_slot]);
+    return enabled == enable_data[eval_slot];
   }
   inline bool isOmega() const {
-    // DCASSERT(unknown != enable_data);
-     return omega == enable_data;
+    // DCASSERT(unknown != enable_data[eval_slot]);
+     return omega == enable_data[eval_slot];
    }
 
 };
@@ -12,6 +12,7 @@
 #include "../ExprLib/mod_vars.h"
 #include "../ExprLib/dd_front.h"
 #include "../ExprLib/measures.h"
+#include "../ExprLib/vect_prog.h"
 
 #include "../Formlsms/dsde_hlm.h"
 #include "../Formlsms/rss_meddly.h"
@@ -2466,6 +2467,8 @@ public:
   pn_tk();
   virtual void Compute(traverse_data &x, expr** pass, int np);
   virtual int Traverse(traverse_data &x, expr** pass, int np);
+protected:
+  int buildVectorProgram(traverse_data &x, expr** pass, int np);
 };
 
 pn_tk::pn_tk() : model_internal(em->INT->addProc(), "tk", 2)
@@ -2494,6 +2497,9 @@ void pn_tk::Compute(traverse_data &x, expr** pass, int np)
 
 int pn_tk::Traverse(traverse_data &x, expr** pass, int np)
 {
+  if (x.which == traverse_data::BuildVectorProgram) {
+    return buildVectorProgram(x, pass, np);
+  }
   if (x.which != traverse_data::BuildDD) {
     return model_internal::Traverse(x, pass, np);
   }
@@ -2517,6 +2523,28 @@ int pn_tk::Traverse(traverse_data &x, expr** pass, int np)
   return 0;
 }
 
+int pn_tk::buildVectorProgram(traverse_data &x, expr** pass, int np)
+{
+  DCASSERT(x.answer);
+  DCASSERT(x.vprog);
+  DCASSERT(np==2);
+  // The state is needed to check the owner, as in Compute
+  if (0==x.current_state || 0==x.parent) return 0;
+
+  // Get place from second parameter
+  SafeCompute(pass[1], x);
+  if (!x.answer->isNormal())  return 0;
+
+  model_statevar* place = dynamic_cast <model_statevar*> (x.answer->getPtr());
+  if (0==place) return 0;
+  const hldsm* hm = x.current_state->Parent();
+  if (0==hm || hm->GetParent() != place->getParent()) return 0;
+
+  int r = x.vprog->addStateVar(place->GetIndex());
+  if (r>=0) x.vprog->setResult(x.parent, r);
+  return 0;
+}
+
 // ********************************************************
 // *                    pn_rate  class                    *
 // ********************************************************
@@ -20,6 +20,11 @@
 LS_Options* markov_process::lsopts = 0;
 int markov_process::solver;
 named_msg markov_process::report;
+long markov_process::num_threads = 1;
+double markov_process::steady_precision = 1e-10;
+long markov_process::steady_check = 1;
+const double markov_process::poisson_precision = 1e-20;
+bool markov_process::lumping = false;
 int markov_process::access = markov_process::BY_COLUMNS;
 markov_process::reporter* markov_process::my_timer = 0;
 
@@ -42,7 +47,9 @@ const LS_Options& markov_process::getSolverOptions()
   DCASSERT(lsopts);
   CHECK_RANGE(0, solver, NUM_SOLVERS);
   // fix the option values that are not automatically linked
-  lsopts[solver].use_relaxation = (lsopts[solver].relaxation != 1.0);
+  lsopts[solver].use_relaxation = (lsopts[solver].relaxation != 1.0)
+                                  || lsopts[solver].adaptive_relaxation;
+  lsopts[solver].num_threads = num_threads;
   return lsopts[solver];
 }
 
@@ -124,6 +131,26 @@ void markov_process::stopAccumulatedReport(timer& watch, long iters) const
   report.stopIO();
 }
 
+void markov_process::startLumpingReport(timer& watch) const
+{
+  if (!report.startReport()) return;
+  report.report() << "Lumping Markov chain\n";
+  report.stopIO();
+  watch.reset();
+}
+
+void markov_process::stopLumpingReport(timer& watch, long states, 
+  long blocks, long splitters) const
+{
+  if (!report.startReport()) return;
+  report.report() << "Lumped  Markov chain\n";
+  report.report() << "\t" << watch.elapsed_seconds() << " seconds";
+  report.report() << " required for " << splitters << " splitters\n";
+  report.report() << "\t" << states << " states lumped into ";
+  report.report() << blocks << " states\n";
+  report.stopIO();
+}
+
 void markov_process::startRevTransReport(timer& watch, double t) const
 {
   if (!report.startReport()) return;
@@ -170,6 +197,11 @@ const char* markov_process::getSolver()
     case GAUSS_SEIDEL:    return "Gauss-Seidel";
     case JACOBI:          return "Jacobi";
     case ROW_JACOBI:      return "Row Jacobi";
+    case GMRES:           return "GMRES";
+    case BICGSTAB:        return "BiCGSTAB";
+    case CGS:             return "CGS";
+    case BLOCK_GAUSS_SEIDEL:  return "Block Gauss-Seidel";
+    case BLOCK_JACOBI:    return "Block Jacobi";
     default:              return "unknown solver";
   }
 }
@@ -297,6 +329,11 @@ bool init_markovproc::execute()
   markov_process::lsopts[markov_process::GAUSS_SEIDEL].method = LS_Gauss_Seidel;
   markov_process::lsopts[markov_process::JACOBI].method = LS_Jacobi;
   markov_process::lsopts[markov_process::ROW_JACOBI].method = LS_Row_Jacobi;
+  markov_process::lsopts[markov_process::GMRES].method = LS_GMRES;
+  markov_process::lsopts[markov_process::BICGSTAB].method = LS_BiCGSTAB;
+  markov_process::lsopts[markov_process::CGS].method = LS_CGS;
+  markov_process::lsopts[markov_process::BLOCK_GAUSS_SEIDEL].method = LS_Block_Gauss_Seidel;
+  markov_process::lsopts[markov_process::BLOCK_JACOBI].method = LS_Block_Jacobi;
 
   //
   // Set up the radio buttons for the solvers
@@ -314,16 +351,70 @@ bool init_markovproc::execute()
       "ROW_JACOBI", "Jacobi, visiting one matrix row at a time", 
       markov_process::ROW_JACOBI
   );
+  solvers[markov_process::GMRES] = new radio_button(
+      "GMRES", "Restarted GMRES, with diagonal preconditioning", 
+      markov_process::GMRES
+  );
+  solvers[markov_process::BICGSTAB] = new radio_button(
+      "BICGSTAB", "BiCGSTAB, with diagonal preconditioning", 
+      markov_process::BICGSTAB
+  );
+  solvers[markov_process::CGS] = new radio_button(
+      "CGS", "Conjugate Gradient Squared, with diagonal preconditioning", 
+      markov_process::CGS
+  );
+  solvers[markov_process::BLOCK_GAUSS_SEIDEL] = new radio_button(
+      "BLOCK_GAUSS_SEIDEL", "Block Gauss-Seidel, with consecutive states grouped into blocks", 
+      markov_process::BLOCK_GAUSS_SEIDEL
+  );
+  solvers[markov_process::BLOCK_JACOBI] = new radio_button(
+      "BLOCK_JACOBI", "Block Jacobi, with consecutive states grouped into blocks; uses MCSolverThreads", 
+      markov_process::BLOCK_JACOBI
+  );
    
   markov_process::solver = markov_process::GAUSS_SEIDEL;
   em->addOption(
     MakeRadioOption(
       "MCSolver",
       "Numerical method to use for solving linear systems during Markov chain analysis.",
-      solvers, 3, markov_process::solver
+      solvers, markov_process::NUM_SOLVERS, markov_process::solver
+    )
+  );
+
+  em->addOption(
+    MakeIntOption(
+      "MCSolverThreads",
+      "Number of threads to use for Markov chain numerical solution.  Used for transient and accumulated measures, and by the ROW_JACOBI and BLOCK_JACOBI solvers; the other solvers are sequential.",
+      markov_process::num_threads, 1, 1024
     )
   );
   
+  em->addOption(
+    MakeRealOption(
+      "UniformizationSteadyPrecision",
+      "Precision for detecting that the distribution has reached steady state, during transient and accumulated analysis of Markov chains.  Once detected, the remaining vector-matrix multiplications are skipped, which can save a huge amount of work for long time horizons.  The test uses the relative difference for each state.  Use 0 to never stop early.",
+      markov_process::steady_precision, 
+      true, true, 0.0,
+      true, false, 1.0
+    )
+  );
+
+  em->addOption(
+    MakeIntOption(
+      "UniformizationSteadyCheck",
+      "Number of steps between checks for steady state, during transient and accumulated analysis of Markov chains.  Each check requires two consecutive vectors to be within UniformizationSteadyPrecision, and also the current vector to be within UniformizationSteadyPrecision of the one at the previous check; this prevents stopping too early for stiff chains, where a single step barely changes the vector.  Use 1 to simply compare consecutive vectors at every step.",
+      markov_process::steady_check, 1, 1000000000
+    )
+  );
+
+  em->addOption(
+    MakeBoolOption(
+      "MCLumping",
+      "Should Markov chains be exactly lumped before numerical solution?  If set, the coarsest exactly lumpable partition of the states is found, keeping states with different initial probabilities apart, and the smaller lumped chain is solved instead.  Probabilities of the original states are recovered by dividing the probability of a lumped state evenly among its states, so all measures are still available.  Transient and accumulated analysis fall back to the original chain if the starting vector is not uniform over the lumped states.",
+      markov_process::lumping
+    )
+  );
+
   //
   // Add settings for each solver radio button (cool, huh?)
   //
@@ -358,15 +449,73 @@ bool init_markovproc::execute()
       )
     );
 
-    settings->AddOption(
-      MakeRealOption(
-        "Relaxation", 
-        "Relaxation parameter to use (or start with).",
-        markov_process::lsopts[i].relaxation, 
-        true, false, 0.0,
-        true, false, 2.0
-      )
-    );
+    //
+    // Relaxation only applies to the stationary methods
+    //
+    if ( (markov_process::GAUSS_SEIDEL == i) || (markov_process::JACOBI == i) 
+         || (markov_process::ROW_JACOBI == i) ) 
+    {
+      settings->AddOption(
+        MakeRealOption(
+          "Relaxation", 
+          "Relaxation parameter to use (or start with).",
+          markov_process::lsopts[i].relaxation, 
+          true, false, 0.0,
+          true, false, 2.0
+        )
+      );
+    }
+    if (markov_process::GAUSS_SEIDEL == i) {
+      settings->AddOption(
+        MakeBoolOption(
+          "AdaptiveRelaxation",
+          "Should the relaxation parameter be adjusted as we go, based on the observed rate of convergence.  If true, the Relaxation setting gives the initial value.",
+          markov_process::lsopts[i].adaptive_relaxation
+        )
+      );
+    }
+
+    //
+    // Subspace dimension for restarted Krylov methods
+    //
+    if (markov_process::GMRES == i) {
+      settings->AddOption(
+        MakeIntOption(
+          "KrylovDimension",
+          "Dimension of the Krylov subspace, i.e., number of iterations between restarts.  Larger values usually need fewer iterations, but each one takes more time, and memory for this many vectors is required.",
+          markov_process::lsopts[i].krylov_dim, 1, 1000
+        )
+      );
+    }
+
+    //
+    // Block structure for the block methods
+    //
+    if ( (markov_process::BLOCK_GAUSS_SEIDEL == i) 
+         || (markov_process::BLOCK_JACOBI == i) ) 
+    {
+      settings->AddOption(
+        MakeIntOption(
+          "BlockSize",
+          "Number of consecutive states in each block.  States are simply chunked in the order they are stored, with no regard to the structure of the model; blocks never span two recurrent classes, since each class is solved separately.",
+          markov_process::lsopts[i].block_size, 1, 2000000000
+        )
+      );
+      settings->AddOption(
+        MakeIntOption(
+          "InnerIters",
+          "Maximum number of Gauss-Seidel iterations used to solve each block, per outer iteration.",
+          markov_process::lsopts[i].inner_iters, 1, 1000
+        )
+      );
+      settings->AddOption(
+        MakeBoolOption(
+          "Aggregate",
+          "Should we use iterative aggregation / disaggregation between outer iterations, for steady-state solutions.  Can be a huge improvement for nearly-decomposable chains, if the fixed-size blocks of BlockSize states happen to follow the decomposition, but memory is required for a dense matrix with one row and column per block.",
+          markov_process::lsopts[i].aggregate
+        )
+      );
+    }
 
     // 
     // Option for auxiliary vectors, only applies to solvers
@@ -42,11 +42,23 @@ class markov_process : public stochastic_lldsm::process {
     static LS_Options* lsopts;
     // options, shared by all Markov-chain low-level models.
     static int solver;
-    static const int GAUSS_SEIDEL = 0;
-    static const int JACOBI       = 1;
-    static const int ROW_JACOBI   = 2;
-    static const int NUM_SOLVERS  = 3;
+    // radio buttons must be in alphabetical order
+    static const int BICGSTAB     = 0;
+    static const int BLOCK_GAUSS_SEIDEL = 1;
+    static const int BLOCK_JACOBI = 2;
+    static const int CGS          = 3;
+    static const int GAUSS_SEIDEL = 4;
+    static const int GMRES        = 5;
+    static const int JACOBI       = 6;
+    static const int ROW_JACOBI   = 7;
+    static const int NUM_SOLVERS  = 8;
     static named_msg report;
+    static long num_threads;
+    static double steady_precision;
+    static long steady_check;
+    // Poisson truncation for uniformization; not user settable.
+    static const double poisson_precision;
+    static bool lumping;
     static int access;
     static const int BY_COLUMNS = 0;
     static const int BY_ROWS    = 1;
@@ -56,6 +68,11 @@ class markov_process : public stochastic_lldsm::process {
   public:
     inline static bool storeByRows() { return BY_ROWS == access; }
     static const LS_Options& getSolverOptions();
+    inline static int getNumThreads() { return int(num_threads); }
+    inline static double getSteadyPrecision() { return steady_precision; }
+    inline static long getSteadyCheck() { return steady_check; }
+    inline static double getPoissonPrecision() { return poisson_precision; }
+    inline static bool useLumping() { return lumping; }
     static const char* getSolver();
 
   // reporting.  The other point of this class.
@@ -70,6 +87,10 @@ class markov_process : public stochastic_lldsm::process {
     void startAccumulatedReport(timer& w, double t) const;
     void stopAccumulatedReport(timer& w, long iters) const;
   
+    void startLumpingReport(timer& w) const;
+    void stopLumpingReport(timer& w, long states, long blocks, 
+      long splitters) const;
+  
     void startRevTransReport(timer& w, double t) const;
     void stopRevTransReport(timer& w, long iters) const;
 
@@ -9,6 +9,9 @@
 
 #include "show_graph.h"
 
+#include <algorithm>
+#include <math.h>
+
 bool statusOK(exprman* em, const LS_Output &o, const char* who) 
 {
     switch (o.status) {
@@ -98,6 +101,12 @@ mclib_process::mclib_process(bool discrete, GraphLib::dynamic_graph* _G)
   
   trap = -1;
   accept = -1;
+
+  lumped = 0;
+  lump_map = 0;
+  lump_size = 0;
+  lump_rep = 0;
+  lump_tried = false;
 }
 
 // ******************************************************************
@@ -113,6 +122,12 @@ mclib_process::mclib_process(MCLib::vanishing_chain* vc)
   
   trap = -1;
   accept = -1;
+
+  lumped = 0;
+  lump_map = 0;
+  lump_size = 0;
+  lump_rep = 0;
+  lump_tried = false;
 }
 
 // ******************************************************************
@@ -123,6 +138,10 @@ mclib_process::~mclib_process()
   delete VC;
   delete chain;
   Delete(initial);
+  delete lumped;
+  delete[] lump_map;
+  delete[] lump_size;
+  delete[] lump_rep;
 }
 
 // ******************************************************************
@@ -175,6 +194,114 @@ GraphLib::node_renumberer* mclib_process::initChain(GraphLib::dynamic_graph *g)
 
 // ******************************************************************
 
+// Helper class for lumpChain
+// ======================================================================
+class by_value {
+    const double* v;
+  public:
+    by_value(const double* _v) : v(_v) { }
+    inline bool operator()(long a, long b) const {
+      return v[a] < v[b];
+    }
+};
+// ======================================================================
+
+bool mclib_process::lumpChain() const
+{
+  if (!useLumping()) return false;
+  if (lump_tried) return (0 != lumped);
+  lump_tried = true;
+  if (0==chain || 0==initial) return false;
+
+  //
+  // Initial partition: states with equal initial probability,
+  // except the trap and accepting states which stay alone.
+  //
+  const long ns = chain->getNumStates();
+  double* p0 = new double[ns];
+  long* order = new long[ns];
+  long* key = new long[ns];
+  for (long s=0; s<ns; s++) p0[s] = 0;
+  initial->ExportTo(p0);
+  for (long s=0; s<ns; s++) order[s] = s;
+  std::sort(order, order+ns, by_value(p0));
+  long k = 0;
+  for (long i=0; i<ns; i++) {
+    if (i && p0[order[i]] != p0[order[i-1]]) k++;
+    key[order[i]] = k;
+  }
+  if (trap >= 0)    key[trap] = ++k;
+  if (accept >= 0)  key[accept] = ++k;
+  delete[] order;
+  delete[] p0;
+
+  //
+  // Lump
+  //
+  long* map = new long[ns];
+  MCLib::Markov_chain::lumping_options opts;
+  opts.exact = true;
+  try {
+    timer w;
+    startLumpingReport(w);
+    lumped = chain->lump(key, map, opts, my_timer ? my_timer->switchMe() : 0);
+    stopLumpingReport(w, ns, lumped ? lumped->getNumStates() : ns, 
+      opts.splitters);
+  }
+  catch (MCLib::error e) {
+    status(em, e, "lumping");
+    lumped = 0;
+  }
+  delete[] key;
+  if (0==lumped) {
+    delete[] map;
+    return false;
+  }
+
+  const long nb = lumped->getNumStates();
+  lump_map = map;
+  lump_size = new long[nb];
+  lump_rep = new long[nb];
+  for (long b=0; b<nb; b++) lump_size[b] = 0;
+  for (long s=ns-1; s>=0; s--) {
+    lump_size[map[s]]++;
+    lump_rep[map[s]] = s;
+  }
+  return true;
+}
+
+// ******************************************************************
+
+double* mclib_process::lumpVector(const double* x) const
+{
+  DCASSERT(lumped);
+  const long ns = chain->getNumStates();
+  for (long s=0; s<ns; s++) {
+    const double r = x[lump_rep[lump_map[s]]];
+    if (fabs(x[s] - r) > 1e-12 * fabs(r)) return 0;
+  }
+  const long nb = lumped->getNumStates();
+  double* lx = new double[nb];
+  for (long b=0; b<nb; b++) {
+    lx[b] = x[lump_rep[b]] * lump_size[b];
+  }
+  return lx;
+}
+
+// ******************************************************************
+
+void mclib_process::expandVector(const double* lx, double* x) const
+{
+  DCASSERT(lumped);
+  const long ns = chain->getNumStates();
+  for (long s=0; s<ns; s++) {
+    const long b = lump_map[s];
+    x[s] = lx[b] / lump_size[b];
+  }
+}
+
+// ******************************************************************
+
 void mclib_process::attachToParent(stochastic_lldsm* p, LS_Vector &init, state_lldsm::reachset* rss)
 {
   process::attachToParent(p, init, rss);
@@ -381,36 +508,51 @@ bool mclib_process
 {
   if (0==chain || 0==probs || 0==aux1)  return false;
 
+  // Solve the lumped chain instead, if we can
+  const MCLib::Markov_chain* mc = chain;
+  double* lp = lumpChain() ? lumpVector(probs) : 0;
+  if (lp) mc = lumped;
+  double* p = lp ? lp : probs;
 
   try {
     timer w;
     if (is_discrete) {
       MCLib::Markov_chain::DTMC_transient_options opts;
+      opts.ssprec = getSteadyPrecision();
+      opts.ss_check = getSteadyCheck();
       opts.vm_result = aux1;
+      opts.num_threads = getNumThreads();
       opts.accumulator = aux2;
 
       int it = int(t);
       startTransientReport(w, it);
-      chain->computeTransient(it, probs, opts);
+      mc->computeTransient(it, p, opts);
       stopTransientReport(w, opts.multiplications);
 
       opts.vm_result = 0;
       opts.accumulator = 0;
     } else {
       MCLib::Markov_chain::CTMC_transient_options opts;
+      opts.epsilon = getPoissonPrecision();
+      opts.ssprec = getSteadyPrecision();
+      opts.ss_check = getSteadyCheck();
       opts.vm_result = aux1;
+      opts.num_threads = getNumThreads();
       opts.accumulator = aux2;
 
       startTransientReport(w, t); 
-      chain->computeTransient(t, probs, opts);
+      mc->computeTransient(t, p, opts);
       stopTransientReport(w, opts.multiplications);
 
       opts.vm_result = 0;
       opts.accumulator = 0;
     }
+    if (lp) expandVector(lp, probs);
+    delete[] lp;
     return true;
   }
   catch (MCLib::error e) {
+    delete[] lp;
     if (em->startInternal(__FILE__, __LINE__)) {
       em->noCause();
       em->internal() << "Unexpected error: ";
@@ -423,40 +565,127 @@ bool mclib_process
 
 // ******************************************************************
 
+// Helper for computeTransients
+inline void deleteLumped(double* lp, double** lpt, long nt)
+{
+  delete[] lp;
+  if (0==lpt) return;
+  for (long i=0; i<nt; i++) delete[] lpt[i];
+  delete[] lpt;
+}
+
+bool mclib_process::computeTransients(const double* t, long nt, 
+  double* probs, double** pt, double* aux1, double* aux2) const
+{
+  if (is_discrete) {
+    // Already cheap: each time point continues from the previous one
+    return stochastic_lldsm::process::computeTransients(t, nt, probs, pt, 
+      aux1, aux2);
+  }
+  if (0==chain || 0==probs || 0==pt || 0==aux1)  return false;
+  if (nt < 1) return true;
+
+  // Solve the lumped chain instead, if we can
+  double* lp = lumpChain() ? lumpVector(probs) : 0;
+  double** lpt = 0;
+  if (lp) {
+    const long nb = lumped->getNumStates();
+    lpt = new double*[nt];
+    for (long i=0; i<nt; i++) lpt[i] = new double[nb];
+  }
+
+  try {
+    timer w;
+    MCLib::Markov_chain::CTMC_transient_options opts;
+    opts.epsilon = getPoissonPrecision();
+    opts.ssprec = getSteadyPrecision();
+    opts.ss_check = getSteadyCheck();
+    opts.vm_result = aux1;
+    opts.num_threads = getNumThreads();
+
+    startTransientReport(w, t[nt-1]); 
+    if (lp) {
+      lumped->computeTransients(t, nt, lp, lpt, opts);
+      for (long i=0; i<nt; i++) expandVector(lpt[i], pt[i]);
+      expandVector(lp, probs);
+    } else {
+      chain->computeTransients(t, nt, probs, pt, opts);
+    }
+    stopTransientReport(w, opts.multiplications);
+
+    opts.vm_result = 0;
+    deleteLumped(lp, lpt, nt);
+    return true;
+  }
+  catch (MCLib::error e) {
+    deleteLumped(lp, lpt, nt);
+    if (em->startInternal(__FILE__, __LINE__)) {
+      em->noCause();
+      em->internal() << "Unexpected error: ";
+      em->internal() << e.getString();
+      em->stopIO();
+    }
+    return false;
+  }
+}
+
 bool mclib_process::computeAccumulated(double t, const double* p0, double* n,
                                   double* aux, double* aux2) const
 {
   if (0==chain || 0==p0 || 0==n || 0==aux || 0==aux2) return false;
 
+  // Solve the lumped chain instead, if we can
+  const MCLib::Markov_chain* mc = chain;
+  double* lp0 = lumpChain() ? lumpVector(p0) : 0;
+  double* ln = 0;
+  if (lp0) {
+    mc = lumped;
+    ln = new double[lumped->getNumStates()];
+  }
+  const double* q0 = lp0 ? lp0 : p0;
+  double* q = ln ? ln : n;
+
   try {
     timer w;
     if (is_discrete) {
       MCLib::Markov_chain::DTMC_transient_options opts;
+      opts.ssprec = getSteadyPrecision();
+      opts.ss_check = getSteadyCheck();
       opts.vm_result = aux;
+      opts.num_threads = getNumThreads();
       opts.accumulator = aux2;
 
       int it = int(t);
       startAccumulatedReport(w, it);
-      chain->accumulate(it, p0, n, opts);
+      mc->accumulate(it, q0, q, opts);
       stopAccumulatedReport(w, opts.multiplications);
 
       opts.vm_result = 0;
       opts.accumulator = 0;
     } else {
       MCLib::Markov_chain::CTMC_transient_options opts;
+      opts.epsilon = getPoissonPrecision();
+      opts.ssprec = getSteadyPrecision();
+      opts.ss_check = getSteadyCheck();
       opts.vm_result = aux;
+      opts.num_threads = getNumThreads();
       opts.accumulator = aux2;
 
       startAccumulatedReport(w, t); 
-      chain->accumulate(t, p0, n, opts);
+      mc->accumulate(t, q0, q, opts);
       stopAccumulatedReport(w, opts.multiplications);
 
       opts.vm_result = 0;
       opts.accumulator = 0;
     }
+    if (ln) expandVector(ln, n);
+    delete[] lp0;
+    delete[] ln;
     return true;
   }
   catch (MCLib::error e) {
+    delete[] lp0;
+    delete[] ln;
     if (em->startInternal(__FILE__, __LINE__)) {
       em->noCause();
       em->internal() << "Unexpected error: ";
@@ -481,7 +710,39 @@ bool mclib_process::computeSteadyState(double* probs) const
     startSteadyReport(w); 
     DCASSERT(initial);
     initial->ExportTo(ls_init);
-    chain->computeInfinityDistribution(ls_init, probs, getSolverOptions(), outdata);
+    if (lumpChain()) {
+      //
+      // Lump the initial distribution, solve the lumped chain,
+      // and split the lumped probabilities evenly.
+      //
+      const long nb = lumped->getNumStates();
+      double* lp0 = new double[nb];
+      for (long b=0; b<nb; b++) lp0[b] = 0;
+      for (long i=0; i<ls_init.size; i++) {
+        long s = ls_init.index ? ls_init.index[i] : i;
+        double v = ls_init.d_value ? ls_init.d_value[i] : ls_init.f_value[i];
+        lp0[lump_map[s]] += v;
+      }
+      LS_Vector lp0vect;
+      lp0vect.size = nb;
+      lp0vect.index = 0;
+      lp0vect.d_value = lp0;
+      lp0vect.f_value = 0;
+      double* lp = new double[nb];
+      try {
+        lumped->computeInfinityDistribution(lp0vect, lp, getSolverOptions(), outdata);
+      }
+      catch (MCLib::error e) {
+        delete[] lp0;
+        delete[] lp;
+        throw e;
+      }
+      expandVector(lp, probs);
+      delete[] lp0;
+      delete[] lp;
+    } else {
+      chain->computeInfinityDistribution(ls_init, probs, getSolverOptions(), outdata);
+    }
     stopSteadyReport(w, outdata.num_iters);
     return statusOK(em, outdata, "steady-state");
   }
@@ -763,12 +1024,19 @@ bool mclib_process::reachesAcceptBy(double t, double* x) const
     timer w;
     if (is_discrete) {
       MCLib::Markov_chain::DTMC_transient_options opts;
+      opts.ssprec = getSteadyPrecision();
+      opts.ss_check = getSteadyCheck();
+      opts.num_threads = getNumThreads();
       int it = int(t);
       startRevTransReport(w, it);
       chain->reverseTransient(it, x, opts);
       stopRevTransReport(w, opts.multiplications);
     } else {
       MCLib::Markov_chain::CTMC_transient_options opts;
+      opts.epsilon = getPoissonPrecision();
+      opts.ssprec = getSteadyPrecision();
+      opts.ss_check = getSteadyCheck();
+      opts.num_threads = getNumThreads();
       startRevTransReport(w, t); 
       chain->reverseTransient(t, x, opts);
       stopRevTransReport(w, opts.multiplications);
@@ -31,6 +31,16 @@ class mclib_process : public markov_process {
     // Helper, used by attachToParent.
     GraphLib::node_renumberer* initChain(GraphLib::dynamic_graph *g);
 
+    // Helpers for lumping.
+
+    /// Build the lumped chain, if needed; returns true if we have one.
+    bool lumpChain() const;
+    /// Allocate and fill the lumped version of x, if x is uniform
+    /// over each lumped state; otherwise returns 0.
+    double* lumpVector(const double* x) const;
+    /// Expand a lumped vector into a full one.
+    void expandVector(const double* lx, double* x) const;
+
   public:
     virtual long getNumStates() const;
     virtual void getNumClasses(long &count) const;
@@ -41,6 +51,8 @@ class mclib_process : public markov_process {
     virtual long getOutgoingWeights(long from, long* to, double* w, long n) const;
     virtual bool computeTransient(double t, double* probs, 
         double* aux, double* aux2) const;
+    virtual bool computeTransients(const double* t, long nt, double* probs,
+        double** pt, double* aux, double* aux2) const;
     virtual bool computeAccumulated(double t, const double* p0, double* n,
         double* aux, double* aux2) const;
     virtual bool computeSteadyState(double* probs) const;
@@ -107,6 +119,17 @@ class mclib_process : public markov_process {
     statedist* initial;
     long trap;
     long accept;
+
+    /// Exactly lumped chain, built on first use if MCLumping is set.
+    mutable MCLib::Markov_chain* lumped;
+    /// Lumped state of each state of chain.
+    mutable long* lump_map;
+    /// Number of states in each lumped state.
+    mutable long* lump_size;
+    /// Some state in each lumped state.
+    mutable long* lump_rep;
+    /// Did we try lumping already.
+    mutable bool lump_tried;
 };
 
 
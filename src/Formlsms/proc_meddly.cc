@@ -2,21 +2,397 @@
 #include "proc_meddly.h"
 #include "rss_meddly.h"
 
+#include "../Modules/statevects.h"
+
+// External libs
+#include "../_LSLib/lslib.h"
+#include "../_Timer/timerlib.h"
+#include "../_Distros/distros.h"
+
+#include <string.h>
+#include <math.h>
+#include <map>
+#include <vector>
+#include <new>
+
+// ******************************************************************
+// *                                                                *
+// *                    meddly_descriptor  class                    *
+// *                                                                *
+// ******************************************************************
+
+/**
+    Kronecker descriptor for the rate matrix, as a sum of terms.
+    Each term is one event's rate matrix, which is usually the
+    Kronecker product of small local matrices, one per level
+    (identity at levels the event does not touch), times a constant.
+    We recover the local matrices from the event's MXD, and multiply
+    vectors against the product one level at a time, visiting only
+    the reachable states through the index set; identity levels
+    below a term are a contiguous block of the vectors.
+    Terms that are not product form (e.g., rates depending on
+    several levels) are summed into one MXD, and multiplied as usual.
+*/
+class meddly_descriptor {
+  public:
+    meddly_descriptor();
+    ~meddly_descriptor();
+
+    /** Add an event's rate matrix.
+          @return true, if it was stored in product form.
+    */
+    bool addTerm(const MEDDLY::dd_edge &R_e);
+
+    /// Index set of reachable states; call before any multiply.
+    void setIndexSet(const MEDDLY::dd_edge &indexes);
+
+    /// Computes y += x * R.
+    void vectorMatrix(double* y, const double* x) const;
+
+    /// Computes y += R * x.
+    void matrixVector(double* y, const double* x) const;
+
+  private:
+    struct local_entry {
+      int from;
+      int to;
+      double value;
+    };
+    struct term {
+      /// local[k]: matrix for level k; empty for the identity.
+      std::vector < std::vector <local_entry> > local;
+      /// Lowest level with a local matrix that is not the identity.
+      int bottom;
+      double scale;
+    };
+    /// Index set node, flattened.
+    struct index_node {
+      long card;
+      /// Position of each child in the index_node array, or -1.
+      std::vector <int> down;
+      std::vector <long> offset;
+    };
+
+    bool isMultiple(MEDDLY::node_handle a, MEDDLY::node_handle b, double &r);
+    void expand(MEDDLY::unpacked_node* U, int k, int in, 
+        MEDDLY::node_handle a) const;
+    int flatten(MEDDLY::node_handle p, std::map <MEDDLY::node_handle, int> &ids);
+
+    void multiply(const term &t, bool trans, int k, int xn, long xo, 
+        int yn, long yo, double s, double* y, const double* x) const;
+
+  private:
+    MEDDLY::expert_forest* fA;
+    MEDDLY::expert_forest* fI;
+    int num_levels;
+
+    std::vector <term> terms;
+
+    /// Sum of the terms not in product form.
+    MEDDLY::dd_edge* rest;
+    MEDDLY::specialized_operation* restVM;
+    MEDDLY::specialized_operation* restMV;
+
+    std::vector <index_node> inodes;
+    int root;
+
+    /// Ratio a/b, or 0 if a is not a multiple of b; for addTerm.
+    std::map < std::pair <MEDDLY::node_handle, MEDDLY::node_handle>, double > ratios;
+};
+
+meddly_descriptor::meddly_descriptor()
+{
+  fA = 0;
+  fI = 0;
+  num_levels = 0;
+  rest = 0;
+  restVM = 0;
+  restMV = 0;
+  root = -1;
+}
+
+meddly_descriptor::~meddly_descriptor()
+{
+  if (restVM) MEDDLY::destroyOperation(restVM);
+  if (restMV) MEDDLY::destroyOperation(restMV);
+  delete rest;
+}
+
+bool meddly_descriptor::addTerm(const MEDDLY::dd_edge &R_e)
+{
+  using namespace MEDDLY;
+  if (0==fA) {
+    fA = smart_cast <expert_forest*> (R_e.getForest());
+    DCASSERT(fA);
+    num_levels = fA->getNumVariables();
+  }
+  DCASSERT(R_e.getForest() == fA);
+  node_handle p = R_e.getNode();
+  if (0==p) return true;    // event never fires
+
+  term t;
+  t.local.resize(num_levels+1);
+  t.bottom = num_levels+1;
+  t.scale = 1;
+  ratios.clear();
+
+  unpacked_node* P = unpacked_node::useUnpackedNode();
+  unpacked_node* Q = unpacked_node::useUnpackedNode();
+  bool product_form = true;
+  for (int k=num_levels; k && product_form; k--) {
+    //
+    // Collect the non-zero entries at this level, with their submatrices;
+    // all submatrices must be multiples of the first one.
+    //
+    std::vector <local_entry> &W = t.local[k];
+    node_handle N = 0;
+    expand(P, k, 0, p);
+    for (int zi=0; zi<P->getNNZs() && product_form; zi++) {
+      if (0==P->d(zi)) continue;
+      expand(Q, -k, P->i(zi), P->d(zi));
+      for (int zj=0; zj<Q->getNNZs(); zj++) {
+        if (0==Q->d(zj)) continue;
+        local_entry e;
+        e.from = P->i(zi);
+        e.to = Q->i(zj);
+        if (0==N) N = Q->d(zj);
+        if (!isMultiple(Q->d(zj), N, e.value)) {
+          product_form = false;
+          break;
+        }
+        W.push_back(e);
+      } // for zj
+    } // for zi
+    if (!product_form) break;
+    DCASSERT(N);
+
+    //
+    // Identity?
+    //
+    bool identity = (W.size() == unsigned(fA->getLevelSize(k)));
+    for (unsigned z=0; identity && z<W.size(); z++) {
+      identity = (W[z].from == W[z].to) && (1.0 == W[z].value);
+    }
+    if (identity) {
+      W.clear();
+    } else {
+      t.bottom = k;
+    }
+    p = N;
+  } // for k
+  unpacked_node::recycle(Q);
+  unpacked_node::recycle(P);
+
+  if (product_form) {
+    DCASSERT(expert_forest::isTerminalNode(p));
+    t.scale = expert_forest::float_Tencoder::handle2value(p);
+    terms.push_back(t);
+    return true;
+  }
+
+  if (0==rest) {
+    rest = new dd_edge(fA);
+  }
+  (*rest) += R_e;
+  return false;
+}
+
+void meddly_descriptor::setIndexSet(const MEDDLY::dd_edge &indexes)
+{
+  using namespace MEDDLY;
+  DCASSERT(0==restVM);
+  DCASSERT(0==restMV);
+  fI = smart_cast <expert_forest*> (indexes.getForest());
+  DCASSERT(fI);
+  inodes.clear();
+  std::map <node_handle, int> ids;
+  // Position 0 is the terminal node
+  index_node T;
+  T.card = 1;
+  inodes.push_back(T);
+  root = flatten(indexes.getNode(), ids);
+
+  if (rest) {
+    restVM = EXPLVECT_MATR_MULT->buildOperation(indexes, *rest, indexes);
+    restMV = MATR_EXPLVECT_MULT->buildOperation(indexes, *rest, indexes);
+  }
+}
+
+void meddly_descriptor::vectorMatrix(double* y, const double* x) const
+{
+  DCASSERT(root >= 0);
+  for (unsigned i=0; i<terms.size(); i++) {
+    multiply(terms[i], false, num_levels, root, 0, root, 0, terms[i].scale, y, x);
+  }
+  if (restVM) restVM->compute(y, x);
+}
+
+void meddly_descriptor::matrixVector(double* y, const double* x) const
+{
+  DCASSERT(root >= 0);
+  for (unsigned i=0; i<terms.size(); i++) {
+    multiply(terms[i], true, num_levels, root, 0, root, 0, terms[i].scale, y, x);
+  }
+  if (restMV) restMV->compute(y, x);
+}
+
+bool meddly_descriptor::isMultiple(MEDDLY::node_handle a, 
+  MEDDLY::node_handle b, double &r)
+{
+  using namespace MEDDLY;
+  if (a == b) {
+    r = 1;
+    return true;
+  }
+  if (expert_forest::isTerminalNode(a) || expert_forest::isTerminalNode(b)) {
+    if (!expert_forest::isTerminalNode(a)) return false;
+    if (!expert_forest::isTerminalNode(b)) return false;
+    double bv = expert_forest::float_Tencoder::handle2value(b);
+    if (0==bv) return false;
+    r = expert_forest::float_Tencoder::handle2value(a) / bv;
+    return true;
+  }
+  if (fA->getNodeLevel(a) != fA->getNodeLevel(b)) return false;
+
+  std::pair <node_handle, node_handle> key(a, b);
+  std::map < std::pair <node_handle, node_handle>, double >::iterator 
+    f = ratios.find(key);
+  if (f != ratios.end()) {
+    r = f->second;
+    return r != 0;
+  }
+
+  unpacked_node* A = unpacked_node::newFromNode(fA, a, false);
+  unpacked_node* B = unpacked_node::newFromNode(fA, b, false);
+  bool ok = (A->getNNZs() == B->getNNZs());
+  r = 0;
+  for (int z=0; ok && z<A->getNNZs(); z++) {
+    double rz;
+    ok = (A->i(z) == B->i(z)) && isMultiple(A->d(z), B->d(z), rz);
+    if (!ok) break;
+    if (0==z) {
+      r = rz;
+      continue;
+    }
+    // Edges hold floats, so allow for rounding
+    ok = fabs(rz - r) <= 1e-6 * fabs(r);
+  }
+  unpacked_node::recycle(B);
+  unpacked_node::recycle(A);
+  if (!ok) r = 0;
+  ratios[key] = r;
+  return ok;
+}
+
+void meddly_descriptor::expand(MEDDLY::unpacked_node* U, int k, int in, 
+  MEDDLY::node_handle a) const
+{
+  if (fA->getNodeLevel(a) == k) {
+    U->initFromNode(fA, a, false);
+    return;
+  }
+  if (k<0 && fA->isIdentityReduced()) {
+    U->initIdentity(fA, k, in, a, false);
+  } else {
+    U->initRedundant(fA, k, a, false);
+  }
+}
+
+int meddly_descriptor::flatten(MEDDLY::node_handle p, 
+  std::map <MEDDLY::node_handle, int> &ids)
+{
+  using namespace MEDDLY;
+  if (expert_forest::isTerminalNode(p)) return p ? 0 : -1;
+  std::map <node_handle, int>::iterator f = ids.find(p);
+  if (f != ids.end()) return f->second;
+
+  // Index sets are quasi-reduced, so no levels are skipped
+  index_node I;
+  const int k = fI->getNodeLevel(p);
+  I.card = fI->getIndexSetCardinality(p);
+  I.down.resize(fI->getLevelSize(k), -1);
+  I.offset.resize(fI->getLevelSize(k), 0);
+  unpacked_node* U = unpacked_node::newFromNode(fI, p, false);
+  for (int z=0; z<U->getNNZs(); z++) {
+    DCASSERT(expert_forest::isTerminalNode(U->d(z)) 
+      || fI->getNodeLevel(U->d(z)) == k-1);
+    I.down[U->i(z)] = flatten(U->d(z), ids);
+    I.offset[U->i(z)] = U->ei(z);
+  }
+  unpacked_node::recycle(U);
+
+  const int id = inodes.size();
+  inodes.push_back(I);
+  ids[p] = id;
+  return id;
+}
+
+void meddly_descriptor::multiply(const term &t, bool trans, int k, 
+  int xn, long xo, int yn, long yo, double s, double* y, const double* x) const
+{
+  //
+  // Identity from here down: the same index set node
+  // on both sides gives a contiguous block.
+  //
+  if (k < t.bottom && xn == yn) {
+    const long card = inodes[xn].card;
+    for (long i=0; i<card; i++) {
+      y[yo+i] += s * x[xo+i];
+    }
+    return;
+  }
+  DCASSERT(k>0);
+
+  const index_node &X = inodes[xn];
+  const index_node &Y = inodes[yn];
+  const std::vector <local_entry> &W = t.local[k];
+
+  if (W.empty()) {
+    for (unsigned i=0; i<X.down.size(); i++) {
+      if (X.down[i] < 0 || Y.down[i] < 0) continue;
+      multiply(t, trans, k-1, X.down[i], xo + X.offset[i], 
+        Y.down[i], yo + Y.offset[i], s, y, x);
+    }
+    return;
+  }
+
+  for (unsigned z=0; z<W.size(); z++) {
+    const int xi = trans ? W[z].to : W[z].from;
+    const int yi = trans ? W[z].from : W[z].to;
+    if (X.down[xi] < 0 || Y.down[yi] < 0) continue;
+    multiply(t, trans, k-1, X.down[xi], xo + X.offset[xi],
+      Y.down[yi], yo + Y.offset[yi], s * W[z].value, y, x);
+  }
+}
+
 // ******************************************************************
 // *                                                                *
 // *                     mclib_process  methods                     *
 // *                                                                *
 // ******************************************************************
 
+long meddly_process::hybrid_level;
+bool meddly_process::use_descriptor;
+
 meddly_process::meddly_process(meddly_encoder* wrap)
 {
   mxd_wrap = wrap;
   proc = 0;
+  mrss = 0;
   num_states = 0;
+  is_discrete = false;
+  numerical_tried = false;
+  VM = 0;
+  descriptor = 0;
+  rowsums = 0;
+  max_rowsum = 0;
+  scaled = 0;
+  initial = 0;
 }
 
 meddly_process::~meddly_process()
 {
+  clearNumerical();
   Delete(mxd_wrap);
   Delete(proc);
 }
@@ -28,7 +404,141 @@ void meddly_process::attachToParent(stochastic_lldsm* p, LS_Vector &init, state_
   process::attachToParent(p, init, rss);
 
   rss->getNumStates(num_states); 
-  // TBD
+  is_discrete = (lldsm::DTMC == p->Type());
+
+  //
+  // The generation engines do not (yet) give us an initial vector;
+  // we build one from the initial states of the reachset,
+  // along with everything else the solvers need, on the first solve.
+  //
+  mrss = smart_cast <meddly_reachset*> (rss);
+  DCASSERT(mrss);
+}
+
+bool meddly_process::addDescriptorTerm(const MEDDLY::dd_edge &R_e)
+{
+  if (0==descriptor) descriptor = new meddly_descriptor;
+  return descriptor->addTerm(R_e);
+}
+
+bool meddly_process::prepareNumerical() const
+{
+  if (numerical_tried) return (VM || descriptor);
+  numerical_tried = true;
+  if (0==proc || 0==mrss || num_states <= 0) {
+    delete descriptor;
+    descriptor = 0;
+    return false;
+  }
+
+  double* ones = 0;
+  try {
+    mrss->buildIndexSet();
+    const MEDDLY::dd_edge &indexes = mrss->getIndexSet();
+
+    //
+    // Initial distribution: uniform over the initial states
+    //
+    double* p0 = new double[num_states];
+    for (long i=0; i<num_states; i++) p0[i] = 0;
+    long ninit = 0;
+    for (MEDDLY::enumerator I(mrss->getInitial()); I; ++I) {
+      long i = mrss->getMintermIndex(I.getAssignments());
+      if (i<0) continue;
+      CHECK_RANGE(0, i, num_states);
+      p0[i] = 1;
+      ninit++;
+    }
+    if (ninit > 1) {
+      for (long i=0; i<num_states; i++) p0[i] /= ninit;
+    }
+    const stochastic_lldsm* p 
+    = smart_cast <const stochastic_lldsm*> (getParent());
+    DCASSERT(p);
+    initial = new statedist(p, p0, num_states);
+    delete[] p0;
+
+    //
+    // Row sums, by multiplying the matrix by a vector of ones
+    //
+    ones = new double[num_states];
+    rowsums = new double[num_states];
+    for (long i=0; i<num_states; i++) {
+      ones[i] = 1;
+      rowsums[i] = 0;
+    }
+    if (descriptor) {
+      descriptor->setIndexSet(indexes);
+      descriptor->matrixVector(rowsums, ones);
+    } else {
+      MEDDLY::specialized_operation* MV = 
+        MEDDLY::MATR_EXPLVECT_MULT->buildOperation(indexes, proc->E, indexes);
+      MV->compute(rowsums, ones);
+      MEDDLY::destroyOperation(MV);
+    }
+    delete[] ones;
+    ones = 0;
+
+    max_rowsum = 0;
+    for (long i=0; i<num_states; i++) {
+      if (rowsums[i] > max_rowsum) max_rowsum = rowsums[i];
+    }
+
+    if (is_discrete) {
+      scaled = new double[num_states];
+    }
+
+    //
+    // Vector-matrix multiply, used by all the solvers
+    //
+    if (descriptor) {
+      // Already set up
+    } else if (hybrid_level > 0) {
+      VM = MEDDLY::HYBRID_EXPLVECT_MATR_MULT->buildOperation(
+        indexes, proc->E, indexes, int(hybrid_level)
+      );
+    } else {
+      VM = MEDDLY::EXPLVECT_MATR_MULT->buildOperation(indexes, proc->E, indexes);
+    }
+    return true;
+  }
+  catch (MEDDLY::error e) {
+    delete[] ones;
+    clearNumerical();
+    if (em->startWarning()) {
+      em->noCause();
+      em->warn() << "Couldn't set up numerical solution for Markov chain ";
+      em->warn() << "using MEDDLY: " << e.getName();
+      em->stopIO();
+    }
+    return false;
+  }
+  catch (std::bad_alloc &) {
+    delete[] ones;
+    clearNumerical();
+    if (em->startWarning()) {
+      em->noCause();
+      em->warn() << "Couldn't set up numerical solution for Markov chain ";
+      em->warn() << "using MEDDLY: insufficient memory";
+      em->stopIO();
+    }
+    return false;
+  }
+}
+
+void meddly_process::clearNumerical() const
+{
+  if (VM) MEDDLY::destroyOperation(VM);
+  VM = 0;
+  delete descriptor;
+  descriptor = 0;
+  delete[] rowsums;
+  rowsums = 0;
+  max_rowsum = 0;
+  delete[] scaled;
+  scaled = 0;
+  Delete(initial);
+  initial = 0;
 }
 
 long meddly_process::getNumStates() const
@@ -202,7 +712,307 @@ bool meddly_process::isTransient(long st) const
 
 statedist* meddly_process::getInitialDistribution() const
 {
-  DCASSERT(0);
-  return 0;
+  if (!prepareNumerical()) return 0;
+  return Share(initial);
+}
+
+bool meddly_process
+::computeTransient(double t, double* probs, double* aux1, double* aux2) const
+{
+  if (!prepareNumerical()) return numericalError("transient");
+  if (0==probs || 0==aux1)  return false;
+
+  try {
+    timer w;
+    long mults;
+    if (is_discrete) {
+      int it = int(t);
+      startTransientReport(w, it);
+      for (mults=0; mults<it; mults++) {
+        uniformStep(aux1, probs, 1.0);
+        memcpy(probs, aux1, num_states * sizeof(double));
+      }
+    } else {
+      if (0==aux2) return false;
+      startTransientReport(w, t);
+      if (0==max_rowsum) {
+        // No transitions; nothing changes
+        stopTransientReport(w, 0);
+        return true;
+      }
+      discrete_pdf poisson_pdf;
+      computePoissonPDF(max_rowsum * t, getPoissonPrecision(), poisson_pdf);
+      mults = uniformize(poisson_pdf, 1, max_rowsum, probs, aux1, aux2);
+      memcpy(probs, aux2, num_states * sizeof(double));
+    }
+    stopTransientReport(w, mults);
+    return true;
+  }
+  catch (MEDDLY::error e) {
+    if (em->startError()) {
+      em->noCause();
+      em->cerr() << "Transient solver failed: " << e.getName();
+      em->stopIO();
+    }
+    return false;
+  }
+}
+
+bool meddly_process::computeAccumulated(double t, const double* p0, double* n,
+      double* aux, double* aux2) const
+{
+  if (!prepareNumerical()) return numericalError("accumulated");
+  if (0==p0 || 0==n || 0==aux || 0==aux2) return false;
+
+  try {
+    timer w;
+    long mults;
+    memcpy(n, p0, num_states * sizeof(double));
+    if (is_discrete) {
+      int it = int(t);
+      startAccumulatedReport(w, it);
+      memcpy(aux2, n, num_states * sizeof(double));
+      for (mults=0; mults<it; mults++) {
+        uniformStep(aux, aux2, 1.0);
+        memcpy(aux2, aux, num_states * sizeof(double));
+        for (long i=0; i<num_states; i++) n[i] += aux2[i];
+      }
+    } else {
+      startAccumulatedReport(w, t);
+      if (0==max_rowsum) {
+        // No transitions; we sit in the initial states
+        for (long i=0; i<num_states; i++) n[i] *= t;
+        stopAccumulatedReport(w, 0);
+        return true;
+      }
+      discrete_pdf poisson_pdf;
+      computePoissonPDF(max_rowsum * t, getPoissonPrecision(), poisson_pdf);
+      discrete_1mcdf poisson_1mcdf;
+      poisson_1mcdf.setFromPDF(poisson_pdf);
+      mults = uniformize(poisson_1mcdf, max_rowsum, max_rowsum, n, aux, aux2);
+      memcpy(n, aux2, num_states * sizeof(double));
+    }
+    stopAccumulatedReport(w, mults);
+    return true;
+  }
+  catch (MEDDLY::error e) {
+    if (em->startError()) {
+      em->noCause();
+      em->cerr() << "Accumulated solver failed: " << e.getName();
+      em->stopIO();
+    }
+    return false;
+  }
+}
+
+bool meddly_process::computeSteadyState(double* probs) const
+{
+  if (!prepareNumerical()) return numericalError("steady-state");
+  if (0==probs) return false;
+
+  //
+  // Power method on the uniformized chain, starting from the
+  // initial distribution.  Slower than Gauss-Seidel, but it does not
+  // need the recurrent classes, and only needs vector-matrix products.
+  //
+  const LS_Options &opts = getSolverOptions();
+  double* aux = (double*) malloc(num_states * sizeof(double));
+  if (0==aux) {
+    if (em->startError()) {
+      em->noCause();
+      em->cerr() << "Insufficient memory for Markov chain steady-state solver";
+      em->stopIO();
+    }
+    return false;
+  }
+
+  try {
+    timer w;
+    startSteadyReport(w);
+    DCASSERT(initial);
+    initial->ExportTo(probs);
+
+    // Strictly larger than the max rowsum, for aperiodicity
+    const double q = 1.02 * (is_discrete ? 1.0 : max_rowsum);
+    double* curr = probs;
+    double* next = aux;
+    long iters;
+    double maxerror = 0;
+    bool converged = (0==q);
+    for (iters=1; !converged && iters<=opts.max_iters; iters++) {
+      uniformStep(next, curr, q);
+
+      double total = 0;
+      for (long i=0; i<num_states; i++) total += next[i];
+      if (total) {
+        for (long i=0; i<num_states; i++) next[i] /= total;
+      }
+
+      if (iters >= opts.min_iters) {
+        maxerror = 0;
+        for (long i=0; i<num_states; i++) {
+          double delta = next[i] - curr[i];
+          if (opts.use_relative) if (next[i]) delta /= next[i];
+          if (delta < 0) delta = -delta;
+          if (delta > maxerror) maxerror = delta;
+        }
+        converged = (maxerror < opts.precision);
+      }
+      SWAP(curr, next);
+    }
+    if (curr != probs) {
+      memcpy(probs, curr, num_states * sizeof(double));
+    }
+    free(aux);
+    stopSteadyReport(w, iters-1);
+
+    if (!converged && em->startWarning()) {
+      em->noCause();
+      em->warn() << "Markov chain power method (for steady-state) ";
+      em->warn() << "did not converge";
+      em->stopIO();
+    }
+    return true;
+  }
+  catch (MEDDLY::error e) {
+    free(aux);
+    if (em->startError()) {
+      em->noCause();
+      em->cerr() << "Steady-state solver failed: " << e.getName();
+      em->stopIO();
+    }
+    return false;
+  }
+}
+
+void meddly_process::vectorMatrix(double* y, const double* x) const
+{
+  if (descriptor) {
+    descriptor->vectorMatrix(y, x);
+  } else {
+    DCASSERT(VM);
+    VM->compute(y, x);
+  }
+}
+
+void meddly_process::uniformStep(double* y, const double* x, double q) const
+{
+  DCASSERT(rowsums);
+  for (long i=0; i<num_states; i++) y[i] = 0;
+
+  if (is_discrete) {
+    //
+    // Rows are weights; scale so they become probabilities.
+    // States without outgoing edges get a self loop.
+    //
+    DCASSERT(scaled);
+    for (long i=0; i<num_states; i++) {
+      scaled[i] = rowsums[i] ? x[i] / rowsums[i] : 0;
+    }
+    vectorMatrix(y, scaled);
+    for (long i=0; i<num_states; i++) {
+      double out = rowsums[i] ? x[i] : 0;
+      y[i] = x[i] + (y[i] - out) / q;
+    }
+  } else {
+    vectorMatrix(y, x);
+    for (long i=0; i<num_states; i++) {
+      y[i] = x[i] + (y[i] - x[i] * rowsums[i]) / q;
+    }
+  }
+}
+
+template <class DISTRO>
+long meddly_process::uniformize(const DISTRO &dist, double dadj, double q,
+  double* p, double* aux, double* acc) const
+{
+  // 
+  // Add initial distribution
+  //
+  for (long i=0; i<num_states; i++) {
+    acc[i] = p[i] * dist.f(0) / dadj;
+  }
+
+  //
+  // Loop and add distribution at time n.
+  // Vector p is trashed, it's used as the "current" vector.
+  //
+  double* myp = p;
+  long mults = 0;
+  long n;
+
+  //
+  // Steady-state detection, as for the explicit solvers:
+  // with a check gap larger than one, we also compare against
+  // the vector from the previous check.
+  //
+  double* saved = 0;
+  long count = 0;
+  if (getSteadyPrecision() && getSteadyCheck() > 1) {
+    saved = new double[num_states];
+    memcpy(saved, p, num_states * sizeof(double));
+  }
+  for (n=0; n<dist.right_trunc(); n++) {
+    uniformStep(aux, myp, q);
+    mults++;
+
+    // Check if we've hit steady state
+    if (steadyReached(myp, aux, saved, count)) break;
+
+    for (long i=0; i<num_states; i++) {
+      acc[i] += aux[i] * dist.f(n+1) / dadj;
+    }
+    SWAP(aux, myp);
+  }
+  delete[] saved;
+
+  // If we detected steady state, then finish the computation
+  // assuming aux vector does not change.
+  double remaining = 0;
+  for (; n<dist.right_trunc(); n++) {
+    remaining += dist.f(n+1);
+  }
+  if (remaining) {
+    for (long i=0; i<num_states; i++) {
+      acc[i] += aux[i] * remaining / dadj;
+    }
+  }
+  return mults;
+}
+
+bool meddly_process::steadyReached(const double* old, const double* x,
+  double* saved, long &count) const
+{
+  const double prec = getSteadyPrecision();
+  if (0==prec) return false;
+  if (0==saved) return withinPrecision(old, x, prec);
+  if (++count < getSteadyCheck()) return false;
+  count = 0;
+  bool ans = withinPrecision(old, x, prec) && withinPrecision(saved, x, prec);
+  memcpy(saved, x, num_states * sizeof(double));
+  return ans;
+}
+
+bool meddly_process::withinPrecision(const double* a, const double* b,
+  double prec) const
+{
+  for (long i=0; i<num_states; i++) {
+    double d = a[i] - b[i];
+    if (d < 0) d = -d;
+    if (a[i]) d /= a[i];
+    if (d > prec) return false;
+  }
+  return true;
+}
+
+bool meddly_process::numericalError(const char* who) const
+{
+  if (em->startError()) {
+    em->noCause();
+    em->cerr() << "Numerical " << who << " solution is not available ";
+    em->cerr() << "for this Markov chain representation using MEDDLY";
+    em->stopIO();
+  }
+  return false;
 }
 
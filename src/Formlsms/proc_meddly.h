@@ -5,6 +5,13 @@
 #include "proc_markov.h"
 #include "../Modules/glue_meddly.h"
 
+class meddly_reachset;
+class meddly_descriptor;
+
+namespace MEDDLY {
+  class specialized_operation;
+};
+
 // ******************************************************************
 // *                                                                *
 // *                      meddly_process class                      *
@@ -28,6 +35,12 @@ class meddly_process : public markov_process {
       proc = p;
     }
 
+    /** Add one event's rate matrix as a term of a Kronecker descriptor,
+        used by the numerical solvers instead of the actual matrix.
+          @return true, if the term is in product form.
+    */
+    bool addDescriptorTerm(const MEDDLY::dd_edge &R_e);
+
     inline meddly_encoder& useMxdWrapper() {
       DCASSERT(mxd_wrap);
       return *mxd_wrap;
@@ -48,11 +61,100 @@ class meddly_process : public markov_process {
     virtual bool isTransient(long st) const;
     virtual statedist* getInitialDistribution() const;
 
+  //
+  // Numerical solution.
+  // The matrix stays in the MXD forest; only the vectors are explicit,
+  // indexed in lexical order by the reachable state index set.
+  //
+  public:
+    virtual bool computeTransient(double t, double* probs, 
+        double* aux, double* aux2) const;
+    virtual bool computeAccumulated(double t, const double* p0, double* n,
+        double* aux, double* aux2) const;
+    virtual bool computeSteadyState(double* probs) const;
+
+    /** If positive, the solvers use a "hybrid" vector-matrix multiply:
+        submatrices for this level and below are flattened into
+        sparse blocks, once, and each product runs over the blocks.
+        If 0, each product traverses the matrix diagram.
+    */
+    static long hybrid_level;
+
+    /** If true, generation engines should give us the rate matrix
+        of each event, with addDescriptorTerm(), and the solvers
+        multiply by the descriptor (the sum of the event matrices).
+    */
+    static bool use_descriptor;
+
+  private:
+    /** Build the vector-matrix multiply operation, rowsums, initial vector,
+        and scratch vector, the first time a solver needs them.
+          @return true, if everything was built.
+    */
+    bool prepareNumerical() const;
+
+    /// Discard whatever prepareNumerical() managed to build.
+    void clearNumerical() const;
+
+    /// Compute y += x * proc, with the descriptor if we have one.
+    void vectorMatrix(double* y, const double* x) const;
+
+    /// Compute y = x * (I + Q/q), where Q is the generator (or P-I).
+    void uniformStep(double* y, const double* x, double q) const;
+
+    /** Run uniformization, weighting the vector after n steps by
+        dist.f(n) / dadj, and adding it to acc.
+          @return Number of vector-matrix multiplications required.
+    */
+    template <class DISTRO>
+    long uniformize(const DISTRO &dist, double dadj, double q, 
+        double* p, double* aux, double* acc) const;
+
+    /** Steady-state test for uniformization, after one step from
+        \a old to \a x; follows UniformizationSteadyPrecision and
+        UniformizationSteadyCheck.  If the check gap is larger than one,
+        \a saved holds the vector from the previous check, and
+        \a count the steps since then; otherwise \a saved is null.
+    */
+    bool steadyReached(const double* old, const double* x,
+        double* saved, long &count) const;
+
+    /// Are all elements of \a b within relative precision of \a a.
+    bool withinPrecision(const double* a, const double* b, double prec) const;
+
+    /// Report a numerical solution error, for method \a who.
+    bool numericalError(const char* who) const;
+
   private:
     meddly_encoder* mxd_wrap;
     shared_ddedge* proc;
 
+    /// Reachable states, for the index set and the initial states.
+    meddly_reachset* mrss;
+
     long num_states;
+
+    bool is_discrete;
+
+    /// Has prepareNumerical() been called?
+    mutable bool numerical_tried;
+
+    /// Computes y += x * proc; 0 if we could not build it.
+    mutable MEDDLY::specialized_operation* VM;
+
+    /// Event matrices, if we are using a descriptor; otherwise 0.
+    mutable meddly_descriptor* descriptor;
+
+    /// Sum of outgoing rates (or weights, for DTMCs) for each state.
+    mutable double* rowsums;
+
+    /// Largest element of rowsums.
+    mutable double max_rowsum;
+
+    /// Scratch vector for DTMC steps; 0 for CTMCs.
+    mutable double* scaled;
+
+    mutable statedist* initial;
 };
 
 
@@ -2,11 +2,50 @@
 #include "rss_meddly.h"
 
 #include "../ExprLib/mod_vars.h"
+#include "../ExprLib/measures.h"
 #include "../Modules/meddly_ssets.h"
 #include "../Modules/biginttype.h"
 
 // #define DEBUG_INDEXSET
 
+// ******************************************************************
+// *                                                                *
+// *                meddly_reachset::range_sums  class              *
+// *                                                                *
+// ******************************************************************
+
+/**
+    Sums of a vector over ranges of indexes.
+    Stored as a tree of partial sums, so a range is a sum of
+    O(log n) partial sums, and there is no cancellation
+    (as there would be with differences of prefix sums).
+*/
+class meddly_reachset::range_sums {
+    long n;
+    double* tree;
+  public:
+    range_sums(const double* p, long _n) {
+      n = _n;
+      tree = new double[2*n];
+      for (long i=0; i<n; i++) tree[n+i] = p[i];
+      for (long i=n-1; i>0; i--) tree[i] = tree[2*i] + tree[2*i+1];
+    }
+    ~range_sums() {
+      delete[] tree;
+    }
+    /// Sum of p[lo], ..., p[hi-1].
+    double sum(long lo, long hi) const {
+      CHECK_RANGE(0, lo, n+1);
+      CHECK_RANGE(0, hi, n+1);
+      double s = 0;
+      for (lo += n, hi += n; lo < hi; lo /= 2, hi /= 2) {
+        if (lo & 1) s += tree[lo++];
+        if (hi & 1) s += tree[--hi];
+      }
+      return s;
+    }
+};
+
 // ******************************************************************
 // *                                                                *
 // *                    meddly_reachset  methods                    *
@@ -30,7 +69,6 @@ meddly_reachset::meddly_reachset()
 meddly_reachset::~meddly_reachset()
 {
   delete natorder;
-  Delete(vars);
   Delete(initial);
   Delete(states);
   Delete(state_indexes);
@@ -39,6 +77,8 @@ meddly_reachset::~meddly_reachset()
   Delete(index_wrap);
   Delete(mxd_wrap);
   Delete(evmdd_wrap);
+  // Last: destroying the domain destroys its forests
+  Delete(vars);
 }
 
 bool meddly_reachset::createVars(MEDDLY::variable** v, int nv)
@@ -318,6 +358,107 @@ stateset* meddly_reachset::getPotential(expr* p) const
   return new meddly_stateset(getParent(), Share(vars), Share(mdd_wrap), ans);
 }
 
+long meddly_reachset::sumMeasures(const double* p, 
+  const std::vector <measure*> &msrs, std::vector <result> &ans,
+  std::vector <bool> &done)
+{
+  using namespace MEDDLY;
+  if (0==p || 0==states || 0==mtmdd_wrap) return 0;
+  long ns;
+  getNumStates(ns);
+  if (ns<1) return 0;
+  buildIndexSet();
+  DCASSERT(state_indexes);
+
+  const expert_forest* fI 
+    = smart_cast <const expert_forest*> (state_indexes->E.getForest());
+  const expert_forest* fR 
+    = smart_cast <const expert_forest*> (mtmdd_wrap->getForest());
+  DCASSERT(fI);
+  DCASSERT(fR);
+
+  range_sums* P = 0;
+  long count = 0;
+  for (unsigned m=0; m<msrs.size(); m++) {
+    DCASSERT(msrs[m]);
+    const type* mt = msrs[m]->RHSType();
+    if (mt) mt = mt->getBaseType();
+    const bool is_bool = (em->BOOL == mt);
+    if (!is_bool && em->REAL != mt) continue;
+
+    //
+    // Build RHS as (integer) MTMDD.
+    // This fails for real constants and division;
+    // then the caller visits the states instead.
+    //
+    traverse_data x(traverse_data::BuildDD);
+    result f;
+    x.answer = &f;
+    x.ddlib = mtmdd_wrap;
+    x.quiet = true;
+    msrs[m]->TraverseRHS(x);
+    if (!f.isNormal()) continue;
+    shared_ddedge* fdd = smart_cast <shared_ddedge*> (f.getPtr());
+    DCASSERT(fdd);
+
+    //
+    // Dot product with p
+    //
+    if (0==P) P = new range_sums(p, ns);
+    ans[m].setReal(
+      dotProduct(fR, fdd->E.getNode(), fI, state_indexes->E.getNode(), 
+        0, is_bool, *P)
+    );
+    done[m] = true;
+    count++;
+  }
+  delete P;
+  return count;
+}
+
+double meddly_reachset::dotProduct(const MEDDLY::expert_forest* fR, 
+  MEDDLY::node_handle r, const MEDDLY::expert_forest* fI, 
+  MEDDLY::node_handle i, long offset, bool is_bool, const range_sums &P) const
+{
+  using namespace MEDDLY;
+  if (0==i) return 0;
+
+  //
+  // Constant from here down: one contiguous range of indexes
+  //
+  if (expert_forest::isTerminalNode(r)) {
+    const int v = expert_forest::int_Tencoder::handle2value(r);
+    if (0==v) return 0;
+    long card = 1;
+    if (!expert_forest::isTerminalNode(i)) {
+      card = fI->getIndexSetCardinality(i);
+    }
+    const double s = P.sum(offset, offset+card);
+    return is_bool ? s : v * s;
+  }
+
+  //
+  // Index sets are quasi-reduced, so the index set node
+  // is at the level we are expanding.
+  //
+  DCASSERT(!expert_forest::isTerminalNode(i));
+  const int k = fI->getNodeLevel(i);
+  DCASSERT(fR->getNodeLevel(r) <= k);
+  unpacked_node* U = unpacked_node::newFromNode(fI, i, false);
+  unpacked_node* R = 0;
+  if (fR->getNodeLevel(r) == k) {
+    R = unpacked_node::newFromNode(fR, r, true);
+  }
+  double sum = 0;
+  for (int z=0; z<U->getNNZs(); z++) {
+    const node_handle rd = R ? R->d(U->i(z)) : r;
+    sum += dotProduct(fR, rd, fI, U->d(z), offset + U->ei(z), is_bool, P);
+  }
+  unpacked_node::recycle(R);
+  unpacked_node::recycle(U);
+  return sum;
+}
+
 void meddly_reachset::buildIndexSet()
 {
   if (state_indexes)  return;
@@ -176,6 +176,17 @@ class meddly_reachset : public state_lldsm::reachset {
     virtual stateset* getInitialStates() const;
     virtual stateset* getPotential(expr* p) const;
 
+    /**
+        Builds each measure's RHS as an integer MTMDD, and takes its
+        dot product with p over the index set.  Constant sub-diagrams
+        cover contiguous ranges of state indexes, which are summed
+        without visiting the states.  Measures whose RHS cannot be
+        built exactly (real constants, division) are not computed.
+    */
+    virtual long sumMeasures(const double* p, 
+      const std::vector <measure*> &msrs, std::vector <result> &ans,
+      std::vector <bool> &done);
+
 
   // 
   // Bonus features
@@ -197,6 +208,14 @@ class meddly_reachset : public state_lldsm::reachset {
       return index;
     }
 
+    //
+    // Get the index set itself; buildIndexSet() must be called first.
+    //
+    inline const MEDDLY::dd_edge& getIndexSet() const {
+      DCASSERT(state_indexes);
+      return state_indexes->E;
+    }
+
     //
     // Remember the mxd wrapper for later (explicit only)
     //
@@ -210,6 +229,15 @@ class meddly_reachset : public state_lldsm::reachset {
       mxd_wrap = 0;
       return foo;
     }
+
+  private:
+    class range_sums;
+
+    // Sum of f(s) * p[index(s)], for f given by MTMDD node r
+    // and states given by index set node i, at offset.
+    double dotProduct(const MEDDLY::expert_forest* fR, MEDDLY::node_handle r,
+      const MEDDLY::expert_forest* fI, MEDDLY::node_handle i, long offset,
+      bool is_bool, const range_sums &P) const;
     
 
   public: 
@@ -194,6 +194,13 @@ void state_lldsm::reachset::visitStates(state_lldsm::state_visitor &v) const
   }
 }
 
+long state_lldsm::reachset::sumMeasures(const double*, 
+  const std::vector <measure*> &, std::vector <result> &, 
+  std::vector <bool> &)
+{
+  return 0;
+}
+
 bool state_lldsm::reachset::Print(OutputStream &s, int width) const
 {
   // Required for shared object, but will we ever call it?
@@ -9,6 +9,7 @@
 #include "../_StateLib/lchild_rsiblingt.h"
 
 class stateset;
+class measure;
 
 namespace StateLib {
   class state_db;
@@ -209,6 +210,21 @@ public:
         */
         void visitStates(state_lldsm::state_visitor &x) const;
 
+        /**
+          Compute measures without visiting the states, if possible.
+          For each measure, with RHS f of type real or bool, this is
+            the sum over reachable states s of p[index(s)] * f(s).
+          Default behavior here is to compute nothing.
+            @param  p     Vector, indexed by state index.
+            @param  msrs  Measures to compute.
+            @param  ans   If msrs[i] is computed, its value goes in ans[i].
+            @param  done  Set done[i] to true if msrs[i] is computed.
+            @return Number of measures computed.
+        */
+        virtual long sumMeasures(const double* p, 
+          const std::vector <measure*> &msrs, std::vector <result> &ans,
+          std::vector <bool> &done);
+
         // Shared object requirements
         virtual bool Print(OutputStream &s, int width) const;
         virtual bool Equals(const shared_object* o) const;
@@ -312,6 +328,15 @@ public:
     RSS->visitStates(x);
   }
 
+  /** Compute measures symbolically, if our states allow it.
+      See reachset::sumMeasures().
+  */
+  inline long sumMeasures(const double* p, const std::vector <measure*> &msrs,
+    std::vector <result> &ans, std::vector <bool> &done) const
+  {
+    return RSS ? RSS->sumMeasures(p, msrs, ans, done) : 0;
+  }
+
   inline stateset* getReachable() const {
     return RSS ? RSS->getReachable() : 0;
   }
@@ -7,6 +7,8 @@
 #include "../ExprLib/mod_vars.h"
 #include "../Modules/biginttype.h"
 
+#include <string.h>
+
 // ******************************************************************
 // *                                                                *
 // *                    stochastic_lldsm methods                    *
@@ -136,6 +138,21 @@ bool stochastic_lldsm::process::computeTransient(double t, double*, double*, dou
   return false;
 }
 
+bool stochastic_lldsm::process::computeTransients(const double* t, long nt,
+  double* probs, double** pt, double* aux, double* aux2) const
+{
+  double last_time = 0.0;
+  for (long k=0; k<nt; k++) {
+    double dt = t[k] - last_time;
+    if (dt) {
+      if (!computeTransient(dt, probs, aux, aux2)) return false;
+      last_time = t[k];
+    }
+    memcpy(pt[k], probs, getNumStates() * sizeof(double));
+  }
+  return true;
+}
+
 bool stochastic_lldsm::process::computeAccumulated(double t, const double*, double*, double*, double*) const
 {
   parent->bailOut(__FILE__, __LINE__, "Can't compute accumulated");
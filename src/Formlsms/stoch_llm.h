@@ -139,6 +139,29 @@ public:
         */
         virtual bool computeTransient(double t, double* probs, 
               double* aux, double* aux2) const;
+
+        /** Compute the distributions at several times.
+            The default behavior here is to call computeTransient()
+            once per time point, each time starting from the
+            previous distribution; derived classes should override
+            this if they can share work between time points.
+              @param  t       Array of times, in increasing order.
+              @param  nt      Number of times.
+              @param  probs   An array of dimension getNumStates().
+                              On input: the probability for each state at time 0.
+                              On output: the probability for each state 
+                              at time t[nt-1].
+              @param  pt      Array of nt arrays, each of dimension
+                              getNumStates().  On output, pt[k] holds
+                              the probability for each state at time t[k].
+              @param  aux     Auxiliary vector, dimension getNumStates().
+              @param  aux2    Another auxiliary vector, dimension getNumStates(),
+                              required only for CTMCs.
+
+              @return    true on success, false otherwise.
+        */
+        virtual bool computeTransients(const double* t, long nt, double* probs,
+              double** pt, double* aux, double* aux2) const;
  
         /** Accumulate expected time spent in each state, until time t.
             This must be provided in derived classes, the
@@ -467,6 +490,13 @@ public:
     return PROC->computeTransient(t, probs, aux, aux2);
   }
  
+  inline bool computeTransients(const double* t, long nt, double* probs,
+              double** pt, double* aux, double* aux2) const
+  {
+    DCASSERT(PROC);
+    return PROC->computeTransients(t, nt, probs, pt, aux, aux2);
+  }
+ 
   inline bool computeAccumulated(double t, const double* p0, double* n,
               double* aux, double* aux2) const
   {
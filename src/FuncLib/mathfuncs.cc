@@ -911,30 +911,11 @@ int order_si::Traverse(traverse_data &x, expr** pass, int np)
 
 class irorder_si : public order_si {
   bool is_for_integers;
-private:
-  static result* scratch;
-  static int scratch_size;
 public:
   irorder_si(const type* args);
   virtual void Compute(traverse_data &x, expr** pass, int np);
-
-  inline static void cleanup() {
-    delete[] scratch;
-    scratch = 0;
-    scratch_size = 0;
-  }
-  inline static void expand(int sz) {
-    if (sz > scratch_size) {
-      scratch_size = sz + (64-sz%64);
-      delete[] scratch;
-      scratch = new result[scratch_size];
-    }
-  }
 };
 
-result* irorder_si::scratch = 0;
-int irorder_si::scratch_size = 0;
-
 irorder_si::irorder_si(const type* args) : order_si(args)
 {
   is_for_integers = (args == em->INT);
@@ -947,8 +928,6 @@ void irorder_si::Compute(traverse_data &x, expr** pass, int np)
   DCASSERT(0==x.aggregate);
   DCASSERT(np>1);
 
-  expand(np);
-
   //
   // Determine k
   // 
@@ -965,8 +944,11 @@ void irorder_si::Compute(traverse_data &x, expr** pass, int np)
   }
 
   //
-  // Compute all operands
+  // Compute all operands.
+  // Scratch space is per call: operands may call us again,
+  // and measures may be computed by several threads.
   //
+  result* scratch = new result[np];
   result* ans = x.answer;
   for (int i=1; i<np; i++) {
     x.answer = scratch+i;
@@ -977,8 +959,10 @@ void irorder_si::Compute(traverse_data &x, expr** pass, int np)
     // null or other error, propogate it
     *ans = *(x.answer);
     x.answer = ans;
+    delete[] scratch;
     return;
   }
+  x.answer = ans;
 
   //
   // Sort the samples
@@ -993,6 +977,7 @@ void irorder_si::Compute(traverse_data &x, expr** pass, int np)
   // return Kth smallest
   //
   *(x.answer) = scratch[k];
+  delete[] scratch;
 }
 
 // ******************************************************************
@@ -380,9 +380,10 @@ exp_state_lib::exp_state_lib() : library(false, false)
 class my_exp_state_lib : public exp_state_lib {
   static long max_stack_depth;
   int storage;
-  static const int HASHING  = 0;
-  static const int RED_BLACK  = 1;
-  static const int SPLAY  = 2;
+  static const int FLAT  = 0;
+  static const int HASHING  = 1;
+  static const int RED_BLACK  = 2;
+  static const int SPLAY  = 3;
   // methods for substate dbs
   int substate_style;
   static const int SEPARATED = 0;
@@ -407,7 +408,12 @@ long my_exp_state_lib::max_stack_depth;
 
 my_exp_state_lib::my_exp_state_lib(exprman* em) : exp_state_lib()
 {
-  radio_button** es_list = new radio_button*[3];
+  radio_button** es_list = new radio_button*[4];
+  es_list[FLAT] = new radio_button(
+    "FLAT",
+    "States are stored at fixed width in an open-addressing hash table, which allows concurrent insertions.  Falls back to HASHING when state sizes must be stored.",
+    FLAT
+  );
   es_list[HASHING] = new radio_button(
     "HASHING",
     "States are stored in a hash table.",
@@ -429,7 +435,7 @@ my_exp_state_lib::my_exp_state_lib(exprman* em) : exp_state_lib()
     MakeRadioOption(
       "ExplicitStateStorage",
       "Data structure to use for explicitly storing states.",
-      es_list, 3, storage
+      es_list, 4, storage
     )
   );
 
@@ -483,6 +489,7 @@ const char* my_exp_state_lib::getDBMethod() const
   switch (storage) {
     case HASHING:     return "hash table";
     case RED_BLACK:   return "red-black tree";
+    case FLAT:        return "flat hash table";
     default:          return "splay tree";
   }
   return "keep dumb compilers happy";
@@ -493,6 +500,13 @@ my_exp_state_lib::createStateDB(bool indexed, bool store_sizes) const
 {
   StateLib::state_db* sdb = 0;
   switch (storage) {
+    case FLAT:
+      if (indexed && !store_sizes) {
+        sdb = StateLib::CreateStateDB(StateLib::SDBT_Flat, true, false);
+        break;
+      }
+      // otherwise, use hashing
+
     case HASHING:
       sdb = StateLib::CreateStateDB(StateLib::SDBT_Hash, indexed, store_sizes);
       break;
@@ -523,11 +537,14 @@ substate_colls* my_exp_state_lib
         return new separate_colls(K, dbs);
     }
 
+    // Substates of different submodels may differ in size,
+    // which FLAT storage does not allow within one database.
     case SHARED:
-        return new unsynch_colls(K, createStateDB(true, ss));
+        return new unsynch_colls(K, createStateDB(true, ss || FLAT==storage));
 
     case SYNCHRONIZED:
-        return new synchronized_colls(K, createStateDB(true, ss));
+        return new synchronized_colls(K, 
+          createStateDB(true, ss || FLAT==storage));
 
     default:
         DCASSERT(0);
@@ -725,6 +725,8 @@ void meddly_encoder
 
       case exprman::aop_times:
         if (flip) {
+          // Quotients are real; integer division would be wrong
+          if (MEDDLY::forest::INTEGER == F->getRangeType()) throw Failed;
           MEDDLY::apply(
             MEDDLY::DIVIDE, meL->E, meR->E, out
           );
@@ -512,7 +512,6 @@ public:
 
 option::error int_opt::SetValue(long b)
 { 
-  if (0==value)  return NullFunction;
   if (min<max) {
     if ((b<min) || (b>max)) return RangeError;
   }
@@ -592,7 +591,6 @@ real_opt::real_opt(const char* n, const char* d, double &v,
 
 option::error real_opt::SetValue(double b) 
 { 
-  if (0==value) return NullFunction;
   bool bad = false;
   if (has_min) {
     if (includes_min) {
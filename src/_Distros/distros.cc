@@ -186,15 +186,19 @@ void discrete_1mcdf::setFromPDF(const discrete_pdf &P)
 // ******************************************************************
 
 /*
-  The following algorithm to compute the Poisson PDF is
+  The truncation points for the Poisson PDF are
   from Fox & Glynn, "Computing Poisson Probabilities",
   Communications of the ACM, 31 (4) April 1988, pp 440-445.
 
-  Currently: reckless disregard for underflow or overflow.
+  The weights are computed by recurrences going outward from the
+  mode, starting from one there.  Every weight is then at most one,
+  and weights decrease away from the mode, so nothing can overflow;
+  a weight is dropped (and further truncates the distribution) once 
+  it is small enough to be negligible, well before it can underflow.
+  This also tightens the Fox-Glynn bounds, which are loose for
+  small lambda.
 */
 
-const double TAU = 1.0e-30;
-const double OMEGA = 1.0e+30;
 const double sqrt2pi = sqrt(2.0*M_PI);
 
 // ******************************************************************
@@ -241,31 +245,46 @@ long PoissonLeft(double lambda, double epsilon)
 
 void computePoissonPDF(double lambda, double epsilon, discrete_pdf &P)
 {
-  long R = PoissonRight(lambda, epsilon);
-  long L = PoissonLeft(lambda, epsilon);
+  //
+  // Half of the error goes to the Fox-Glynn truncation points,
+  // the other half to dropping negligible weights.
+  //
+  long R = PoissonRight(lambda, epsilon/2);
+  long L = PoissonLeft(lambda, epsilon/2);
 
   double* shifted_pdf = new double[R-L+1];
   double* pdf = shifted_pdf - L;
 
-  // Straight from page 442
+  // Weights, relative to the one at the mode, smaller than this
+  // can be dropped; their total is less than epsilon/2.
+  const double tiny = epsilon / (2.0*(R-L+1));
+
   long m = long(lambda);
-  pdf[m] = OMEGA/(1e10*(R-L+1));
+  if (m < L) m = L;
+  if (m > R) m = R;
+  pdf[m] = 1;
   // Down
+  long newL = L;
   for (long j=m; j>L; j--) {
     pdf[j-1] = (j/lambda)*pdf[j];
+    if (pdf[j-1] < tiny) {
+      newL = j;
+      break;
+    }
   }
-  // Up (simplified)
+  // Up
+  long newR = R;
   for (long j=m+1; j<=R; j++) {
-    // double qty = lambda/j;
     pdf[j] = (lambda / j) * pdf[j-1];
-    if (pdf[j] < TAU) {
-      R = j;
-    } 
-  }
+    if (pdf[j] < tiny) {
+      newR = j-1;
+      break;
+    }
+  } 
   // Get total; add small terms first
   double total = 0.0;
-  long l = L;
-  long r = R;
+  long l = newL;
+  long r = newR;
   while (l < r) {
     if (pdf[l] <= pdf[r]) {
       total += pdf[l];
@@ -276,14 +295,22 @@ void computePoissonPDF(double lambda, double epsilon, discrete_pdf &P)
     }
   } // while
   total += pdf[l];
-  // Normalize
 
-  for (int j=L; j<=R; j++) {
+  // Shrink array, if we dropped anything
+  if (newL > L || newR < R) {
+    double* trimmed = new double[newR-newL+1];
+    memcpy(trimmed, pdf+newL, (newR-newL+1) * sizeof(double));
+    delete[] shifted_pdf;
+    shifted_pdf = trimmed;
+    pdf = shifted_pdf - newL;
+    L = newL;
+    R = newR;
+  }
+
+  // Normalize
+  for (long j=L; j<=R; j++) {
     pdf[j] /= total;
   }
 
   P.reset(L, R, shifted_pdf, 0);
 }
-
-
-
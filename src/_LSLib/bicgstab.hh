@@ -0,0 +1,162 @@
+
+#ifndef BICGSTAB_HH
+#define BICGSTAB_HH
+
+#include "lslib.h"
+#include "debug.hh"
+#include "krylov.hh"
+#include <math.h>
+
+/**
+
+    Workhorse for preconditioned BiCGSTAB,
+    solving Ax=b or (if b is null) Ax=0.
+
+    The MATRIX class must provide the following methods/members:
+
+      one_over_diag[]             : negated reciprocals of diagonal elements
+      long Start()                : index of first row
+      long Stop()                 : one plus index of last row
+      long Size()                 : dimension of vectors
+      MatrixVectorMultiply(y, x)  : y += (A without diagonals) * x
+
+
+    @param  A     Matrix
+    @param  x     Vector
+    @param  b     Right-hand side, full; or null for Ax=0
+    @param  opts  options
+    @param  out   Output information
+*/
+
+template <class MATRIX>
+void New_BiCGSTAB(
+          const MATRIX &A,          // abstract matrix
+          double *x,                // solution vector
+          const double *b,          // constant vector (right side)
+          const LS_Options &opts,   // solver options
+          LS_Output &out            // performance results
+)
+{
+  out.status = LS_No_Convergence;
+  out.num_iters = 0;
+#ifdef NAN
+  out.precision = NAN;
+#endif
+  out.relaxation = 1;
+
+  const long start = A.Start();
+  const long stop = A.Stop();
+  const long size = A.Size();
+
+  double* work = KrylovWorkspace(7, size);
+  double* r     = work;
+  double* rhat  = work + size;
+  double* p     = work + 2*size;
+  double* v     = work + 3*size;
+  double* phat  = work + 4*size;
+  double* shat  = work + 5*size;
+  double* t     = work + 6*size;
+  // s can share storage with r
+
+  if (0==b) KrylovNormalize(x, start, stop);
+
+  KrylovResidual(A, b, x, r);
+  for (long i=start; i<stop; i++) {
+    rhat[i] = r[i];
+    p[i] = 0;
+    v[i] = 0;
+  }
+  double rho = 1;
+  double alpha = 1;
+  double omega = 1;
+
+  long iters;
+  double maxerror = 0;
+  for (iters=1; iters<=opts.max_iters; iters++) {
+    if (opts.debug)  DebugIter("BiCGSTAB", iters, x, start, stop);
+
+    double rho_new = KrylovDot(rhat, r, start, stop);
+    if (KrylovBreakdown(rho_new, rhat, r, start, stop)) {
+      // Either we are exactly at the solution, or a breakdown
+      maxerror = KrylovPrecision(A, x, r,
+          b ? 1.0 : 1.0 / KrylovSum(x, start, stop), opts);
+      if (maxerror < opts.precision) {
+        out.status = LS_Success;
+        break;
+      }
+      // Breakdown; restart using the current residual
+      for (long i=start; i<stop; i++) {
+        rhat[i] = r[i];
+        p[i] = 0;
+        v[i] = 0;
+      }
+      rho = 1;
+      alpha = 1;
+      omega = 1;
+      rho_new = KrylovDot(rhat, r, start, stop);
+    }
+    double beta = (rho_new / rho) * (alpha / omega);
+    rho = rho_new;
+    for (long i=start; i<stop; i++) {
+      p[i] = r[i] + beta * (p[i] - omega * v[i]);
+    }
+
+    KrylovPrecondition(A, phat, p);
+    KrylovMultiply(A, v, phat);
+    double sigma = KrylovDot(rhat, v, start, stop);
+    if (0==sigma) break;
+    alpha = rho / sigma;
+
+    // s = r - alpha v, stored in r
+    for (long i=start; i<stop; i++) r[i] -= alpha * v[i];
+
+    KrylovPrecondition(A, shat, r);
+    KrylovMultiply(A, t, shat);
+    double tt = KrylovDot(t, t, start, stop);
+    omega = tt ? KrylovDot(t, r, start, stop) / tt : 0;
+
+    for (long i=start; i<stop; i++) {
+      x[i] += alpha * phat[i] + omega * shat[i];
+      r[i] -= omega * t[i];
+    }
+
+    //
+    // Determine current precision
+    //
+    maxerror = 0;
+    if (iters >= opts.min_iters) {
+      maxerror = KrylovPrecision(A, x, r,
+          b ? 1.0 : 1.0 / KrylovSum(x, start, stop), opts);
+      if (maxerror < opts.precision) {
+        // The updated residual drifts from the true one; check that too
+        KrylovResidual(A, b, x, r);
+        maxerror = KrylovPrecision(A, x, r,
+            b ? 1.0 : 1.0 / KrylovSum(x, start, stop), opts);
+        if (maxerror < opts.precision) {
+          out.status = LS_Success;
+          break;
+        }
+        omega = 0;  // forces a restart with the true residual
+      }
+    }
+    if (0==omega) {
+      // Can't continue with these recurrences; restart them
+      for (long i=start; i<stop; i++) {
+        rhat[i] = r[i];
+        p[i] = 0;
+        v[i] = 0;
+      }
+      rho = 1;
+      alpha = 1;
+      omega = 1;
+    }
+  } // for iters
+  out.num_iters = iters;
+  out.precision = maxerror;
+
+  if (0==b) KrylovNormalize(x, start, stop);
+
+  free(work);
+}
+
+#endif
@@ -0,0 +1,323 @@
+
+#ifndef BLOCK_HH
+#define BLOCK_HH
+
+#include "lslib.h"
+#include "debug.hh"
+#include <math.h>
+
+/**
+    Rows of block i, clipped to [start, stop).
+    Blocks are either given explicitly, by opts.blocks,
+    or consecutive groups of opts.block_size rows.
+    The block may be empty, if it falls outside [start, stop).
+*/
+inline void GetBlock(const LS_Options &opts, long start, long stop,
+  long i, long &lo, long &hi)
+{
+  if (opts.blocks) {
+    lo = opts.blocks[i];
+    hi = opts.blocks[i+1];
+    if (lo < start) lo = start;
+    if (hi > stop)  hi = stop;
+  } else {
+    long bs = (opts.block_size > 0) ? opts.block_size : 1;
+    lo = start + i * bs;
+    hi = lo + bs;
+    if (hi > stop) hi = stop;
+  }
+}
+
+/// Number of blocks to visit, for rows [start, stop).
+inline long NumBlocks(const LS_Options &opts, long start, long stop)
+{
+  if (opts.blocks) return opts.num_blocks;
+  long bs = (opts.block_size > 0) ? opts.block_size : 1;
+  return (stop - start + bs - 1) / bs;
+}
+
+/**
+    Solve (approximately) the diagonal block for rows [lo, hi)
+    using at most opts.inner_iters Gauss-Seidel sweeps.
+    We stop early once a sweep changes the block by less than
+    a tenth of what the first sweep did, since there is no point
+    solving the block much more precisely than the outer iteration.
+    Off-block elements use vector xout; for block Gauss-Seidel
+    this is x itself, for block Jacobi it is the previous iterate.
+*/
+template <class MATRIX>
+inline void SolveBlock(const MATRIX &A, double* x, const double* xout,
+  const double* bneg, long lo, long hi, const LS_Options &opts)
+{
+  long inner = (opts.inner_iters > 0) ? opts.inner_iters : 1;
+  double first = 0;
+  for (long k=0; k<inner; k++) {
+    double change = 0;
+    for (long s=lo; s<hi; s++) {
+      double tmp = bneg ? bneg[s] : 0.0;
+      A.BlockRowDotProduct(s, lo, hi, x, xout, tmp);
+      tmp *= A.one_over_diag[s];
+      double delta = tmp - x[s];
+      x[s] = tmp;
+      if (opts.use_relative) if (x[s]) delta /= x[s];
+      if (delta<0) delta = -delta;
+      if (delta > change) change = delta;
+    }
+    if (0==k) first = change;
+    else if (change <= 0.1 * first) break;
+  }
+}
+
+/**
+    Flows between blocks, for aggregation.
+    Adds x[i] * q_ij to F[I*nb+J], for each state i in block I and
+    j in block J, where q_ij is the element of the transposed matrix,
+    i.e., A is stored by rows and element (j, i) of A is q_ij.
+    We need to see the column indexes, so this only works for
+    CRS matrices; returns false for others.
+*/
+template <class MATRIX>
+inline bool BlockFlows(const MATRIX &, const double*, const long*, long, 
+  double*)
+{
+  return false;
+}
+
+template <class REAL>
+inline bool CRS_BlockFlows(const LS_CRS_Matrix<REAL> &A, const double* x,
+  const long* blockof, long nb, double* F)
+{
+  for (long j=A.Start(); j<A.Stop(); j++) {
+    const long J = blockof[j];
+    for (long a = A.row_ptr[j]; a < A.row_ptr[j+1]; a++) {
+      const long i = A.col_ind[a];
+      if (i < A.Start() || i >= A.Stop()) continue;
+      F[blockof[i]*nb+J] += x[i] * A.val[a];
+    }
+    if (A.one_over_diag[j]) F[J*nb+J] -= x[j] / A.one_over_diag[j];
+  }
+  return true;
+}
+
+inline bool BlockFlows(const LS_CRS_Matrix_float &A, const double* x,
+  const long* blockof, long nb, double* F)
+{
+  return CRS_BlockFlows(A, x, blockof, nb, F);
+}
+
+inline bool BlockFlows(const LS_CRS_Matrix_double &A, const double* x,
+  const long* blockof, long nb, double* F)
+{
+  return CRS_BlockFlows(A, x, blockof, nb, F);
+}
+
+/**
+    Aggregation / disaggregation step (Koury, McAllister, Stewart)
+    for Ax=0.  Solves the small Markov chain whose states are the
+    blocks, with rates given by the current solution, and rescales
+    each block of x by the result.  This takes care of the slow
+    "between blocks" convergence that plain block methods suffer
+    on nearly-decomposable chains.
+    The scaling factors eta satisfy eta F = 0, where F holds the flows
+    between blocks; we solve for them with Gauss-Seidel, starting
+    from all ones (the answer when x is already a solution).
+      @param  F       Workspace, dimension nb*nb.
+      @param  eta     Workspace, dimension nb.
+      @return false if aggregation is not possible for this matrix.
+*/
+template <class MATRIX>
+inline bool Aggregate(const MATRIX &A, double* x, const long* blockof, 
+  long nb, double* F, double* eta, const LS_Options &opts)
+{
+  for (long I=0; I<nb*nb; I++) F[I] = 0;
+  if (!BlockFlows(A, x, blockof, nb, F)) return false;
+
+  for (long I=0; I<nb; I++) eta[I] = 1;
+  long inner = (opts.inner_iters > 0) ? opts.inner_iters : 1;
+  for (long k=0; k<inner; k++) {
+    double change = 0;
+    for (long J=0; J<nb; J++) {
+      const double diag = F[J*nb+J];
+      if (0==diag) continue;
+      double sum = 0;
+      for (long I=0; I<nb; I++) {
+        if (I != J) sum += eta[I] * F[I*nb+J];
+      }
+      double tmp = - sum / diag;
+      double delta = tmp - eta[J];
+      eta[J] = tmp;
+      if (tmp) delta /= tmp;
+      if (delta<0) delta = -delta;
+      if (delta > change) change = delta;
+    }
+    if (change < opts.precision) break;
+  }
+
+  double total = 0;
+  for (long s=A.Start(); s<A.Stop(); s++) {
+    x[s] *= eta[blockof[s]];
+    total += x[s];
+  }
+  if (total > 0) {
+    total = 1.0 / total;
+    for (long s=A.Start(); s<A.Stop(); s++) x[s] *= total;
+  }
+  return true;
+}
+
+/**
+
+    Workhorse for Block Gauss-Seidel and Block Jacobi,
+    solving Ax=b or (if bneg is null) Ax=0.
+
+    Each outer iteration visits the diagonal blocks in order,
+    and solves for the block unknowns using inner Gauss-Seidel
+    sweeps, with off-block unknowns fixed.  For block Gauss-Seidel
+    the off-block unknowns are the most recent values; for block
+    Jacobi they are the values from the previous outer iteration,
+    so the blocks are independent and may be solved in parallel.
+    For Ax=0, if opts.aggregate is set, each outer iteration
+    starts with an aggregation / disaggregation step.
+
+    The MATRIX class must provide the following methods/members:
+
+      one_over_diag[]           : negated reciprocals of diagonal elements
+      long Start()              : index of first row
+      long Stop()               : one plus index of last row
+      BlockRowDotProduct(r, lo, hi, xin, xout, ans)
+                                : Row r times x is added to ans,
+                                  where x is xin for columns in [lo, hi)
+                                  and xout otherwise.
+
+
+    @param  A     Matrix
+    @param  x     Solution vector
+    @param  bneg  Negated right-hand side, full; or null for Ax=0
+    @param  old   Auxiliary vector
+    @param  opts  options
+    @param  out   Output information
+*/
+
+template <bool JACOBI, class MATRIX>
+void New_Block(
+          const MATRIX &A,          // abstract matrix
+          double *x,                // solution vector
+          const double *bneg,       // negated constant vector, or null
+          double *old,              // auxiliary vector
+          const LS_Options &opts,   // solver options
+          LS_Output &out            // performance results
+)
+{
+  out.status = LS_No_Convergence;
+  out.num_iters = 0;
+#ifdef NAN
+  out.precision = NAN;
+#endif
+  out.relaxation = 1;
+
+  const long start = A.Start();
+  const long stop = A.Stop();
+  const long nb = NumBlocks(opts, start, stop);
+  const double* xout = JACOBI ? old : x;
+
+  LS_Workers W(JACOBI ? opts.num_threads : 1);
+  long* bounds = new long[W.NumThreads()+1];
+  W.Partition(0, nb, 0, bounds);
+
+  //
+  // Extra workspace for aggregation
+  //
+  long* blockof = 0;
+  double* F = 0;
+  double* eta = 0;
+  if (opts.aggregate && (0==bneg) && (nb > 1)) {
+    blockof = (long*) malloc(A.Size() * sizeof(long));
+    F = (double*) malloc(nb * nb * sizeof(double));
+    eta = (double*) malloc(nb * sizeof(double));
+    if ((NULL==blockof) || (NULL==F) || (NULL==eta)) {
+      delete[] bounds;
+      free(blockof);
+      free(F);
+      free(eta);
+      throw LS_Out_Of_Memory;
+    }
+    for (long i=0; i<nb; i++) {
+      long lo, hi;
+      GetBlock(opts, start, stop, i, lo, hi);
+      for (long s=lo; s<hi; s++) blockof[s] = i;
+    }
+  }
+
+  long iters;
+  double maxerror = 0;
+  try {
+    for (iters=1; iters<=opts.max_iters; iters++) {
+      if (opts.debug)  DebugIter(JACOBI ? "Block Jacobi" : "Block Gauss-Seidel",
+                          iters, x, start, stop);
+
+      if (blockof) {
+        if (!Aggregate(A, x, blockof, nb, F, eta, opts)) {
+          // Can't aggregate with this matrix type; carry on without
+          free(blockof);
+          blockof = 0;
+        }
+      }
+
+      for (long s=start; s<stop; s++) old[s] = x[s];
+
+      if (W.NumThreads() > 1) {
+        W.Run([&](int t) {
+          for (long i=bounds[t]; i<bounds[t+1]; i++) {
+            long lo, hi;
+            GetBlock(opts, start, stop, i, lo, hi);
+            if (lo < hi) SolveBlock(A, x, xout, bneg, lo, hi, opts);
+          }
+        });
+      } else {
+        for (long i=0; i<nb; i++) {
+          long lo, hi;
+          GetBlock(opts, start, stop, i, lo, hi);
+          if (lo < hi) SolveBlock(A, x, xout, bneg, lo, hi, opts);
+        }
+      }
+
+      //
+      // Determine current precision
+      //
+      maxerror = 0;
+      double total = 0;
+      for (long s=start; s<stop; s++) {
+        double delta = x[s] - old[s];
+        total += x[s];
+        if (opts.use_relative) if (x[s]) delta /= x[s];
+        if (delta<0) delta = -delta;
+        if (delta > maxerror) maxerror = delta;
+      }
+      if (0==bneg) if (total != 1.0) {
+        total = 1.0 / total;
+        for (long s=start; s<stop; s++) x[s] *= total;
+      }
+
+      if (iters < opts.min_iters) continue;
+      if (maxerror < opts.precision) {
+        out.status = LS_Success;
+        break;
+      }
+    } // for iters
+  }
+  catch (...) {
+    delete[] bounds;
+    free(blockof);
+    free(F);
+    free(eta);
+    throw;
+  }
+  delete[] bounds;
+  free(blockof);
+  free(F);
+  free(eta);
+  out.num_iters = iters;
+  out.precision = maxerror;
+}
+
+#endif
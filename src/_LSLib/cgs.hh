@@ -0,0 +1,156 @@
+
+#ifndef CGS_HH
+#define CGS_HH
+
+#include "lslib.h"
+#include "debug.hh"
+#include "krylov.hh"
+#include <math.h>
+
+/**
+
+    Workhorse for preconditioned Conjugate Gradient Squared,
+    solving Ax=b or (if b is null) Ax=0.
+
+    The MATRIX class must provide the following methods/members:
+
+      one_over_diag[]             : negated reciprocals of diagonal elements
+      long Start()                : index of first row
+      long Stop()                 : one plus index of last row
+      long Size()                 : dimension of vectors
+      MatrixVectorMultiply(y, x)  : y += (A without diagonals) * x
+
+
+    @param  A     Matrix
+    @param  x     Vector
+    @param  b     Right-hand side, full; or null for Ax=0
+    @param  opts  options
+    @param  out   Output information
+*/
+
+template <class MATRIX>
+void New_CGS(
+          const MATRIX &A,          // abstract matrix
+          double *x,                // solution vector
+          const double *b,          // constant vector (right side)
+          const LS_Options &opts,   // solver options
+          LS_Output &out            // performance results
+)
+{
+  out.status = LS_No_Convergence;
+  out.num_iters = 0;
+#ifdef NAN
+  out.precision = NAN;
+#endif
+  out.relaxation = 1;
+
+  const long start = A.Start();
+  const long stop = A.Stop();
+  const long size = A.Size();
+
+  double* work = KrylovWorkspace(7, size);
+  double* r     = work;
+  double* rhat  = work + size;
+  double* p     = work + 2*size;
+  double* u     = work + 3*size;
+  double* q     = work + 4*size;
+  double* vhat  = work + 5*size;
+  double* uhat  = work + 6*size;
+
+  if (0==b) KrylovNormalize(x, start, stop);
+
+  KrylovResidual(A, b, x, r);
+  for (long i=start; i<stop; i++) {
+    rhat[i] = r[i];
+    p[i] = r[i];
+    u[i] = r[i];
+  }
+  double rho = KrylovDot(rhat, r, start, stop);
+
+  long iters;
+  double maxerror = 0;
+  for (iters=1; iters<=opts.max_iters; iters++) {
+    if (opts.debug)  DebugIter("CGS", iters, x, start, stop);
+
+    if (KrylovBreakdown(rho, rhat, r, start, stop)) {
+      // Either we are exactly at the solution, or a breakdown
+      maxerror = KrylovPrecision(A, x, r,
+          b ? 1.0 : 1.0 / KrylovSum(x, start, stop), opts);
+      if (maxerror < opts.precision) {
+        out.status = LS_Success;
+        break;
+      }
+      // Breakdown; restart using the current residual
+      for (long i=start; i<stop; i++) {
+        rhat[i] = r[i];
+        p[i] = r[i];
+        u[i] = r[i];
+      }
+      rho = KrylovDot(rhat, r, start, stop);
+    }
+
+    // vhat = A M^{-1} p
+    KrylovPrecondition(A, uhat, p);
+    KrylovMultiply(A, vhat, uhat);
+    double sigma = KrylovDot(rhat, vhat, start, stop);
+    if (0==sigma) break;
+    double alpha = rho / sigma;
+
+    for (long i=start; i<stop; i++) {
+      q[i] = u[i] - alpha * vhat[i];
+      // use vhat for u + q
+      vhat[i] = u[i] + q[i];
+    }
+
+    // x += alpha M^{-1} (u+q), r -= alpha A M^{-1} (u+q)
+    KrylovPrecondition(A, uhat, vhat);
+    KrylovMultiply(A, vhat, uhat);
+    for (long i=start; i<stop; i++) {
+      x[i] += alpha * uhat[i];
+      r[i] -= alpha * vhat[i];
+    }
+
+    //
+    // Determine current precision
+    //
+    maxerror = 0;
+    if (iters >= opts.min_iters) {
+      maxerror = KrylovPrecision(A, x, r,
+          b ? 1.0 : 1.0 / KrylovSum(x, start, stop), opts);
+      if (maxerror < opts.precision) {
+        // The updated residual drifts from the true one; check that too
+        KrylovResidual(A, b, x, r);
+        maxerror = KrylovPrecision(A, x, r,
+            b ? 1.0 : 1.0 / KrylovSum(x, start, stop), opts);
+        if (maxerror < opts.precision) {
+          out.status = LS_Success;
+          break;
+        }
+        // Restart using the true residual
+        for (long i=start; i<stop; i++) {
+          rhat[i] = r[i];
+          p[i] = r[i];
+          u[i] = r[i];
+        }
+        rho = KrylovDot(rhat, r, start, stop);
+        continue;
+      }
+    }
+
+    double rho_new = KrylovDot(rhat, r, start, stop);
+    double beta = rho_new / rho;
+    rho = rho_new;
+    for (long i=start; i<stop; i++) {
+      u[i] = r[i] + beta * q[i];
+      p[i] = u[i] + beta * (q[i] + beta * p[i]);
+    }
+  } // for iters
+  out.num_iters = iters;
+  out.precision = maxerror;
+
+  if (0==b) KrylovNormalize(x, start, stop);
+
+  free(work);
+}
+
+#endif
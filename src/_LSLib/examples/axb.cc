@@ -37,6 +37,11 @@ public:
     A.RowDotProduct(i, x, sum);
   }
 
+  virtual void BlockRowDotProduct(long i, long lo, long hi,
+    const double* xin, const double* xout, double &sum) const {
+    A.BlockRowDotProduct(i, lo, hi, xin, xout, sum);
+  }
+
 };
 
 
@@ -205,8 +210,18 @@ int Usage(const char* name)
     cerr << "\tt: store vector as truncated full\n";
     cerr << "\ts: show solution vector\n";
     cerr << "\tw x: sets relaxation parameter (default 1.0)\n";
+    cerr << "\tW: adjust relaxation parameter as we go (Gauss-Seidel only)\n";
     cerr << "\te epsilon: sets precision\n";
     cerr << "\tn iters: sets maximum number of iterations (default 10000)\n";
+    cerr << "\tT threads: sets number of threads (default 1)\n";
+    cerr << "\tB: BiCGSTAB\n";
+    cerr << "\tG: GMRES\n";
+    cerr << "\tS: Conjugate Gradient Squared\n";
+    cerr << "\tk dim: sets Krylov subspace dimension for GMRES (default 20)\n";
+    cerr << "\tb: Block Gauss-Seidel\n";
+    cerr << "\tJ: Block Jacobi\n";
+    cerr << "\tz size: sets number of rows per block (default 64)\n";
+    cerr << "\ti iters: sets maximum inner iterations per block (default 10)\n";
     return 0;
 }
 
@@ -224,7 +239,7 @@ int main(int argc, char** argv)
   bool show_solution = false;
   opts.max_iters = 10000;
   for (;;) {
-    ch = getopt(argc, argv, "?rjgacstw:e:n:");
+    ch = getopt(argc, argv, "?rjgabcstBGJSWw:e:n:T:k:z:i:");
     if (ch<0) break;
     switch (ch) {
       case 'a':  
@@ -247,6 +262,53 @@ int main(int argc, char** argv)
           opts.method = LS_Gauss_Seidel;
           break;
 
+      case 'B':
+          opts.method = LS_BiCGSTAB;
+          break;
+
+      case 'G':
+          opts.method = LS_GMRES;
+          break;
+
+      case 'S':
+          opts.method = LS_CGS;
+          break;
+
+      case 'b':
+          opts.method = LS_Block_Gauss_Seidel;
+          break;
+
+      case 'J':
+          opts.method = LS_Block_Jacobi;
+          break;
+
+      case 'z':
+          if (optarg) {
+            int n = atoi(optarg);
+            if (n>0) {
+              opts.block_size = n;
+            }
+          }
+          break;
+
+      case 'i':
+          if (optarg) {
+            int n = atoi(optarg);
+            if (n>0) {
+              opts.inner_iters = n;
+            }
+          }
+          break;
+
+      case 'k':
+          if (optarg) {
+            int n = atoi(optarg);
+            if (n>0) {
+              opts.krylov_dim = n;
+            }
+          }
+          break;
+
       case 't':
           sparse_b = false;
           break;
@@ -255,6 +317,10 @@ int main(int argc, char** argv)
           show_solution = true;
           break;
 
+      case 'W':
+          opts.adaptive_relaxation = 1;
+          break;
+
       case 'w':
           if (optarg) {
             double r = atof(optarg);
@@ -282,6 +348,15 @@ int main(int argc, char** argv)
           }
           break;
 
+      case 'T':
+          if (optarg) {
+            int n = atoi(optarg);
+            if (n>0) {
+              opts.num_threads = n;
+            }
+          }
+          break;
+
       default:
           return Usage(name);
     } // switch
@@ -308,9 +383,11 @@ int main(int argc, char** argv)
     cerr << "standard input\n";
     ReadInput(cin);
   }
-  if (opts.relaxation != 1.0) {
+  if (opts.relaxation != 1.0 || opts.adaptive_relaxation) {
     opts.use_relaxation = 1;
-    cerr << "Using relaxation parameter " << opts.relaxation << "\n";
+    cerr << "Using relaxation parameter " << opts.relaxation;
+    if (opts.adaptive_relaxation) cerr << " (adaptive)";
+    cerr << "\n";
   }
   if (use_abstract)   cerr << "Calling abstract solver library with ";
   else                cerr << "Calling explicit solver library with ";
@@ -324,6 +401,21 @@ int main(int argc, char** argv)
     case LS_Jacobi: 
         cerr << "Jacobi\n";
         break;
+    case LS_GMRES: 
+        cerr << "GMRES(" << opts.krylov_dim << ")\n";
+        break;
+    case LS_BiCGSTAB: 
+        cerr << "BiCGSTAB\n";
+        break;
+    case LS_CGS: 
+        cerr << "CGS\n";
+        break;
+    case LS_Block_Gauss_Seidel: 
+        cerr << "block Gauss-Seidel (" << opts.block_size << " rows per block)\n";
+        break;
+    case LS_Block_Jacobi: 
+        cerr << "block Jacobi (" << opts.block_size << " rows per block)\n";
+        break;
     default:
         cerr << "Unknown solver\n";
         return 1;
@@ -348,6 +440,8 @@ int main(int argc, char** argv)
     case LS_Success:
       cerr << "Took " << out.num_iters << " iterations\n";
       cerr << "Achieved " << out.precision << " precision\n";
+      if (opts.adaptive_relaxation)
+        cerr << "Final relaxation parameter " << out.relaxation << "\n";
       break;
 
     case LS_Wrong_Format:
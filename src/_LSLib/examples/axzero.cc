@@ -37,6 +37,11 @@ public:
     A.RowDotProduct(i, x, sum);
   }
 
+  virtual void BlockRowDotProduct(long i, long lo, long hi,
+    const double* xin, const double* xout, double &sum) const {
+    A.BlockRowDotProduct(i, lo, hi, xin, xout, sum);
+  }
+
 };
 
 
@@ -127,6 +132,17 @@ int Usage(const char* name)
     cerr << "\te epsilon: sets precision\n";
     cerr << "\tn iters: sets maximum number of iterations (default 10000)\n";
     cerr << "\tw x: sets relaxation parameter (default 1.0)\n";
+    cerr << "\tW: adjust relaxation parameter as we go (Gauss-Seidel only)\n";
+    cerr << "\tT threads: sets number of threads (default 1)\n";
+    cerr << "\tB: BiCGSTAB\n";
+    cerr << "\tG: GMRES\n";
+    cerr << "\tS: Conjugate Gradient Squared\n";
+    cerr << "\tk dim: sets Krylov subspace dimension for GMRES (default 20)\n";
+    cerr << "\tb: Block Gauss-Seidel\n";
+    cerr << "\tJ: Block Jacobi\n";
+    cerr << "\tz size: sets number of rows per block (default 64)\n";
+    cerr << "\ti iters: sets maximum inner iterations per block (default 10)\n";
+    cerr << "\tA: use aggregation with the block methods\n";
     return 0;
 }
 
@@ -145,7 +161,7 @@ int main(int argc, char** argv)
   int totaliters = 10000;
   opts.float_vectors = false;
   for (;;) {
-    ch = getopt(argc, argv, "?acfgjprsd:e:n:w:");
+    ch = getopt(argc, argv, "?abcfgjprsABGJSWd:e:n:w:T:k:z:i:");
     if (ch<0) break;
     switch (ch) {
       case 'a':  
@@ -176,10 +192,65 @@ int main(int argc, char** argv)
           opts.method = LS_Power;
           break;
 
+      case 'B':
+          opts.method = LS_BiCGSTAB;
+          break;
+
+      case 'G':
+          opts.method = LS_GMRES;
+          break;
+
+      case 'S':
+          opts.method = LS_CGS;
+          break;
+
+      case 'b':
+          opts.method = LS_Block_Gauss_Seidel;
+          break;
+
+      case 'J':
+          opts.method = LS_Block_Jacobi;
+          break;
+
+      case 'A':
+          opts.aggregate = true;
+          break;
+
+      case 'z':
+          if (optarg) {
+            int n = atoi(optarg);
+            if (n>0) {
+              opts.block_size = n;
+            }
+          }
+          break;
+
+      case 'i':
+          if (optarg) {
+            int n = atoi(optarg);
+            if (n>0) {
+              opts.inner_iters = n;
+            }
+          }
+          break;
+
+      case 'k':
+          if (optarg) {
+            int n = atoi(optarg);
+            if (n>0) {
+              opts.krylov_dim = n;
+            }
+          }
+          break;
+
       case 's':
           show_solution = true;
           break;
 
+      case 'W':
+          opts.adaptive_relaxation = 1;
+          break;
+
       case 'w':
           if (optarg) {
             double r = atof(optarg);
@@ -216,6 +287,15 @@ int main(int argc, char** argv)
           }
           break;
 
+      case 'T':
+          if (optarg) {
+            int n = atoi(optarg);
+            if (n>0) {
+              opts.num_threads = n;
+            }
+          }
+          break;
+
       default:
           return Usage(name);
     } // switch
@@ -241,9 +321,14 @@ int main(int argc, char** argv)
     cerr << "standard input\n";
     ReadInput(cin);
   }
-  if (opts.relaxation != 1.0) {
+  if (opts.relaxation != 1.0 || opts.adaptive_relaxation) {
     opts.use_relaxation = 1;
-    cerr << "Using relaxation parameter " << opts.relaxation << "\n";
+    cerr << "Using relaxation parameter " << opts.relaxation;
+    if (opts.adaptive_relaxation) cerr << " (adaptive)";
+    cerr << "\n";
+  }
+  if (opts.num_threads > 1) {
+    cerr << "Using " << opts.num_threads << " threads\n";
   }
   if (use_abstract)  cerr << "Calling abstract solver library with ";
   else      cerr << "Calling explicit solver library with ";
@@ -257,6 +342,21 @@ int main(int argc, char** argv)
     case LS_Jacobi: 
         cerr << "Jacobi\n";
         break;
+    case LS_GMRES: 
+        cerr << "GMRES(" << opts.krylov_dim << ")\n";
+        break;
+    case LS_BiCGSTAB: 
+        cerr << "BiCGSTAB\n";
+        break;
+    case LS_CGS: 
+        cerr << "CGS\n";
+        break;
+    case LS_Block_Gauss_Seidel: 
+        cerr << "block Gauss-Seidel (" << opts.block_size << " rows per block)\n";
+        break;
+    case LS_Block_Jacobi: 
+        cerr << "block Jacobi (" << opts.block_size << " rows per block)\n";
+        break;
     case LS_Power: 
         cerr << "Power method\n";
         break;
@@ -295,6 +395,8 @@ int main(int argc, char** argv)
     case LS_Success:
         cerr << "Took " << iters_so_far << " iterations\n";
         cerr << "Achieved " << out.precision << " precision\n";
+        if (opts.adaptive_relaxation)
+          cerr << "Final relaxation parameter " << out.relaxation << "\n";
         break;
 
     case LS_Wrong_Format:
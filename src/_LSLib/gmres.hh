@@ -0,0 +1,186 @@
+
+#ifndef GMRES_HH
+#define GMRES_HH
+
+#include "lslib.h"
+#include "debug.hh"
+#include "krylov.hh"
+#include <math.h>
+
+/**
+
+    Workhorse for restarted, preconditioned GMRES(m),
+    solving Ax=b or (if b is null) Ax=0.
+    The subspace dimension m is given by opts.krylov_dim.
+
+    The MATRIX class must provide the following methods/members:
+
+      one_over_diag[]             : negated reciprocals of diagonal elements
+      long Start()                : index of first row
+      long Stop()                 : one plus index of last row
+      long Size()                 : dimension of vectors
+      MatrixVectorMultiply(y, x)  : y += (A without diagonals) * x
+
+
+    @param  A     Matrix
+    @param  x     Vector
+    @param  b     Right-hand side, full; or null for Ax=0
+    @param  opts  options
+    @param  out   Output information
+*/
+
+template <class MATRIX>
+void New_GMRES(
+          const MATRIX &A,          // abstract matrix
+          double *x,                // solution vector
+          const double *b,          // constant vector (right side)
+          const LS_Options &opts,   // solver options
+          LS_Output &out            // performance results
+)
+{
+  out.status = LS_No_Convergence;
+  out.num_iters = 0;
+#ifdef NAN
+  out.precision = NAN;
+#endif
+  out.relaxation = 1;
+
+  const long m = (opts.krylov_dim > 0) ? opts.krylov_dim : 1;
+  const long start = A.Start();
+  const long stop = A.Stop();
+  const long size = A.Size();
+
+  //
+  // Workspace: m+1 basis vectors, plus two more
+  //
+  double* work = KrylovWorkspace(m+3, size);
+  double* V = work;
+  double* r = work + (m+1)*size;
+  double* z = work + (m+2)*size;
+  // Hessenberg matrix, by columns, and Givens rotations
+  double* H = (double*) malloc((m+1) * m * sizeof(double));
+  double* cs = (double*) malloc(m * sizeof(double));
+  double* sn = (double*) malloc(m * sizeof(double));
+  double* g = (double*) malloc((m+1) * sizeof(double));
+  if ((NULL==H) || (NULL==cs) || (NULL==sn) || (NULL==g)) {
+    free(work);
+    free(H);
+    free(cs);
+    free(sn);
+    free(g);
+    throw LS_Out_Of_Memory;
+  }
+
+  if (0==b) KrylovNormalize(x, start, stop);
+
+  long iters = 0;
+  double maxerror = 0;
+  while (iters < opts.max_iters) {
+    if (opts.debug)  DebugIter("GMRES", iters+1, x, start, stop);
+
+    //
+    // Start a cycle
+    //
+    KrylovResidual(A, b, x, r);
+    double beta = sqrt(KrylovDot(r, r, start, stop));
+    if (0==beta) {
+      maxerror = 0;
+      out.status = LS_Success;
+      break;
+    }
+    for (long s=start; s<stop; s++) V[s] = r[s] / beta;
+    g[0] = beta;
+    for (long i=1; i<=m; i++) g[i] = 0;
+
+    //
+    // Arnoldi process, with Givens rotations to keep
+    // the least-squares problem triangular
+    //
+    long k;
+    for (k=0; k<m && iters<opts.max_iters; ) {
+      double* Vk = V + k*size;
+      double* w = V + (k+1)*size;
+      double* Hk = H + k*(m+1);
+      iters++;
+
+      KrylovPrecondition(A, z, Vk);
+      KrylovMultiply(A, w, z);
+
+      // Modified Gram-Schmidt
+      for (long i=0; i<=k; i++) {
+        double* Vi = V + i*size;
+        Hk[i] = KrylovDot(w, Vi, start, stop);
+        for (long s=start; s<stop; s++) w[s] -= Hk[i] * Vi[s];
+      }
+      Hk[k+1] = sqrt(KrylovDot(w, w, start, stop));
+      bool lucky = (0==Hk[k+1]);
+      if (!lucky) {
+        for (long s=start; s<stop; s++) w[s] /= Hk[k+1];
+      }
+
+      // Apply previous rotations to the new column
+      for (long i=0; i<k; i++) {
+        double tmp = cs[i] * Hk[i] + sn[i] * Hk[i+1];
+        Hk[i+1] = -sn[i] * Hk[i] + cs[i] * Hk[i+1];
+        Hk[i] = tmp;
+      }
+      // New rotation to eliminate Hk[k+1]
+      double denom = sqrt(Hk[k] * Hk[k] + Hk[k+1] * Hk[k+1]);
+      if (0==denom) {
+        cs[k] = 1;
+        sn[k] = 0;
+      } else {
+        cs[k] = Hk[k] / denom;
+        sn[k] = Hk[k+1] / denom;
+      }
+      Hk[k] = denom;
+      Hk[k+1] = 0;
+      g[k+1] = -sn[k] * g[k];
+      g[k] = cs[k] * g[k];
+      k++;
+
+      if (lucky) break;
+      // Cheap estimate of the residual norm; the real test is below
+      if (fabs(g[k]) < opts.precision * beta) break;
+    } // for k
+
+    //
+    // Solve the triangular system for y (stored in g),
+    // then x += M^{-1} V y
+    //
+    for (long i=k-1; i>=0; i--) {
+      for (long j=i+1; j<k; j++) g[i] -= H[j*(m+1)+i] * g[j];
+      if (H[i*(m+1)+i]) g[i] /= H[i*(m+1)+i];
+      else              g[i] = 0;
+    }
+    for (long s=start; s<stop; s++) r[s] = 0;
+    for (long i=0; i<k; i++) {
+      double* Vi = V + i*size;
+      for (long s=start; s<stop; s++) r[s] += g[i] * Vi[s];
+    }
+    KrylovPrecondition(A, z, r);
+    for (long s=start; s<stop; s++) x[s] += z[s];
+    if (0==b) KrylovNormalize(x, start, stop);
+
+    //
+    // Determine current precision
+    //
+    KrylovResidual(A, b, x, r);
+    maxerror = KrylovPrecision(A, x, r, 1.0, opts);
+    if (iters < opts.min_iters) continue;
+    if (maxerror < opts.precision) {
+      out.status = LS_Success;
+      break;
+    }
+  } // while iters
+  out.num_iters = iters;
+  out.precision = maxerror;
+
+  free(work);
+  free(H);
+  free(cs);
+  free(sn);
+  free(g);
+}
+
+#endif
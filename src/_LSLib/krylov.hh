@@ -0,0 +1,136 @@
+
+#ifndef KRYLOV_HH
+#define KRYLOV_HH
+
+#include "lslib.h"
+#include <math.h>
+
+/*
+    Helpers shared by the Krylov subspace solvers.
+
+    The matrices store the off-diagonal elements, and the negated
+    reciprocals of the diagonal elements.  So, the diagonal element
+    for row s is -1/one_over_diag[s], unless one_over_diag[s] is zero,
+    in which case we treat the diagonal element as zero.
+
+    All solvers use (right) Jacobi preconditioning, i.e.,
+    M = diagonal of A, and rows with a zero diagonal are not scaled.
+*/
+
+/// Allocate a workspace of n vectors, each of dimension size.
+inline double* KrylovWorkspace(long n, long size)
+{
+  double* w = (double*) malloc(n * size * sizeof(double));
+  if (NULL==w) throw LS_Out_Of_Memory;
+  return w;
+}
+
+/// y = A x, including the diagonal.
+template <class MATRIX>
+inline void KrylovMultiply(const MATRIX &A, double* y, const double* x)
+{
+  for (long s=A.Start(); s<A.Stop(); s++) y[s] = 0;
+  A.MatrixVectorMultiply(y, x);
+  for (long s=A.Start(); s<A.Stop(); s++) {
+    if (A.one_over_diag[s]) y[s] -= x[s] / A.one_over_diag[s];
+  }
+}
+
+/// z = M^{-1} v, for the Jacobi preconditioner.
+template <class MATRIX>
+inline void KrylovPrecondition(const MATRIX &A, double* z, const double* v)
+{
+  for (long s=A.Start(); s<A.Stop(); s++) {
+    if (A.one_over_diag[s])   z[s] = -v[s] * A.one_over_diag[s];
+    else                      z[s] = v[s];
+  }
+}
+
+/// r = b - A x.  If b is null, we use b = 0.
+template <class MATRIX>
+inline void KrylovResidual(const MATRIX &A, const double* b,
+  const double* x, double* r)
+{
+  KrylovMultiply(A, r, x);
+  if (b) {
+    for (long s=A.Start(); s<A.Stop(); s++) r[s] = b[s] - r[s];
+  } else {
+    for (long s=A.Start(); s<A.Stop(); s++) r[s] = -r[s];
+  }
+}
+
+/// Inner product of x and y.
+inline double KrylovDot(const double* x, const double* y, long start, long stop)
+{
+  double sum = 0;
+  for (long s=start; s<stop; s++) sum += x[s] * y[s];
+  return sum;
+}
+
+/**
+    Is the inner product (x,y) too small, compared with the norms of
+    x and y, to be trusted?  Used to detect (near) breakdowns of
+    the Lanczos-type methods.
+*/
+inline bool KrylovBreakdown(double dot, const double* x, const double* y,
+  long start, long stop)
+{
+  double xx = KrylovDot(x, x, start, stop);
+  double yy = KrylovDot(y, y, start, stop);
+  return fabs(dot) <= 1e-14 * sqrt(xx * yy);
+}
+
+/// Sum of elements of x.
+inline double KrylovSum(const double* x, long start, long stop)
+{
+  double sum = 0;
+  for (long s=start; s<stop; s++) sum += x[s];
+  return sum;
+}
+
+/**
+    Precision of the current solution, given its residual.
+    We use the change that one Jacobi step would make to the solution,
+    so that the precision means the same thing as for the other solvers.
+    For Ax=0 the solution is not normalized yet, so scale should be
+    one over the sum of the elements of x; otherwise it should be 1.
+*/
+template <class MATRIX>
+inline double KrylovPrecision(const MATRIX &A, const double* x,
+  const double* r, double scale, const LS_Options &opts)
+{
+  double maxerror = 0;
+  for (long s=A.Start(); s<A.Stop(); s++) {
+    double delta = r[s] * scale;
+    if (A.one_over_diag[s]) delta *= A.one_over_diag[s];
+    if (opts.use_relative) if (x[s]) delta /= x[s] * scale;
+    if (delta<0) delta = -delta;
+    if (delta > maxerror) maxerror = delta;
+  }
+  return maxerror;
+}
+
+/**
+    Build the full, dense right-hand side b, from a VECTOR class
+    that provides CopyNegativeToFull().  Caller must free() the result.
+*/
+template <class MATRIX, class VECTOR>
+inline double* KrylovRHS(const MATRIX &A, const VECTOR &b)
+{
+  double* full = KrylovWorkspace(1, A.Size());
+  for (long s=A.Start(); s<A.Stop(); s++) full[s] = 0;
+  b.CopyNegativeToFull(full, A.Start(), A.Stop());
+  for (long s=A.Start(); s<A.Stop(); s++) full[s] = -full[s];
+  return full;
+}
+
+/// Normalize x so its elements sum to one.
+inline void KrylovNormalize(double* x, long start, long stop)
+{
+  double total = KrylovSum(x, start, stop);
+  if (0==total) return;
+  total = 1.0 / total;
+  for (long s=start; s<stop; s++) x[s] *= total;
+}
+
+#endif
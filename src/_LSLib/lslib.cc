@@ -6,6 +6,12 @@
 #include <string.h>
 #include <assert.h>
 
+#include <new>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <vector>
+
 /// Standard MIN "macro".
 template <class T> inline T MIN(T X,T Y) { return ((X<Y)?X:Y); }
 /// Standard MAX "macro".
@@ -23,8 +29,17 @@ template <class T> inline T MAX(T X,T Y) { return ((X>Y)?X:Y); }
 #include "row_jac_axb.hh"
 #include "vmm_jac_axb.hh"
 
+#include "par_jac_ax0.hh"
+#include "par_jac_axb.hh"
+
+#include "gmres.hh"
+#include "bicgstab.hh"
+#include "cgs.hh"
+
+#include "block.hh"
+
 const int MAJOR_VERSION = 2;
-const int MINOR_VERSION = 1;
+const int MINOR_VERSION = 5;
 
 // ******************************************************************
 // *                                                                *
@@ -59,6 +74,150 @@ void LS_Generic_Matrix::RowDotProduct(long, const double*, double &) const
   throw LS_Wrong_Format;
 }
 
+void LS_Generic_Matrix::BlockRowDotProduct(long, long, long, 
+  const double*, const double*, double &) const
+{
+  throw LS_Wrong_Format;
+}
+
+
+
+// ******************************************************************
+// *                                                                *
+// *                       LS_Workers methods                       *
+// *                                                                *
+// ******************************************************************
+
+struct LS_Workers::pool {
+  std::vector <std::thread> threads;
+  std::mutex lock;
+  std::condition_variable start;
+  std::condition_variable done;
+  /// Current job
+  const std::function<void(int)>* job;
+  /// Incremented for each new job
+  long generation;
+  /// Number of worker threads still running the current job
+  int busy;
+  /// Set when the threads should exit
+  bool quit;
+  /// Did any thread throw an error?
+  bool failed;
+  LS_Error error;
+
+  inline void runJob(const std::function<void(int)> &J, int t) {
+    try {
+      J(t);
+    }
+    catch (LS_Error e) {
+      std::lock_guard <std::mutex> L(lock);
+      if (!failed) error = e;
+      failed = true;
+    }
+    catch (std::bad_alloc &) {
+      std::lock_guard <std::mutex> L(lock);
+      if (!failed) error = LS_Out_Of_Memory;
+      failed = true;
+    }
+  }
+};
+
+LS_Workers::LS_Workers(int n)
+{
+  nthreads = (n>1) ? n : 1;
+  P = new pool;
+  P->job = 0;
+  P->generation = 0;
+  P->busy = 0;
+  P->quit = false;
+  P->failed = false;
+  P->error = LS_Success;
+  for (int t=1; t<nthreads; t++) {
+    P->threads.push_back(std::thread(Worker, P, t));
+  }
+}
+
+LS_Workers::~LS_Workers()
+{
+  {
+    std::lock_guard <std::mutex> L(P->lock);
+    P->quit = true;
+  }
+  P->start.notify_all();
+  for (unsigned i=0; i<P->threads.size(); i++) {
+    P->threads[i].join();
+  }
+  delete P;
+}
+
+void LS_Workers::Partition(long start, long stop, const long* row_ptr, 
+  long* bounds) const
+{
+  bounds[0] = start;
+  bounds[nthreads] = stop;
+  if (0==row_ptr) {
+    for (int t=1; t<nthreads; t++) {
+      bounds[t] = start + ((stop-start) * t) / nthreads;
+    }
+    return;
+  }
+  //
+  // Weight of a row is its number of nonzeroes, plus one
+  // for the per-row overhead (diagonal, convergence check).
+  //
+  const double total = (row_ptr[stop] - row_ptr[start]) + (stop - start);
+  long r = start;
+  for (int t=1; t<nthreads; t++) {
+    const double target = (total * t) / nthreads;
+    while (r < stop) {
+      double w = (row_ptr[r] - row_ptr[start]) + (r - start);
+      if (w >= target) break;
+      r++;
+    }
+    bounds[t] = r;
+  }
+}
+
+void LS_Workers::Run(const std::function<void(int)> &job)
+{
+  if (1==nthreads) {
+    job(0);
+    return;
+  }
+  {
+    std::lock_guard <std::mutex> L(P->lock);
+    P->job = &job;
+    P->busy = nthreads-1;
+    P->failed = false;
+    P->generation++;
+  }
+  P->start.notify_all();
+
+  P->runJob(job, 0);
+
+  std::unique_lock <std::mutex> L(P->lock);
+  while (P->busy) P->done.wait(L);
+  P->job = 0;
+  if (P->failed) throw P->error;
+}
+
+void LS_Workers::Worker(pool* P, int t)
+{
+  long seen = 0;
+  std::unique_lock <std::mutex> L(P->lock);
+  for (;;) {
+    while (!P->quit && P->generation == seen) P->start.wait(L);
+    if (P->quit) return;
+    seen = P->generation;
+    const std::function<void(int)>* J = P->job;
+    L.unlock();
+
+    P->runJob(*J, t);
+
+    L.lock();
+    if (0 == --P->busy) P->done.notify_one();
+  }
+}
 
 
 // ******************************************************************
@@ -107,6 +266,10 @@ void Ax0_Solver(const MATRIX &A, double *x, const LS_Options &opts, LS_Output &o
         return;    
 
     case LS_Row_Jacobi:
+        if (opts.num_threads > 1) {
+            Par_RowJacobi_Ax0(A, x, opts, out);
+            return;
+        }
         if (opts.float_vectors) {
             fold = (float*) malloc(A.Size() * sizeof(float));
             if (NULL==fold) throw LS_Out_Of_Memory;
@@ -136,6 +299,35 @@ void Ax0_Solver(const MATRIX &A, double *x, const LS_Options &opts, LS_Output &o
         }
         return;    
 
+    case LS_GMRES:
+        New_GMRES(A, x, (const double*) 0, opts, out);
+        return;
+
+    case LS_BiCGSTAB:
+        New_BiCGSTAB(A, x, (const double*) 0, opts, out);
+        return;
+
+    case LS_CGS:
+        New_CGS(A, x, (const double*) 0, opts, out);
+        return;
+
+    case LS_Block_Gauss_Seidel:
+    case LS_Block_Jacobi:
+        dold = (double*) malloc(A.Size() * sizeof(double));
+        if (NULL==dold) throw LS_Out_Of_Memory;
+        try {
+          if (LS_Block_Jacobi == opts.method)
+              New_Block<true>(A, x, (const double*) 0, dold, opts, out);
+          else
+              New_Block<false>(A, x, (const double*) 0, dold, opts, out);
+        }
+        catch (LS_Error e) {
+          free(dold);
+          throw e;
+        }
+        free(dold);
+        return;
+
     default:
         out.status = LS_Not_Implemented;
         return;
@@ -181,6 +373,10 @@ void Axb_Solver(const MATRIX &A, double *x, const VECTOR &b,
         return;    
 
     case LS_Row_Jacobi:
+        if (opts.num_threads > 1) {
+            Par_RowJacobi_Axb(A, x, b, opts, out);
+            return;
+        }
         if (opts.float_vectors) {
             fold = (float*) malloc(A.Size() * sizeof(float));
             if (NULL==fold) throw LS_Out_Of_Memory;
@@ -208,6 +404,48 @@ void Axb_Solver(const MATRIX &A, double *x, const VECTOR &b,
         }
         return;    
 
+    case LS_GMRES:
+    case LS_BiCGSTAB:
+    case LS_CGS:
+        {
+          double* bfull = KrylovRHS(A, b);
+          try {
+            if (LS_GMRES == opts.method)
+                New_GMRES(A, x, bfull, opts, out);
+            else if (LS_BiCGSTAB == opts.method)
+                New_BiCGSTAB(A, x, bfull, opts, out);
+            else
+                New_CGS(A, x, bfull, opts, out);
+          }
+          catch (LS_Error e) {
+            free(bfull);
+            throw e;
+          }
+          free(bfull);
+        }
+        return;
+
+    case LS_Block_Gauss_Seidel:
+    case LS_Block_Jacobi:
+        dold = (double*) malloc(2 * A.Size() * sizeof(double));
+        if (NULL==dold) throw LS_Out_Of_Memory;
+        try {
+          // second half holds the negated right-hand side
+          double* bneg = dold + A.Size();
+          for (long s=A.Start(); s<A.Stop(); s++) bneg[s] = 0;
+          b.CopyNegativeToFull(bneg, A.Start(), A.Stop());
+          if (LS_Block_Jacobi == opts.method)
+              New_Block<true>(A, x, bneg, dold, opts, out);
+          else
+              New_Block<false>(A, x, bneg, dold, opts, out);
+        }
+        catch (LS_Error e) {
+          free(dold);
+          throw e;
+        }
+        free(dold);
+        return;
+
     default:
         out.status = LS_Illegal_Method;
         return;
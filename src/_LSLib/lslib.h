@@ -6,6 +6,8 @@
 #ifndef LSLIB_H
 #define LSLIB_H
 
+#include <functional>
+
 ///  Specific linear solution types.
 enum LS_Method {
   /**  Power method.
@@ -20,9 +22,31 @@ enum LS_Method {
   LS_Jacobi,
 
   ///  Gauss-Seidel method.
-  LS_Gauss_Seidel
+  LS_Gauss_Seidel,
+
+  /**  Restarted GMRES, with Jacobi preconditioning.
+       Subspace dimension is given by LS_Options::krylov_dim.
+  */
+  LS_GMRES,
+
+  ///  BiCGSTAB, with Jacobi preconditioning.
+  LS_BiCGSTAB,
+
+  ///  Conjugate Gradient Squared, with Jacobi preconditioning.
+  LS_CGS,
 
-  // other, fancy methods?  block methods?
+  /**  Block Gauss-Seidel.
+       Blocks are given by LS_Options::blocks or LS_Options::block_size,
+       and are solved by (at most LS_Options::inner_iters) inner
+       Gauss-Seidel iterations.
+  */
+  LS_Block_Gauss_Seidel,
+
+  /**  Block Jacobi.
+       Same as block Gauss-Seidel, except that all blocks use the
+       previous iterate, so blocks may be solved in parallel.
+  */
+  LS_Block_Jacobi
 };
 
 
@@ -63,6 +87,11 @@ struct LS_Options {
   bool use_relaxation;
   /// (Initial) relaxation parameter to use.
   double relaxation;
+  /** Adjust the relaxation parameter, based on the observed rate
+      of convergence?  Currently, only for Gauss-Seidel,
+      and only if use_relaxation is set.
+  */
+  bool adaptive_relaxation;
   /// Number of iterations before checking for convergence.
   long min_iters;
   /// Maximum number of iterations.
@@ -71,6 +100,35 @@ struct LS_Options {
   bool use_relative;
   /// Desired precision
   double precision;
+  /** Number of threads to use, for solvers that support it.
+      Currently, only Row Jacobi uses more than one thread.
+  */
+  int num_threads;
+  /** Dimension of the Krylov subspace, for restarted methods (GMRES).
+      Krylov methods always use double auxiliary vectors.
+  */
+  long krylov_dim;
+  /** Block structure, for the block methods.
+      Block i contains rows blocks[i] up to (but not including)
+      blocks[i+1], for 0 <= i < num_blocks.  Blocks are clipped to
+      the rows of the matrix, so a partition of all states can be used
+      when solving for a subset of them.
+      If null, blocks are consecutive groups of block_size rows.
+  */
+  const long* blocks;
+  /// Number of blocks in array blocks.
+  long num_blocks;
+  /// Rows per block, if blocks is null.
+  long block_size;
+  /// Maximum number of inner iterations per block, for the block methods.
+  long inner_iters;
+  /** For the block methods and Ax=0: use iterative aggregation /
+      disaggregation between outer iterations?  Very effective for
+      nearly-decomposable chains, if the blocks follow the decomposition.
+      Needs memory for a dense matrix with one row and column per block,
+      and is (silently) skipped unless the matrix is stored by rows.
+  */
+  bool aggregate;
 public:
   /// Constructor.  Allows us to set reasonable defaults.
   LS_Options() {
@@ -79,10 +137,18 @@ public:
     float_vectors = 0;
     use_relaxation = 0;
     relaxation = 1.0;
+    adaptive_relaxation = 0;
     min_iters = 10;
     max_iters = 10000;
     use_relative = 1;
     precision = 1e-6;
+    num_threads = 1;
+    krylov_dim = 20;
+    blocks = 0;
+    num_blocks = 0;
+    block_size = 64;
+    inner_iters = 10;
+    aggregate = 0;
   }
 };
 
@@ -190,6 +256,18 @@ public:
       }
   }
 
+  /**
+      Compute sum += (row i of this matrix without diagonals) * x,
+      where x is xin for columns in [lo, hi), and xout otherwise.
+  */
+  inline void BlockRowDotProduct(long i, long lo, long hi, 
+    const double* xin, const double* xout, double &sum) const {
+      for (long a = row_ptr[i]; a < row_ptr[i+1]; a++) {
+        const long j = col_ind[a];
+        sum += ((j >= lo && j < hi) ? xin[j] : xout[j]) * val[a];
+      }
+  }
+
 };
 
 
@@ -265,6 +343,11 @@ public:
   inline void RowDotProduct(long i, const REAL2* x, double &sum) const {
     throw LS_Wrong_Format;
   }
+
+  inline void BlockRowDotProduct(long i, long lo, long hi, 
+    const double* xin, const double* xout, double &sum) const {
+    throw LS_Wrong_Format;
+  }
 };
 
 
@@ -331,6 +414,60 @@ public:
       If we cannot, then throw LS_Wrong_Format (default behavior).
   */
   virtual void RowDotProduct(long i, const double* x, double &sum) const;
+
+  /**
+      Compute sum += (row i of this matrix without diagonals) * x,
+      where x is xin for columns in [lo, hi), and xout otherwise.
+      Needed only for the block methods.
+      If we cannot, then throw LS_Wrong_Format (default behavior).
+  */
+  virtual void BlockRowDotProduct(long i, long lo, long hi, 
+    const double* xin, const double* xout, double &sum) const;
+};
+
+
+
+/**
+    Pool of worker threads, used by the multi-threaded solvers
+    but also available to applications (e.g., for uniformization).
+    Threads are started by the constructor and kept until
+    the destructor, so a solver pays for them once, 
+    not once per iteration.
+*/
+class LS_Workers {
+public:
+  /// Start the threads.  Thread 0 is always the calling thread.
+  LS_Workers(int nthreads);
+  ~LS_Workers();
+
+  inline int NumThreads() const { return nthreads; }
+
+  /**
+      Split rows [start, stop) into NumThreads() consecutive blocks,
+      each with about the same number of nonzeroes.
+        @param  start   First row.
+        @param  stop    One plus the last row.
+        @param  row_ptr Row pointers, as in LS_CRS_Matrix.
+                        If null, the rows are split evenly.
+        @param  bounds  Output: thread t gets rows bounds[t] 
+                        up to (but not including) bounds[t+1].
+                        Dimension must be at least NumThreads()+1.
+  */
+  void Partition(long start, long stop, const long* row_ptr, long* bounds) const;
+
+  /**
+      Run job(t) for t=0, ..., NumThreads()-1, in parallel.
+      Returns once all threads have finished.
+      If any job throws an LS_Error, it is thrown again here.
+  */
+  void Run(const std::function<void(int)> &job);
+
+private:
+  struct pool;
+  static void Worker(pool* P, int t);
+private:
+  int nthreads;
+  pool* P;
 };
 
 
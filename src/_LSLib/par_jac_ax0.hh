@@ -0,0 +1,190 @@
+
+#ifndef PAR_JAC_AX0_HH
+#define PAR_JAC_AX0_HH
+
+#include "lslib.h"
+#include "debug.hh"
+#include "partition.hh"
+#include <math.h>
+
+/**
+
+    Workhorse for multi-threaded Row Jacobi solving Ax=0.
+    Each thread handles one consecutive block of rows.
+
+    The MATRIX class must provide the following methods/members:
+      
+      one_over_diag[]           : negated reciprocals of diagonal elements
+      long Start()              : index of first row
+      long Stop()               : one plus index of last row
+      RowDotProduct(r, x, ans)  : Row r times x is added to ans
+
+    and RowDotProduct must be safe to call from several threads at once.
+
+
+    @param  A       Matrix
+    @param  xnew    Vector
+    @param  xold    Auxiliary vector
+    @param  W       Worker threads
+    @param  bounds  Rows for each thread, see LS_Workers::Partition()
+    @param  opts    options
+    @param  out     Output information
+*/
+
+template <bool RELAX, class MATRIX, class REAL>
+void New_ParRowJacobi_Ax0(
+          const MATRIX &A,          // abstract matrix
+          double *xnew,             // solution vector
+          REAL *xold,               // auxiliary vector
+          LS_Workers &W,            // threads
+          const long* bounds,       // rows per thread
+          const LS_Options &opts,   // solver options
+          LS_Output &out            // performance results
+)
+{
+  out.status = LS_No_Convergence;
+  out.num_iters = 0;
+#ifdef NAN
+  out.precision = NAN;
+#endif
+  double one_minus_omega;
+  if (RELAX) {
+    out.relaxation = opts.relaxation;
+    one_minus_omega = 1.0 - opts.relaxation;
+  } else {
+    out.relaxation = 1;
+    one_minus_omega = 0;
+  }
+  long iters;
+  double maxerror = 0;
+  double total = 1;
+  bool check = false;
+
+  // Per-thread totals and errors
+  double* totals = new double[W.NumThreads()];
+  double* errors = new double[W.NumThreads()];
+
+  //
+  // Copy xnew into xold
+  //
+  W.Run([&](int t) {
+    for (long s=bounds[t]; s<bounds[t+1]; s++) {
+      xold[s] = xnew[s];
+    }
+  });
+
+  for (iters=1; iters<=opts.max_iters; iters++) {
+    if (opts.debug)  DebugIter("Row Jacobi", iters, xnew, A.Start(), A.Stop());
+
+    //
+    // Compute the new vector, totals, and precision
+    //
+    check = (iters >= opts.min_iters);
+    W.Run([&](int t) {
+      double my_total = 0.0;
+      double my_error = 0.0;
+      for (long s=bounds[t]; s<bounds[t+1]; s++) {
+        double tmp = 0.0;
+        A.RowDotProduct(s, xold, tmp);
+
+        if (RELAX) {
+          tmp *= A.one_over_diag[s] * opts.relaxation;
+          tmp += xold[s] * one_minus_omega;
+        } else {
+          tmp *= A.one_over_diag[s];
+        }
+
+        my_total += (xnew[s] = tmp);
+
+        if (check) {
+          double delta = tmp - xold[s];
+          if (opts.use_relative) if (tmp) delta /= tmp;
+          if (delta<0) delta = -delta;
+          if (delta > my_error) my_error = delta;
+        }
+      } // for s
+      totals[t] = my_total;
+      errors[t] = my_error;
+    });
+
+    total = 0.0;
+    maxerror = 0;
+    for (int t=0; t<W.NumThreads(); t++) {
+      total += totals[t];
+      if (errors[t] > maxerror) maxerror = errors[t];
+    }
+
+    //
+    // Normalize and copy vector over
+    //
+    total = 1.0 / total;
+    W.Run([&](int t) {
+      for (long s=bounds[t]; s<bounds[t+1]; s++) {
+        xold[s] = xnew[s] * total;
+      }
+    });
+
+    if (iters < opts.min_iters) continue;
+    if (maxerror < opts.precision) {
+      out.status = LS_Success;
+      break;
+    }
+  } // for iters
+  out.num_iters = iters;
+  out.precision = maxerror;
+
+  //
+  // Normalize answer
+  //
+  W.Run([&](int t) {
+    for (long s=bounds[t]; s<bounds[t+1]; s++) {
+      xnew[s] *= total;
+    }
+  });
+
+  delete[] totals;
+  delete[] errors;
+}
+
+
+/**
+    Set up threads and auxiliary vector, 
+    then call the multi-threaded Row Jacobi workhorse for Ax=0.
+*/
+template <class MATRIX>
+void Par_RowJacobi_Ax0(const MATRIX &A, double *x, const LS_Options &opts, 
+  LS_Output &out)
+{
+  LS_Workers W(opts.num_threads);
+  long* bounds = new long[W.NumThreads()+1];
+  PartitionRows(A, W, bounds);
+
+  if (opts.float_vectors) {
+      float* fold = (float*) malloc(A.Size() * sizeof(float));
+      if (NULL==fold) {
+        delete[] bounds;
+        throw LS_Out_Of_Memory;
+      }
+      if (opts.use_relaxation) {
+          New_ParRowJacobi_Ax0<true>(A, x, fold, W, bounds, opts, out);
+      } else {
+          New_ParRowJacobi_Ax0<false>(A, x, fold, W, bounds, opts, out);
+      }
+      free(fold);
+  } else { 
+      double* dold = (double*) malloc(A.Size() * sizeof(double));
+      if (NULL==dold) {
+        delete[] bounds;
+        throw LS_Out_Of_Memory;
+      }
+      if (opts.use_relaxation) {
+          New_ParRowJacobi_Ax0<true>(A, x, dold, W, bounds, opts, out);
+      } else {
+          New_ParRowJacobi_Ax0<false>(A, x, dold, W, bounds, opts, out);
+      }
+      free(dold);
+  } 
+  delete[] bounds;
+}
+
+#endif
@@ -0,0 +1,27 @@
+
+#ifndef PARTITION_HH
+#define PARTITION_HH
+
+#include "lslib.h"
+
+// Split matrix rows among threads, by nonzeroes when we can see them.
+
+template <class MATRIX>
+inline void PartitionRows(const MATRIX &A, const LS_Workers &W, long* bounds)
+{
+  W.Partition(A.Start(), A.Stop(), 0, bounds);
+}
+
+inline void PartitionRows(const LS_CRS_Matrix_float &A, const LS_Workers &W, 
+  long* bounds)
+{
+  W.Partition(A.Start(), A.Stop(), A.row_ptr, bounds);
+}
+
+inline void PartitionRows(const LS_CRS_Matrix_double &A, const LS_Workers &W,
+  long* bounds)
+{
+  W.Partition(A.Start(), A.Stop(), A.row_ptr, bounds);
+}
+
+#endif
@@ -0,0 +1,122 @@
+
+#ifndef RELAX_HH
+#define RELAX_HH
+
+#include "lslib.h"
+#include <math.h>
+
+/**
+    Adjusts the relaxation parameter omega for SOR,
+    based on the observed rate of convergence.
+
+    After each change of omega, we let the iteration settle for a
+    window of iterations, then estimate the spectral radius lambda
+    of the SOR iteration matrix from the decrease of the change
+    between iterates over the next window.  From lambda and the
+    current omega, Young's relation
+        (lambda + omega - 1)^2 = lambda omega^2 mu^2
+    gives an estimate of the spectral radius mu of the Jacobi
+    iteration matrix, and the optimal omega is then
+        2 / (1 + sqrt(1 - mu^2)).
+
+    That relation holds only for consistently ordered matrices,
+    which Markov chains rarely are, so we are careful: omega grows
+    by small steps, and as soon as a new omega converges more slowly
+    than the previous one, we go back to the previous one and stop
+    adjusting.  If the initial omega barely converges, we start over
+    (once) from plain Gauss-Seidel.
+*/
+class relaxation_tuner {
+    /// Current relaxation parameter.
+    double omega;
+    /// Previous relaxation parameter.
+    double last_omega;
+    /// Observed rate of the previous relaxation parameter.
+    double last_rate;
+    /// Norm of the change at the start of the measuring window.
+    double first_norm;
+    /// Number of iterations since omega was last changed.
+    int count;
+    /// Still adjusting?
+    bool active;
+    /// Did we already start over from Gauss-Seidel?
+    bool restarted;
+
+    /// Length of a window, in iterations.
+    static const int window = 10;
+  public:
+    relaxation_tuner(double w) {
+      omega = w;
+      last_omega = w;
+      last_rate = 1;
+      first_norm = 0;
+      count = 0;
+      active = true;
+      restarted = false;
+    }
+
+    inline double Omega() const { return omega; }
+
+    /**
+        Should be called at the end of each iteration, with the
+        (absolute, 1-) norm of the change made by that iteration.
+        Returns true if omega was changed.
+    */
+    inline bool Update(double norm) {
+      // Largest omega we will try, and largest change at once.
+      const double max_omega = 1.95;
+      const double max_step = 0.2;
+      // Rates above this are too slow to count as converging.
+      const double stalled = 0.999;
+
+      if (!active) return false;
+      count++;
+      if (count == window) first_norm = norm;
+      if (count < 2*window) return false;
+      count = 0;
+
+      if (0==first_norm || 0==norm) {
+        active = false;
+        return false;
+      }
+      double rate = pow(norm / first_norm, 1.0 / window);
+
+      if (rate >= last_rate) {
+        if (!restarted && (omega != 1) &&
+            ((omega == last_omega) || (last_rate > stalled)))
+        {
+          // Initial omega is (almost) not converging;
+          // start over from Gauss-Seidel
+          restarted = true;
+          omega = 1;
+          last_omega = 1;
+          last_rate = 1;
+          return true;
+        }
+        // No improvement; settle on the previous omega
+        active = false;
+        if (omega == last_omega) return false;
+        omega = last_omega;
+        return true;
+      }
+      last_rate = rate;
+      last_omega = omega;
+
+      double mu2 = (rate + omega - 1);
+      mu2 *= mu2 / (rate * omega * omega);
+      double w;
+      if (mu2 >= 1) w = max_omega;
+      else          w = 2.0 / (1.0 + sqrt(1.0 - mu2));
+      if (w > omega + max_step) w = omega + max_step;
+      if (w > max_omega) w = max_omega;
+      if (w < 1) w = 1;
+      if (fabs(w - omega) < 0.01) {
+        active = false;
+        return false;
+      }
+      omega = w;
+      return true;
+    }
+};
+
+#endif
@@ -4,6 +4,7 @@
 
 #include "lslib.h"
 #include "debug.hh"
+#include "relax.hh"
 #include <math.h>
 
 /**
@@ -37,19 +38,23 @@ void New_RowGS_Ax0(
 #ifdef NAN
   out.precision = NAN;
 #endif
+  double omega;
   double one_minus_omega;
   if (RELAX) {
-    out.relaxation = opts.relaxation;
+    omega = opts.relaxation;
     one_minus_omega = 1.0 - opts.relaxation;
   } else {
-    out.relaxation = 1;
+    omega = 1;
     one_minus_omega = 0;
   }
+  const bool adapt = RELAX && opts.adaptive_relaxation;
+  relaxation_tuner tuner(omega);
   long iters;
   double maxerror = 0;
   for (iters=1; iters<=opts.max_iters; iters++) {
     if (opts.debug)  DebugIter("Gauss-Seidel", iters, x, A.Start(), A.Stop());
     maxerror = 0;
+    double change = 0;
     double total = 0;
     bool check = (iters >= opts.min_iters);
     for (long s=A.Start(); s<A.Stop(); s++) {
@@ -58,7 +63,7 @@ void New_RowGS_Ax0(
       A.RowDotProduct(s, x, tmp);
 
       if (RELAX) {
-        tmp *= A.one_over_diag[s] * opts.relaxation;
+        tmp *= A.one_over_diag[s] * omega;
         tmp += x[s] * one_minus_omega;
       } else {
         tmp *= A.one_over_diag[s];
@@ -66,6 +71,7 @@ void New_RowGS_Ax0(
 
       double delta = tmp - x[s];
       x[s] = tmp;
+      if (adapt) change += fabs(delta);
       total += x[s];
 
       if (check) {
@@ -87,6 +93,11 @@ void New_RowGS_Ax0(
       for (long s=A.Stop()-1; s>=A.Start(); s--) x[s] *= total;
     }
 
+    if (adapt) if (tuner.Update(change)) {
+      omega = tuner.Omega();
+      one_minus_omega = 1.0 - omega;
+    }
+
     if (iters < opts.min_iters) continue;
     if (maxerror < opts.precision) {
       out.status = LS_Success;
@@ -94,6 +105,7 @@ void New_RowGS_Ax0(
     }
   } // for iters
   out.num_iters = iters;
+  out.relaxation = omega;
   out.precision = maxerror;
 }
 
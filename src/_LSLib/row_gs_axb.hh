@@ -4,6 +4,7 @@
 
 #include "lslib.h"
 #include "debug.hh"
+#include "relax.hh"
 #include "vectors.hh"
 #include <math.h>
 
@@ -49,14 +50,17 @@ void New_RowGS_Axb(
 #ifdef NAN
   out.precision = NAN;
 #endif
+  double omega;
   double one_minus_omega;
   if (RELAX) {
-    out.relaxation = opts.relaxation;
+    omega = opts.relaxation;
     one_minus_omega = 1.0 - opts.relaxation;
   } else {
-    out.relaxation = 1;
+    omega = 1;
     one_minus_omega = 0;
   }
+  const bool adapt = RELAX && opts.adaptive_relaxation;
+  relaxation_tuner tuner(omega);
   long iters;
   double maxerror = 0;
   long bstart;
@@ -65,6 +69,7 @@ void New_RowGS_Axb(
   for (iters=1; iters<=opts.max_iters; iters++) {
     if (opts.debug)  DebugIter("Gauss-Seidel", iters, x, A.Start(), A.Stop());
     maxerror = 0;
+    double change = 0;
     long bp = bstart;
     bool check = (iters >= opts.min_iters);
     for (long s=A.Start(); s<A.Stop(); s++) {
@@ -73,7 +78,7 @@ void New_RowGS_Axb(
       A.RowDotProduct(s, x, tmp);
 
       if (RELAX) {
-        tmp *= A.one_over_diag[s] * opts.relaxation;
+        tmp *= A.one_over_diag[s] * omega;
         tmp += x[s] * one_minus_omega;
       } else {
         tmp *= A.one_over_diag[s];
@@ -82,6 +87,7 @@ void New_RowGS_Axb(
       double delta = tmp - x[s];
       delta = tmp - x[s];
       x[s] = tmp;
+      if (adapt) change += fabs(delta);
 
       if (check) {
         if (opts.use_relative) if (x[s]) delta /= x[s];
@@ -96,6 +102,11 @@ void New_RowGS_Axb(
 
     } // for s
 
+    if (adapt) if (tuner.Update(change)) {
+      omega = tuner.Omega();
+      one_minus_omega = 1.0 - omega;
+    }
+
     if (iters < opts.min_iters) continue;
     if (maxerror < opts.precision) {
       out.status = LS_Success;
@@ -103,6 +114,7 @@ void New_RowGS_Axb(
     }
   } // for iters
   out.num_iters = iters;
+  out.relaxation = omega;
   out.precision = maxerror;
 }
 
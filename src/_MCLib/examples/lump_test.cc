@@ -0,0 +1,199 @@
+
+/*
+    Tests for lumping
+*/
+
+#include <iostream>
+#include <string.h>
+#include "mcbuilder.h"
+
+// #define VERBOSE
+
+using namespace GraphLib;
+using namespace std;
+using namespace MCLib;
+
+// ==============================> Graph 1 <==============================
+
+/*
+  Three identical servers, each fails with rate 1 and is repaired
+  with rate 2.  State i has bit k set iff server k is up.
+  Lumps into 4 states: number of servers up.
+*/
+const edge graph1[] = {
+  // failures
+  {1, 0, 1}, {2, 0, 1}, {4, 0, 1},
+  {3, 2, 1}, {3, 1, 1},
+  {5, 4, 1}, {5, 1, 1},
+  {6, 4, 1}, {6, 2, 1},
+  {7, 6, 1}, {7, 5, 1}, {7, 3, 1},
+  // repairs
+  {0, 1, 2}, {0, 2, 2}, {0, 4, 2},
+  {2, 3, 2}, {1, 3, 2},
+  {4, 5, 2}, {1, 5, 2},
+  {4, 6, 2}, {2, 6, 2},
+  {6, 7, 2}, {5, 7, 2}, {3, 7, 2},
+  // End
+  {-1, -1, -1}
+};
+
+const long num_nodes1 = 8;
+
+// All servers up; this is also the initial state
+const long key1[] = {0, 0, 0, 0, 0, 0, 0, 1};
+const double init1[] = {0, 0, 0, 0, 0, 0, 0, 1};
+const long blocks1 = 4;
+
+// =======================================================================
+
+void show_vector(const char* name, const double* x, long size)
+{
+  cout << "  " << name << ": [" << x[0];
+  for (long i=1; i<size; i++) cout << ", " << x[i];
+  cout << "]\n";
+}
+
+// =======================================================================
+
+bool run_test(const char* name, bool discrete, bool exact,
+  const edge graph[], const long num_nodes, const long key[],
+  const double init[], const long num_blocks, double time)
+{
+#ifdef VERBOSE
+  const bool verbose = true;
+#else
+  const bool verbose = false;
+#endif
+
+  cout << "Testing " << (exact ? "exact" : "ordinary") << " lumping of ";
+  cout << (discrete ? "DTMC " : "CTMC ") << name << " at time " << time << "\n";
+
+  Markov_chain* MC = build_double(discrete, graph, num_nodes, verbose);
+
+  long* map = new long[num_nodes];
+  Markov_chain::lumping_options lopt;
+  lopt.exact = exact;
+  Markov_chain* L = 0;
+  try {
+    L = MC->lump(key, map, lopt, 0);
+  }
+  catch (MCLib::error e) {
+    cout << "    Caught Markov chain library error: ";
+    cout << e.getString() << "\n";
+    return false;
+  }
+  if (0==L) {
+    cout << "  Nothing lumped!\n";
+    return false;
+  }
+  cout << "  Lumped " << num_nodes << " states into ";
+  cout << L->getNumStates() << " using " << lopt.splitters << " splitters\n";
+  if (L->getNumStates() != num_blocks) {
+    cout << "  Expected " << num_blocks << " states\n";
+    return false;
+  }
+
+  //
+  // Solve both chains
+  //
+  double* full = new double[num_nodes];
+  memcpy(full, init, num_nodes*sizeof(double));
+  double* lumped = new double[num_blocks];
+  for (long b=0; b<num_blocks; b++) lumped[b] = 0;
+  for (long s=0; s<num_nodes; s++) lumped[map[s]] += init[s];
+
+  try {
+    if (discrete) {
+      Markov_chain::DTMC_transient_options opt;
+      MC->computeTransient(int(time), full, opt);
+      L->computeTransient(int(time), lumped, opt);
+    } else {
+      Markov_chain::CTMC_transient_options opt;
+      MC->computeTransient(time, full, opt);
+      L->computeTransient(time, lumped, opt);
+    }
+  }
+  catch (MCLib::error e) {
+    cout << "    Caught Markov chain library error: ";
+    cout << e.getString() << "\n";
+    return false;
+  }
+
+  //
+  // Compare block probabilities, and for exact lumping,
+  // state probabilities
+  //
+  double* sums = new double[num_blocks];
+  long* sizes = new long[num_blocks];
+  for (long b=0; b<num_blocks; b++) {
+    sums[b] = 0;
+    sizes[b] = 0;
+  }
+  for (long s=0; s<num_nodes; s++) {
+    sums[map[s]] += full[s];
+    sizes[map[s]]++;
+  }
+  show_vector("Full   solution", full, num_nodes);
+  show_vector("Summed solution", sums, num_blocks);
+  show_vector("Lumped solution", lumped, num_blocks);
+
+  double diff = 0;
+  for (long b=0; b<num_blocks; b++) {
+    double d = sums[b] - lumped[b];
+    if (d<0) d = -d;
+    if (d > diff) diff = d;
+  }
+  if (exact) {
+    for (long s=0; s<num_nodes; s++) {
+      double d = full[s] - lumped[map[s]] / sizes[map[s]];
+      if (d<0) d = -d;
+      if (d > diff) diff = d;
+    }
+  }
+  cout << "  Difference: " << diff;
+  bool ok = diff < 1e-8;
+  if (ok)   cout << " (OK)\n";
+  else      cout << " too large!\n";
+
+  //
+  // Cleanup
+  //
+  delete MC;
+  delete L;
+  delete[] map;
+  delete[] full;
+  delete[] lumped;
+  delete[] sums;
+  delete[] sizes;
+
+  return ok;
+}
+
+// =======================================================================
+
+int main()
+{
+  cout.precision(8);
+
+  if (!run_test("servers", false, false, graph1, num_nodes1, key1, init1, blocks1, 0.5)) {
+    return 1;
+  }
+  if (!run_test("servers", false, false, graph1, num_nodes1, key1, init1, blocks1, 50)) {
+    return 1;
+  }
+  if (!run_test("servers", false, true, graph1, num_nodes1, key1, init1, blocks1, 0.5)) {
+    return 1;
+  }
+  if (!run_test("servers", false, true, graph1, num_nodes1, key1, init1, blocks1, 50)) {
+    return 1;
+  }
+  if (!run_test("servers", true, false, graph1, num_nodes1, key1, init1, blocks1, 3)) {
+    return 1;
+  }
+  if (!run_test("servers", true, true, graph1, num_nodes1, key1, init1, blocks1, 3)) {
+    return 1;
+  }
+
+  return 0;
+}
+
@@ -79,7 +79,11 @@ public:
     if (r<=0 || r>=2) return;
     ssopts.relaxation = r;
     if (r!=1.0)   ssopts.use_relaxation = 1;
-    else          ssopts.use_relaxation = 0;
+    else          ssopts.use_relaxation = ssopts.adaptive_relaxation;
+  }
+  static inline void adaptiveRelaxation() {
+    ssopts.adaptive_relaxation = 1;
+    ssopts.use_relaxation = 1;
   }
   static inline void epsilon(double e) {
     if (e>0 && e<1) ssopts.precision = e;
@@ -584,11 +588,27 @@ bool solver_parser::solveSteady()
         case LS_Jacobi: 
             fprintf(errlog,  "Jacobi");
             break;
+        case LS_GMRES: 
+            fprintf(errlog,  "GMRES");
+            break;
+        case LS_BiCGSTAB: 
+            fprintf(errlog,  "BiCGSTAB");
+            break;
+        case LS_CGS: 
+            fprintf(errlog,  "CGS");
+            break;
+        case LS_Block_Gauss_Seidel: 
+            fprintf(errlog,  "Block Gauss-Seidel");
+            break;
+        case LS_Block_Jacobi: 
+            fprintf(errlog,  "Block Jacobi");
+            break;
         default:
             fprintf(errlog,  "Unknown solver");
       } // switch
       if (ssopts.use_relaxation) {
         fprintf(errlog,  " with relaxation %lf", ssopts.relaxation);
+        if (ssopts.adaptive_relaxation) fprintf(errlog, " (adaptive)");
       }
       fprintf(errlog,  "\n");
     }
@@ -840,10 +860,16 @@ int Usage(const char* name)
   fprintf(stderr, "\tr: Jacobi by rows\n");
   fprintf(stderr, "\tj: Jacobi by vector-matrix multiply\n");
   fprintf(stderr, "\tg: Gauss-Seidel (by rows)\n");
+  fprintf(stderr, "\tG: GMRES\n");
+  fprintf(stderr, "\tB: BiCGSTAB\n");
+  fprintf(stderr, "\tS: Conjugate Gradient Squared\n");
+  fprintf(stderr, "\tb: Block Gauss-Seidel\n");
+  fprintf(stderr, "\tJ: Block Jacobi\n");
   fprintf(stderr, "\n");
   fprintf(stderr, "\te x: desired precision (epsilon)\n");
   fprintf(stderr, "\tm x: maximum number of iterations\n");
   fprintf(stderr, "\tw x: relaxation parameter (default 1.0)\n");
+  fprintf(stderr, "\tW: adjust relaxation parameter as we go (Gauss-Seidel only)\n");
   fprintf(stderr, "\n");
   return 1;
 }
@@ -856,7 +882,7 @@ int main(int argc, char** argv)
   int ch;
   bool dry_run = false;
   for (;;) {
-    ch = getopt(argc, argv, "?dqtczrjge:m:w:");
+    ch = getopt(argc, argv, "?dqtczrjgbGBJSWe:m:w:");
     if (ch<0) break;
     switch (ch) {
       case 'd':
@@ -883,6 +909,26 @@ int main(int argc, char** argv)
           dryrun_parser::useMethod(LS_Gauss_Seidel);
           continue;
 
+      case 'G':
+          dryrun_parser::useMethod(LS_GMRES);
+          continue;
+
+      case 'B':
+          dryrun_parser::useMethod(LS_BiCGSTAB);
+          continue;
+
+      case 'S':
+          dryrun_parser::useMethod(LS_CGS);
+          continue;
+
+      case 'b':
+          dryrun_parser::useMethod(LS_Block_Gauss_Seidel);
+          continue;
+
+      case 'J':
+          dryrun_parser::useMethod(LS_Block_Jacobi);
+          continue;
+
       case 'e':
           if (optarg) dryrun_parser::epsilon( atof(optarg) );
           continue;
@@ -895,6 +941,10 @@ int main(int argc, char** argv)
           if (optarg) dryrun_parser::relaxation( atof(optarg) );
           continue;
 
+      case 'W':
+          dryrun_parser::adaptiveRelaxation();
+          continue;
+
       default:
         return Usage(name);
     } // switch
@@ -278,8 +278,24 @@ double diff_vector(const double* A, const double* B, long size)
 
 // =======================================================================
 
+const char* method_name(LS_Method m)
+{
+  switch (m) {
+    case LS_Gauss_Seidel:   return "Gauss-Seidel";
+    case LS_GMRES:          return "GMRES";
+    case LS_BiCGSTAB:       return "BiCGSTAB";
+    case LS_CGS:            return "CGS";
+    case LS_Block_Gauss_Seidel:  return "block Gauss-Seidel";
+    case LS_Block_Jacobi:   return "block Jacobi";
+    default:                return "unknown solver";
+  }
+}
+
+// =======================================================================
+
 bool run_test(const char* name, const bool discrete, const edge graph[], 
-  const long num_nodes, const double init[], const double ss[])
+  const long num_nodes, const double init[], const double ss[],
+  LS_Method method, bool adaptive, bool aggregate)
 {
 #ifdef VERBOSE
   const bool verbose = true;
@@ -289,7 +305,10 @@ bool run_test(const char* name, const bool discrete, const edge graph[],
 
   cout << "Testing ";
   if (discrete) cout << "DTMC "; else cout << "CTMC ";
-  cout << name << "\n";
+  cout << name << " using " << method_name(method);
+  if (adaptive) cout << " with adaptive relaxation";
+  if (aggregate) cout << " with aggregation";
+  cout << "\n";
 
   Markov_chain* MCd = build_double(discrete, graph, num_nodes, verbose);
   Markov_chain* MCf = build_float(discrete, graph, num_nodes, verbose);
@@ -308,7 +327,19 @@ bool run_test(const char* name, const bool discrete, const edge graph[],
   //
   LS_Options opt;
 //  opt.debug = true;
-  opt.method = LS_Gauss_Seidel;
+  opt.method = method;
+  // Krylov methods do not converge monotonically, so the stopping
+  // test is a weaker bound on the error; ask for a bit more.
+  if ((method == LS_GMRES) || (method == LS_BiCGSTAB) || (method == LS_CGS)) {
+    opt.precision = 3e-7;
+  }
+  if (adaptive) {
+    opt.use_relaxation = true;
+    opt.adaptive_relaxation = true;
+  }
+  // small blocks, so that even these chains have several
+  opt.block_size = 2;
+  opt.aggregate = aggregate;
 
   //
   // Catch LS outputs
@@ -375,27 +406,39 @@ bool run_test(const char* name, const bool discrete, const edge graph[],
 
 int main()
 {
-  if (!run_test("Oz dtmc", discrete1, graph1, num_nodes1, init1, pinfinity1)) {
-    return 1;
-  }
-  if (!run_test("University dtmc", discrete2, graph2, num_nodes2, init2, pinfinity2)) {
-    return 1;
-  }
-  if (!run_test("2-state ctmc", discrete3, graph3, num_nodes3, init3, pinfinity3)) {
-    return 1;
-  }
-  if (!run_test("Reducible dtmc", discrete4, graph4, num_nodes4, init4, pinfinity4)) {
-    return 1;
-  }
-  if (!run_test("Reducible dtmc", discrete4, graph4, num_nodes4, init4a, pinfinity4a)) {
-    return 1;
-  }
-  if (!run_test("Reducible dtmc", discrete4, graph4, num_nodes4, init4b, pinfinity4b)) {
-    return 1;
-  }
-  if (!run_test("FMS N=1 ctmc", discrete5, graph5, num_nodes5, init5, pinfinity5)) {
-    return 1;
-  }
+  const LS_Method methods[] = { 
+    LS_Gauss_Seidel, LS_Gauss_Seidel, LS_GMRES, LS_BiCGSTAB, LS_CGS,
+    LS_Block_Gauss_Seidel, LS_Block_Gauss_Seidel, LS_Block_Jacobi
+  };
+  const bool adaptive[] = {
+    false, true, false, false, false, false, false, false
+  };
+  const bool aggregate[] = {
+    false, false, false, false, false, false, true, false
+  };
+  for (int m=0; m<8; m++) {
+    if (!run_test("Oz dtmc", discrete1, graph1, num_nodes1, init1, pinfinity1, methods[m], adaptive[m], aggregate[m])) {
+      return 1;
+    }
+    if (!run_test("University dtmc", discrete2, graph2, num_nodes2, init2, pinfinity2, methods[m], adaptive[m], aggregate[m])) {
+      return 1;
+    }
+    if (!run_test("2-state ctmc", discrete3, graph3, num_nodes3, init3, pinfinity3, methods[m], adaptive[m], aggregate[m])) {
+      return 1;
+    }
+    if (!run_test("Reducible dtmc", discrete4, graph4, num_nodes4, init4, pinfinity4, methods[m], adaptive[m], aggregate[m])) {
+      return 1;
+    }
+    if (!run_test("Reducible dtmc", discrete4, graph4, num_nodes4, init4a, pinfinity4a, methods[m], adaptive[m], aggregate[m])) {
+      return 1;
+    }
+    if (!run_test("Reducible dtmc", discrete4, graph4, num_nodes4, init4b, pinfinity4b, methods[m], adaptive[m], aggregate[m])) {
+      return 1;
+    }
+    if (!run_test("FMS N=1 ctmc", discrete5, graph5, num_nodes5, init5, pinfinity5, methods[m], adaptive[m], aggregate[m])) {
+      return 1;
+    }
+  } // for m
   return 0;
 }
 
@@ -129,7 +129,8 @@ double diff_vector(const double* A, const double* B, long size)
 // =======================================================================
 
 bool run_dtmc_test(const char* name, const edge graph[], 
-  const long num_nodes, const double init[], const long time, const double pt[])
+  const long num_nodes, const double init[], const long time, const double pt[],
+  int threads = 1)
 {
 #ifdef VERBOSE
   const bool verbose = true;
@@ -138,7 +139,9 @@ bool run_dtmc_test(const char* name, const edge graph[],
 #endif
 
   cout << "Testing DTMC ";
-  cout << name << "\n";
+  cout << name;
+  if (threads > 1) cout << " with " << threads << " threads";
+  cout << "\n";
 
   Markov_chain* MCd = build_double(true, graph, num_nodes, verbose);
   Markov_chain* MCf = build_float(true, graph, num_nodes, verbose);
@@ -147,6 +150,7 @@ bool run_dtmc_test(const char* name, const edge graph[],
   // Set up options
   //
   Markov_chain::DTMC_transient_options opt;
+  opt.num_threads = threads;
 
   //
   // Solve finite time probabilities
@@ -214,7 +218,8 @@ bool run_dtmc_test(const char* name, const edge graph[],
 // =======================================================================
 
 bool run_ctmc_test(const char* name, const double q, const edge graph[], 
-  const long num_nodes, const double init[], const double time, const double pt[])
+  const long num_nodes, const double init[], const double time, const double pt[],
+  int threads = 1, long ss_check = 1)
 {
 #ifdef VERBOSE
   const bool verbose = true;
@@ -223,7 +228,10 @@ bool run_ctmc_test(const char* name, const double q, const edge graph[],
 #endif
 
   cout << "Testing CTMC ";
-  cout << name << "\n";
+  cout << name;
+  if (threads > 1) cout << " with " << threads << " threads";
+  if (ss_check > 1) cout << " checking steady state every " << ss_check << " steps";
+  cout << "\n";
 
   Markov_chain* MCd = build_double(false, graph, num_nodes, verbose);
   Markov_chain* MCf = build_float(false, graph, num_nodes, verbose);
@@ -233,6 +241,8 @@ bool run_ctmc_test(const char* name, const double q, const edge graph[],
   //
   Markov_chain::CTMC_transient_options opt;
   opt.q = q;
+  opt.num_threads = threads;
+  opt.ss_check = ss_check;
 
   //
   // Solve finite time probabilities
@@ -298,6 +308,111 @@ bool run_ctmc_test(const char* name, const double q, const edge graph[],
 
 // =======================================================================
 
+bool run_ctmc_multi_test(const char* name, const double q, const edge graph[], 
+  const long num_nodes, const double init[], 
+  const long nt, const double times[], const double* pt[])
+{
+#ifdef VERBOSE
+  const bool verbose = true;
+#else
+  const bool verbose = false;
+#endif
+
+  cout << "Testing CTMC ";
+  cout << name;
+  cout << " at " << nt << " times in one sweep\n";
+
+  Markov_chain* MCd = build_double(false, graph, num_nodes, verbose);
+  Markov_chain* MCf = build_float(false, graph, num_nodes, verbose);
+
+  //
+  // Set up options
+  //
+  Markov_chain::CTMC_transient_options opt;
+  opt.q = q;
+
+  //
+  // Solve finite time probabilities
+  //
+  double* sold = new double[num_nodes];
+  memcpy(sold, init, num_nodes*sizeof(double));
+  double* solf = new double[num_nodes];
+  memcpy(solf, init, num_nodes*sizeof(double));
+  double** alld = new double*[nt];
+  double** allf = new double*[nt];
+  for (long k=0; k<nt; k++) {
+    alld[k] = new double[num_nodes];
+    allf[k] = new double[num_nodes];
+  }
+
+  try {
+    MCd->computeTransients(times, nt, sold, alld, opt);
+    MCf->computeTransients(times, nt, solf, allf, opt);
+  }
+  catch (GraphLib::error e) {
+    cout << "    Caught graph library error: ";
+    cout << e.getString() << "\n";
+    return false;
+  }
+  catch (MCLib::error e) {
+    cout << "    Caught Markov chain library error: ";
+    cout << e.getString() << "\n";
+    return false;
+  }
+
+  //
+  // Check results
+  //
+
+  cout << "Poisson right truncation point: " << opt.poisson_right << "\n";
+  cout << "Performed " << opt.multiplications << " multiplications\n";
+
+  bool ok = true;
+  for (long k=0; k<nt; k++) {
+    cout << "  Time " << times[k] << "\n";
+    show_vector("MCd solution vector", alld[k], num_nodes);
+    show_vector("MCf solution vector", allf[k], num_nodes);
+    show_vector("Expected     vector", pt[k], num_nodes);
+
+    double diff_d = diff_vector(pt[k], alld[k], num_nodes);
+    double diff_f = diff_vector(pt[k], allf[k], num_nodes);
+
+    cout << "  MCd relative difference: " << diff_d;
+    if (diff_d < 1e-5)  cout << " (OK)\n";
+    else                cout << " too large!\n";
+
+    cout << "  MCf relative difference: " << diff_f;
+    if (diff_f < 1e-5)  cout << " (OK)\n";
+    else                cout << " too large!\n";
+
+    ok = ok && (diff_d < 1e-5) && (diff_f < 1e-5);
+  }
+
+  double diff_last = diff_vector(pt[nt-1], sold, num_nodes);
+  cout << "  Final vector relative difference: " << diff_last;
+  if (diff_last < 1e-5) cout << " (OK)\n";
+  else                  cout << " too large!\n";
+  ok = ok && (diff_last < 1e-5);
+
+  //
+  // Cleanup
+  //
+  delete MCd;
+  delete MCf;
+  delete[] sold;
+  delete[] solf;
+  for (long k=0; k<nt; k++) {
+    delete[] alld[k];
+    delete[] allf[k];
+  }
+  delete[] alld;
+  delete[] allf;
+
+  return ok;
+}
+
+// =======================================================================
+
 int main()
 {
   cout.precision(8);
@@ -337,6 +452,13 @@ int main()
     return 1;
   }
 
+  if (!run_dtmc_test("Oz t3", graph1, num_nodes1, init1, time1_c, p1_c, 2)) {
+    return 1;
+  }
+  if (!run_dtmc_test("Periodic t5", graph2, num_nodes2, p2_0, 5, p2_2, 4)) {
+    return 1;
+  }
+
   //
   // CTMC tests
   //
@@ -362,6 +484,26 @@ int main()
     return 1;
   }
 
+  if (!run_ctmc_test("Transient", 0.8, graph3, num_nodes3, p3_0, 10, p3_10, 2)) {
+    return 1;
+  }
+  if (!run_ctmc_test("Oz t4", 0, graph4, num_nodes4, p4_0, 4, p4_4, 3)) {
+    return 1;
+  }
+
+  if (!run_ctmc_test("Oz t100", 0, graph4, num_nodes4, p4_0, 100, p4_ss, 1, 10)) {
+    return 1;
+  }
+  if (!run_ctmc_test("Oz t1000000", 0, graph4, num_nodes4, p4_0, 1e6, p4_ss, 1, 10)) {
+    return 1;
+  }
+
+  const double times4[] = {0, 1, 2, 4, 8, 100};
+  const double* pts4[] = {p4_0, p4_1, p4_2, p4_4, p4_8, p4_ss};
+  if (!run_ctmc_multi_test("Oz", 0, graph4, num_nodes4, p4_0, 6, times4, pts4)) {
+    return 1;
+  }
+
   return 0;
 }
 
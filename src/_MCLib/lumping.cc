@@ -0,0 +1,491 @@
+
+/**
+  Implementation of Markov_chain lumping.
+*/
+
+#include "mclib.h"
+
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+
+// #define DEBUG_LUMPING
+
+#ifdef DEBUG_LUMPING
+#include <iostream>
+using namespace std;
+#endif
+
+namespace MCLib {
+
+  // ======================================================================
+  // |                                                                    |
+  // |                        lump_partition class                        |
+  // |                                                                    |
+  // ======================================================================
+
+  /**
+      Partition of the states, for partition refinement.
+      The states of each block are stored contiguously,
+      so that blocks can be split in place.
+      Also keeps the set of blocks still to be used as splitters.
+  */
+  class lump_partition {
+    public:
+      lump_partition(long ns);
+      ~lump_partition();
+
+      /**
+          Set the initial partition.
+            @param  key   States s and t start in the same block
+                          iff key[s] == key[t].  If null, we start
+                          with a single block.
+      */
+      void initialize(const long* key);
+
+      inline long numBlocks() const { return num_blocks; }
+      inline long blockOf(long s) const { return block[s]; }
+      inline long firstOf(long b) const { return first[b]; }
+      inline long stopOf(long b) const { return stop[b]; }
+      inline long sizeOf(long b) const { return stop[b] - first[b]; }
+      inline long state(long i) const { return elems[i]; }
+
+      /// Pop a splitter, or return -1 if there are none left.
+      inline long popSplitter() {
+        if (0==num_splitters) return -1;
+        long b = splitters[--num_splitters];
+        queued[b] = false;
+        return b;
+      }
+
+      /**
+          Add weight to state s, for the current splitter.
+          The weights of states not touched are zero.
+      */
+      inline void addWeight(long s, double w) {
+        if (!touched[s]) {
+          touched[s] = true;
+          weight[s] = 0;
+          mag[s] = 0;
+          touched_list[num_touched++] = s;
+        }
+        weight[s] += w;
+        mag[s] += fabs(w);
+      }
+
+      /**
+          Split every block so that its states have equal weights.
+          Weights are considered equal if they are within the relative
+          tolerance.  Resets the weights for the next splitter.
+            @param  skip  Block to leave alone, or -1.
+      */
+      void splitBlocks(long skip, double tol);
+
+    private:
+      /// Move state s to position i of elems.
+      inline void moveTo(long s, long i) {
+        long t = elems[i];
+        long j = pos[s];
+        elems[i] = s;
+        pos[s] = i;
+        elems[j] = t;
+        pos[t] = j;
+      }
+      inline void pushSplitter(long b) {
+        if (queued[b]) return;
+        queued[b] = true;
+        splitters[num_splitters++] = b;
+      }
+      /// Is the weight of state s zero, within tolerance?
+      inline bool isZero(long s, double tol) const {
+        return fabs(weight[s]) <= tol * mag[s];
+      }
+
+      class by_weight {
+          const double* w;
+        public:
+          by_weight(const double* _w) : w(_w) { }
+          inline bool operator()(long a, long b) const {
+            return w[a] < w[b];
+          }
+      };
+
+    private:
+      long num_states;
+      long num_blocks;
+
+      /// States, grouped by block.
+      long* elems;
+      /// Position of each state in elems.
+      long* pos;
+      /// Block of each state.
+      long* block;
+      /// Index in elems of the first state of each block.
+      long* first;
+      /// One plus index in elems of the last state of each block.
+      long* stop;
+      /// Start of the touched states within each block.
+      long* split;
+
+      /// Stack of splitters.
+      long* splitters;
+      long num_splitters;
+      /// Is the block in the splitter stack?
+      bool* queued;
+
+      /// Weight of each state, for the current splitter.
+      double* weight;
+      /// Sum of magnitudes of the weight terms, for tolerances.
+      double* mag;
+      bool* touched;
+      long* touched_list;
+      long num_touched;
+      /// Blocks with touched states.
+      long* touched_blocks;
+  };
+
+  // ******************************************************************
+
+  lump_partition::lump_partition(long ns)
+  {
+    num_states = ns;
+    num_blocks = 0;
+    elems = new long[ns];
+    pos = new long[ns];
+    block = new long[ns];
+    first = new long[ns];
+    stop = new long[ns];
+    split = new long[ns];
+    splitters = new long[ns];
+    num_splitters = 0;
+    queued = new bool[ns];
+    weight = new double[ns];
+    mag = new double[ns];
+    touched = new bool[ns];
+    touched_list = new long[ns];
+    num_touched = 0;
+    touched_blocks = new long[ns];
+    for (long s=0; s<ns; s++) {
+      touched[s] = false;
+      queued[s] = false;
+    }
+  }
+
+  lump_partition::~lump_partition()
+  {
+    delete[] elems;
+    delete[] pos;
+    delete[] block;
+    delete[] first;
+    delete[] stop;
+    delete[] split;
+    delete[] splitters;
+    delete[] queued;
+    delete[] weight;
+    delete[] mag;
+    delete[] touched;
+    delete[] touched_list;
+    delete[] touched_blocks;
+  }
+
+  // ******************************************************************
+
+  class by_key {
+      const long* key;
+    public:
+      by_key(const long* k) : key(k) { }
+      inline bool operator()(long a, long b) const {
+        return key[a] < key[b];
+      }
+  };
+
+  void lump_partition::initialize(const long* key)
+  {
+    for (long s=0; s<num_states; s++) elems[s] = s;
+    if (key) std::stable_sort(elems, elems+num_states, by_key(key));
+
+    num_blocks = 0;
+    for (long i=0; i<num_states; i++) {
+      long s = elems[i];
+      pos[s] = i;
+      if (0==i || (key && key[s] != key[elems[i-1]])) {
+        if (num_blocks) stop[num_blocks-1] = i;
+        first[num_blocks] = i;
+        num_blocks++;
+      }
+      block[s] = num_blocks-1;
+    }
+    if (num_blocks) stop[num_blocks-1] = num_states;
+
+    for (long b=0; b<num_blocks; b++) pushSplitter(b);
+  }
+
+  // ******************************************************************
+
+  void lump_partition::splitBlocks(long skip, double tol)
+  {
+    //
+    // Move the touched states, with non-zero weight,
+    // to the end of their blocks.
+    //
+    long num_tb = 0;
+    for (long i=0; i<num_touched; i++) {
+      long b = block[touched_list[i]];
+      split[b] = stop[b];
+    }
+    for (long i=0; i<num_touched; i++) {
+      long s = touched_list[i];
+      long b = block[s];
+      if (b == skip) continue;
+      if (isZero(s, tol)) continue;
+      if (split[b] == stop[b]) touched_blocks[num_tb++] = b;
+      moveTo(s, --split[b]);
+    }
+
+    //
+    // Split each touched block
+    //
+    for (long k=0; k<num_tb; k++) {
+      const long b = touched_blocks[k];
+      std::sort(elems + split[b], elems + stop[b], by_weight(weight));
+      for (long i=split[b]; i<stop[b]; i++) pos[elems[i]] = i;
+
+      // The states not touched keep block b, unless there are none,
+      // in which case the first group of touched states keeps it.
+      const long before = num_blocks;
+      long curr = b;
+      bool first_group = (split[b] == first[b]);
+      const long old_stop = stop[b];
+      for (long i=split[b]; i<old_stop; i++) {
+        long s = elems[i];
+        bool new_group = (i == split[b]);
+        if (!new_group) {
+          double a = weight[elems[i-1]];
+          double c = weight[s];
+          new_group = fabs(c - a) > tol * MAX(fabs(a), fabs(c));
+        }
+        if (new_group) {
+          if (first_group) {
+            first_group = false;
+          } else {
+            // start a new block
+            stop[curr] = i;
+            curr = num_blocks++;
+            first[curr] = i;
+          }
+        }
+        block[s] = curr;
+      }
+      stop[curr] = old_stop;
+
+      if (before == num_blocks) continue;
+      //
+      // If b was waiting to be used as a splitter, then its pieces
+      // must be too; add the new ones.  Otherwise, add all the pieces.
+      //
+      pushSplitter(b);
+      for (long nb=before; nb<num_blocks; nb++) {
+        pushSplitter(nb);
+      }
+    } // for k
+
+    //
+    // Reset weights
+    //
+    for (long i=0; i<num_touched; i++) {
+      touched[touched_list[i]] = false;
+    }
+    num_touched = 0;
+  }
+
+}; // namespace MCLib
+
+// ======================================================================
+// |                                                                    |
+// |                   Markov_chain  lumping  methods                   |
+// |                                                                    |
+// ======================================================================
+
+/*
+    For ordinary lumping, each splitter C splits blocks according 
+    to the total rate from each state into C; blocks other than C
+    itself, since the rates within a block do not matter.
+
+    For exact lumping, each splitter C splits blocks according
+    to the total rate from C into each state, including C itself
+    and the diagonal elements (minus the row sums for CTMCs,
+    self loops for DTMCs).
+
+    Splitters are kept in a stack; whenever a block is split,
+    all its pieces become (or stay) splitters.
+*/
+
+template <class REAL>
+long MCLib::Markov_chain::refinePartition(const REAL* selfloops, 
+  const long* initial, long* block, lumping_options &opts) const
+{
+  const long ns = getNumStates();
+  lump_partition P(ns);
+  P.initialize(initial);
+
+  const GraphLib::static_graph* G[2];
+  if (opts.exact) {
+    G[0] = &G_byrows_diag;
+    G[1] = &G_byrows_off;
+  } else {
+    G[0] = &G_bycols_diag;
+    G[1] = &G_bycols_off;
+  }
+
+  opts.splitters = 0;
+  for (long C = P.popSplitter(); C >= 0; C = P.popSplitter()) {
+    opts.splitters++;
+    for (long i=P.firstOf(C); i<P.stopOf(C); i++) {
+      const long s = P.state(i);
+      for (int g=0; g<2; g++) {
+        const REAL* val = (const REAL*) G[g]->Labels();
+        for (long e=G[g]->RowPointer(s); e<G[g]->RowPointer(s+1); e++) {
+          P.addWeight(G[g]->ColumnIndex(e), val[e]);
+        }
+      }
+      if (opts.exact) {
+        if (selfloops)  P.addWeight(s, selfloops[s]);
+        else            P.addWeight(s, -rowsums[s]);
+      }
+    } // for i
+    P.splitBlocks(opts.exact ? -1 : C, opts.tolerance);
+  } // for C
+
+  for (long s=0; s<ns; s++) block[s] = P.blockOf(s);
+
+#ifdef DEBUG_LUMPING
+  cout << "Lumped " << ns << " states into " << P.numBlocks() << " blocks\n";
+  for (long b=0; b<P.numBlocks(); b++) {
+    cout << "  block " << b << ": {";
+    for (long i=P.firstOf(b); i<P.stopOf(b); i++) {
+      if (i>P.firstOf(b)) cout << ", ";
+      cout << P.state(i);
+    }
+    cout << "}\n";
+  }
+#endif
+
+  return P.numBlocks();
+}
+
+// ******************************************************************
+
+/*
+    Ordinary lumping: the rate from block B to block C is the
+    total rate from any one state of B into C.
+
+    Exact lumping: the rate from block B to block C is the total
+    rate from B into any one state of C, times |C| / |B|.
+*/
+
+template <class REAL>
+MCLib::Markov_chain* MCLib::Markov_chain::buildLumped(const REAL* selfloops,
+  long* block, long nb, bool exact, GraphLib::timer_hook *sw) const
+{
+  const long ns = getNumStates();
+
+  //
+  // Block sizes, and one state from each block
+  //
+  long* size = new long[nb];
+  long* rep = new long[nb];
+  for (long b=0; b<nb; b++) size[b] = 0;
+  for (long s=ns-1; s>=0; s--) {
+    size[block[s]]++;
+    rep[block[s]] = s;
+  }
+
+  //
+  // Build the lumped graph
+  //
+  GraphLib::dynamic_summable<REAL>* G = 
+    new GraphLib::dynamic_summable<REAL>(isDiscrete(), true);
+  G->addNodes(nb);
+
+  const GraphLib::static_graph* H[2];
+  if (exact) {
+    H[0] = &G_bycols_diag;
+    H[1] = &G_bycols_off;
+  } else {
+    H[0] = &G_byrows_diag;
+    H[1] = &G_byrows_off;
+  }
+  for (long b=0; b<nb; b++) {
+    const long s = rep[b];
+    for (int h=0; h<2; h++) {
+      const REAL* val = (const REAL*) H[h]->Labels();
+      for (long e=H[h]->RowPointer(s); e<H[h]->RowPointer(s+1); e++) {
+        const long c = block[H[h]->ColumnIndex(e)];
+        if (c == b && !isDiscrete()) continue;
+        if (exact) {
+          G->addEdge(c, b, REAL(val[e] * double(size[b]) / size[c]));
+        } else {
+          G->addEdge(b, c, val[e]);
+        }
+      }
+    }
+    if (selfloops && selfloops[s]) G->addEdge(b, b, selfloops[s]);
+  }
+  delete[] size;
+  delete[] rep;
+
+  //
+  // Classify and renumber, and build the chain
+  //
+  GraphLib::abstract_classifier* ac = G->determineSCCs(0, 1, true, sw);
+  GraphLib::static_classifier C;
+  GraphLib::node_renumberer* Ren = ac->buildRenumbererAndStatic(C);
+  delete ac;
+  if (Ren) G->renumberNodes(*Ren);
+
+  Markov_chain* L = new Markov_chain(isDiscrete(), *G, C, sw);
+  delete G;
+
+  //
+  // Renumber the blocks the same way
+  //
+  if (Ren) {
+    for (long s=0; s<ns; s++) block[s] = Ren->new_number(block[s]);
+    delete Ren;
+  }
+  return L;
+}
+
+// ******************************************************************
+
+MCLib::Markov_chain* MCLib::Markov_chain::lump(const long* initial, long* map,
+  lumping_options &opts, GraphLib::timer_hook *sw) const
+{
+  if (0==map) {
+    throw MCLib::error(MCLib::error::Null_Vector);
+  }
+  const long ns = getNumStates();
+  if (0==ns) return 0;
+
+  if (sw) sw->start("Lumping");
+  long nb;
+  if (double_graphs) {
+    nb = refinePartition(selfloops_d, initial, map, opts);
+  } else {
+    nb = refinePartition(selfloops_f, initial, map, opts);
+  }
+  if (sw) sw->stop();
+
+  if (nb == ns) {
+    // Nothing to lump
+    for (long s=0; s<ns; s++) map[s] = s;
+    return 0;
+  }
+
+  if (double_graphs) {
+    return buildLumped(selfloops_d, map, nb, opts.exact, sw);
+  } else {
+    return buildLumped(selfloops_f, map, nb, opts.exact, sw);
+  }
+}
+
@@ -261,6 +261,49 @@ inline void graphToMatrix(const GraphLib::static_graph &G, LS_CRS_Matrix<REAL> &
   M.one_over_diag = 0;  // We'll do this by hand later
 }
 
+/**
+    Matrix wrapper for the vector-matrix multiplies of transient analysis.
+    With one thread, we multiply using the matrix itself.
+    With more, we use its transpose, so that each element of the result
+    is a dot product and the threads never write to the same element.
+*/
+template <class MATRIX>
+class vm_matrix {
+    MATRIX A;
+    MATRIX AT;
+    LS_Workers &W;
+    long* bounds;
+  public:
+    vm_matrix(const GraphLib::static_graph &G, 
+      const GraphLib::static_graph &GT, LS_Workers &w) : W(w)
+    {
+      graphToMatrix(G, A);
+      bounds = 0;
+      if (W.NumThreads() > 1) {
+        graphToMatrix(GT, AT);
+        bounds = new long[W.NumThreads()+1];
+        W.Partition(AT.Start(), AT.Stop(), AT.row_ptr, bounds);
+      }
+    }
+    ~vm_matrix() {
+      delete[] bounds;
+    }
+    inline long Size() const { 
+      return A.Size(); 
+    }
+    inline void VectorMatrixMultiply(double* y, const double* x) const {
+      if (0==bounds) {
+        A.VectorMatrixMultiply(y, x);
+        return;
+      }
+      W.Run([&](int t) {
+        for (long i=bounds[t]; i<bounds[t+1]; i++) {
+          AT.RowDotProduct(i, x, y[i]);
+        }
+      });
+    }
+};
+
 /**
     Multiply by diagonals, where diagonals are stored explicitly.
     Essentially, the same as element-wise product.
@@ -313,6 +356,51 @@ bool vectorsWithinEpsilon(const double* A, const double* B, const long size,
   return true;
 }
 
+/**
+    Steady-state detection for the transient solvers.
+    See DTMC_transient_options::ss_check.
+*/
+class steady_detector {
+    double* saved;
+    long size;
+    double prec;
+    long gap;
+    long count;
+  public:
+    steady_detector(const MCLib::Markov_chain::DTMC_transient_options &opts,
+      const double* p, long sz)
+    {
+      size = sz;
+      prec = opts.ssprec;
+      gap = opts.ss_check;
+      count = 0;
+      saved = 0;
+      if (prec && gap > 1) {
+        saved = new double[size];
+        memcpy(saved, p, size * sizeof(double));
+      }
+    }
+    ~steady_detector() {
+      delete[] saved;
+    }
+    /**
+        Called after each step.
+          @param  old   Vector before the step.
+          @param  x     Vector after the step.
+          @return true iff we think x is the steady-state vector.
+    */
+    inline bool reached(const double* old, const double* x) {
+      if (0==prec) return false;
+      if (0==saved) return vectorsWithinEpsilon(old, x, size, prec);
+      if (++count < gap) return false;
+      count = 0;
+      bool ans = vectorsWithinEpsilon(old, x, size, prec)
+                  && vectorsWithinEpsilon(saved, x, size, prec);
+      memcpy(saved, x, size * sizeof(double));
+      return ans;
+    }
+};
+
 /**
     Divide a vector by a scalar.
 */
@@ -991,6 +1079,7 @@ namespace MCLib {
       }
 
       double* aux = opts.vm_result;
+      steady_detector steady(opts, p, size);
 
       for (opts.multiplications=0; opts.multiplications<t; opts.multiplications++) {
         // VM multiply
@@ -1004,7 +1093,7 @@ namespace MCLib {
         // aux is now the distribution after one step.
 
         // Check if we've hit steady state
-        if (vectorsWithinEpsilon(p, aux, size, opts.ssprec)) {
+        if (steady.reached(p, aux)) {
           opts.multiplications++;
           break;
         }
@@ -1034,13 +1123,14 @@ void MCLib::Markov_chain::computeTransient(int t, double* p,
     throw MCLib::error(MCLib::error::Wrong_Type);
   }
 
+  LS_Workers W(opts.num_threads);
+
   if (double_graphs) {
     //
     // Set up matrices (shallow copies here)
     //
-    LS_CRS_Matrix_double Qdiag, Qoff;
-    graphToMatrix(G_byrows_diag, Qdiag);
-    graphToMatrix(G_byrows_off, Qoff);
+    vm_matrix <LS_CRS_Matrix_double> Qdiag(G_byrows_diag, G_bycols_diag, W);
+    vm_matrix <LS_CRS_Matrix_double> Qoff(G_byrows_off, G_bycols_off, W);
 
     //
     // And pass everything to our nice template function :^)
@@ -1050,9 +1140,8 @@ void MCLib::Markov_chain::computeTransient(int t, double* p,
     //
     // Set up matrices (shallow copies here)
     //
-    LS_CRS_Matrix_float Qdiag, Qoff;
-    graphToMatrix(G_byrows_diag, Qdiag);
-    graphToMatrix(G_byrows_off, Qoff);
+    vm_matrix <LS_CRS_Matrix_float> Qdiag(G_byrows_diag, G_bycols_diag, W);
+    vm_matrix <LS_CRS_Matrix_float> Qoff(G_byrows_off, G_bycols_off, W);
 
     //
     // And pass everything to our nice template function :^)
@@ -1074,13 +1163,14 @@ void MCLib::Markov_chain::reverseTransient(int t, double* p,
     throw MCLib::error(MCLib::error::Wrong_Type);
   }
 
+  LS_Workers W(opts.num_threads);
+
   if (double_graphs) {
     //
     // Set up matrices (shallow copies here)
     //
-    LS_CRS_Matrix_double Qdiag, Qoff;
-    graphToMatrix(G_bycols_diag, Qdiag);
-    graphToMatrix(G_bycols_off, Qoff);
+    vm_matrix <LS_CRS_Matrix_double> Qdiag(G_bycols_diag, G_byrows_diag, W);
+    vm_matrix <LS_CRS_Matrix_double> Qoff(G_bycols_off, G_byrows_off, W);
 
     //
     // And pass everything to our nice template function :^)
@@ -1090,9 +1180,8 @@ void MCLib::Markov_chain::reverseTransient(int t, double* p,
     //
     // Set up matrices (shallow copies here)
     //
-    LS_CRS_Matrix_float Qdiag, Qoff;
-    graphToMatrix(G_bycols_diag, Qdiag);
-    graphToMatrix(G_bycols_off, Qoff);
+    vm_matrix <LS_CRS_Matrix_float> Qdiag(G_bycols_diag, G_byrows_diag, W);
+    vm_matrix <LS_CRS_Matrix_float> Qoff(G_bycols_off, G_byrows_off, W);
 
     //
     // And pass everything to our nice template function :^)
@@ -1129,6 +1218,7 @@ namespace MCLib {
       zeroArray(opts.accumulator, size);
       double* aux = opts.vm_result;
       double* myp = p;
+      steady_detector steady(opts, p, size);
 
       // 
       // Add initial distribution
@@ -1157,10 +1247,11 @@ namespace MCLib {
 
         // Check if we've hit steady state
         opts.multiplications++;
-        if (vectorsWithinEpsilon(myp, aux, size, opts.ssprec)) break;
+        if (steady.reached(myp, aux)) break;
 
-        // Add to accumulator
-        addToVector(opts.accumulator, dist.f(i+1)/dadj, aux, size);
+        // Add to accumulator; nothing to add left of the poisson window
+        const double w = dist.f(i+1);
+        if (w) addToVector(opts.accumulator, w/dadj, aux, size);
 
 #ifdef DEBUG_UNIFORMIZATION
         showUnifStep(i+1, dist.f(i+1)/dadj, aux, opts.accumulator, size);
@@ -1208,13 +1299,14 @@ void MCLib::Markov_chain::computeTransient(double t, double* p,
   discrete_pdf poisson_pdf;
   computePoissonPDF(opts.q * t, opts.epsilon, poisson_pdf);
 
+  LS_Workers W(opts.num_threads);
+
   if (double_graphs) {
     //
     // Set up matrices (shallow copies here)
     //
-    LS_CRS_Matrix_double Qdiag, Qoff;
-    graphToMatrix(G_byrows_diag, Qdiag);
-    graphToMatrix(G_byrows_off, Qoff);
+    vm_matrix <LS_CRS_Matrix_double> Qdiag(G_byrows_diag, G_bycols_diag, W);
+    vm_matrix <LS_CRS_Matrix_double> Qoff(G_byrows_off, G_bycols_off, W);
 
     //
     // And pass everything to our nice template function :^)
@@ -1224,9 +1316,8 @@ void MCLib::Markov_chain::computeTransient(double t, double* p,
     //
     // Set up matrices (shallow copies here)
     //
-    LS_CRS_Matrix_float Qdiag, Qoff;
-    graphToMatrix(G_byrows_diag, Qdiag);
-    graphToMatrix(G_byrows_off, Qoff);
+    vm_matrix <LS_CRS_Matrix_float> Qdiag(G_byrows_diag, G_bycols_diag, W);
+    vm_matrix <LS_CRS_Matrix_float> Qoff(G_byrows_off, G_bycols_off, W);
 
     //
     // And pass everything to our nice template function :^)
@@ -1236,6 +1327,141 @@ void MCLib::Markov_chain::computeTransient(double t, double* p,
 }
 
 
+// ******************************************************************
+
+namespace MCLib {
+  template <class MATRIX>
+  void templ_ctmc_transients(MATRIX &Qdiag, MATRIX &Qoff, const double* rowsums,
+    const discrete_pdf* dist, long nt, double* p, double** pt,
+    Markov_chain::CTMC_transient_options &opts)
+  {
+      const long size = Qdiag.Size();
+      //
+      // Set up auxiliary vectors if necessary
+      //
+      if (0== opts.vm_result) {
+        opts.vm_result = new double[size];
+      }
+
+      long right = 0;
+      for (long k=0; k<nt; k++) {
+        right = MAX(right, dist[k].right_trunc());
+      }
+      opts.poisson_right = right;
+
+      //
+      // Initialize vectors, and add initial distribution
+      //
+      double* aux = opts.vm_result;
+      double* myp = p;
+      steady_detector steady(opts, p, size);
+      for (long k=0; k<nt; k++) {
+        zeroArray(pt[k], size);
+        addToVector(pt[k], dist[k].f(0), p, size);
+      }
+
+      //
+      // Loop and add distribution at step n to every time point
+      // whose poisson window contains n.  Since the times are
+      // increasing, so are the right truncation points;
+      // first is the first time point whose window is not yet done.
+      //
+      opts.multiplications = 0;
+      long first = 0;
+      long i;
+      for (i=0; i<right; i++) {
+        // VM multiply
+        zeroArray(aux, size);
+        Qdiag.VectorMatrixMultiply(aux, myp);
+        Qoff.VectorMatrixMultiply(aux, myp);
+        adjustDiagonals(aux, myp, opts.q, rowsums, size);
+        normalizeVector(aux, size);
+
+        // aux is now the distribution after i+1 steps.
+
+        // Check if we've hit steady state
+        opts.multiplications++;
+        if (steady.reached(myp, aux)) break;
+
+        // Add to accumulators
+        while (first < nt && dist[first].right_trunc() <= i) first++;
+        for (long k=first; k<nt; k++) {
+          const double w = dist[k].f(i+1);
+          if (w) addToVector(pt[k], w, aux, size);
+        }
+
+        SWAP(aux, myp);
+      } // for i
+
+      // If we detected steady state, then finish the computation
+      // assuming aux vector does not change.
+      for (long k=first; k<nt; k++) {
+        double remaining_probs = 0;
+        for (long j=i; j<dist[k].right_trunc(); j++) {
+          remaining_probs += dist[k].f(j+1);
+        }
+        if (remaining_probs) {
+          addToVector(pt[k], remaining_probs, aux, size);
+        }
+      }
+
+      // Leave the final distribution in p.
+      memcpy(p, pt[nt-1], size * sizeof(double));
+  }
+}
+
+// ******************************************************************
+
+void MCLib::Markov_chain::computeTransients(const double* t, long nt, 
+  double* p, double** pt, CTMC_transient_options &opts) const
+{
+  if (0==p || 0==pt) {
+    throw MCLib::error(MCLib::error::Null_Vector);
+  }
+  if (isDiscrete()) {
+    throw MCLib::error(MCLib::error::Wrong_Type);
+  }
+  if (nt < 1) return;
+  for (long k=0; k<nt; k++) {
+    if (0==pt[k]) throw MCLib::error(MCLib::error::Null_Vector);
+    if (t[k] < 0 || (k && t[k] < t[k-1])) {
+      throw MCLib::error(MCLib::error::Bad_Time);
+    }
+  }
+
+  opts.q = MAX(opts.q, getUniformizationConst());
+
+  //
+  // Set up poisson distributions, one per time point
+  //
+  discrete_pdf* poisson_pdf = new discrete_pdf[nt];
+  for (long k=0; k<nt; k++) {
+    computePoissonPDF(opts.q * t[k], opts.epsilon, poisson_pdf[k]);
+  }
+
+  LS_Workers W(opts.num_threads);
+
+  try {
+    if (double_graphs) {
+      vm_matrix <LS_CRS_Matrix_double> Qdiag(G_byrows_diag, G_bycols_diag, W);
+      vm_matrix <LS_CRS_Matrix_double> Qoff(G_byrows_off, G_bycols_off, W);
+
+      templ_ctmc_transients(Qdiag, Qoff, rowsums, poisson_pdf, nt, p, pt, opts);
+    } else {
+      vm_matrix <LS_CRS_Matrix_float> Qdiag(G_byrows_diag, G_bycols_diag, W);
+      vm_matrix <LS_CRS_Matrix_float> Qoff(G_byrows_off, G_bycols_off, W);
+
+      templ_ctmc_transients(Qdiag, Qoff, rowsums, poisson_pdf, nt, p, pt, opts);
+    }
+  }
+  catch (...) {
+    delete[] poisson_pdf;
+    throw;
+  }
+  delete[] poisson_pdf;
+}
+
+
 // ******************************************************************
 
 void MCLib::Markov_chain::reverseTransient(double t, double* p, 
@@ -1256,13 +1482,14 @@ void MCLib::Markov_chain::reverseTransient(double t, double* p,
   discrete_pdf poisson_pdf;
   computePoissonPDF(opts.q * t, opts.epsilon, poisson_pdf);
 
+  LS_Workers W(opts.num_threads);
+
   if (double_graphs) {
     //
     // Set up matrices (shallow copies here)
     //
-    LS_CRS_Matrix_double Qdiag, Qoff;
-    graphToMatrix(G_bycols_diag, Qdiag);
-    graphToMatrix(G_bycols_off, Qoff);
+    vm_matrix <LS_CRS_Matrix_double> Qdiag(G_bycols_diag, G_byrows_diag, W);
+    vm_matrix <LS_CRS_Matrix_double> Qoff(G_bycols_off, G_byrows_off, W);
 
     //
     // And pass everything to our nice template function :^)
@@ -1272,9 +1499,8 @@ void MCLib::Markov_chain::reverseTransient(double t, double* p,
     //
     // Set up matrices (shallow copies here)
     //
-    LS_CRS_Matrix_float Qdiag, Qoff;
-    graphToMatrix(G_bycols_diag, Qdiag);
-    graphToMatrix(G_bycols_off, Qoff);
+    vm_matrix <LS_CRS_Matrix_float> Qdiag(G_bycols_diag, G_byrows_diag, W);
+    vm_matrix <LS_CRS_Matrix_float> Qoff(G_bycols_off, G_byrows_off, W);
 
     //
     // And pass everything to our nice template function :^)
@@ -1306,6 +1532,7 @@ namespace MCLib {
 
       double* aux = opts.vm_result;
       double* myp = n;
+      steady_detector steady(opts, n, size);
 
       addToVector(opts.accumulator, n, size);
 #ifdef DEBUG_ACCUMULATE
@@ -1330,7 +1557,7 @@ namespace MCLib {
 #endif
 
         // Check if we've hit steady state
-        if (vectorsWithinEpsilon(myp, aux, size, opts.ssprec)) {
+        if (steady.reached(myp, aux)) {
           opts.multiplications++;
           break;
         }
@@ -1371,13 +1598,14 @@ void MCLib::Markov_chain::accumulate(int t, const double* p0, double* n0t,
     memcpy(n0t, p0, getNumStates() * sizeof(double));
   }
 
+  LS_Workers W(opts.num_threads);
+
   if (double_graphs) {
     //
     // Set up matrices (shallow copies here)
     //
-    LS_CRS_Matrix_double Qdiag, Qoff;
-    graphToMatrix(G_byrows_diag, Qdiag);
-    graphToMatrix(G_byrows_off, Qoff);
+    vm_matrix <LS_CRS_Matrix_double> Qdiag(G_byrows_diag, G_bycols_diag, W);
+    vm_matrix <LS_CRS_Matrix_double> Qoff(G_byrows_off, G_bycols_off, W);
 
     //
     // And pass everything to our nice template function :^)
@@ -1387,9 +1615,8 @@ void MCLib::Markov_chain::accumulate(int t, const double* p0, double* n0t,
     //
     // Set up matrices (shallow copies here)
     //
-    LS_CRS_Matrix_float Qdiag, Qoff;
-    graphToMatrix(G_byrows_diag, Qdiag);
-    graphToMatrix(G_byrows_off, Qoff);
+    vm_matrix <LS_CRS_Matrix_float> Qdiag(G_byrows_diag, G_bycols_diag, W);
+    vm_matrix <LS_CRS_Matrix_float> Qoff(G_byrows_off, G_bycols_off, W);
 
     //
     // And pass everything to our nice template function :^)
@@ -1441,13 +1668,14 @@ void MCLib::Markov_chain::accumulate(double t, const double* p0, double* n0t,
     memcpy(n0t, p0, getNumStates() * sizeof(double));
   }
 
+  LS_Workers W(opts.num_threads);
+
   if (double_graphs) {
     //
     // Set up matrices (shallow copies here)
     //
-    LS_CRS_Matrix_double Qdiag, Qoff;
-    graphToMatrix(G_byrows_diag, Qdiag);
-    graphToMatrix(G_byrows_off, Qoff);
+    vm_matrix <LS_CRS_Matrix_double> Qdiag(G_byrows_diag, G_bycols_diag, W);
+    vm_matrix <LS_CRS_Matrix_double> Qoff(G_byrows_off, G_bycols_off, W);
 
     //
     // And pass everything to our nice template function :^)
@@ -1457,9 +1685,8 @@ void MCLib::Markov_chain::accumulate(double t, const double* p0, double* n0t,
     //
     // Set up matrices (shallow copies here)
     //
-    LS_CRS_Matrix_float Qdiag, Qoff;
-    graphToMatrix(G_byrows_diag, Qdiag);
-    graphToMatrix(G_byrows_off, Qoff);
+    vm_matrix <LS_CRS_Matrix_float> Qdiag(G_byrows_diag, G_bycols_diag, W);
+    vm_matrix <LS_CRS_Matrix_float> Qoff(G_byrows_off, G_bycols_off, W);
 
     //
     // And pass everything to our nice template function :^)
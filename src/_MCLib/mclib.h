@@ -94,20 +94,33 @@ namespace MCLib {
       struct DTMC_transient_options {
         /// Precision for detection of steady-state (use 0 to not check)
         double ssprec;
+        /** Number of steps between checks for steady-state.
+            With 1, we check every step, by comparing consecutive vectors.
+            Otherwise, every ss_check steps we require consecutive
+            vectors to be close, and also the current vector to be
+            close to the one from the previous check.  That is cheaper,
+            and much less likely to stop too early on stiff chains,
+            where one step changes the vector very little.
+        */
+        long ss_check;
         /// Vector to hold result of vector-matrix multiply
         double* vm_result;
         /// Vector to accumulate sum, if necessary
         double* accumulator;
         /// Output: number of vector matrix multiplies required.
         long multiplications;
+        /// Number of threads to use for vector matrix multiplies.
+        int num_threads;
 
         /** 
           Constructor; sets reasonable defaults
         */
         DTMC_transient_options() {
           ssprec = 1e-10;
+          ss_check = 1;
           vm_result = 0;
           accumulator = 0;
+          num_threads = 1;
         }
         /** 
           Destructor; destroys auxiliary vectors.
@@ -233,6 +246,37 @@ namespace MCLib {
 
       };
 
+  public:
+
+      /// Options for lumping.
+      struct lumping_options {
+        /** Exact lumping, if true; otherwise, ordinary lumping.
+            With ordinary lumping, the probability of a block is
+            the sum of the probabilities of its states, but how that
+            splits among the states is not known.  With exact lumping,
+            and an initial distribution that is uniform within each
+            block, all states of a block have the same probability
+            at any time, and in steady state.
+        */
+        bool exact;
+        /** Relative tolerance for deciding that two (sums of) rates
+            are equal.  Sums of identical rates, added in different
+            orders, may differ in the last few bits.
+        */
+        double tolerance;
+        /// Output: number of splitters processed.
+        long splitters;
+
+        /** 
+          Constructor; sets reasonable defaults
+        */
+        lumping_options() {
+          exact = false;
+          tolerance = 1e-10;
+          splitters = 0;
+        }
+      };
+
   public:
       /**
           Constructor.
@@ -383,6 +427,36 @@ namespace MCLib {
       bool traverseIncoming(GraphLib::BF_graph_traversal &t) const;
 
 
+      /** Lump the chain.
+          Finds the coarsest ordinary (or exact) lumpable partition
+          of the states that refines a given partition,
+          by partition refinement, and builds the lumped chain.
+          States that must not be lumped together, for example because
+          they have different rewards, or (for exact lumping) 
+          different initial probabilities, should be placed into 
+          different blocks of the initial partition.
+
+            @param  initial   Initial partition: states s and t may
+                              be lumped only if initial[s] == initial[t].
+                              If null, we start with all states together.
+
+            @param  map       Output: array of dimension getNumStates(),
+                              map[s] is the state of the lumped chain
+                              that contains state s.
+
+            @param  opts      Lumping options.
+
+            @param  sw        Where to report timing information 
+                              (nowhere if 0).
+
+            @return The lumped chain, with its own state classification,
+                    or 0 if no two states can be lumped together.
+                    The caller is responsible for deleting it.
+      */
+      Markov_chain* lump(const long* initial, long* map, 
+        lumping_options &opts, GraphLib::timer_hook *sw) const;
+
+
       /** Compute the period for a given class.
           For CTMCs, gives the period of the embedded DTMC.
 
@@ -427,6 +501,32 @@ namespace MCLib {
       void computeTransient(double t, double* p, CTMC_transient_options &opts) 
       const;
 
+      /** Compute the distributions at several times, given the starting
+          distribution, with a single uniformization sweep.
+          Must be a CTMC.
+          Each vector-matrix product is shared by all time points whose
+          Poisson window covers it, so this is much cheaper than
+          calling computeTransient() once per time point.
+          Vectors are allocated so that x[s] is the probability for state s,
+          for any legal state handle s.
+
+          @param  t       Array of times, in increasing order.
+
+          @param  nt      Number of times.
+
+          @param  p       On input: distribution at time 0.
+                          On output: distribution at time t[nt-1].
+
+          @param  pt      Array of nt vectors.
+                          On output: pt[k] is the distribution at time t[k].
+
+          @param  opts    Options and auxiliary vectors.
+                          On output, poisson_right is the largest
+                          right truncation point.
+      */
+      void computeTransients(const double* t, long nt, double* p, double** pt,
+        CTMC_transient_options &opts) const;
+
 
 
       /** Compute an expectation at time t, for all possible starting states.
@@ -691,6 +791,16 @@ namespace MCLib {
     private:
       // Helper methods
 
+      /// Partition refinement for lump().
+      template <class REAL>
+      long refinePartition(const REAL* selfloops, const long* initial,
+        long* block, lumping_options &opts) const;
+
+      /// Builds the lumped chain, and renumbers the blocks, for lump().
+      template <class REAL>
+      Markov_chain* buildLumped(const REAL* selfloops, long* block, 
+        long nb, bool exact, GraphLib::timer_hook *sw) const;
+
       /**
           Things common to both constructors.
           Moved here to eliminate code duplication.
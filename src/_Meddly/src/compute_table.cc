@@ -54,6 +54,7 @@ MEDDLY::ct_initializer::ct_initializer(initializer_list* prev) : initializer_lis
   setBuiltinStyle(MonolithicUnchainedHash);
   setMaxSize(16777216);
   setStaleRemoval(Moderate);
+  setMemoryLimit(0);
 }
 
 MEDDLY::ct_initializer::~ct_initializer()
@@ -87,6 +88,11 @@ void MEDDLY::ct_initializer::setMaxSize(unsigned ms)
   the_settings.maxSize = ms;
 }
 
+void MEDDLY::ct_initializer::setMemoryLimit(long bytes)
+{
+  the_settings.memoryLimit = bytes;
+}
+
 void MEDDLY::ct_initializer::setBuiltinStyle(builtinCTstyle cts)
 {
   delete builtin_ct_factory;
@@ -100,6 +106,10 @@ void MEDDLY::ct_initializer::setBuiltinStyle(builtinCTstyle cts)
           builtin_ct_factory = new monolithic_chained_style;
           break;
 
+    case MonolithicLossyHash:
+          builtin_ct_factory = new monolithic_lossy_style;
+          break;
+
     case OperationUnchainedHash:
           builtin_ct_factory = new operation_unchained_style;
           break;
@@ -132,6 +142,59 @@ MEDDLY::compute_table* MEDDLY::ct_initializer::createForOp(operation* op)
   }
 }
 
+void MEDDLY::ct_initializer::rebuildTables()
+{
+  if (0==ct_factory) throw error(error::INVALID_ASSIGNMENT, __FILE__, __LINE__);
+
+  //
+  // Empty everything first, while all operations
+  // can still make sense of their entries.
+  //
+  operation::removeAllFromMonolithic();
+  for (int i=0; i<operation::list_size; i++) {
+    operation* op = operation::op_list[i];
+    if (0==op) continue;
+    if (op->CT && op->CT != operation::Monolithic_CT) {
+      op->CT->removeAll();
+    }
+  }
+
+  //
+  // Now replace the tables.  Free search keys
+  // belong to the old tables, so discard those too.
+  //
+  for (int i=0; i<operation::list_size; i++) {
+    operation* op = operation::op_list[i];
+    if (0==op) continue;
+    while (op->CT_free_keys) {
+      compute_table::search_key* next = op->CT_free_keys->next;
+      delete op->CT_free_keys;
+      op->CT_free_keys = next;
+    }
+    if (op->CT && op->CT != operation::Monolithic_CT) delete op->CT;
+    op->CT = 0;
+  }
+  delete operation::Monolithic_CT;
+  operation::Monolithic_CT = 0;
+  if (ct_factory->usesMonolithic()) {
+    operation::Monolithic_CT = ct_factory->create(the_settings);
+  }
+  for (int i=0; i<operation::list_size; i++) {
+    operation* op = operation::op_list[i];
+    if (0==op || 0==op->key_length) continue;
+    if (operation::Monolithic_CT) {
+      op->CT = operation::Monolithic_CT;
+    } else {
+      op->CT = createForOp(op);
+    }
+  }
+}
+
+long MEDDLY::ct_initializer::getMemoryLimit()
+{
+  return the_settings.memoryLimit;
+}
+
 // **********************************************************************
 // *                                                                    *
 // *                    compute_table_style  methods                    *
@@ -201,6 +264,27 @@ MEDDLY::compute_table::~compute_table()
 {
 }
 
+bool MEDDLY::compute_table::isThreadSafe() const
+{
+  return false;
+}
+
+bool MEDDLY::compute_table::removeSomeStales(unsigned slots)
+{
+  removeStales();
+  return true;
+}
+
+void MEDDLY::compute_table::shrink()
+{
+  removeAll();
+}
+
+unsigned long MEDDLY::compute_table::getMemoryUsed() const
+{
+  return 0;
+}
+
 // **********************************************************************
 
 MEDDLY::compute_table::search_key::search_key(operation* _op)
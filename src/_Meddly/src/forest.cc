@@ -22,9 +22,11 @@
 // TODO: Testing
 
 #include <fstream>
+#include <climits>
 #include <sstream>
 #include "defines.h"
 #include "unique_table.h"
+#include "thread_pool.h"
 #include "hash_stream.h"
 #include "storage/bytepack.h"
 #include "reordering/reordering_factory.h"
@@ -61,6 +63,181 @@
 // #define REPORT_ON_DESTROY
 // #define DUMP_ON_FOREST_DESTROY
 
+namespace MEDDLY {
+  class binary_writer;
+  class binary_reader;
+};
+
+// ******************************************************************
+// *                                                                *
+// *                      binary_writer  class                      *
+// *                                                                *
+// ******************************************************************
+
+/// Growable byte buffer, used to build binary blocks in memory.
+class MEDDLY::binary_writer {
+  public:
+    binary_writer() {
+      data = 0;
+      size = 0;
+      alloc = 0;
+    }
+    ~binary_writer() {
+      free(data);
+    }
+    inline void putVarint(unsigned long a) {
+      reserve(10);
+      size += varintToData(a, data+size);
+    }
+    inline void putSigned(long a) {
+      putVarint(zigzagEncode(a));
+    }
+    inline void putBytes(const void* p, int bytes) {
+      reserve(bytes);
+      memcpy(data+size, p, bytes);
+      size += bytes;
+    }
+    inline const unsigned char* bytes() const {
+      return data;
+    }
+    inline size_t length() const {
+      return size;
+    }
+  private:
+    inline void reserve(size_t more) {
+      if (size + more <= alloc) return;
+      size_t nalloc = MAX(2*alloc, size + more + 1024);
+      unsigned char* ndata = (unsigned char*) realloc(data, nalloc);
+      if (0==ndata) throw error(error::INSUFFICIENT_MEMORY, __FILE__, __LINE__);
+      data = ndata;
+      alloc = nalloc;
+    }
+  private:
+    unsigned char* data;
+    size_t size;
+    size_t alloc;
+};
+
+// ******************************************************************
+// *                                                                *
+// *                      binary_reader  class                      *
+// *                                                                *
+// ******************************************************************
+
+/// Bounds-checked reads from a binary block in memory.
+class MEDDLY::binary_reader {
+  public:
+    binary_reader(const unsigned char* d, size_t len) {
+      ptr = d;
+      end = d + len;
+    }
+    inline unsigned long getVarint() {
+      unsigned long a;
+      ptr = dataToVarint(ptr, end, a);
+      if (0==ptr) throw error(error::INVALID_FILE, __FILE__, __LINE__);
+      return a;
+    }
+    inline long getSigned() {
+      return zigzagDecode(getVarint());
+    }
+    inline void getBytes(void* p, int bytes) {
+      if (end - ptr < bytes) throw error(error::INVALID_FILE, __FILE__, __LINE__);
+      memcpy(p, ptr, bytes);
+      ptr += bytes;
+    }
+    inline const unsigned char* position() const {
+      return ptr;
+    }
+  private:
+    const unsigned char* ptr;
+    const unsigned char* end;
+};
+
+// ******************************************************************
+// *                                                                *
+// *                     binary format  helpers                     *
+// *                                                                *
+// ******************************************************************
+
+namespace MEDDLY {
+  /// Identifies binary blocks, followed by the format version.
+  const unsigned char binary_magic[4] = { 'M', 'D', 'D', 'B' };
+  const unsigned char binary_version = 1;
+
+  /*
+      Edge values.  Integers are written as variable-length integers,
+      anything else is written as raw bytes.
+  */
+  inline void putEdgeValue(binary_writer &w, const expert_forest* f,
+    const void* ev)
+  {
+    if (forest::INTEGER == f->getRangeType()) {
+      if (sizeof(long) == f->edgeBytes()) {
+        long v;
+        memcpy(&v, ev, sizeof(long));
+        w.putSigned(v);
+        return;
+      }
+      if (sizeof(int) == f->edgeBytes()) {
+        int v;
+        memcpy(&v, ev, sizeof(int));
+        w.putSigned(v);
+        return;
+      }
+    }
+    w.putBytes(ev, f->edgeBytes());
+  }
+
+  inline void getEdgeValue(binary_reader &r, const expert_forest* f, void* ev)
+  {
+    if (forest::INTEGER == f->getRangeType()) {
+      if (sizeof(long) == f->edgeBytes()) {
+        long v = r.getSigned();
+        memcpy(ev, &v, sizeof(long));
+        return;
+      }
+      if (sizeof(int) == f->edgeBytes()) {
+        int v = r.getSigned();
+        memcpy(ev, &v, sizeof(int));
+        return;
+      }
+    }
+    r.getBytes(ev, f->edgeBytes());
+  }
+
+  /*
+      Downward pointers.  Terminals are written as their handle,
+      nodes as the distance back (in output order) from the node
+      being written, which is small for most nodes.
+  */
+  inline void putDown(binary_writer &w, const expert_forest* f,
+    node_handle d, int current, const node_handle* index2output)
+  {
+    if (f->isTerminalNode(d)) {
+      w.putVarint((zigzagEncode(d) << 1) | 1);
+    } else {
+      w.putVarint((unsigned long)(current - index2output[d]) << 1);
+    }
+  }
+
+  /// Returns a handle that the caller must link, if needed.
+  inline node_handle getDown(binary_reader &r, int current,
+    const node_handle* map)
+  {
+    unsigned long x = r.getVarint();
+    if (x & 1) {
+      long t = zigzagDecode(x >> 1);
+      if (t > 0) throw error(error::INVALID_FILE, __FILE__, __LINE__);
+      return node_handle(t);
+    }
+    unsigned long back = x >> 1;
+    if (0==back || back >= (unsigned long) current) {
+      throw error(error::INVALID_FILE, __FILE__, __LINE__);
+    }
+    return map[current - back];
+  }
+};
+
 // ******************************************************************
 // *                                                                *
 // *                    forest::policies methods                    *
@@ -74,6 +251,7 @@ MEDDLY::forest::policies::policies()
 {
   nodemm = 0;   // 
   nodestor = 0; // should cause an exception later
+  unique = unique_table_type::CHAINED;
 }
 
 MEDDLY::forest::policies::policies(bool rel) 
@@ -91,6 +269,10 @@ void MEDDLY::forest::policies::useDefaults(bool rel)
   compact_frac = 40;
   zombieTrigger = 1000000;
   orphanTrigger = 500000;
+  memoryTrigger = 0;
+  gcIncrement = 0;
+  memoryLimit = 0;
+  reorderTrigger = 0;
   compactAfterGC = false;
   compactBeforeExpand = true;
 
@@ -101,8 +283,13 @@ void MEDDLY::forest::policies::useDefaults(bool rel)
 
   nodestor = SIMPLE_STORAGE;
 
-  reorder = reordering_type::SINK_DOWN;
+  reorder = reordering_type::SIFTING;
   swap = variable_swap_type::VAR;
+  reorderMaxGrowth = 1.2;
+  reorderVarSeconds = 0;
+  reorderWindow = 3;
+
+  unique = unique_table_type::CHAINED;
 }
 
 // ******************************************************************
@@ -111,11 +298,14 @@ void MEDDLY::forest::policies::useDefaults(bool rel)
 // *                                                                *
 // ******************************************************************
 
+long MEDDLY::forest::statset::all_memory_used = 0;
+
 MEDDLY::forest::statset::statset()
 {
   reclaimed_nodes = 0;
   num_compactions = 0;
   garbage_collections = 0;
+  memory_sheds = 0;
   zombie_nodes = 0;
   orphan_nodes = 0;
   active_nodes = 0;
@@ -180,6 +370,20 @@ void MEDDLY::forest::logger::currentTime(long &sec, long &usec)
 #endif
 }
 
+// ******************************************************************
+// *                                                                *
+// *                  forest::checkpointer methods                  *
+// *                                                                *
+// ******************************************************************
+
+MEDDLY::forest::checkpointer::checkpointer()
+{
+}
+
+MEDDLY::forest::checkpointer::~checkpointer()
+{
+}
+
 // ******************************************************************
 // *                                                                *
 // *                                                                *
@@ -280,6 +484,7 @@ MEDDLY::forest
   //
   opCount = 0;
   szOpCount = 0;
+  stale_op = 0;
   //
   // Initialize list of registered dd_edges
   //
@@ -299,6 +504,7 @@ MEDDLY::forest
   //
 
   theLogger = 0;
+  theCheckpointer = 0;
 }
 
 MEDDLY::forest::~forest()
@@ -308,6 +514,8 @@ MEDDLY::forest::~forest()
 #endif
   // operations are deleted elsewhere...
   free(opCount);
+  // whatever node memory is left goes with us
+  statset::all_memory_used -= stats.memory_used;
   // Make SURE our edges are orphaned
   for (unsigned i = 0; i < firstFree; ++i) {
     if (edge[i].edge) edge[i].edge->orphan();
@@ -457,6 +665,22 @@ void MEDDLY::forest::removeStaleComputeTableEntries()
   }
 }
 
+bool MEDDLY::forest::removeSomeStaleComputeTableEntries(unsigned slots)
+{
+  if (operation::usesMonolithicComputeTable()) {
+    return operation::removeSomeStalesFromMonolithic(slots);
+  }
+  // Sweep the operation tables one after another
+  while (stale_op < szOpCount && 0==opCount[stale_op]) stale_op++;
+  if (stale_op < szOpCount) {
+    operation* op = operation::getOpWithIndex(stale_op);
+    if (op->removeSomeStaleComputeTableEntries(slots)) stale_op++;
+  }
+  if (stale_op < szOpCount) return false;
+  stale_op = 0;
+  return true;
+}
+
 void MEDDLY::forest::removeAllComputeTableEntries()
 {
   if (is_marked_for_deletion) return;
@@ -689,6 +913,7 @@ const unsigned int MEDDLY::expert_forest::SHOW_DETAILS    = 0x04;
 const unsigned int MEDDLY::expert_forest::SHOW_INDEX      = 0x02;
 const unsigned int MEDDLY::expert_forest::SHOW_TERMINALS  = 0x01;
 
+long MEDDLY::expert_forest::all_mem_check_at = LONG_MAX;
 
 MEDDLY::expert_forest::expert_forest(int ds, domain *d, bool rel, range_type t,
   edge_labeling ev, const policies &p, int* level_reduction_rule)
@@ -713,6 +938,13 @@ MEDDLY::expert_forest::expert_forest(int ds, domain *d, bool rel, range_type t,
   //
   unique = new unique_table(this);
   performing_gc = false;
+  gc_sweeping = false;
+  gc_memory_trigger = p.memoryTrigger;
+  setMemoryCheck();
+  reorder_trigger = p.reorderTrigger;
+  reorder_due = false;
+  workers = 0;
+  shared_size = 0;
   in_validate = 0;
   in_val_size = 0;
   delete_depth = 0;
@@ -1227,11 +1459,19 @@ void MEDDLY::expert_forest
     s << " current memory allocated\n" << pad;
     s.put_mem(getPeakMemoryAllocated(), human);
     s << " peak memory allocated\n";
+    if (deflt.memoryLimit > 0) {
+      s << pad;
+      s.put_mem(deflt.memoryLimit, human);
+      s << " memory limit\n";
+    }
   }
   if (flags & EXTRA_STATS) {
     s << pad << stats.reclaimed_nodes << " reclaimed nodes\n";
     s << pad << stats.num_compactions << " compactions\n";
     s << pad << stats.garbage_collections << " garbage collections\n";
+    if (deflt.memoryLimit > 0 || ct_initializer::getMemoryLimit() > 0) {
+      s << pad << stats.memory_sheds << " compute table sheds\n";
+    }
   }
   // forest specific
   reportForestStats(s, pad);
@@ -1248,15 +1488,15 @@ void MEDDLY::expert_forest
 // '                                                                '
 // ''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''
 
-void MEDDLY::expert_forest
-::writeEdges(output &s, const dd_edge* E, int n) const
+MEDDLY::node_handle* MEDDLY::expert_forest
+::orderNodesForOutput(const dd_edge* E, int n, int &num_nodes,
+  node_handle* &index2output) const
 {
   node_handle* eRaw = new node_handle[n];
   for (int i=0; i<n; i++) {
     eRaw[i] = E[i].getNode();
   }
   node_handle* output2index = markNodesInSubgraph(eRaw, n, false);
-  delete[] eRaw;
 
   // move a pointer to the end of the list, and
   // find the largest node index we're writing
@@ -1265,7 +1505,7 @@ void MEDDLY::expert_forest
   for (last = 0; output2index[last]; last++) { 
     maxnode = MAX(maxnode, output2index[last]);
   };
-  int num_nodes = last;
+  num_nodes = last;
   last--;
 
   // arrange nodes to output, by levels
@@ -1291,8 +1531,8 @@ void MEDDLY::expert_forest
   } // loop over levels
 
   // build the inverse mapping
-  node_handle* index2output = new node_handle[maxnode+1];
-  for (int i=0; i<maxnode; i++) index2output[i] = 0;
+  index2output = new node_handle[maxnode+1];
+  for (int i=0; i<=maxnode; i++) index2output[i] = 0;
   for (int i=0; output2index[i]; i++) {
     MEDDLY_CHECK_RANGE(1, output2index[i], maxnode+1);
     index2output[output2index[i]] = i+1;
@@ -1315,6 +1555,17 @@ void MEDDLY::expert_forest
   printf("\n");
 #endif
 
+  delete[] eRaw;
+  return output2index;
+}
+
+void MEDDLY::expert_forest
+::writeEdges(output &s, const dd_edge* E, int n) const
+{
+  int num_nodes;
+  node_handle* index2output;
+  node_handle* output2index = orderNodesForOutput(E, n, num_nodes, index2output);
+
   // Write the nodes
   const char* block = codeChars();
   s << block << " " << num_nodes << "\n";
@@ -1539,6 +1790,324 @@ void MEDDLY::expert_forest::readEdges(input &s, dd_edge* E, int n)
   }
 }
 
+void MEDDLY::expert_forest
+::writeEdgesBinary(output &s, const dd_edge* E, int n) const
+{
+  int num_nodes;
+  node_handle* index2output;
+  node_handle* output2index = orderNodesForOutput(E, n, num_nodes, index2output);
+
+  binary_writer w;
+
+  //
+  // Forest type and domain bounds
+  //
+  const char* block = codeChars();
+  w.putVarint(strlen(block));
+  w.putBytes(block, strlen(block));
+  w.putVarint(getNumVariables());
+  w.putVarint(isForRelations() ? 1 : 0);
+  for (int k=1; k<=getNumVariables(); k++) {
+    w.putVarint(getLevelSize(k));
+    if (isForRelations()) w.putVarint(getLevelSize(-k));
+  }
+
+  //
+  // Nodes, as runs of nodes at the same level
+  //
+  w.putVarint(num_nodes);
+  unpacked_node* un = unpacked_node::useUnpackedNode();
+  for (int i=0; i<num_nodes; ) {
+    int k = getNodeLevel(output2index[i]);
+    int run;
+    for (run=1; i+run < num_nodes; run++) {
+      if (getNodeLevel(output2index[i+run]) != k) break;
+    }
+    w.putSigned(k);
+    w.putVarint(run);
+
+    for (int stop = i+run; i<stop; i++) {
+      un->initFromNode(this, output2index[i], unpacked_node::AS_STORED);
+      const int nn = un->isSparse() ? un->getNNZs() : un->getSize();
+      w.putVarint(((unsigned long) nn << 1) | (un->isSparse() ? 1 : 0));
+      if (un->isSparse()) {
+        int prev = -1;
+        for (int z=0; z<nn; z++) {
+          w.putVarint(un->i(z) - prev - 1);
+          prev = un->i(z);
+        }
+      }
+      for (int z=0; z<nn; z++) {
+        putDown(w, this, un->d(z), i+1, index2output);
+      }
+      if (edgeBytes()) {
+        for (int z=0; z<nn; z++) {
+          putEdgeValue(w, this, un->eptr(z));
+        }
+      }
+      if (unhashedHeaderBytes()) {
+        w.putBytes(un->UHptr(), unhashedHeaderBytes());
+      }
+      if (hashedHeaderBytes()) {
+        w.putBytes(un->HHptr(), hashedHeaderBytes());
+      }
+    } // for i
+  } // for runs
+  unpacked_node::recycle(un);
+
+  //
+  // Edges
+  //
+  w.putVarint(n);
+  for (int i=0; i<n; i++) {
+    if (isMultiTerminal()) {
+      // no edge value
+    } else if (INTEGER == getRangeType()) {
+      long ev;
+      E[i].getEdgeValue(ev);
+      w.putSigned(ev);
+    } else {
+      float ev;
+      E[i].getEdgeValue(ev);
+      w.putBytes(&ev, sizeof(float));
+    }
+    putDown(w, this, E[i].getNode(), num_nodes+1, index2output);
+  }
+
+  delete[] index2output;
+  free(output2index);
+
+  //
+  // Write the block: magic, version, length, body
+  //
+  unsigned char head[16];
+  memcpy(head, binary_magic, 4);
+  head[4] = binary_version;
+  int hlen = 5 + varintToData(w.length(), head+5);
+  if (s.write(hlen, head) != hlen) {
+    throw error(error::COULDNT_WRITE, __FILE__, __LINE__);
+  }
+  if (s.write(w.length(), w.bytes()) != int(w.length())) {
+    throw error(error::COULDNT_WRITE, __FILE__, __LINE__);
+  }
+}
+
+size_t MEDDLY::expert_forest
+::readEdgesBinary(const void* data, size_t len, dd_edge* E, int n)
+{
+  const unsigned char* start = (const unsigned char*) data;
+
+  //
+  // Block header
+  //
+  if (len < 5 || memcmp(start, binary_magic, 4) || start[4] != binary_version) {
+    throw error(error::INVALID_FILE, __FILE__, __LINE__);
+  }
+  binary_reader head(start+5, len-5);
+  unsigned long body_len = head.getVarint();
+  size_t head_len = head.position() - start;
+  if (body_len > len - head_len) {
+    throw error(error::INVALID_FILE, __FILE__, __LINE__);
+  }
+  binary_reader r(head.position(), body_len);
+
+  //
+  // Forest type and domain bounds must be compatible
+  //
+  const char* block = codeChars();
+  char buffer[40];
+  unsigned long blocklen = r.getVarint();
+  if (blocklen != strlen(block) || blocklen >= sizeof(buffer)) {
+    throw error(error::INVALID_FILE, __FILE__, __LINE__);
+  }
+  r.getBytes(buffer, blocklen);
+  if (memcmp(buffer, block, blocklen)) {
+    throw error(error::INVALID_FILE, __FILE__, __LINE__);
+  }
+  if (r.getVarint() != (unsigned long) getNumVariables()) {
+    throw error(error::INVALID_FILE, __FILE__, __LINE__);
+  }
+  if (r.getVarint() != (isForRelations() ? 1u : 0u)) {
+    throw error(error::INVALID_FILE, __FILE__, __LINE__);
+  }
+  for (int k=1; k<=getNumVariables(); k++) {
+    for (int p=0; p <= (isForRelations() ? 1 : 0); p++) {
+      unsigned long bound = r.getVarint();
+      if (isExtensibleLevel(k)) continue;
+      if (bound > (unsigned long) getLevelSize(p ? -k : k)) {
+        throw error(error::INVALID_FILE, __FILE__, __LINE__);
+      }
+    }
+  }
+
+  //
+  // Nodes
+  //
+  long num_nodes = r.getVarint();
+  if (num_nodes < 0 || (unsigned long) num_nodes > body_len) {
+    throw error(error::INVALID_FILE, __FILE__, __LINE__);
+  }
+  node_handle* map = new node_handle[num_nodes+1];
+  for (long i=0; i<=num_nodes; i++) map[i] = 0;
+
+  try {
+    for (int node_index=1; node_index<=num_nodes; ) {
+      long k = r.getSigned();
+      if (k < -getNumVariables() || k > getNumVariables() || !isValidLevel(k)) {
+        throw error(error::INVALID_LEVEL, __FILE__, __LINE__);
+      }
+      unsigned long run = r.getVarint();
+      if (0==run || run > (unsigned long) (num_nodes - node_index + 1)) {
+        throw error(error::INVALID_FILE, __FILE__, __LINE__);
+      }
+      const bool ext = isExtensibleLevel(k);
+      const long size = getLevelSize(k);
+
+      for (int stop = node_index+run; node_index<stop; node_index++) {
+        unsigned long x = r.getVarint();
+        long nn = x >> 1;
+        if (!ext && nn > size) {
+          throw error(error::INVALID_FILE, __FILE__, __LINE__);
+        }
+        unpacked_node* nb = (x & 1)
+          ? unpacked_node::newSparse(this, k, nn)
+          : unpacked_node::newFull(this, k, nn);
+
+        int linked = 0;
+        try {
+          if (x & 1) {
+            long idx = -1;
+            for (int z=0; z<nn; z++) {
+              idx += 1 + r.getVarint();
+              if (!ext && idx >= size) {
+                throw error(error::INVALID_FILE, __FILE__, __LINE__);
+              }
+              nb->i_ref(z) = idx;
+            }
+          }
+          for (; linked<nn; linked++) {
+            nb->d_ref(linked) = linkNode(getDown(r, node_index, map));
+          }
+          if (nb->hasEdges()) {
+            for (int z=0; z<nn; z++) {
+              getEdgeValue(r, this, nb->eptr_write(z));
+            }
+          }
+          if (unhashedHeaderBytes()) {
+            r.getBytes(nb->UHdata(), unhashedHeaderBytes());
+          }
+          if (hashedHeaderBytes()) {
+            r.getBytes(nb->HHdata(), hashedHeaderBytes());
+          }
+        }
+        catch (error& e) {
+          // nb is not a node yet; undo the links we made for it
+          for (int z=0; z<linked; z++) unlinkNode(nb->d(z));
+          unpacked_node::recycle(nb);
+          throw e;
+        }
+
+        map[node_index] = createReducedNode(-1, nb);
+      } // for node_index
+    } // for runs
+
+    //
+    // Edges
+    //
+    unsigned long num_ptrs = r.getVarint();
+    if (num_ptrs > (unsigned long) n) {
+      throw error(error::INVALID_ASSIGNMENT, __FILE__, __LINE__);
+    }
+    for (int i=0; i<int(num_ptrs); i++) {
+      dd_edge e(this);
+      if (isMultiTerminal()) {
+        e.set(linkNode(getDown(r, num_nodes+1, map)));
+      } else if (INTEGER == getRangeType()) {
+        long ev = r.getSigned();
+        e.set(linkNode(getDown(r, num_nodes+1, map)), ev);
+      } else {
+        float ev;
+        r.getBytes(&ev, sizeof(float));
+        e.set(linkNode(getDown(r, num_nodes+1, map)), ev);
+      }
+      E[i] = e;
+    }
+  } // try
+  catch (error& e) {
+    for (long i=0; i<=num_nodes; i++) unlinkNode(map[i]);
+    delete[] map;
+    throw e;
+  }
+
+  // unlink map pointers
+  for (long i=0; i<=num_nodes; i++) unlinkNode(map[i]);
+  delete[] map;
+
+#ifdef DEVELOPMENT_CODE
+  validateIncounts(true);
+#endif
+
+  return head_len + body_len;
+}
+
+void MEDDLY::expert_forest::readEdgesBinary(input &s, dd_edge* E, int n)
+{
+  // read the header, one byte at a time for the length
+  unsigned char head[16];
+  if (s.read(5, head) != 5) {
+    throw error(error::INVALID_FILE, __FILE__, __LINE__);
+  }
+  int hlen = 5;
+  do {
+    if (hlen >= 15 || s.read(1, head+hlen) != 1) {
+      throw error(error::INVALID_FILE, __FILE__, __LINE__);
+    }
+    hlen++;
+  } while (head[hlen-1] & 0x80);
+
+  unsigned long body_len;
+  if (0==dataToVarint(head+5, head+hlen, body_len)) {
+    throw error(error::INVALID_FILE, __FILE__, __LINE__);
+  }
+  unsigned char* block = (unsigned char*) malloc(hlen + body_len);
+  if (0==block) {
+    throw error(error::INSUFFICIENT_MEMORY, __FILE__, __LINE__);
+  }
+  memcpy(block, head, hlen);
+  try {
+    if (s.read(int(body_len), block+hlen) != int(body_len)) {
+      throw error(error::INVALID_FILE, __FILE__, __LINE__);
+    }
+    readEdgesBinary(block, hlen + body_len, E, n);
+  }
+  catch (error& e) {
+    free(block);
+    throw e;
+  }
+  free(block);
+}
+
+void MEDDLY::expert_forest::saveCheckpoint(node_handle p)
+{
+  MEDDLY_DCASSERT(theCheckpointer);
+  dd_edge e(this);
+  e.set(linkNode(p));
+  theCheckpointer->save(e);
+}
+
+void MEDDLY::expert_forest::saveCheckpoint(const unpacked_node &nb)
+{
+  MEDDLY_DCASSERT(theCheckpointer);
+  MEDDLY_DCASSERT(nb.isFull());
+  unpacked_node* copy = unpacked_node::newFull(this, nb.getLevel(), nb.getSize());
+  for (int i=0; i<nb.getSize(); i++) {
+    copy->d_ref(i) = linkNode(nb.d(i));
+  }
+  dd_edge e(this);
+  e.set(createReducedNode(-1, copy));
+  theCheckpointer->save(e);
+}
+
 void MEDDLY::expert_forest::garbageCollect()
 {
   if (performing_gc) return;
@@ -1572,6 +2141,37 @@ void MEDDLY::expert_forest::garbageCollect()
     removeStaleComputeTableEntries();
   }
 
+  finishGarbageCollection();
+  performing_gc = false;
+}
+
+void MEDDLY::expert_forest::garbageCollectStep()
+{
+  if (0 == deflt.gcIncrement) {
+    garbageCollect();
+    return;
+  }
+  if (performing_gc) return;
+  performing_gc = true;
+  if (!gc_sweeping) {
+    stats.garbage_collections++;
+    gc_sweeping = true;
+  }
+
+  if (removeSomeStaleComputeTableEntries(deflt.gcIncrement)) {
+#ifdef DEBUG_GC
+    printf("Incremental garbage collection done\n");
+    fflush(stdout);
+#endif
+    finishGarbageCollection();
+  }
+  performing_gc = false;
+}
+
+void MEDDLY::expert_forest::finishGarbageCollection()
+{
+  gc_sweeping = false;
+
   if (deflt.compactAfterGC) {
 #ifdef DEBUG_GC
     printf("Compacting levels...\n");
@@ -1586,7 +2186,69 @@ void MEDDLY::expert_forest::garbageCollect()
 #endif
   }
 
-  performing_gc = false;
+  //
+  // If the live nodes alone are over the memory trigger,
+  // wait for memory to grow by half before collecting again.
+  //
+  if (deflt.memoryTrigger > 0) {
+    gc_memory_trigger = MAX(deflt.memoryTrigger, 
+      stats.memory_used + stats.memory_used / 2);
+  }
+}
+
+void MEDDLY::expert_forest::checkMemoryLimits()
+{
+  if (performing_gc) return;
+  if (isOverMemoryLimit()) {
+#ifdef DEBUG_GC
+    printf("Over memory limit, shrinking compute tables\n");
+    fflush(stdout);
+#endif
+    stats.memory_sheds++;
+    operation::shrinkComputeTables();
+  }
+  if (isOverMemoryLimit()) {
+#ifdef DEBUG_GC
+    printf("Still over memory limit, collecting garbage\n");
+    fflush(stdout);
+#endif
+    garbageCollect();
+    compactMemory();
+  }
+  if (isOverMemoryLimit()) {
+    throw error(error::INSUFFICIENT_MEMORY, __FILE__, __LINE__);
+  }
+  setMemoryCheck();
+}
+
+bool MEDDLY::expert_forest::isOverMemoryLimit() const
+{
+  if (deflt.memoryLimit > 0 && stats.memory_used > deflt.memoryLimit) {
+    return true;
+  }
+  long limit = ct_initializer::getMemoryLimit();
+  if (limit <= 0) return false;
+  return statset::all_memory_used 
+    + long(operation::computeTableMemory()) > limit;
+}
+
+void MEDDLY::expert_forest::setMemoryCheck()
+{
+  mem_check_at = (deflt.memoryLimit > 0) ? deflt.memoryLimit : LONG_MAX;
+
+  long limit = ct_initializer::getMemoryLimit();
+  if (limit <= 0) {
+    all_mem_check_at = LONG_MAX;
+    return;
+  }
+  //
+  // The compute tables can grow without any node being created,
+  // so check again after using half of the remaining room
+  // (but not too often).
+  //
+  long room = limit - statset::all_memory_used 
+    - long(operation::computeTableMemory());
+  all_mem_check_at = statset::all_memory_used + MAX(room/2, limit/64);
 }
 
 void MEDDLY::expert_forest::compactMemory()
@@ -1712,6 +2374,22 @@ void MEDDLY::expert_forest::readUnhashedHeader(input &s, unpacked_node &nb) cons
   throw error(error::TYPE_MISMATCH, __FILE__, __LINE__);
 }
 
+void MEDDLY::expert_forest::autoReorderVariables()
+{
+  garbageCollect();
+  if (getNumVariables() > 1) {
+    removeAllComputeTableEntries();
+
+    // Search on a private copy of the order, as in reorderVariables()
+    var_order = std::make_shared<variable_order>(*var_order);
+    auto reordering = reordering_factory::create(getPolicies().reorder);
+    reordering->improveOrder(this);
+    var_order = useDomain()->makeVariableOrder(*var_order);
+  }
+  reorder_trigger = MAX(reorder_trigger, 2 * getCurrentNumNodes());
+  reorder_due = false;
+}
+
 void MEDDLY::expert_forest::reorderVariables(const int* level2var)
 {
   removeAllComputeTableEntries();
@@ -1726,6 +2404,37 @@ void MEDDLY::expert_forest::reorderVariables(const int* level2var)
   var_order = useDomain()->makeVariableOrder(*var_order);
 }
 
+bool MEDDLY::expert_forest::startSharing(thread_pool* P)
+{
+  MEDDLY_DCASSERT(P);
+  MEDDLY_DCASSERT(0==workers);
+
+  //
+  // Nodes cannot grow past the level sizes,
+  // so we know the most memory a node needs.
+  //
+  shared_size = 1;
+  for (int k=1; k<=getNumVariables(); k++) {
+    if (isExtensibleLevel(k)) return false;
+    shared_size = MAX(shared_size, getLevelSize(k));
+    if (isForRelations()) shared_size = MAX(shared_size, getLevelSize(-k));
+  }
+
+  if (!nodeMan->reserveNodes(P->nodeMargin(), shared_size, true)) return false;
+  nodeHeaders.reserveHandles(P->nodeMargin(), true);
+  nodeHeaders.setShared(true);
+  workers = P;
+  return true;
+}
+
+void MEDDLY::expert_forest::stopSharing()
+{
+  MEDDLY_DCASSERT(workers);
+  workers = 0;
+  nodeHeaders.setShared(false);
+  nodeHeaders.sweep();
+}
+
 // ''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''
 // '                                                                '
 // '                                                                '
@@ -1891,6 +2600,9 @@ MEDDLY::node_handle MEDDLY::expert_forest
     return getTransparentNode();
   }
 
+  // other threads are building nodes, too
+  if (workers) return createSharedNode(nb);
+
   // check for duplicates in unique table
   node_handle q = unique->find(nb, getVarByLevel(nb.getLevel()));
   if (q) {
@@ -1908,8 +2620,9 @@ MEDDLY::node_handle MEDDLY::expert_forest
 
   // NOW is the best time to run the garbage collector, if necessary.
 #ifndef GC_OFF
-  if (isTimeToGc()) garbageCollect();
+  if (isTimeToGc()) garbageCollectStep();
 #endif
+  if (isTimeToCheckMemory()) checkMemoryLimits();
 
   // Grab a new node
   node_handle p = nodeHeaders.getFreeNodeHandle();
@@ -1946,6 +2659,91 @@ MEDDLY::node_handle MEDDLY::expert_forest
   return p;
 }
 
+MEDDLY::node_handle MEDDLY::expert_forest
+::createSharedNode(unpacked_node &nb)
+{
+  MEDDLY_DCASSERT(workers);
+  MEDDLY_DCASSERT(nb.getSize() <= shared_size);
+
+  // Park here, with no locks held, if someone needs to move memory
+  workers->safepoint();
+
+  //
+  // Make sure we can grab a handle and node memory without moving
+  // anything.  Every thread that passes this check allocates at most
+  // once before checking again, so a margin of twice the number of
+  // threads always leaves room for everyone.
+  //
+  const int margin = workers->nodeMargin();
+  for (;;) {
+    bool room;
+    {
+      std::lock_guard<std::mutex> guard(workers->allocLock());
+      room = nodeHeaders.reserveHandles(margin, false)
+              && nodeMan->reserveNodes(margin, shared_size, false);
+    }
+    if (room) break;
+    workers->exclusive([this, margin]() { growShared(margin); });
+  }
+
+  //
+  // As in createReducedHelper(), but the search and the
+  // new node must happen while holding the unique table lock.
+  //
+  const int var = getVarByLevel(nb.getLevel());
+  unique->lock(var);
+  node_handle q = unique->find(nb, var);
+  if (q) {
+    linkNode(q);
+    unique->unlock(var);
+    // unlink all downward pointers
+    int rawsize = nb.isSparse() ? nb.getNNZs() : nb.getSize();
+    for (int i = 0; i<rawsize; i++)  unlinkNode(nb.d(i));
+    return q;
+  }
+
+  node_handle p;
+  try {
+    std::lock_guard<std::mutex> guard(workers->allocLock());
+    p = nodeHeaders.getFreeNodeHandle();
+    nodeHeaders.setNodeLevel(p, nb.getLevel());
+    MEDDLY_DCASSERT(0 == nodeHeaders.getNodeCacheCount(p));
+    MEDDLY_DCASSERT(0 == nodeHeaders.getIncomingCount(p));
+
+    stats.incActive(1);
+    if (theLogger && theLogger->recordingNodeCounts()) {
+      theLogger->addToActiveNodeCount(this, nb.getLevel(), 1);
+    }
+    nodeHeaders.setNodeAddress(p, nodeMan->makeNode(p, nb, getNodeStorage()));
+  }
+  catch (...) {
+    unique->unlock(var);
+    throw;
+  }
+  linkNode(p);
+  unique->add(nb.hash(), p);
+  unique->unlock(var);
+
+#ifdef DEBUG_CREATE_REDUCED
+  printf("Created shared node %ld\n", long(p));
+#endif
+  return p;
+}
+
+void MEDDLY::expert_forest::growShared(int margin)
+{
+  //
+  // Everyone else is parked; clean up what they left behind,
+  // before making more room.
+  //
+  nodeHeaders.setShared(false);
+  nodeHeaders.sweep();
+  nodeHeaders.reserveHandles(margin, true);
+  bool ok = nodeMan->reserveNodes(margin, shared_size, true);
+  nodeHeaders.setShared(true);
+  if (!ok) throw error(error::INSUFFICIENT_MEMORY, __FILE__, __LINE__);
+}
+
 MEDDLY::node_handle MEDDLY::expert_forest
 ::createReducedExtensibleNodeHelper(int in, unpacked_node &nb)
 {
@@ -2000,8 +2798,9 @@ MEDDLY::node_handle MEDDLY::expert_forest
 
   // NOW is the best time to run the garbage collector, if necessary.
 #ifndef GC_OFF
-  if (isTimeToGc()) garbageCollect();
+  if (isTimeToGc()) garbageCollectStep();
 #endif
+  if (isTimeToCheckMemory()) checkMemoryLimits();
 
   // Expand level size
   const int nb_ext_i = nb.ext_i();
@@ -33,6 +33,7 @@
 #include "operations/init_builtin.h"
 #include "forests/init_forests.h"
 #include "storage/init_storage.h"
+#include "thread_pool.h"
 
 // #define STATS_ON_DESTROY
 
@@ -60,6 +61,7 @@ namespace MEDDLY {
   int operation::list_size = 0;
   int operation::list_alloc = 0;
   int operation::free_list = -1;
+  bool operation::concurrent = false;
 
   //
   // List of all domains
@@ -70,8 +72,8 @@ namespace MEDDLY {
   int domain::free_list = -1;
 
   //
-  // List of free unpacked nodes
-  unpacked_node* unpacked_node::freeList = 0;
+  // List of free unpacked nodes, one per thread
+  thread_local unpacked_node* unpacked_node::freeList = 0;
 
   // helper functions
   void purgeMarkedOperations();
@@ -188,6 +190,10 @@ void MEDDLY::removeOperationFromCache(operation* op)
   if (!libraryRunning) 
     throw error(error::UNINITIALIZED, __FILE__, __LINE__);
   const opname* code = op->getOpName();
+  // Operations built internally may use opnames created after
+  // the cache, and are never cached; they can still end up here
+  // if an exception (e.g., a memory limit) skipped their cleanup.
+  if (code->getIndex() >= op_cache_size) return;
 
   operation* curr;
   operation* prev = 0;
@@ -408,6 +414,9 @@ void MEDDLY::cleanup()
   delete[] op_cache;
   op_cache = 0;
 
+  // stop the saturation threads
+  thread_pool::shutdown();
+
   // clean up recycled unpacked nodes
   unpacked_node::freeRecycled();
 
@@ -420,6 +429,16 @@ void MEDDLY::cleanup()
   libraryRunning = 0;
 }
 
+void MEDDLY::setNumThreads(int n)
+{
+  thread_pool::setNumThreads(n);
+}
+
+int MEDDLY::getNumThreads()
+{
+  return thread_pool::getNumThreads();
+}
+
 //----------------------------------------------------------------------
 // front end - library info
 //----------------------------------------------------------------------
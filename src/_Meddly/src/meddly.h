@@ -326,6 +326,12 @@ namespace MEDDLY {
       TC_POST_IMAGE,
       REACHABLE_STATES_DFS, REACHABLE_STATES_BFS,
       REVERSE_REACHABLE_DFS, REVERSE_REACHABLE_BFS.
+
+      If a forest has automatic reordering enabled (policy reorderTrigger),
+      REACHABLE_STATES_DFS and the BFS operations return early when
+      reordering becomes due, with a subset of the answer that contains
+      the first operand.  The caller should reorder the forests and
+      repeat the operation, starting from that subset.
   */
   extern const binary_opname* PRE_IMAGE;
   extern const binary_opname* POST_IMAGE;
@@ -368,6 +374,24 @@ namespace MEDDLY {
   */
   void cleanup();
 
+  /** Set the number of threads for saturation.
+      With more than one thread, saturation (REACHABLE_STATES_DFS,
+      REVERSE_REACHABLE_DFS, SATURATION_FORWARD and SATURATION_BACKWARD)
+      fires events at the same level, and saturates the children
+      of a node, in parallel.
+      This happens only if the compute table is safe for concurrent
+      use (style MonolithicLossyHash, see ct_initializer), and for
+      forests that do not have extensible variables and use
+      simple node storage; otherwise saturation is sequential.
+      On-the-fly and implicit saturation are always sequential,
+      because they change the relation (and domain) as they go.
+        @param  n   Number of threads, at least 1 (the default).
+  */
+  void setNumThreads(int n);
+
+  /// Get the number of threads for saturation.
+  int getNumThreads();
+
   /** Get the information about the library.
       @param  what  Determines the type of information to obtain.
       @return A human-readable information string.
@@ -1071,7 +1095,22 @@ class MEDDLY::forest {
         // Choose the swappable inversion randomly
         RANDOM,
         // Always choose the swappable inversion with the lowest average reference count
-        LARC
+        LARC,
+        // Sink down to a given order; search for a better order by
+        // sifting (Rudell), within reorderMaxGrowth and reorderVarSeconds
+        SIFTING,
+        // Sink down to a given order; search for a better order by
+        // trying all orders of each window of reorderWindow variables
+        WINDOW
+      };
+
+      /// Supported unique table implementations.
+      enum class unique_table_type {
+        /// Hash table, chaining through the node headers.
+        CHAINED,
+        /// Open addressing; node hashes are kept in the table,
+        /// and the table is resized a little at a time.
+        OPEN_ADDRESSING
       };
 
       /// Defaults: how may we store nodes for all levels in the forest.
@@ -1084,6 +1123,16 @@ class MEDDLY::forest {
       reordering_type reorder;
       // Default variable swap strategy.
       variable_swap_type swap;
+      /// Sifting and window reordering: stop moving a variable once
+      /// the forest is this many times larger than the smallest seen.
+      double reorderMaxGrowth;
+      /// Sifting and window reordering: seconds allowed for each
+      /// variable (or window); 0 for no limit.
+      double reorderVarSeconds;
+      /// Window reordering: number of adjacent variables (2 or 3).
+      int reorderWindow;
+      /// Unique table implementation.
+      unique_table_type unique;
 
       /// Backend memory management mechanism for nodes.
       const memory_manager_style* nodemm;
@@ -1102,6 +1151,22 @@ class MEDDLY::forest {
       int zombieTrigger;
       /// Number of orphan nodes to trigger garbage collection
       int orphanTrigger;
+      /// Bytes of node memory to trigger garbage collection, in place
+      /// of the zombie and orphan triggers; 0 to use those triggers.
+      long memoryTrigger;
+      /// Incremental garbage collection: compute table slots to scan
+      /// for stale entries each time a node is created, while a
+      /// collection is under way; 0 to collect all at once.
+      int gcIncrement;
+      /// Soft limit on bytes of node memory for this forest;
+      /// 0 for no limit.  When it is exceeded, the compute tables
+      /// are emptied and shrunk, then garbage is collected and memory
+      /// compacted; if that is not enough, creating a node fails
+      /// with error INSUFFICIENT_MEMORY.
+      long memoryLimit;
+      /// Number of active nodes to trigger automatic variable
+      /// reordering (see reorder); 0 to never reorder automatically.
+      long reorderTrigger;
       /// Should we run the memory compactor after garbage collection
       bool compactAfterGC;
       /// Should we run the memory compactor before trying to expand
@@ -1138,6 +1203,9 @@ class MEDDLY::forest {
 
       void setVarSwap();
       void setLevelSwap();
+
+      void setChainedUniqueTable();
+      void setOpenUniqueTable();
     }; // end of struct policies
 
     /// Collection of various stats for performance measurement
@@ -1148,6 +1216,8 @@ class MEDDLY::forest {
       long num_compactions;
       /// Number of times the garbage collector ran.
       long garbage_collections;
+      /// Number of times the compute tables were shrunk for a memory limit.
+      long memory_sheds;
       /// Current number of zombie nodes (waiting for deletion)
       long zombie_nodes;
       /// Current number of orphan nodes (disconnected)
@@ -1168,6 +1238,8 @@ class MEDDLY::forest {
       long peak_memory_used;
       /// Peak memory allocated for nodes
       long peak_memory_alloc;
+      /// Current memory used for nodes, over all forests
+      static long all_memory_used;
 
       // unique table stats
 
@@ -1269,6 +1341,33 @@ class MEDDLY::forest {
         void fixLogger();
     };
 
+    /**
+        Abstract base class for checkpointing long computations.
+        Reachability operations whose result is in a forest with a
+        checkpointer will, between steps, ask if a checkpoint is due
+        and, if so, pass along the states found so far.
+        Those are a subset of the final answer that contains the
+        initial states; restarting the operation from them
+        therefore gives the same answer.
+    */
+    class checkpointer {
+      public:
+        checkpointer();
+        virtual ~checkpointer();
+
+        /**
+            Is a checkpoint due?
+            Called often, so this should be cheap.
+        */
+        virtual bool due() = 0;
+
+        /**
+            Save a partial result.
+              @param  partial   States found so far.
+        */
+        virtual void save(const dd_edge &partial) = 0;
+    };
+
 
   protected:
     /** Constructor -- this class cannot be instantiated.
@@ -1483,6 +1582,13 @@ class MEDDLY::forest {
     /// Remove any stale compute table entries associated with this forest.
     void removeStaleComputeTableEntries();
 
+    /** Remove some of the stale compute table entries associated with
+        this forest, scanning at most the given number of table slots
+        and picking up where the last call stopped.
+          @return   true if this call completed a sweep of the tables.
+    */
+    bool removeSomeStaleComputeTableEntries(unsigned slots);
+
     /// Remove all compute table entries associated with this forest.
     void removeAllComputeTableEntries();
 
@@ -1923,6 +2029,50 @@ class MEDDLY::forest {
     */
     virtual void readEdges(input &s, dd_edge* E, int n) = 0;
 
+    /** Write edges to a file in a compact binary format.
+        Like \a writeEdges(), but nodes are written as level-ordered
+        arrays with variable-length integers for the downward pointers
+        (relative to the node being written) and edge values.
+        The header records the variable bounds of the domain,
+        and the length of the block, so several blocks
+        (possibly from different forests) may follow each other.
+          @param  s   Stream to write to
+          @param  E   Array of edges
+          @param  n   Dimension of the edge array
+
+          @throws     COULDNT_WRITE, if writing failed
+    */
+    virtual void writeEdgesBinary(output &s, const dd_edge* E, int n) const = 0;
+
+    /** Read edges written by \a writeEdgesBinary(), from memory.
+        Intended for use with a memory-mapped file.
+          @param  data  Start of the block
+          @param  len   Number of bytes available at \a data
+          @param  E     Array of edges
+          @param  n     Dimension of the edge array
+
+          @return       Number of bytes used; the next block
+                        (if any) starts there.
+
+          @throws     INVALID_FILE, if the data does not match what we expect,
+                      including variable bounds larger than ours.
+          @throws     INVALID_ASSIGNMENT, if the block has more than
+                      \a n edges.
+    */
+    virtual size_t readEdgesBinary(const void* data, size_t len,
+      dd_edge* E, int n) = 0;
+
+    /** Read edges written by \a writeEdgesBinary(), from a stream.
+          @param  s   Stream to read from
+          @param  E   Array of edges
+          @param  n   Dimension of the edge array
+
+          @throws     INVALID_FILE, if the file does not match what we expect.
+          @throws     INVALID_ASSIGNMENT, if the block has more than
+                      \a n edges.
+    */
+    virtual void readEdgesBinary(input &s, dd_edge* E, int n) = 0;
+
     /** Force garbage collection.
         All disconnected nodes in this forest are discarded along with any
         compute table entries that may include them.
@@ -1974,6 +2124,15 @@ class MEDDLY::forest {
     */
     void setLogger(logger* L, const char* name);
 
+    /** Checkpoint long operations producing edges in this forest.
+          @param  C     Checkpointer to use; if 0, no checkpoints.
+                        Will NOT be deleted by the forest.
+    */
+    void setCheckpointer(checkpointer* C);
+
+    /// The checkpointer, if any.
+    checkpointer* getCheckpointer() const;
+
 
   // ------------------------------------------------------------
   // For derived classes.
@@ -1985,6 +2144,7 @@ class MEDDLY::forest {
     policies deflt;
     statset stats;
     logger *theLogger;
+    checkpointer *theCheckpointer;
 
   // ------------------------------------------------------------
   // Ugly details from here down.
@@ -2003,6 +2163,8 @@ class MEDDLY::forest {
 
     int* opCount;
     int szOpCount;
+    /// Operation table being swept by removeSomeStaleComputeTableEntries().
+    int stale_op;
 
     /// Register an operation with this forest.
     /// Called only within operation.
@@ -133,6 +133,14 @@ inline void MEDDLY::forest::policies::setLevelSwap() {
   swap = variable_swap_type::LEVEL;
 }
 
+inline void MEDDLY::forest::policies::setChainedUniqueTable() {
+  unique = unique_table_type::CHAINED;
+}
+
+inline void MEDDLY::forest::policies::setOpenUniqueTable() {
+  unique = unique_table_type::OPEN_ADDRESSING;
+}
+
 // end of struct policies
 
 // forest::statset::
@@ -148,12 +156,14 @@ inline void MEDDLY::forest::statset::decActive(long b) {
 }
 inline void MEDDLY::forest::statset::incMemUsed(long b) {
   memory_used += b;
+  all_memory_used += b;
   if (memory_used > peak_memory_used) 
     peak_memory_used = memory_used;
   MEDDLY_DCASSERT(memory_used >= 0);
 }
 inline void MEDDLY::forest::statset::decMemUsed(long b) {
   memory_used -= b;
+  all_memory_used -= b;
   MEDDLY_DCASSERT(memory_used >= 0);
 }
 inline void MEDDLY::forest::statset::incMemAlloc(long b) {
@@ -403,6 +413,14 @@ inline void MEDDLY::forest::setLogger(logger* L, const char* name) {
   if (theLogger) theLogger->logForestInfo(this, name);
 }
 
+inline void MEDDLY::forest::setCheckpointer(checkpointer* C) {
+  theCheckpointer = C;
+}
+
+inline MEDDLY::forest::checkpointer* MEDDLY::forest::getCheckpointer() const {
+  return theCheckpointer;
+}
+
 // forest::edge_visitor::
 inline void MEDDLY::forest::visitRegisteredEdges(edge_visitor &ev) {
   for (unsigned i = 0; i < firstFree; ++i) {
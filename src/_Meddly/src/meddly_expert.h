@@ -109,6 +109,7 @@ namespace MEDDLY {
   class unique_table;
 
   class reordering_base;
+  class thread_pool;
 
   // ******************************************************************
   // *                                                                *
@@ -132,6 +133,20 @@ namespace MEDDLY {
   extern const numerical_opname* MATR_EXPLVECT_MULT;
   // extern const numerical_opname* MATR_VECT_MULT; // renamed!
 
+  /** Computes y = y + xA, like EXPLVECT_MATR_MULT, but "hybrid":
+      when the operation is built, the submatrices of A at the split
+      level (see numerical_opname::numerical_args) are flattened into
+      sparse blocks, once, with identical submatrices sharing a block.
+      Each product then runs over the blocks only, which is much faster
+      for iterative solvers, at the cost of memory for the blocks.
+  */
+  extern const numerical_opname* HYBRID_EXPLVECT_MATR_MULT;
+
+  /** Computes y = y + Ax, like MATR_EXPLVECT_MULT, but "hybrid";
+      see HYBRID_EXPLVECT_MATR_MULT.
+  */
+  extern const numerical_opname* HYBRID_MATR_EXPLVECT_MULT;
+
   // ******************************************************************
   // *                                                                *
   // *                  Named saturation operations                   *
@@ -738,7 +753,7 @@ class MEDDLY::unpacked_node {
 
   private:
     const expert_forest* parent;
-    static unpacked_node* freeList;
+    static thread_local unpacked_node* freeList;
     unpacked_node* next; // for recycled list
     /*
       TBD - extra info that is not hashed
@@ -1102,6 +1117,19 @@ class MEDDLY::memory_manager {
     */
     virtual void* getChunkAddress(node_address h) const = 0;
 
+    /**
+        Make sure that further requests, for a total of numSlots slots,
+        will not move any existing chunk.
+        Used before several threads request chunks at once.
+
+          @param  numSlots  Total number of slots that will be requested.
+          @param  grow      If true, enlarge storage now if needed.
+
+          @return   true, if the requests cannot move chunks.
+                    The default returns false.
+    */
+    virtual bool reserveChunks(size_t numSlots, bool grow);
+
 
     /** Show various statistics.
           @param  s         Output stream to write to
@@ -1280,6 +1308,39 @@ class MEDDLY::node_headers {
     */
     void swapNodes(node_handle p, node_handle q, bool swap_incounts);
 
+  public: // shared mode, for parallel saturation
+
+    /**
+        Turn shared mode on or off.
+        In shared mode, several threads may link, unlink, cache
+        and uncache nodes at once.  The counts are updated
+        atomically, and disconnected nodes are left in place
+        until the next call to sweep().
+        Handles must be obtained with getFreeNodeHandle()
+        while holding the forest allocation lock.
+    */
+    void setShared(bool s);
+
+    /// Is shared mode on.
+    bool isShared() const;
+
+    /**
+        Make sure at least n handles can be obtained
+        without expanding the handle list.
+          @param  n     Number of handles.
+          @param  grow  If true, expand the handle list if needed.
+          @return true  iff there are n free handles.
+    */
+    bool reserveHandles(int n, bool grow);
+
+    /**
+        Delete or zombify all disconnected nodes,
+        and recycle all dead handles no longer in any cache.
+        Used after shared mode, which leaves these in place.
+        Shared mode must be off.
+    */
+    void sweep();
+
   public: // node status
     bool isActive(node_handle p) const;
     /// Is this a zombie node (dead but not able to be deleted yet)
@@ -1418,6 +1479,9 @@ class MEDDLY::node_headers {
     /// Are we using the pessimistic strategy?
     bool pessimistic;
 
+    /// Are several threads using the nodes?
+    bool shared;
+
     /// Parent forest, needed for recycling
     expert_forest &parent;
 
@@ -1533,6 +1597,17 @@ class MEDDLY::node_storage {
     */
     virtual void unlinkDownAndRecycle(node_address addr) = 0;
 
+    /** Make sure that count new nodes, with up to size downward
+        pointers each, can be made without moving existing nodes.
+        Used before several threads make nodes at once.
+            @param  count   Number of nodes.
+            @param  size    Largest number of downward pointers.
+            @param  grow    If true, enlarge storage now if needed.
+            @return         true, if the nodes can be made safely.
+                            The default returns false.
+    */
+    virtual bool reserveNodes(int count, int size, bool grow);
+
 
     // various ways to read a node
 
@@ -2058,6 +2133,72 @@ class MEDDLY::expert_forest: public forest
     node_handle*
     markNodesInSubgraph(const node_handle* roots, int N, bool sort) const;
 
+    /** Build the list of nodes below some edges, in the order
+        they are written to files: grouped by level, with every
+        node after all nodes it points to.
+
+          @param  E             Array of edges.
+          @param  n             Dimension of \a E.
+          @param  num_nodes     (Output) number of nodes in the list.
+          @param  index2output  (Output) new[]'d array, where
+                                index2output[p] is the position of
+                                node p in the list (starting from 1).
+
+          @return   A malloc'd array of non-terminal nodes, terminated by 0.
+    */
+    node_handle* orderNodesForOutput(const dd_edge* E, int n,
+      int &num_nodes, node_handle* &index2output) const;
+
+    /// Is there a checkpointer, and is a checkpoint due?
+    bool checkpointDue() const;
+
+    /** Pass a partial result to the checkpointer.
+          @param  p     Node with the states found so far;
+                        the caller keeps its reference.
+    */
+    void saveCheckpoint(node_handle p);
+
+    /** Pass a partial result to the checkpointer.
+          @param  nb    Node builder with the states found so far;
+                        it is left unchanged.
+    */
+    void saveCheckpoint(const unpacked_node &nb);
+
+    /** Is automatic variable reordering due?
+        True once the number of active nodes has grown past the
+        current trigger (if enabled), until the next call to
+        autoReorderVariables().  Saturation and BFS reachability
+        check this (for the set and relation forests) and stop early,
+        with the states found so far, so that the caller can reorder
+        and continue.
+    */
+    bool reorderingDue();
+
+    /** Let the threads of a pool build nodes in this forest.
+        Until stopSharing(), nodes are never deleted and there is
+        no garbage collection; everything else works as usual.
+        Not possible for extensible variables, or node storage
+        that cannot reserve memory (see node_storage::reserveNodes()).
+          @param  P   Pool whose threads will use the forest.
+          @return     true, on success.
+    */
+    bool startSharing(thread_pool* P);
+
+    /// End of startSharing(); clean up disconnected nodes.
+    void stopSharing();
+
+    /** Search for a better variable order, after a garbage collection,
+        using the reordering strategy in the policies, and raise the trigger to twice the number of active nodes
+        afterwards (it never decreases).
+        Must not be called while an operation is in progress.
+    */
+    void autoReorderVariables();
+
+    /** Change the number of active nodes that triggers automatic
+        reordering, from the policy setting; 0 turns it off.
+    */
+    void setReorderTrigger(long nodes);
+
     /** Count and return the number of non-terminal nodes
         in the subgraph below the given node.
     */
@@ -2231,10 +2372,21 @@ class MEDDLY::expert_forest: public forest
 
     virtual void writeEdges(output &s, const dd_edge* E, int n) const;
     virtual void readEdges(input &s, dd_edge* E, int n);
+    virtual void writeEdgesBinary(output &s, const dd_edge* E, int n) const;
+    virtual size_t readEdgesBinary(const void* data, size_t len,
+      dd_edge* E, int n);
+    virtual void readEdgesBinary(input &s, dd_edge* E, int n);
     virtual void garbageCollect();
     virtual void compactMemory();
     virtual void showInfo(output &strm, int verbosity);
 
+    /** Collect garbage because a trigger was reached.
+        With policy gcIncrement, scan only a slice of the compute
+        table(s), picking up where the last step stopped;
+        otherwise, the same as garbageCollect().
+    */
+    void garbageCollectStep();
+
   // ------------------------------------------------------------
   // abstract virtual, must be overridden.
   //
@@ -2509,6 +2661,26 @@ class MEDDLY::expert_forest: public forest
 
     bool isTimeToGc() const;
 
+    /// Has node memory grown enough to check the memory limits.
+    bool isTimeToCheckMemory() const;
+
+    /** Enforce the memory limits (see policies::memoryLimit
+        and ct_initializer::setMemoryLimit()), by shrinking the
+        compute tables, then collecting garbage and compacting.
+        Throws INSUFFICIENT_MEMORY if we are still over a limit.
+    */
+    void checkMemoryLimits();
+
+    /// Is node memory, plus compute table memory for the global
+    /// limit, over either limit.
+    bool isOverMemoryLimit() const;
+
+    /// Decide how much node memory may grow before the next check.
+    void setMemoryCheck();
+
+    /// Compaction and trigger updates at the end of a collection.
+    void finishGarbageCollection();
+
     /** Change the location of a node.
         Used by node_storage during compaction.
         Should not be called by anything else.
@@ -2549,6 +2721,14 @@ class MEDDLY::expert_forest: public forest
     */
     node_handle createReducedExtensibleNodeHelper(int in, unpacked_node &nb);
 
+    /** Finish createReducedHelper() for a node that is not
+        eliminated by reduction, while sharing the forest.
+    */
+    node_handle createSharedNode(unpacked_node &nb);
+
+    /// Sweep, and make room for the shared threads; see startSharing().
+    void growShared(int size);
+
     // Sanity check; used in development code.
     void validateDownPointers(const unpacked_node &nb) const;
 
@@ -2581,6 +2761,24 @@ class MEDDLY::expert_forest: public forest
   private:
     // Garbage collection in progress
     bool performing_gc;
+    // Incremental garbage collection under way
+    bool gc_sweeping;
+    // Node memory to trigger garbage collection, if policy memoryTrigger
+    long gc_memory_trigger;
+    // Node memory at which to check the memory limits
+    long mem_check_at;
+    // Node memory, over all forests, at which to check the global limit
+    static long all_mem_check_at;
+
+    // Active nodes to trigger automatic reordering, or 0
+    long reorder_trigger;
+    // Has the trigger been reached since the last reordering
+    bool reorder_due;
+
+    // Pool of threads sharing this forest, or 0
+    thread_pool* workers;
+    // Node size for which memory is reserved while sharing
+    int shared_size;
 
     // memory for validating incounts
     node_handle* in_validate;
@@ -2744,8 +2942,14 @@ class MEDDLY::numerical_opname : public specialized_opname {
         const dd_edge &x_ind;
         const dd_edge &A;
         const dd_edge &y_ind;
+        /** For hybrid operations: submatrices for levels split and
+            below are flattened into sparse blocks.  Use the number of
+            levels to flatten everything, or 0 for half the levels.
+        */
+        int split;
 
-        numerical_args(const dd_edge &xi, const dd_edge &a, const dd_edge &yi);
+        numerical_args(const dd_edge &xi, const dd_edge &a, const dd_edge &yi,
+          int sl = 0);
         virtual ~numerical_args();
     };
 
@@ -2755,7 +2959,7 @@ class MEDDLY::numerical_opname : public specialized_opname {
 
     /// For convenience, and backward compatability :^)
     specialized_operation* buildOperation(const dd_edge &x_ind,
-      const dd_edge &A, const dd_edge &y_ind) const;
+      const dd_edge &A, const dd_edge &y_ind, int split = 0) const;
 };
 
 
@@ -3584,6 +3788,12 @@ class MEDDLY::ct_initializer : public initializer_list {
       /// One huge hash table that does not use chaining.
       MonolithicUnchainedHash,
 
+      /** One fixed-size hash table that does not use chaining,
+          and never grows.  When full, new entries replace old ones.
+          Safe for concurrent searches and insertions.
+      */
+      MonolithicLossyHash,
+
       /// A hash table (with chaining) for each operation.
       OperationChainedHash,
 
@@ -3597,6 +3807,9 @@ class MEDDLY::ct_initializer : public initializer_list {
     struct settings {
       staleRemovalOption staleRemoval;
       unsigned maxSize;
+      /// Soft limit on bytes of node and compute table memory,
+      /// over all forests and tables; 0 for none.
+      long memoryLimit;
     };
 
   public:
@@ -3611,11 +3824,19 @@ class MEDDLY::ct_initializer : public initializer_list {
   public:
     static void setStaleRemoval(staleRemovalOption sro);
     static void setMaxSize(unsigned ms);
+    static void setMemoryLimit(long bytes);
     static void setBuiltinStyle(builtinCTstyle cts);
     static void setUserStyle(const compute_table_style*);
 
+    /** Replace all compute tables by (empty) ones of the current style.
+        Use this to change the style after library initialization;
+        all existing entries are lost.
+    */
+    static void rebuildTables();
+
     // for convenience
     static compute_table* createForOp(operation* op);
+    static long getMemoryLimit();
 
   private:
     static settings the_settings;
@@ -3772,6 +3993,11 @@ class MEDDLY::compute_table {
       /// Is this a per-operation compute table?
       virtual bool isOperationTable() const = 0;
 
+      /** Can several threads search and add entries at once.
+          The default returns false.
+      */
+      virtual bool isThreadSafe() const;
+
       /// Initialize a search key for a given operation.
       virtual search_key* initializeSearchKey(operation* op) = 0;
 
@@ -3801,10 +4027,32 @@ class MEDDLY::compute_table {
       */
       virtual void removeStales() = 0;
 
+      /** Remove some stale entries.
+          Scans up to the given number of table slots for stale entries,
+          continuing where the previous call stopped, so that a complete
+          sweep may be spread over many calls.
+          The default scans the whole table with removeStales().
+            @param  slots   Maximum number of slots to scan.
+            @return         true if this call completed a sweep
+                            of the whole table.
+      */
+      virtual bool removeSomeStales(unsigned slots);
+
       /** Removes all entries.
       */
       virtual void removeAll() = 0;
 
+      /** Removes all entries, and releases as much memory as possible.
+          Used to shed memory when a memory limit is reached.
+          The default simply calls removeAll().
+      */
+      virtual void shrink();
+
+      /** Bytes of memory used by the table.
+          The default returns 0, for tables that do not track this.
+      */
+      virtual unsigned long getMemoryUsed() const;
+
       /// Get performance stats for the table.
       const stats& getStats();
 
@@ -3846,6 +4094,8 @@ class MEDDLY::operation {
     static int list_alloc;
     // declared and initialized in meddly.cc
     static int free_list;
+    // declared and initialized in meddly.cc
+    static bool concurrent;
 
     // should ONLY be called during library cleanup.
     static void destroyAllOps();
@@ -3885,6 +4135,7 @@ class MEDDLY::operation {
     friend void MEDDLY::cleanup();
 
     friend class ct_initializer;
+    friend class thread_pool;
 
   public:
     /// New constructor.
@@ -3900,12 +4151,25 @@ class MEDDLY::operation {
     operation* getNext();
 
     static bool usesMonolithicComputeTable();
+    /// Can several threads use the compute tables at once.
+    static bool computeTablesAreThreadSafe();
     static void removeStalesFromMonolithic();
+    static bool removeSomeStalesFromMonolithic(unsigned slots);
     static void removeAllFromMonolithic();
 
+    /// Bytes of memory used by all compute tables.
+    static unsigned long computeTableMemory();
+    /// Empty and shrink all compute tables; see compute_table::shrink().
+    static void shrinkComputeTables();
+
     /// Remove stale compute table entries for this operation.
     void removeStaleComputeTableEntries();
 
+    /** Remove some stale compute table entries for this operation;
+        see compute_table::removeSomeStales().
+    */
+    bool removeSomeStaleComputeTableEntries(unsigned slots);
+
     /// Remove all compute table entries for this operation.
     void removeAllComputeTableEntries();
 
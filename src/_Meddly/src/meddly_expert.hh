@@ -544,6 +544,20 @@ inline void MEDDLY::node_headers::setPessimistic(bool pess)
 
 // ******************************************************************
 
+inline void MEDDLY::node_headers::setShared(bool s)
+{
+  shared = s;
+}
+
+// ******************************************************************
+
+inline bool MEDDLY::node_headers::isShared() const
+{
+  return shared;
+}
+
+// ******************************************************************
+
 inline MEDDLY::node_handle
 MEDDLY::node_headers::lastUsedHandle() const
 {
@@ -558,7 +572,8 @@ MEDDLY::node_headers::isActive(node_handle p) const
   if (p<=0) return true;
   if (p>a_last) return false;
   MEDDLY_DCASSERT(address);
-  return address[p].offset;
+  // recycled handles keep the free list in the offset, with level 0
+  return address[p].offset && address[p].level;
 }
 
 // ******************************************************************
@@ -666,6 +681,7 @@ MEDDLY::node_headers::getNodeCacheCount(node_handle p) const
   MEDDLY_DCASSERT(address);
   MEDDLY_DCASSERT(p>0);
   MEDDLY_DCASSERT(p<=a_last);
+  if (shared) return __atomic_load_n(&address[p].cache_count, __ATOMIC_RELAXED);
   return address[p].cache_count;
 }
 
@@ -680,6 +696,10 @@ MEDDLY::node_headers::cacheNode(node_handle p)
   MEDDLY_DCASSERT(address);
   MEDDLY_DCASSERT(p>0);
   MEDDLY_DCASSERT(p<=a_last);
+  if (shared) {
+    __atomic_add_fetch(&address[p].cache_count, 1, __ATOMIC_RELAXED);
+    return p;
+  }
   address[p].cache_count++;
 
 #ifdef TRACK_CACHECOUNT
@@ -701,6 +721,11 @@ MEDDLY::node_headers::uncacheNode(MEDDLY::node_handle p)
   MEDDLY_DCASSERT(p>0);
   MEDDLY_DCASSERT(p<=a_last);
   MEDDLY_DCASSERT(address[p].cache_count > 0);
+  if (shared) {
+    // clean up later, in sweep()
+    __atomic_sub_fetch(&address[p].cache_count, 1, __ATOMIC_RELAXED);
+    return;
+  }
   address[p].cache_count--;
 
 #ifdef TRACK_CACHECOUNT
@@ -748,6 +773,7 @@ MEDDLY::node_headers::getIncomingCount(node_handle p) const
   MEDDLY_DCASSERT(address);
   MEDDLY_DCASSERT(p>0);
   MEDDLY_DCASSERT(p<=a_last);
+  if (shared) return __atomic_load_n(&address[p].incoming_count, __ATOMIC_RELAXED);
   return address[p].incoming_count;
 }
 
@@ -764,6 +790,11 @@ MEDDLY::node_headers::linkNode(node_handle p)
   MEDDLY_DCASSERT(p<=a_last);
   MEDDLY_DCASSERT(address[p].offset);
 
+  if (shared) {
+    __atomic_add_fetch(&address[p].incoming_count, 1, __ATOMIC_RELAXED);
+    return p;
+  }
+
   if (0==address[p].incoming_count) {
     // Reclaim an orphan node
     parent.stats.reclaimed_nodes++;
@@ -794,6 +825,12 @@ MEDDLY::node_headers::unlinkNode(node_handle p)
   MEDDLY_DCASSERT(address[p].offset);
   MEDDLY_DCASSERT(address[p].incoming_count>0);
 
+  if (shared) {
+    // clean up later, in sweep()
+    __atomic_sub_fetch(&address[p].incoming_count, 1, __ATOMIC_RELAXED);
+    return;
+  }
+
   address[p].incoming_count--;
 
 #ifdef TRACK_DELETIONS
@@ -1298,6 +1335,12 @@ MEDDLY::expert_forest::isExtensibleLevel(int k) const
   return getDomain()->getVar(k < 0? -k: k)->isExtensible();
 }
 
+inline bool
+MEDDLY::expert_forest::checkpointDue() const
+{
+  return theCheckpointer && theCheckpointer->due();
+}
+
 inline int
 MEDDLY::expert_forest::getLevelSize(int lh) const
 {
@@ -1637,13 +1680,40 @@ MEDDLY::expert_forest::setHashedSize(char hbytes)
   hashed_bytes = hbytes;
 }
 
+inline bool
+MEDDLY::expert_forest::reorderingDue()
+{
+  if (reorder_trigger > 0 && getCurrentNumNodes() > reorder_trigger) {
+    reorder_due = true;
+  }
+  return reorder_due;
+}
+
+inline void
+MEDDLY::expert_forest::setReorderTrigger(long nodes)
+{
+  reorder_trigger = nodes;
+  reorder_due = false;
+}
+
 inline bool
 MEDDLY::expert_forest::isTimeToGc() const
 {
+  if (gc_sweeping) return true;
+  if (deflt.memoryTrigger > 0) {
+    return stats.memory_used > gc_memory_trigger;
+  }
   return isPessimistic() ? (stats.zombie_nodes > deflt.zombieTrigger)
       : (stats.orphan_nodes > deflt.orphanTrigger);
 }
 
+inline bool
+MEDDLY::expert_forest::isTimeToCheckMemory() const
+{
+  return (stats.memory_used > mem_check_at) 
+    ||   (statset::all_memory_used > all_mem_check_at);
+}
+
 inline void
 MEDDLY::expert_forest::moveNodeOffset(MEDDLY::node_handle node, node_address old_addr,
     node_address new_addr)
@@ -1711,9 +1781,9 @@ MEDDLY::specialized_opname::arguments::autoDestroy() const
 
 inline MEDDLY::specialized_operation*
 MEDDLY::numerical_opname::buildOperation(const dd_edge &x_ind,
-    const dd_edge &A, const dd_edge &y_ind) const
+    const dd_edge &A, const dd_edge &y_ind, int split) const
 {
-  numerical_args na(x_ind, A, y_ind);
+  numerical_args na(x_ind, A, y_ind, split);
   na.setAutoDestroy(false); // na will be destroyed when we return
   return buildOperation(&na);
 }
@@ -2193,7 +2263,11 @@ MEDDLY::operation::useCTkey()
 {
   MEDDLY_DCASSERT(CT);
   compute_table::search_key* ans;
-  if (CT_free_keys) {
+  if (concurrent) {
+    // The free list is not shared between threads
+    ans = CT->initializeSearchKey(this);
+  }
+  else if (CT_free_keys) {
     ans = CT_free_keys;
     CT_free_keys = ans->next;
   }
@@ -2227,6 +2301,12 @@ MEDDLY::operation::usesMonolithicComputeTable()
   return Monolithic_CT;
 }
 
+inline bool
+MEDDLY::operation::computeTablesAreThreadSafe()
+{
+  return Monolithic_CT && Monolithic_CT->isThreadSafe();
+}
+
 inline int
 MEDDLY::operation::getIndex() const
 {
@@ -2296,6 +2376,10 @@ inline void
 MEDDLY::operation::doneCTkey(compute_table::search_key* K)
 {
   MEDDLY_DCASSERT(K);
+  if (concurrent) {
+    delete K;
+    return;
+  }
   K->next = CT_free_keys;
   CT_free_keys = K;
 }
@@ -50,3 +50,8 @@ MEDDLY::memory_manager::~memory_manager()
 {
 }
 
+bool MEDDLY::memory_manager::reserveChunks(size_t numSlots, bool grow)
+{
+  return false;
+}
+
@@ -80,6 +80,8 @@ namespace MEDDLY {
         return data + h;
       }
 
+      virtual bool reserveChunks(size_t numSlots, bool grow);
+
       virtual node_address getFirstAddress() const {
         return 1;
       }
@@ -299,6 +301,22 @@ MEDDLY::node_address MEDDLY::hole_manager<INT>::allocateFromArray(size_t numSlot
 
 // ******************************************************************
 
+template <class INT>
+bool MEDDLY::hole_manager<INT>::reserveChunks(size_t numSlots, bool grow)
+{
+  //
+  // Chunks move only when we enlarge the array,
+  // so make room at the end for all of them.
+  //
+  if (last_used_slot + numSlots < data_alloc) return true;
+  if (!grow) return false;
+  size_t want_size = last_used_slot + numSlots;
+  want_size += want_size/2;
+  return resize(want_size);
+}
+
+// ******************************************************************
+
 template <class INT>
 bool MEDDLY::hole_manager<INT>::resize(long new_alloc) 
 {
@@ -60,6 +60,9 @@ class MEDDLY::malloc_manager : public memory_manager {
     virtual node_address requestChunk(size_t &numSlots);
     virtual void recycleChunk(node_address h, size_t numSlots);
     virtual void* getChunkAddress(node_address h) const;
+    virtual bool reserveChunks(size_t numSlots, bool grow) {
+      return true;  // chunks never move
+    }
 
     virtual void reportStats(output &s, const char* pad, bool human, bool details) const;
     virtual void dumpInternal(output &s) const;
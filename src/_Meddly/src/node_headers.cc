@@ -129,6 +129,7 @@ MEDDLY::node_headers::node_headers(expert_forest &P)
   //
   usesCacheCounts = true;
   usesIncomingCounts = true;
+  shared = false;
 }
 
 // ******************************************************************
@@ -249,6 +250,66 @@ void MEDDLY::node_headers::swapNodes(node_handle p, node_handle q, bool swap_inc
 
 // ******************************************************************
 
+bool MEDDLY::node_headers::reserveHandles(int n, bool grow)
+{
+  // Recycled handles are not counted; this is a lower bound
+  while (a_size - a_last - 1 < n) {
+    if (!grow) return false;
+    expandHandleList();
+  }
+  return true;
+}
+
+// ******************************************************************
+
+void MEDDLY::node_headers::sweep()
+{
+  MEDDLY_DCASSERT(!shared);
+  MEDDLY_DCASSERT(address);
+
+  //
+  // Clean up nodes as unlinkNode() and uncacheNode() would have.
+  // Deleting a node may delete others, and shrink a_last.
+  //
+  for (node_handle p=1; p<=a_last; p++) {
+    if (0==address[p].level) continue;          // unused handle
+    if (address[p].incoming_count) continue;    // still connected
+
+    if (0==address[p].offset) {
+      // zombie
+      if (0==address[p].cache_count) recycleNodeHandle(p);
+      continue;
+    }
+    if (0==address[p].cache_count) {
+      parent.deleteNode(p);
+      recycleNodeHandle(p);
+      continue;
+    }
+    if (pessimistic) {
+      parent.deleteNode(p);
+      address[p].offset = 0;
+    }
+  }
+
+  //
+  // Counts were not maintained in shared mode; rebuild them.
+  //
+  long zombies = 0;
+  long orphans = 0;
+  for (node_handle p=1; p<=a_last; p++) {
+    if (0==address[p].level) continue;
+    if (0==address[p].offset) {
+      zombies++;
+      continue;
+    }
+    if (0==address[p].incoming_count) orphans++;
+  }
+  parent.stats.zombie_nodes = zombies;
+  parent.stats.orphan_nodes = orphans;
+}
+
+// ******************************************************************
+
 void MEDDLY::node_headers::dumpInternal(output &s) const
 {
   s << "Node headers and management:\n";
@@ -630,6 +630,11 @@ MEDDLY::node_storage::~node_storage()
   // nothing, derived classes must handle everything
 }
 
+bool MEDDLY::node_storage::reserveNodes(int count, int size, bool grow)
+{
+  return false;
+}
+
 void MEDDLY::node_storage::dumpInternal(output &s, unsigned flags) const
 {
   dumpInternalInfo(s);
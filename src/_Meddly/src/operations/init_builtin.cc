@@ -123,6 +123,8 @@ namespace MEDDLY {
 
   const numerical_opname* EXPLVECT_MATR_MULT = 0;
   const numerical_opname* MATR_EXPLVECT_MULT = 0;
+  const numerical_opname* HYBRID_EXPLVECT_MATR_MULT = 0;
+  const numerical_opname* HYBRID_MATR_EXPLVECT_MULT = 0;
 
   // saturation operation "codes"
 
@@ -203,6 +205,8 @@ void MEDDLY::builtin_initializer::setup()
 
   initP(MEDDLY::EXPLVECT_MATR_MULT, EXPLVECT_MATR_MULT, initExplVectorMatrixMult()  );
   initP(MEDDLY::MATR_EXPLVECT_MULT, MATR_EXPLVECT_MULT, initMatrixExplVectorMult()  );
+  initP(MEDDLY::HYBRID_EXPLVECT_MATR_MULT, HYBRID_EXPLVECT_MATR_MULT, initHybridVectorMatrixMult()  );
+  initP(MEDDLY::HYBRID_MATR_EXPLVECT_MULT, HYBRID_MATR_EXPLVECT_MULT, initHybridMatrixVectorMult()  );
 
   initP(MEDDLY::SATURATION_FORWARD,   SATURATION_FORWARD,   initSaturationForward()   );
   initP(MEDDLY::SATURATION_BACKWARD,  SATURATION_BACKWARD,  initSaturationBackward()  );
@@ -275,6 +279,8 @@ void MEDDLY::builtin_initializer::cleanup()
 
   cleanPair(EXPLVECT_MATR_MULT, MEDDLY::EXPLVECT_MATR_MULT);
   cleanPair(MATR_EXPLVECT_MULT, MEDDLY::MATR_EXPLVECT_MULT);
+  cleanPair(HYBRID_EXPLVECT_MATR_MULT, MEDDLY::HYBRID_EXPLVECT_MATR_MULT);
+  cleanPair(HYBRID_MATR_EXPLVECT_MULT, MEDDLY::HYBRID_MATR_EXPLVECT_MULT);
 
   cleanPair(MM_MULTIPLY,    MEDDLY::MM_MULTIPLY);
 
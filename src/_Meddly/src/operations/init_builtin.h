@@ -69,6 +69,8 @@ class MEDDLY::builtin_initializer : public initializer_list {
 
   numerical_opname* EXPLVECT_MATR_MULT;
   numerical_opname* MATR_EXPLVECT_MULT;
+  numerical_opname* HYBRID_EXPLVECT_MATR_MULT;
+  numerical_opname* HYBRID_MATR_EXPLVECT_MULT;
 
   satpregen_opname* SATURATION_FORWARD;
   satpregen_opname* SATURATION_BACKWARD;
@@ -102,6 +102,8 @@ class MEDDLY::common_bfs_mt : public binary_operation {
         arg1F->showNodeGraph(stderr, reachableStates);
 #endif
         resF->unlinkNode(front);
+        if (resF->checkpointDue()) resF->saveCheckpoint(reachableStates);
+        if (resF->reorderingDue() || arg2F->reorderingDue()) break;
       }
       resF->unlinkNode(prevReachable);
       return reachableStates;
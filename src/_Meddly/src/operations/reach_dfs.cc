@@ -22,8 +22,11 @@
 #include "config.h"
 #endif
 #include "../defines.h"
+#include "../thread_pool.h"
 #include "reach_dfs.h"
 
+#include <vector>
+
 // #define TRACE_RECFIRE
 // #define DEBUG_DFS
 // #define DEBUG_INITIAL
@@ -195,9 +198,79 @@ class MEDDLY::common_dfs_mt : public binary_operation {
     virtual void computeDDEdge(const dd_edge& a, const dd_edge& b, dd_edge &c);
     virtual void saturateHelper(unpacked_node &mdd) = 0;
 
+    /// Should we split the work below level k among threads.
+    inline bool inParallel(int k) const {
+      return workers && k > 1;
+    }
+    /// Threads for the current saturation, or 0.
+    inline thread_pool* pool() const {
+      return workers;
+    }
+
   protected:
-    inline compute_table::search_key* 
-    findResult(node_handle a, node_handle b, node_handle &c) 
+    virtual node_handle recFire(node_handle mdd, node_handle mxd) = 0;
+
+    /// A call to recFire(), saved for later, with the index it updates.
+    struct firing {
+      node_handle mdd;
+      node_handle mxd;
+      node_handle result;
+      int j;
+      firing(node_handle a, node_handle r, int k) {
+        mdd = a;
+        mxd = r;
+        result = 0;
+        j = k;
+      }
+    };
+
+    /// Fire everything in F, in parallel; fills in the results.
+    void fireAll(std::vector<firing> &F);
+
+    /** Add states to nb[j].
+          @param  nb    Node being built.
+          @param  j     Index to update.
+          @param  rec   States to add; we take over the link.
+          @return       true, iff nb[j] changed.
+    */
+    inline bool addStates(unpacked_node &nb, int j, node_handle rec) {
+      if (0==rec) return false;
+      if (rec == nb.d(j)) {
+        resF->unlinkNode(rec);
+        return false;
+      }
+      if (0 == nb.d(j)) {
+        nb.d_ref(j) = rec;
+        return true;
+      }
+      if (-1 == rec) {
+        resF->unlinkNode(nb.d(j));
+        nb.d_ref(j) = -1;
+        return true;
+      }
+      node_handle acc = mddUnion->compute(nb.d(j), rec);
+      resF->unlinkNode(rec);
+      if (acc != nb.d(j)) {
+        resF->unlinkNode(nb.d(j));
+        nb.d_ref(j) = acc;
+        return true;
+      }
+      resF->unlinkNode(acc);
+      return false;
+    }
+
+    /** Can we checkpoint, or stop early, at the top level.
+        In parallel, only between batches of firings,
+        so that no other thread is building nodes.
+    */
+    inline bool atQuietTop(const unpacked_node &nb) const {
+      if (nb.getLevel() != resF->getNumVariables()) return false;
+      return 0==workers || 0==batches.load();
+    }
+
+  protected:
+    inline compute_table::search_key*
+    findResult(node_handle a, node_handle b, node_handle &c)
     {
       compute_table::search_key* CTsrch = useCTkey();
       MEDDLY_DCASSERT(CTsrch);
@@ -285,11 +358,15 @@ class MEDDLY::common_dfs_mt : public binary_operation {
   private:
     indexq* freeqs;
     charbuf* freebufs;
+    thread_pool* workers;
+    /// Number of fireAll() calls in progress.
+    std::atomic<int> batches;
 
   protected:
+    // The free lists are not shared between threads.
     inline indexq* useIndexQueue(int sz) {
       indexq* ans;
-      if (freeqs) {
+      if (freeqs && !workers) {
         ans = freeqs;
         freeqs = freeqs->next;
       } else {
@@ -303,13 +380,17 @@ class MEDDLY::common_dfs_mt : public binary_operation {
     inline void recycle(indexq* a) {
       MEDDLY_DCASSERT(a);
       MEDDLY_DCASSERT(a->isEmpty());
+      if (workers) {
+        delete a;
+        return;
+      }
       a->next = freeqs;
       freeqs = a;
     }
 
     inline charbuf* useCharBuf(int sz) {
       charbuf* ans;
-      if (freebufs) {
+      if (freebufs && !workers) {
         ans = freebufs;
         freebufs = freebufs->next;
       } else {
@@ -322,6 +403,10 @@ class MEDDLY::common_dfs_mt : public binary_operation {
     }
     inline void recycle(charbuf* a) {
       MEDDLY_DCASSERT(a);
+      if (workers) {
+        delete a;
+        return;
+      }
       a->next = freebufs;
       freebufs = a;
     }
@@ -538,8 +623,14 @@ MEDDLY::node_handle MEDDLY::saturation_op::saturate(node_handle mdd, int k)
   }
 
   // Do computation
-  for (int i=0; i<sz; i++) {
-    C->d_ref(i) = mddDptrs->d(i) ? saturate(mddDptrs->d(i), k-1) : 0;
+  if (parent->inParallel(k)) {
+    parent->pool()->forEach(sz, [this, C, mddDptrs, k](int i) {
+      C->d_ref(i) = mddDptrs->d(i) ? saturate(mddDptrs->d(i), k-1) : 0;
+    });
+  } else {
+    for (int i=0; i<sz; i++) {
+      C->d_ref(i) = mddDptrs->d(i) ? saturate(mddDptrs->d(i), k-1) : 0;
+    }
   }
 
   // Cleanup
@@ -745,6 +836,8 @@ MEDDLY::common_dfs_mt::common_dfs_mt(const binary_opname* oc, expert_forest* a1,
   mxdDifference = 0;
   freeqs = 0;
   freebufs = 0;
+  workers = 0;
+  batches = 0;
 }
 
 #ifndef USE_NODE_STATUS
@@ -812,9 +905,20 @@ void MEDDLY::common_dfs_mt
   // Partition NSF by levels
   splitMxd(b.getNode());
 
-  // Execute saturation operation
+  // Execute saturation operation, in parallel if we can
   saturation_op *so = new saturation_op(this, arg1F, resF);
-  node_handle cnode = so->saturate(a.getNode());
+  workers = thread_pool::start(arg1F, arg2F, resF);
+  node_handle cnode;
+  try {
+    cnode = so->saturate(a.getNode());
+  }
+  catch (...) {
+    thread_pool::finish(workers);
+    workers = 0;
+    throw;
+  }
+  thread_pool::finish(workers);
+  workers = 0;
   c.set(cnode);
 
   // Cleanup
@@ -914,6 +1018,22 @@ void MEDDLY::common_dfs_mt::splitMxd(node_handle mxd)
 #endif
 }
 
+void MEDDLY::common_dfs_mt::fireAll(std::vector<firing> &F)
+{
+  MEDDLY_DCASSERT(workers);
+  batches++;
+  try {
+    workers->forEach(int(F.size()), [this, &F](int n) {
+      F[n].result = recFire(F[n].mdd, F[n].mxd);
+    });
+  }
+  catch (...) {
+    batches--;
+    throw;
+  }
+  batches--;
+}
+
 // ******************************************************************
 // *                 common_dfs_mt::indexq  methods                 *
 // ******************************************************************
@@ -975,7 +1095,7 @@ class MEDDLY::forwd_dfs_mt : public common_dfs_mt {
       expert_forest* arg2, expert_forest* res);
   protected:
     virtual void saturateHelper(unpacked_node &mdd);
-    node_handle recFire(node_handle mdd, node_handle mxd);
+    virtual node_handle recFire(node_handle mdd, node_handle mxd);
 };
 
 MEDDLY::forwd_dfs_mt::forwd_dfs_mt(const binary_opname* opcode, 
@@ -1007,8 +1127,22 @@ void MEDDLY::forwd_dfs_mt::saturateHelper(unpacked_node &nb)
     if (nb.d(i)) queue->add(i);
   }
 
+  // states found so far, at the top level, may be checkpointed
+  const bool top = atQuietTop(nb);
+
+  // in parallel, fire each row at once
+  const bool par = inParallel(nb.getLevel());
+  std::vector<firing> F;
+
   // explore indexes
   while (!queue->isEmpty()) {
+    if (top && resF->checkpointDue()) resF->saveCheckpoint(nb);
+    if (top && (resF->reorderingDue() || arg2F->reorderingDue())) {
+      // stop early with the states found so far
+      while (!queue->isEmpty()) queue->remove();
+      break;
+    }
+
     const int i = queue->remove();
 
     MEDDLY_DCASSERT(nb.d(i));
@@ -1023,40 +1157,28 @@ void MEDDLY::forwd_dfs_mt::saturateHelper(unpacked_node &nb)
       Rp->initIdentity(arg2F, -nb.getLevel(), i, Ru->d(i), false);
     }
 
+    if (par) {
+      F.clear();
+      for (int jz=0; jz<Rp->getNNZs(); jz++) {
+        const int j = Rp->i(jz);
+        if (-1==nb.d(j)) continue;  // nothing can be added to this set
+        F.push_back(firing(nb.d(i), Rp->d(jz), j));
+      }
+      fireAll(F);
+      for (unsigned f=0; f<F.size(); f++) {
+        // if row i changed, it goes back in the queue
+        if (addStates(nb, F[f].j, F[f].result)) queue->add(F[f].j);
+      }
+      continue;
+    }
+
     for (int jz=0; jz<Rp->getNNZs(); jz++) {
       const int j = Rp->i(jz);
       if (-1==nb.d(j)) continue;  // nothing can be added to this set
 
       node_handle rec = recFire(nb.d(i), Rp->d(jz));
 
-      if (rec == 0) continue;
-      if (rec == nb.d(j)) { 
-        resF->unlinkNode(rec); 
-        continue; 
-      }
-
-      bool updated = true;
-
-      if (0 == nb.d(j)) {
-        nb.d_ref(j) = rec;
-      }
-      else if (rec == -1) {
-        resF->unlinkNode(nb.d(j));
-        nb.d_ref(j) = -1;
-      }
-      else {
-        node_handle acc = mddUnion->compute(nb.d(j), rec);
-        resF->unlinkNode(rec);
-        if (acc != nb.d(j)) {
-          resF->unlinkNode(nb.d(j));
-          nb.d_ref(j) = acc;
-        } else {
-          resF->unlinkNode(acc);
-          updated = false;
-        }
-      }
-
-      if (updated) {
+      if (addStates(nb, j, rec)) {
         if (j == i) {
           // Restart inner for-loop.
           jz = -1;
@@ -1123,8 +1245,18 @@ MEDDLY::node_handle MEDDLY::forwd_dfs_mt::recFire(node_handle mdd, node_handle m
     // Skipped levels in the MXD,
     // that's an important special case that we can handle quickly.
 
-    for (int i=0; i<rSize; i++) {
-      nb->d_ref(i) = recFire(A->d(i), mxd);
+    if (inParallel(rLevel)) {
+      std::vector<firing> F;
+      for (int i=0; i<rSize; i++) {
+        nb->d_ref(i) = 0;
+        if (A->d(i)) F.push_back(firing(A->d(i), mxd, i));
+      }
+      fireAll(F);
+      for (unsigned f=0; f<F.size(); f++) nb->d_ref(F[f].j) = F[f].result;
+    } else {
+      for (int i=0; i<rSize; i++) {
+        nb->d_ref(i) = recFire(A->d(i), mxd);
+      }
     }
 
   } else {
@@ -1135,6 +1267,10 @@ MEDDLY::node_handle MEDDLY::forwd_dfs_mt::recFire(node_handle mdd, node_handle m
     // clear out result (important!)
     for (int i=0; i<rSize; i++) nb->d_ref(i) = 0;
 
+    // in parallel, collect the firings and do them all at once
+    const bool par = inParallel(rLevel);
+    std::vector<firing> F;
+
     // Initialize mxd readers, note we might skip the unprimed level
     unpacked_node *Ru = unpacked_node::useUnpackedNode();
     unpacked_node *Rp = unpacked_node::useUnpackedNode();
@@ -1160,6 +1296,10 @@ MEDDLY::node_handle MEDDLY::forwd_dfs_mt::recFire(node_handle mdd, node_handle m
         // ok, there is an i->j "edge".
         // determine new states to be added (recursively)
         // and add them
+        if (par) {
+          F.push_back(firing(A->d(i), Rp->d(jz), j));
+          continue;
+        }
         node_handle newstates = recFire(A->d(i), Rp->d(jz));
         if (0==newstates) continue;
         if (0==nb->d(j)) {
@@ -1172,9 +1312,16 @@ MEDDLY::node_handle MEDDLY::forwd_dfs_mt::recFire(node_handle mdd, node_handle m
         resF->unlinkNode(oldj);
         resF->unlinkNode(newstates);
       } // for j
-  
+
     } // for i
 
+    if (par) {
+      fireAll(F);
+      for (unsigned f=0; f<F.size(); f++) {
+        addStates(*nb, F[f].j, F[f].result);
+      }
+    }
+
     unpacked_node::recycle(Rp);
     unpacked_node::recycle(Ru);
   } // else
@@ -1211,7 +1358,7 @@ class MEDDLY::bckwd_dfs_mt : public common_dfs_mt {
       expert_forest* arg2, expert_forest* res);
   protected:
     virtual void saturateHelper(unpacked_node& mdd);
-    node_handle recFire(node_handle mdd, node_handle mxd);
+    virtual node_handle recFire(node_handle mdd, node_handle mxd);
 };
 
 MEDDLY::bckwd_dfs_mt::bckwd_dfs_mt(const binary_opname* opcode, 
@@ -1242,6 +1389,10 @@ void MEDDLY::bckwd_dfs_mt::saturateHelper(unpacked_node& nb)
   for (int i = 0; i < nb.getSize(); i++) expl->data[i] = 2;
   bool repeat = true;
 
+  // in parallel, fire each row at once
+  const bool par = inParallel(nb.getLevel());
+  std::vector<firing> F;
+
   // explore 
   while (repeat) {
     // "advance" the explore list
@@ -1260,44 +1411,32 @@ void MEDDLY::bckwd_dfs_mt::saturateHelper(unpacked_node& nb)
         Rp->initIdentity(arg2F, -nb.getLevel(), i, Ru->d(iz), false);
       }
 
+      if (par) F.clear();
       for (int jz=0; jz<Rp->getNNZs(); jz++) {
         const int j = Rp->i(jz);
         if (0==expl->data[j]) continue;
         if (0==nb.d(j))       continue;
         // We have an i->j edge to explore
-        node_handle rec = recFire(nb.d(j), Rp->d(jz));
-
-        if (0==rec) continue;
-        if (rec == nb.d(i)) {
-          resF->unlinkNode(rec);
+        if (par) {
+          F.push_back(firing(nb.d(j), Rp->d(jz), i));
           continue;
         }
+        node_handle rec = recFire(nb.d(j), Rp->d(jz));
 
-        bool updated = true;
-
-        if (0 == nb.d(i)) {
-          nb.d_ref(i) = rec;
-        }
-        else if (-1 == rec) {
-          resF->unlinkNode(nb.d(i));
-          nb.d_ref(i) = -1;
-        } 
-        else {
-          node_handle acc = mddUnion->compute(nb.d(i), rec);
-          resF->unlinkNode(rec);
-          if (acc != nb.d(i)) {
-            resF->unlinkNode(nb.d(i));
-            nb.d_ref(i) = acc;
-          } else {
-            resF->unlinkNode(acc);
-            updated = false;
-          }
-        }
-        if (updated) {
+        if (addStates(nb, i, rec)) {
           expl->data[i] = 2;
           repeat = true;
         }
       } // for j
+      if (par) {
+        fireAll(F);
+        for (unsigned f=0; f<F.size(); f++) {
+          if (addStates(nb, i, F[f].result)) {
+            expl->data[i] = 2;
+            repeat = true;
+          }
+        }
+      }
     } // for i
   } // while repeat
   // cleanup
@@ -1343,8 +1482,18 @@ MEDDLY::node_handle MEDDLY::bckwd_dfs_mt::recFire(node_handle mdd, node_handle m
     //
     // Skipped levels in the MXD,
     // that's an important special case that we can handle quickly.
-    for (int i=0; i<rSize; i++) {
-      nb->d_ref(i) = recFire(A->d(i), mxd);
+    if (inParallel(rLevel)) {
+      std::vector<firing> F;
+      for (int i=0; i<rSize; i++) {
+        nb->d_ref(i) = 0;
+        if (A->d(i)) F.push_back(firing(A->d(i), mxd, i));
+      }
+      fireAll(F);
+      for (unsigned f=0; f<F.size(); f++) nb->d_ref(F[f].j) = F[f].result;
+    } else {
+      for (int i=0; i<rSize; i++) {
+        nb->d_ref(i) = recFire(A->d(i), mxd);
+      }
     }
   } else {
     // 
@@ -1354,6 +1503,10 @@ MEDDLY::node_handle MEDDLY::bckwd_dfs_mt::recFire(node_handle mdd, node_handle m
     // clear out result (important!)
     for (int i=0; i<rSize; i++) nb->d_ref(i) = 0;
 
+    // in parallel, collect the firings and do them all at once
+    const bool par = inParallel(rLevel);
+    std::vector<firing> F;
+
     // Initialize mxd readers, note we might skip the unprimed level
     unpacked_node *Ru = unpacked_node::useUnpackedNode();
     unpacked_node *Rp = unpacked_node::useUnpackedNode();
@@ -1379,6 +1532,10 @@ MEDDLY::node_handle MEDDLY::bckwd_dfs_mt::recFire(node_handle mdd, node_handle m
         // ok, there is an i->j "edge".
         // determine new states to be added (recursively)
         // and add them
+        if (par) {
+          F.push_back(firing(A->d(j), Rp->d(jz), i));
+          continue;
+        }
         node_handle newstates = recFire(A->d(j), Rp->d(jz));
         if (0==newstates) continue;
         if (0==nb->d(i)) {
@@ -1391,9 +1548,16 @@ MEDDLY::node_handle MEDDLY::bckwd_dfs_mt::recFire(node_handle mdd, node_handle m
         resF->unlinkNode(oldi);
         resF->unlinkNode(newstates);
       } // for j
-  
+
     } // for i
 
+    if (par) {
+      fireAll(F);
+      for (unsigned f=0; f<F.size(); f++) {
+        addStates(*nb, F[f].j, F[f].result);
+      }
+    }
+
     unpacked_node::recycle(Rp);
     unpacked_node::recycle(Ru);
   } // else
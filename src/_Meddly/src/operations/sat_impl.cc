@@ -358,8 +358,13 @@ void MEDDLY::forwd_impl_dfs_by_events_mt::saturateHelper(unpacked_node& nb)
     }
   }
   
+  // states found so far, at the top level, may be checkpointed
+  const bool top = (level == resF->getNumVariables());
+
   // explore indexes
   while (!queue->isEmpty()) {
+    if (top && resF->checkpointDue()) resF->saveCheckpoint(nb);
+
     int i = queue->remove();
     
     MEDDLY_DCASSERT(nb.d(i));
@@ -228,6 +228,32 @@ class MEDDLY::common_otf_dfs_by_events_mt : public specialized_operation {
         void resize(int sz);
     };
 
+  protected:
+    /**
+        Unpacked columns of one event matrix at one level.
+        A column is unpacked the first time its row is explored,
+        and kept until the event is rebuilt or saturateHelper()
+        finishes, since the same row is usually explored many times.
+    */
+    class colcache {
+        expert_forest* F;
+        int level;
+        int size;
+        unpacked_node** col;
+      public:
+        colcache(expert_forest* f, int k, int sz);
+        ~colcache();
+        inline int getSize() const { return size; }
+        /// Column for row i, from node p.
+        inline const unpacked_node* get(int i, node_handle p) {
+          MEDDLY_CHECK_RANGE(0, i, size);
+          if (0==col[i]) col[i] = build(i, p);
+          return col[i];
+        }
+      private:
+        unpacked_node* build(int i, node_handle p);
+    };
+
   private:
     indexq* freeqs;
     charbuf* freebufs;
@@ -571,6 +597,40 @@ void MEDDLY::common_otf_dfs_by_events_mt::charbuf::resize(int sz)
     throw error(error::INSUFFICIENT_MEMORY, __FILE__, __LINE__);
 }
 
+// ******************************************************************
+// *       common_otf_dfs_by_events_mt::colcache methods            *
+// ******************************************************************
+
+MEDDLY::common_otf_dfs_by_events_mt::colcache::colcache(expert_forest* f,
+  int k, int sz)
+{
+  F = f;
+  level = k;
+  size = sz;
+  col = new unpacked_node*[size];
+  for (int i=0; i<size; i++) col[i] = 0;
+}
+
+MEDDLY::common_otf_dfs_by_events_mt::colcache::~colcache()
+{
+  for (int i=0; i<size; i++) {
+    if (col[i]) unpacked_node::recycle(col[i]);
+  }
+  delete[] col;
+}
+
+MEDDLY::unpacked_node*
+MEDDLY::common_otf_dfs_by_events_mt::colcache::build(int i, node_handle p)
+{
+  unpacked_node* Rp = unpacked_node::useUnpackedNode();
+  if (F->getNodeLevel(p) == -level) {
+    Rp->initFromNode(F, p, false);
+  } else {
+    Rp->initIdentity(F, -level, i, p, false);
+  }
+  return Rp;
+}
+
 // ******************************************************************
 // *                                                                *
 // *             forwd_otf_dfs_by_events_mt class                   *
@@ -622,6 +682,10 @@ void MEDDLY::forwd_otf_dfs_by_events_mt::saturateHelper(unpacked_node& nb)
       }
     }
   }
+  colcache** C = new colcache*[nEventsAtThisLevel];
+  for (int ei = 0; ei < nEventsAtThisLevel; ei++) {
+    C[ei] = Ru[ei] ? new colcache(arg2F, level, Ru[ei]->getSize()) : 0;
+  }
   unpacked_node* Rp = unpacked_node::useUnpackedNode();
 
   //      Node reader auto expands when passed by reference
@@ -634,8 +698,13 @@ void MEDDLY::forwd_otf_dfs_by_events_mt::saturateHelper(unpacked_node& nb)
     if (nb.d(i)) queue->add(i);
   }
 
+  // states found so far, at the top level, may be checkpointed
+  const bool top = (level == resF->getNumVariables());
+
   // explore indexes
   while (!queue->isEmpty()) {
+    if (top && resF->checkpointDue()) resF->saveCheckpoint(nb);
+
     const int i = queue->remove();
 
     MEDDLY_DCASSERT(nb.d(i));
@@ -665,6 +734,9 @@ void MEDDLY::forwd_otf_dfs_by_events_mt::saturateHelper(unpacked_node& nb)
             Ru[ei]->initFromNode(arg2F, mxd, true);
           }
         }
+        // old columns are stale
+        delete C[ei];
+        C[ei] = Ru[ei] ? new colcache(arg2F, level, Ru[ei]->getSize()) : 0;
       }
       // check if row i of the event ei is empty
       if (0 == Ru[ei]) continue;
@@ -680,24 +752,29 @@ void MEDDLY::forwd_otf_dfs_by_events_mt::saturateHelper(unpacked_node& nb)
 #endif
       if (0 == ei_i) continue;
 
-      // grab column (TBD: build these ahead of time?)
-      const int dlevel = arg2F->getNodeLevel(ei_i);
-
-      if (dlevel == -level) {
-        Rp->initFromNode(arg2F, ei_i, false);
+      // grab column; only the extensible part is not cached
+      const unpacked_node* Rc;
+      if (i < C[ei]->getSize()) {
+        Rc = C[ei]->get(i, ei_i);
       } else {
-        Rp->initIdentity(arg2F, -level, i, ei_i, false);
+        const int dlevel = arg2F->getNodeLevel(ei_i);
+        if (dlevel == -level) {
+          Rp->initFromNode(arg2F, ei_i, false);
+        } else {
+          Rp->initIdentity(arg2F, -level, i, ei_i, false);
+        }
+        Rc = Rp;
       }
 
 #ifdef USE_XDDS
-      MEDDLY_DCASSERT(!Rp->isExtensible());
+      MEDDLY_DCASSERT(!Rc->isExtensible());
 #endif
 
-      for (int jz=0; jz<Rp->getNNZs(); jz++) {
-        const int j = Rp->i(jz);
+      for (int jz=0; jz<Rc->getNNZs(); jz++) {
+        const int j = Rc->i(jz);
         if (j < nb.getSize() && -1==nb.d(j)) continue;  // nothing can be added to this set
 
-        node_handle newstates = recFire(nb.d(i), Rp->d(jz));
+        node_handle newstates = recFire(nb.d(i), Rc->d(jz));
         if (newstates == 0) continue;
 
         // Confirm local state
@@ -730,7 +807,11 @@ void MEDDLY::forwd_otf_dfs_by_events_mt::saturateHelper(unpacked_node& nb)
 
   // cleanup
   unpacked_node::recycle(Rp);
-  for (int ei = 0; ei < nEventsAtThisLevel; ei++) unpacked_node::recycle(Ru[ei]);
+  for (int ei = 0; ei < nEventsAtThisLevel; ei++) {
+    delete C[ei];
+    unpacked_node::recycle(Ru[ei]);
+  }
+  delete[] C;
   delete[] Ru;
   recycle(queue);
 }
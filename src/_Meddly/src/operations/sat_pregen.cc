@@ -18,8 +18,10 @@
 */
 
 #include "../defines.h"
+#include "../thread_pool.h"
 #include "sat_pregen.h"
 #include <typeinfo> // for "bad_cast" exception
+#include <vector>
 
 namespace MEDDLY {
   class saturation_by_events_opname;
@@ -135,6 +137,67 @@ class MEDDLY::common_dfs_by_events_mt : public specialized_operation {
     virtual void compute(const dd_edge& a, dd_edge &c);
     virtual void saturateHelper(unpacked_node& mdd) = 0;
 
+    /// Should we split the work below level k among threads.
+    inline bool inParallel(int k) const {
+      return workers && k > 1;
+    }
+    /// Threads for the current saturation, or 0.
+    inline thread_pool* pool() const {
+      return workers;
+    }
+
+  protected:
+    virtual node_handle recFire(node_handle mdd, node_handle mxd) = 0;
+
+    /// A call to recFire(), saved for later, with the index it updates.
+    struct firing {
+      node_handle mdd;
+      node_handle mxd;
+      node_handle result;
+      int j;
+      firing(node_handle a, node_handle r, int k) {
+        mdd = a;
+        mxd = r;
+        result = 0;
+        j = k;
+      }
+    };
+
+    /// Fire everything in F, in parallel; fills in the results.
+    void fireAll(std::vector<firing> &F);
+
+    /** Add states to nb[j].
+          @param  nb    Node being built.
+          @param  j     Index to update.
+          @param  rec   States to add; we take over the link.
+          @return       true, iff nb[j] changed.
+    */
+    inline bool addStates(unpacked_node &nb, int j, node_handle rec) {
+      if (0==rec) return false;
+      if (rec == nb.d(j)) {
+        resF->unlinkNode(rec);
+        return false;
+      }
+      if (0 == nb.d(j)) {
+        nb.d_ref(j) = rec;
+        return true;
+      }
+      if (-1 == rec) {
+        resF->unlinkNode(nb.d(j));
+        nb.d_ref(j) = -1;
+        return true;
+      }
+      node_handle acc = mddUnion->compute(nb.d(j), rec);
+      resF->unlinkNode(rec);
+      if (acc != nb.d(j)) {
+        resF->unlinkNode(nb.d(j));
+        nb.d_ref(j) = acc;
+        return true;
+      }
+      resF->unlinkNode(acc);
+      return false;
+    }
+
   protected:
     inline compute_table::search_key* 
     findResult(node_handle a, node_handle b, node_handle &c) 
@@ -226,14 +289,41 @@ class MEDDLY::common_dfs_by_events_mt : public specialized_operation {
         void resize(int sz);
     };
 
+  protected:
+    /**
+        Unpacked columns of one event matrix at one level.
+        A column is unpacked the first time its row is explored,
+        and kept until the end of saturateHelper(), since
+        the same row is usually explored many times.
+    */
+    class colcache {
+        expert_forest* F;
+        int level;
+        int size;
+        unpacked_node** col;
+      public:
+        colcache(expert_forest* f, int k, int sz);
+        ~colcache();
+        /// Column for row i, stored in the given slot, from node p.
+        inline const unpacked_node* get(int slot, int i, node_handle p) {
+          MEDDLY_CHECK_RANGE(0, slot, size);
+          if (0==col[slot]) col[slot] = build(i, p);
+          return col[slot];
+        }
+      private:
+        unpacked_node* build(int i, node_handle p);
+    };
+
   private:
     indexq* freeqs;
     charbuf* freebufs;
+    thread_pool* workers;
 
   protected:
+    // The free lists are not shared between threads.
     inline indexq* useIndexQueue(int sz) {
       indexq* ans;
-      if (freeqs) {
+      if (freeqs && !workers) {
         ans = freeqs;
         freeqs = freeqs->next;
       } else {
@@ -247,13 +337,17 @@ class MEDDLY::common_dfs_by_events_mt : public specialized_operation {
     inline void recycle(indexq* a) {
       MEDDLY_DCASSERT(a);
       MEDDLY_DCASSERT(a->isEmpty());
+      if (workers) {
+        delete a;
+        return;
+      }
       a->next = freeqs;
       freeqs = a;
     }
 
     inline charbuf* useCharBuf(int sz) {
       charbuf* ans;
-      if (freebufs) {
+      if (freebufs && !workers) {
         ans = freebufs;
         freebufs = freebufs->next;
       } else {
@@ -266,6 +360,10 @@ class MEDDLY::common_dfs_by_events_mt : public specialized_operation {
     }
     inline void recycle(charbuf* a) {
       MEDDLY_DCASSERT(a);
+      if (workers) {
+        delete a;
+        return;
+      }
       a->next = freebufs;
       freebufs = a;
     }
@@ -334,8 +432,14 @@ MEDDLY::saturation_by_events_op::saturate(node_handle mdd, int k)
   }
 
   // Do computation
-  for (int i=0; i<sz; i++) {
-    nb->d_ref(i) = mddDptrs->d(i) ? saturate(mddDptrs->d(i), k-1) : 0;
+  if (parent->inParallel(k)) {
+    parent->pool()->forEach(sz, [this, nb, mddDptrs, k](int i) {
+      nb->d_ref(i) = mddDptrs->d(i) ? saturate(mddDptrs->d(i), k-1) : 0;
+    });
+  } else {
+    for (int i=0; i<sz; i++) {
+      nb->d_ref(i) = mddDptrs->d(i) ? saturate(mddDptrs->d(i), k-1) : 0;
+    }
   }
 
   // Cleanup
@@ -418,6 +522,7 @@ MEDDLY::common_dfs_by_events_mt::common_dfs_by_events_mt(
   mxdDifference = 0;
   freeqs = 0;
   freebufs = 0;
+  workers = 0;
   rel = relation;
   arg1F = static_cast<expert_forest*>(rel->getInForest());
   arg2F = static_cast<expert_forest*>(rel->getRelForest());
@@ -508,7 +613,18 @@ void MEDDLY::common_dfs_by_events_mt
     printf("done.\n");
   }
   saturation_by_events_op* so = new saturation_by_events_op(this, arg1F, resF);
-  node_handle cnode = so->saturate(a.getNode());
+  workers = thread_pool::start(arg1F, arg2F, resF);
+  node_handle cnode;
+  try {
+    cnode = so->saturate(a.getNode());
+  }
+  catch (...) {
+    thread_pool::finish(workers);
+    workers = 0;
+    throw;
+  }
+  thread_pool::finish(workers);
+  workers = 0;
   c.set(cnode);
 
   // Cleanup
@@ -525,6 +641,14 @@ void MEDDLY::common_dfs_by_events_mt
   delete so;
 }
 
+void MEDDLY::common_dfs_by_events_mt::fireAll(std::vector<firing> &F)
+{
+  MEDDLY_DCASSERT(workers);
+  workers->forEach(int(F.size()), [this, &F](int n) {
+    F[n].result = recFire(F[n].mdd, F[n].mxd);
+  });
+}
+
 // ******************************************************************
 // *       common_dfs_by_events_mt::indexq  methods                 *
 // ******************************************************************
@@ -574,6 +698,40 @@ void MEDDLY::common_dfs_by_events_mt::charbuf::resize(int sz)
     throw error(error::INSUFFICIENT_MEMORY, __FILE__, __LINE__);
 }
 
+// ******************************************************************
+// *       common_dfs_by_events_mt::colcache methods                *
+// ******************************************************************
+
+MEDDLY::common_dfs_by_events_mt::colcache::colcache(expert_forest* f,
+  int k, int sz)
+{
+  F = f;
+  level = k;
+  size = sz;
+  col = new unpacked_node*[size];
+  for (int i=0; i<size; i++) col[i] = 0;
+}
+
+MEDDLY::common_dfs_by_events_mt::colcache::~colcache()
+{
+  for (int i=0; i<size; i++) {
+    if (col[i]) unpacked_node::recycle(col[i]);
+  }
+  delete[] col;
+}
+
+MEDDLY::unpacked_node*
+MEDDLY::common_dfs_by_events_mt::colcache::build(int i, node_handle p)
+{
+  unpacked_node* Rp = unpacked_node::useUnpackedNode();
+  if (F->getNodeLevel(p) == -level) {
+    Rp->initFromNode(F, p, false);
+  } else {
+    Rp->initIdentity(F, -level, i, p, false);
+  }
+  return Rp;
+}
+
 // ******************************************************************
 // *                                                                *
 // *             forwd_dfs_by_events_mt class                       *
@@ -586,7 +744,7 @@ class MEDDLY::forwd_dfs_by_events_mt : public common_dfs_by_events_mt {
     satpregen_opname::pregen_relation* rel);
   protected:
     virtual void saturateHelper(unpacked_node& mdd);
-    node_handle recFire(node_handle mdd, node_handle mxd);
+    virtual node_handle recFire(node_handle mdd, node_handle mxd);
 };
 
 MEDDLY::forwd_dfs_by_events_mt::forwd_dfs_by_events_mt(
@@ -615,7 +773,10 @@ void MEDDLY::forwd_dfs_by_events_mt::saturateHelper(unpacked_node& nb)
       Ru[ei]->initFromNode(arg2F, events[ei], true);
     }
   }
-  unpacked_node* Rp = unpacked_node::useUnpackedNode();
+  colcache** C = new colcache*[nEventsAtThisLevel];
+  for (int ei = 0; ei < nEventsAtThisLevel; ei++) {
+    C[ei] = new colcache(arg2F, nb.getLevel(), Ru[ei]->getSize());
+  }
 
   // indexes to explore
   indexq* queue = useIndexQueue(nb.getSize());
@@ -623,65 +784,50 @@ void MEDDLY::forwd_dfs_by_events_mt::saturateHelper(unpacked_node& nb)
     if (nb.d(i)) queue->add(i);
   }
 
+  // in parallel, fire each row (over all events) at once
+  const bool par = inParallel(nb.getLevel());
+  std::vector<firing> F;
+
   // explore indexes
   while (!queue->isEmpty()) {
     int i = queue->remove();
 
     MEDDLY_DCASSERT(nb.d(i));
 
+    if (par) F.clear();
     for (int ei = 0; ei < nEventsAtThisLevel; ei++) {
       if (0 == Ru[ei]->d(i)) continue;  // row i of the event ei is empty
 
-      // grab column (TBD: build these ahead of time?)
-      int dlevel = arg2F->getNodeLevel(Ru[ei]->d(i));
-
-      if (dlevel == -nb.getLevel()) {
-        Rp->initFromNode(arg2F, Ru[ei]->d(i), false);
-      } else {
-        Rp->initIdentity(arg2F, -nb.getLevel(), i, Ru[ei]->d(i), false);
-      }
+      // grab column
+      const unpacked_node* Rp = C[ei]->get(i, i, Ru[ei]->d(i));
 
       for (int jz=0; jz<Rp->getNNZs(); jz++) {
         int j = Rp->i(jz);
         if (-1==nb.d(j)) continue;  // nothing can be added to this set
 
-        node_handle rec = recFire(nb.d(i), Rp->d(jz));
-
-        if (rec == 0) continue;
-        if (rec == nb.d(j)) { 
-          resF->unlinkNode(rec); 
-          continue; 
-        }
-
-        bool updated = true;
-
-        if (0 == nb.d(j)) {
-          nb.d_ref(j) = rec;
-        }
-        else if (rec == -1) {
-          resF->unlinkNode(nb.d(j));
-          nb.d_ref(j) = -1;
-        }
-        else {
-          node_handle acc = mddUnion->compute(nb.d(j), rec);
-          resF->unlinkNode(rec);
-          if (acc != nb.d(j)) {
-            resF->unlinkNode(nb.d(j));
-            nb.d_ref(j) = acc;
-          } else {
-            resF->unlinkNode(acc);
-            updated = false;
-          }
+        if (par) {
+          F.push_back(firing(nb.d(i), Rp->d(jz), j));
+          continue;
         }
+        node_handle rec = recFire(nb.d(i), Rp->d(jz));
 
-        if (updated) queue->add(j);
+        if (addStates(nb, j, rec)) queue->add(j);
       } // for j
     } // for all events, ei
+    if (par) {
+      fireAll(F);
+      for (unsigned f=0; f<F.size(); f++) {
+        if (addStates(nb, F[f].j, F[f].result)) queue->add(F[f].j);
+      }
+    }
   } // while there are indexes to explore
 
   // cleanup
-  unpacked_node::recycle(Rp);
-  for (int ei = 0; ei < nEventsAtThisLevel; ei++) unpacked_node::recycle(Ru[ei]);
+  for (int ei = 0; ei < nEventsAtThisLevel; ei++) {
+    delete C[ei];
+    unpacked_node::recycle(Ru[ei]);
+  }
+  delete[] C;
   delete[] Ru;
   recycle(queue);
 }
@@ -736,8 +882,18 @@ MEDDLY::node_handle MEDDLY::forwd_dfs_by_events_mt::recFire(
     // Skipped levels in the MXD,
     // that's an important special case that we can handle quickly.
 
-    for (int i=0; i<rSize; i++) {
-      nb->d_ref(i) = recFire(A->d(i), mxd);
+    if (inParallel(rLevel)) {
+      std::vector<firing> F;
+      for (int i=0; i<rSize; i++) {
+        nb->d_ref(i) = 0;
+        if (A->d(i)) F.push_back(firing(A->d(i), mxd, i));
+      }
+      fireAll(F);
+      for (unsigned f=0; f<F.size(); f++) nb->d_ref(F[f].j) = F[f].result;
+    } else {
+      for (int i=0; i<rSize; i++) {
+        nb->d_ref(i) = recFire(A->d(i), mxd);
+      }
     }
 
   } else {
@@ -748,6 +904,10 @@ MEDDLY::node_handle MEDDLY::forwd_dfs_by_events_mt::recFire(
     // clear out result (important!)
     for (int i=0; i<rSize; i++) nb->d_ref(i) = 0;
 
+    // in parallel, collect the firings and do them all at once
+    const bool par = inParallel(rLevel);
+    std::vector<firing> F;
+
     // Initialize mxd readers, note we might skip the unprimed level
     unpacked_node *Ru = unpacked_node::useUnpackedNode();
     unpacked_node *Rp = unpacked_node::useUnpackedNode();
@@ -773,6 +933,10 @@ MEDDLY::node_handle MEDDLY::forwd_dfs_by_events_mt::recFire(
         // ok, there is an i->j "edge".
         // determine new states to be added (recursively)
         // and add them
+        if (par) {
+          F.push_back(firing(A->d(i), Rp->d(jz), j));
+          continue;
+        }
         node_handle newstates = recFire(A->d(i), Rp->d(jz));
         if (0==newstates) continue;
         if (0==nb->d(j)) {
@@ -785,9 +949,16 @@ MEDDLY::node_handle MEDDLY::forwd_dfs_by_events_mt::recFire(
         resF->unlinkNode(oldj);
         resF->unlinkNode(newstates);
       } // for j
-  
+
     } // for i
 
+    if (par) {
+      fireAll(F);
+      for (unsigned f=0; f<F.size(); f++) {
+        addStates(*nb, F[f].j, F[f].result);
+      }
+    }
+
     unpacked_node::recycle(Rp);
     unpacked_node::recycle(Ru);
   } // else
@@ -824,7 +995,7 @@ class MEDDLY::bckwd_dfs_by_events_mt : public common_dfs_by_events_mt {
     satpregen_opname::pregen_relation* rel);
   protected:
     virtual void saturateHelper(unpacked_node& mdd);
-    node_handle recFire(node_handle mdd, node_handle mxd);
+    virtual node_handle recFire(node_handle mdd, node_handle mxd);
 };
 
 MEDDLY::bckwd_dfs_by_events_mt::bckwd_dfs_by_events_mt(
@@ -852,13 +1023,20 @@ void MEDDLY::bckwd_dfs_by_events_mt::saturateHelper(unpacked_node& nb)
       Ru[ei]->initFromNode(arg2F, events[ei], true);
     }
   }
-  unpacked_node* Rp = unpacked_node::useUnpackedNode();
+  colcache** C = new colcache*[nEventsAtThisLevel];
+  for (int ei = 0; ei < nEventsAtThisLevel; ei++) {
+    C[ei] = new colcache(arg2F, nb.getLevel(), Ru[ei]->getNNZs());
+  }
 
   // indexes to explore
   charbuf* expl = useCharBuf(nb.getSize());
   for (int i = 0; i < nb.getSize(); i++) expl->data[i] = 2;
   bool repeat = true;
 
+  // in parallel, fire each row at once
+  const bool par = inParallel(nb.getLevel());
+  std::vector<firing> F;
+
   // explore 
   while (repeat) {
     // "advance" the explore list
@@ -870,60 +1048,45 @@ void MEDDLY::bckwd_dfs_by_events_mt::saturateHelper(unpacked_node& nb)
       // explore all rows
       for (int iz=0; iz<Ru[ei]->getNNZs(); iz++) {
         int i = Ru[ei]->i(iz);
-        // grab column (TBD: build these ahead of time?)
-        int dlevel = arg2F->getNodeLevel(Ru[ei]->d(iz));
-
-        if (dlevel == -nb.getLevel()) {
-          Rp->initFromNode(arg2F, Ru[ei]->d(iz), false); 
-        } else {
-          Rp->initIdentity(arg2F, -nb.getLevel(), i, Ru[ei]->d(iz), false);
-        }
+        // grab column
+        const unpacked_node* Rp = C[ei]->get(iz, i, Ru[ei]->d(iz));
 
+        if (par) F.clear();
         for (int jz=0; jz<Rp->getNNZs(); jz++) {
           int j = Rp->i(jz);
           if (0==expl->data[j]) continue;
           if (0==nb.d(j))       continue;
           // We have an i->j edge to explore
-          node_handle rec = recFire(nb.d(j), Rp->d(jz));
-
-          if (0==rec) continue;
-          if (rec == nb.d(i)) {
-            resF->unlinkNode(rec);
+          if (par) {
+            F.push_back(firing(nb.d(j), Rp->d(jz), i));
             continue;
           }
+          node_handle rec = recFire(nb.d(j), Rp->d(jz));
 
-          bool updated = true;
-
-          if (0 == nb.d(i)) {
-            nb.d_ref(i) = rec;
-          }
-          else if (-1 == rec) {
-            resF->unlinkNode(nb.d(i));
-            nb.d_ref(i) = -1;
-          } 
-          else {
-            node_handle acc = mddUnion->compute(nb.d(i), rec);
-            resF->unlinkNode(rec);
-            if (acc != nb.d(i)) {
-              resF->unlinkNode(nb.d(i));
-              nb.d_ref(i) = acc;
-            } else {
-              resF->unlinkNode(acc);
-              updated = false;
-            }
-          }
-          if (updated) {
+          if (addStates(nb, i, rec)) {
             expl->data[i] = 2;
             repeat = true;
           }
         } // for j
+        if (par) {
+          fireAll(F);
+          for (unsigned f=0; f<F.size(); f++) {
+            if (addStates(nb, i, F[f].result)) {
+              expl->data[i] = 2;
+              repeat = true;
+            }
+          }
+        }
       } // for i
     } // for each event
   } // while repeat
 
   // cleanup
-  unpacked_node::recycle(Rp);
-  for (int ei = 0; ei < nEventsAtThisLevel; ei++) unpacked_node::recycle(Ru[ei]);
+  for (int ei = 0; ei < nEventsAtThisLevel; ei++) {
+    delete C[ei];
+    unpacked_node::recycle(Ru[ei]);
+  }
+  delete[] C;
   delete[] Ru;
   recycle(expl);
 }
@@ -967,8 +1130,18 @@ MEDDLY::node_handle MEDDLY::bckwd_dfs_by_events_mt::recFire(node_handle mdd,
     //
     // Skipped levels in the MXD,
     // that's an important special case that we can handle quickly.
-    for (int i=0; i<rSize; i++) {
-      nb->d_ref(i) = recFire(A->d(i), mxd);
+    if (inParallel(rLevel)) {
+      std::vector<firing> F;
+      for (int i=0; i<rSize; i++) {
+        nb->d_ref(i) = 0;
+        if (A->d(i)) F.push_back(firing(A->d(i), mxd, i));
+      }
+      fireAll(F);
+      for (unsigned f=0; f<F.size(); f++) nb->d_ref(F[f].j) = F[f].result;
+    } else {
+      for (int i=0; i<rSize; i++) {
+        nb->d_ref(i) = recFire(A->d(i), mxd);
+      }
     }
   } else {
     // 
@@ -978,6 +1151,10 @@ MEDDLY::node_handle MEDDLY::bckwd_dfs_by_events_mt::recFire(node_handle mdd,
     // clear out result (important!)
     for (int i=0; i<rSize; i++) nb->d_ref(i) = 0;
 
+    // in parallel, collect the firings and do them all at once
+    const bool par = inParallel(rLevel);
+    std::vector<firing> F;
+
     // Initialize mxd readers, note we might skip the unprimed level
     unpacked_node *Ru = unpacked_node::useUnpackedNode();
     unpacked_node *Rp = unpacked_node::useUnpackedNode();
@@ -1003,6 +1180,10 @@ MEDDLY::node_handle MEDDLY::bckwd_dfs_by_events_mt::recFire(node_handle mdd,
         // ok, there is an i->j "edge".
         // determine new states to be added (recursively)
         // and add them
+        if (par) {
+          F.push_back(firing(A->d(j), Rp->d(jz), i));
+          continue;
+        }
         node_handle newstates = recFire(A->d(j), Rp->d(jz));
         if (0==newstates) continue;
         if (0==nb->d(i)) {
@@ -1015,9 +1196,16 @@ MEDDLY::node_handle MEDDLY::bckwd_dfs_by_events_mt::recFire(node_handle mdd,
         resF->unlinkNode(oldi);
         resF->unlinkNode(newstates);
       } // for j
-  
+
     } // for i
 
+    if (par) {
+      fireAll(F);
+      for (unsigned f=0; f<F.size(); f++) {
+        addStates(*nb, F[f].j, F[f].result);
+      }
+    }
+
     unpacked_node::recycle(Rp);
     unpacked_node::recycle(Ru);
   } // else
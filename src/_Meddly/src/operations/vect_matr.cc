@@ -20,6 +20,10 @@
 #include "../defines.h"
 #include "vect_matr.h"
 #include <typeinfo> // for "bad_cast" exception
+#include <vector>
+#include <map>
+#include <tuple>
+#include <algorithm>
 
 namespace MEDDLY {
   class base_evplus_mt;
@@ -28,8 +32,12 @@ namespace MEDDLY {
 
   class MV_evplus_mt;
 
+  class hybrid_block;
+  class hybrid_evplus_mt;
+
   class VM_opname;
   class MV_opname;
+  class hybrid_opname;
 
   inline bool isEvPlusStyle(const forest* f) {
     return f->isEVPlus() || f->isIndexSet();
@@ -473,6 +481,383 @@ void MEDDLY::MV_evplus_mt::comp_pr(int k, double* y, node_handle y_ind,
 }
 
 
+// ******************************************************************
+// *                                                                *
+// *                       hybrid_block class                       *
+// *                                                                *
+// ******************************************************************
+
+/** A submatrix, flattened into compressed sparse rows.
+    Row and column indexes are relative to where the block is used.
+*/
+class MEDDLY::hybrid_block {
+  public:
+    struct entry {
+      int row;
+      int col;
+      float value;
+
+      inline bool operator<(const entry &e) const {
+        return (row < e.row) || ((row == e.row) && (col < e.col));
+      }
+    };
+
+    /// Build from a list of entries; the list is sorted.
+    hybrid_block(std::vector<entry> &E);
+    ~hybrid_block();
+
+    inline long getNNZs() const { return rowptr[rows]; }
+
+    /// y[c] += x[r] * B[r][c]
+    inline void vectorMatrix(double* y, const double* x) const {
+      for (int r=0; r<rows; r++) {
+        const double xr = x[r];
+        if (0==xr) continue;
+        for (long j=rowptr[r]; j<rowptr[r+1]; j++) {
+          y[cols[j]] += xr * vals[j];
+        }
+      }
+    }
+
+    /// y[r] += B[r][c] * x[c]
+    inline void matrixVector(double* y, const double* x) const {
+      for (int r=0; r<rows; r++) {
+        double sum = 0;
+        for (long j=rowptr[r]; j<rowptr[r+1]; j++) {
+          sum += vals[j] * x[cols[j]];
+        }
+        y[r] += sum;
+      }
+    }
+
+  private:
+    int rows;
+    long* rowptr;
+    int* cols;
+    float* vals;
+};
+
+MEDDLY::hybrid_block::hybrid_block(std::vector<entry> &E)
+{
+  std::sort(E.begin(), E.end());
+  rows = E.empty() ? 0 : E.back().row + 1;
+  rowptr = new long[rows+1];
+  cols = new int[E.size()];
+  vals = new float[E.size()];
+
+  long j = 0;
+  for (int r=0; r<rows; r++) {
+    rowptr[r] = j;
+    for (; j < long(E.size()) && E[j].row == r; j++) {
+      cols[j] = E[j].col;
+      vals[j] = E[j].value;
+    }
+  }
+  rowptr[rows] = j;
+}
+
+MEDDLY::hybrid_block::~hybrid_block()
+{
+  delete[] rowptr;
+  delete[] cols;
+  delete[] vals;
+}
+
+// ******************************************************************
+// *                                                                *
+// *                     hybrid_evplus_mt class                     *
+// *                                                                *
+// ******************************************************************
+
+/** Hybrid vector-matrix or matrix-vector multiplication.
+
+    The levels of A above the split level are traversed once, when the
+    operation is built, to produce a list of "instances": the row and
+    column offsets, in the explicit vectors, of each submatrix rooted
+    at the split level.  The submatrices themselves are flattened into
+    hybrid_blocks, cached by their matrix and index set nodes, so
+    that a submatrix used many times is stored once.
+    A product then simply multiplies the blocks of each instance.
+
+    The matrix rows are indexed by x_ind for vector-matrix products,
+    and by y_ind for matrix-vector products.
+*/
+class MEDDLY::hybrid_evplus_mt : public base_evplus_mt {
+  public:
+    hybrid_evplus_mt(const numerical_opname* code, const dd_edge &x_ind,
+      const dd_edge& A, const dd_edge &y_ind, int split, bool vm);
+    virtual ~hybrid_evplus_mt();
+
+    virtual void compute(double* y, const double* x);
+
+    virtual void compute_r(int k, double* y, node_handle y_ind, 
+      const double* x, node_handle x_ind, node_handle A) 
+    {
+      throw error(error::MISCELLANEOUS, __FILE__, __LINE__);
+    }
+
+  protected:
+    /// Traverse unprimed level k; stop at level \a stop.
+    void walk(int k, long ro, node_handle r_ind, long co, 
+      node_handle c_ind, node_handle a);
+
+    /// Traverse primed level k.
+    void walkPrimed(int k, long ro, node_handle r_ind, long co, 
+      node_handle c_ind, int ain, node_handle a);
+
+    /// Reached the split level: add an instance, building its block.
+    void addInstance(long ro, node_handle r_ind, long co, 
+      node_handle c_ind, node_handle a);
+
+  private:
+    struct instance {
+      long row;
+      long col;
+      const hybrid_block* block;
+    };
+
+    /// Vector-matrix, or matrix-vector
+    bool by_rows;
+
+    /// Forests for row and column indexes
+    const expert_forest* fr;
+    const expert_forest* fc;
+
+    /// Level where the current traversal stops.
+    int stop;
+
+    std::vector<instance> instances;
+    std::vector<hybrid_block*> blocks;
+
+    /// Block cache, by matrix, row index, and column index nodes.
+    std::map< std::tuple<node_handle, node_handle, node_handle>, 
+      hybrid_block* > block_cache;
+
+    /// Entries of the block being built.
+    std::vector<hybrid_block::entry> building;
+};
+
+MEDDLY::hybrid_evplus_mt::hybrid_evplus_mt(const numerical_opname* code, 
+  const dd_edge &x_ind, const dd_edge& A, const dd_edge &y_ind, 
+  int split, bool vm)
+  : base_evplus_mt(code, x_ind, A, y_ind)
+{
+  if (!checkForestCompatibility()) {
+    throw error(error::INVALID_OPERATION, __FILE__, __LINE__);
+  }
+  if (split < 0) {
+    throw error(error::INVALID_ARGUMENT, __FILE__, __LINE__);
+  }
+  if (0==split) split = (L+1)/2;
+  if (split > L) split = L;
+
+  by_rows = vm;
+  fr = by_rows ? fx : fy;
+  fc = by_rows ? fy : fx;
+
+  // Build the instances and blocks, once
+  stop = split;
+  if (by_rows) {
+    walk(L, 0, x_root, 0, y_root, A_root);
+  } else {
+    walk(L, 0, y_root, 0, x_root, A_root);
+  }
+
+  // Nodes may be recycled once we return
+  block_cache.clear();
+  building.clear();
+  building.shrink_to_fit();
+}
+
+MEDDLY::hybrid_evplus_mt::~hybrid_evplus_mt()
+{
+  for (unsigned i=0; i<blocks.size(); i++) {
+    delete blocks[i];
+  }
+}
+
+void MEDDLY::hybrid_evplus_mt::compute(double* y, const double* x)
+{
+  if (by_rows) {
+    for (unsigned i=0; i<instances.size(); i++) {
+      const instance &I = instances[i];
+      I.block->vectorMatrix(y + I.col, x + I.row);
+    }
+  } else {
+    for (unsigned i=0; i<instances.size(); i++) {
+      const instance &I = instances[i];
+      I.block->matrixVector(y + I.row, x + I.col);
+    }
+  }
+}
+
+void MEDDLY::hybrid_evplus_mt::walk(int k, long ro, node_handle r_ind, 
+  long co, node_handle c_ind, node_handle a)
+{
+  if (0==a) return;   // zero submatrix
+  if (k == stop) {
+    if (k) {
+      addInstance(ro, r_ind, co, c_ind, a);
+      return;
+    }
+    float v = expert_forest::float_Tencoder::handle2value(a);
+    if (v) {
+      hybrid_block::entry e = { int(ro), int(co), v };
+      building.push_back(e);
+    }
+    return;
+  }
+
+  MEDDLY_DCASSERT(fr->getNodeLevel(r_ind) == k);
+  MEDDLY_DCASSERT(fc->getNodeLevel(c_ind) == k);
+  int aLevel = fA->getNodeLevel(a);
+
+  //
+  // Identity matrix times a constant, below the split level
+  //
+  if (0==aLevel && 0==stop && (r_ind == c_ind)) {
+    if (fr == fc && fr->isIndexSet()) {
+      float v = expert_forest::float_Tencoder::handle2value(a);
+      if (0==v) return;
+      for (long i = fr->getIndexSetCardinality(r_ind)-1; i>=0; i--) {
+        hybrid_block::entry e = { int(ro+i), int(co+i), v };
+        building.push_back(e);
+      }
+      return;
+    }
+  }
+
+  //
+  // Identity node: row and column indexes must match
+  //
+  if (ABS(aLevel) < k) {
+    unpacked_node* rR = unpacked_node::newFromNode(fr, r_ind, false);
+    unpacked_node* cR = unpacked_node::newFromNode(fc, c_ind, false);
+
+    int rp = 0;
+    int cp = 0;
+    for (;;) {
+      if (rR->i(rp) < cR->i(cp)) {
+        rp++;
+        if (rp >= rR->getNNZs()) break;
+        continue;
+      }
+      if (rR->i(rp) > cR->i(cp)) {
+        cp++;
+        if (cp >= cR->getNNZs()) break;
+        continue;
+      }
+      // match, need to recurse
+      walk(k-1, ro + rR->ei(rp), rR->d(rp), co + cR->ei(cp), cR->d(cp), a);
+      rp++;
+      if (rp >= rR->getNNZs()) break;
+      cp++;
+      if (cp >= cR->getNNZs()) break;
+    } // for (;;)
+
+    unpacked_node::recycle(cR);
+    unpacked_node::recycle(rR);
+    return;
+  }
+
+  //
+  // Not an identity node
+  //
+  unpacked_node* aR = unpacked_node::useUnpackedNode();
+  if (aLevel == k) {
+    aR->initFromNode(fA, a, false);
+  } else {
+    aR->initRedundant(fA, k, a, false);
+  }
+  unpacked_node* rR = unpacked_node::newFromNode(fr, r_ind, false);
+
+  int rp = 0;
+  int ap = 0;
+  for (;;) {
+    if (aR->i(ap) < rR->i(rp)) {
+      ap++;
+      if (ap >= aR->getNNZs()) break;
+      continue;
+    }
+    if (aR->i(ap) > rR->i(rp)) {
+      rp++;
+      if (rp >= rR->getNNZs()) break;
+      continue;
+    }
+    // match, need to recurse
+    walkPrimed(k, ro + rR->ei(rp), rR->d(rp), co, c_ind, 
+      aR->i(ap), aR->d(ap));
+    ap++;
+    if (ap >= aR->getNNZs()) break;
+    rp++;
+    if (rp >= rR->getNNZs()) break;
+  } // for (;;)
+
+  unpacked_node::recycle(rR);
+  unpacked_node::recycle(aR);
+}
+
+void MEDDLY::hybrid_evplus_mt::walkPrimed(int k, long ro, node_handle r_ind,
+  long co, node_handle c_ind, int ain, node_handle a)
+{
+  unpacked_node* aR = unpacked_node::useUnpackedNode();
+  if (fA->getNodeLevel(a) == -k) {
+    aR->initFromNode(fA, a, false);
+  } else {
+    aR->initIdentity(fA, k, ain, a, false);
+  }
+  unpacked_node* cR = unpacked_node::newFromNode(fc, c_ind, false);
+
+  int cp = 0;
+  int ap = 0;
+  for (;;) {
+    if (aR->i(ap) < cR->i(cp)) {
+      ap++;
+      if (ap >= aR->getNNZs()) break;
+      continue;
+    }
+    if (aR->i(ap) > cR->i(cp)) {
+      cp++;
+      if (cp >= cR->getNNZs()) break;
+      continue;
+    }
+    // match, need to recurse
+    walk(k-1, ro, r_ind, co + cR->ei(cp), cR->d(cp), aR->d(ap));
+    ap++;
+    if (ap >= aR->getNNZs()) break;
+    cp++;
+    if (cp >= cR->getNNZs()) break;
+  } // for (;;)
+
+  unpacked_node::recycle(cR);
+  unpacked_node::recycle(aR);
+}
+
+void MEDDLY::hybrid_evplus_mt::addInstance(long ro, node_handle r_ind, 
+  long co, node_handle c_ind, node_handle a)
+{
+  std::tuple<node_handle, node_handle, node_handle> key(a, r_ind, c_ind);
+  hybrid_block* B = block_cache[key];
+  if (0==B) {
+    //
+    // Flatten the submatrix
+    //
+    int save_stop = stop;
+    stop = 0;
+    building.clear();
+    walk(save_stop, 0, r_ind, 0, c_ind, a);
+    stop = save_stop;
+
+    B = new hybrid_block(building);
+    blocks.push_back(B);
+    block_cache[key] = B;
+  }
+  if (0==B->getNNZs()) return;
+
+  instance I = { ro, co, B };
+  instances.push_back(I);
+}
+
 // ******************************************************************
 // *                                                                *
 // *                        VM_opname  class                        *
@@ -614,6 +999,77 @@ MEDDLY::MV_opname::buildOperation(arguments* a) const
   if (na->autoDestroy()) delete na;
 }
 
+// ******************************************************************
+// *                                                                *
+// *                      hybrid_opname  class                      *
+// *                                                                *
+// ******************************************************************
+
+class MEDDLY::hybrid_opname : public numerical_opname {
+  public:
+    hybrid_opname(bool vm);
+    virtual specialized_operation* buildOperation(arguments* a) const;
+  private:
+    bool by_rows;
+};
+
+MEDDLY::hybrid_opname::hybrid_opname(bool vm) 
+ : numerical_opname(vm ? "HybridVectMatrMult" : "HybridMatrVectMult")
+{
+  by_rows = vm;
+}
+
+MEDDLY::specialized_operation* 
+MEDDLY::hybrid_opname::buildOperation(arguments* a) const
+{
+  numerical_args* na = dynamic_cast<numerical_args*>(a);
+  if (0==na) throw error(error::INVALID_ARGUMENT, __FILE__, __LINE__);
+
+  const expert_forest* fx = (const expert_forest*) na->x_ind.getForest();
+  const expert_forest* fA = (const expert_forest*) na->A.getForest();
+  const expert_forest* fy = (const expert_forest*) na->y_ind.getForest();
+
+  // everyone must use the same domain
+  if (      (fx->getDomain() != fy->getDomain()) 
+        ||  (fx->getDomain() != fA->getDomain())  )
+  {
+    throw error(error::DOMAIN_MISMATCH, __FILE__, __LINE__);
+  }
+
+  // Check edge types
+  if (
+           (fy->getRangeType() != forest::INTEGER) 
+        || (fy->isForRelations())
+        || (fx->getRangeType() != forest::INTEGER)
+        || (fx->isForRelations())
+        || (fA->getRangeType() != forest::REAL)
+        || (!fA->isForRelations())
+      ) 
+  {
+    throw error(error::TYPE_MISMATCH, __FILE__, __LINE__);
+  }
+
+  // A can't be fully reduced.
+  if (fA->isFullyReduced()) {
+    throw error(error::TYPE_MISMATCH, __FILE__, __LINE__);
+  }
+
+  // For now, fy and fx must be Indexed sets or EVPLUS forests.
+  if ( !isEvPlusStyle(fy) || !isEvPlusStyle(fx) ) {
+    throw error(error::NOT_IMPLEMENTED, __FILE__, __LINE__);
+  }
+
+  if (forest::MULTI_TERMINAL != fA->getEdgeLabeling()) {
+    throw error(error::NOT_IMPLEMENTED, __FILE__, __LINE__);
+  }
+
+  specialized_operation* op = new hybrid_evplus_mt(this, 
+      na->x_ind, na->A, na->y_ind, na->split, by_rows);
+
+  if (na->autoDestroy()) delete na;
+  return op;
+}
+
 // ******************************************************************
 // *                                                                *
 // *                           Front  end                           *
@@ -630,3 +1086,13 @@ MEDDLY::numerical_opname* MEDDLY::initMatrixExplVectorMult()
   return new MV_opname;
 }
 
+MEDDLY::numerical_opname* MEDDLY::initHybridVectorMatrixMult()
+{
+  return new hybrid_opname(true);
+}
+
+MEDDLY::numerical_opname* MEDDLY::initHybridMatrixVectorMult()
+{
+  return new hybrid_opname(false);
+}
+
@@ -28,6 +28,12 @@ namespace MEDDLY {
 
   /// Set up a numerical_opname for "matrix vector multiply".
   numerical_opname* initMatrixExplVectorMult();
+
+  /// Set up a numerical_opname for "hybrid vector matrix multiply".
+  numerical_opname* initHybridVectorMatrixMult();
+
+  /// Set up a numerical_opname for "hybrid matrix vector multiply".
+  numerical_opname* initHybridMatrixVectorMult();
 }
 
 #endif
@@ -158,9 +158,10 @@ MEDDLY::specialized_opname::~specialized_opname()
 // ******************************************************************
 
 MEDDLY::numerical_opname::numerical_args
-::numerical_args(const dd_edge &xi, const dd_edge &a, const dd_edge &yi)
- : x_ind(xi), A(a), y_ind(yi)
+::numerical_args(const dd_edge &xi, const dd_edge &a, const dd_edge &yi,
+  int sl) : x_ind(xi), A(a), y_ind(yi)
 {
+  split = sl;
 }
 
 MEDDLY::numerical_opname::numerical_args::~numerical_args()
@@ -1679,13 +1680,14 @@ MEDDLY::satimpl_opname::implicit_relation::~implicit_relation()
   last_in_node_array = 0;
   impl_unique.clear();
   
-  for(int i = 0; i <=num_levels; i++) {delete[] event_list[i]; delete[] confirmed[i];}
-  delete[] event_list;
-  delete[] event_added;
-  delete[] event_list_alloc;
+  // all but confirmed are from malloc; nothing is allocated for level 0
+  for(int i = 1; i <=num_levels; i++) {free(event_list[i]); free(confirmed[i]);}
+  free(event_list);
+  free(event_added);
+  free(event_list_alloc);
   delete[] confirmed;
-  delete[] confirm_states;
-  delete[] confirmed_array_size;
+  free(confirm_states);
+  free(confirmed_array_size);
 }
 
 
@@ -1989,11 +1991,39 @@ void MEDDLY::operation::removeStalesFromMonolithic()
   if (Monolithic_CT) Monolithic_CT->removeStales();
 }
 
+bool MEDDLY::operation::removeSomeStalesFromMonolithic(unsigned slots)
+{
+  if (Monolithic_CT) return Monolithic_CT->removeSomeStales(slots);
+  return true;
+}
+
 void MEDDLY::operation::removeAllFromMonolithic()
 {
   if (Monolithic_CT) Monolithic_CT->removeAll();
 }
 
+unsigned long MEDDLY::operation::computeTableMemory()
+{
+  unsigned long mem = 0;
+  if (Monolithic_CT) mem += Monolithic_CT->getMemoryUsed();
+  for (int i=0; i<list_size; i++) {
+    if (0==op_list[i]) continue;
+    compute_table* ct = op_list[i]->CT;
+    if (ct && ct != Monolithic_CT) mem += ct->getMemoryUsed();
+  }
+  return mem;
+}
+
+void MEDDLY::operation::shrinkComputeTables()
+{
+  if (Monolithic_CT) Monolithic_CT->shrink();
+  for (int i=0; i<list_size; i++) {
+    if (0==op_list[i]) continue;
+    compute_table* ct = op_list[i]->CT;
+    if (ct && ct != Monolithic_CT) ct->shrink();
+  }
+}
+
 
 void MEDDLY::operation::markForDeletion()
 {
@@ -2023,6 +2053,12 @@ void MEDDLY::operation::removeStaleComputeTableEntries()
   if (CT) CT->removeStales();
 }
 
+bool MEDDLY::operation::removeSomeStaleComputeTableEntries(unsigned slots)
+{
+  if (CT) return CT->removeSomeStales(slots);
+  return true;
+}
+
 void MEDDLY::operation::removeAllComputeTableEntries()
 {
 #ifdef DEBUG_CLEANUP
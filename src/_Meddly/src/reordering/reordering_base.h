@@ -13,9 +13,23 @@ protected:
   int getInCount(expert_forest* forest, node_handle p) const;
 
 public:
+  virtual ~reordering_base() { }
+
   virtual void reorderVariables(expert_forest* forest, const int* level2var) = 0;
+
+  /*
+   * Search for a better order, starting from the current one
+   * (for automatic reordering).  By default, use the forest's
+   * dynamicReorderVariables().
+   */
+  virtual void improveOrder(expert_forest* forest);
 };
 
+inline void reordering_base::improveOrder(expert_forest* forest)
+{
+  forest->dynamicReorderVariables(forest->getNumVariables(), 1);
+}
+
 inline const unique_table* reordering_base::get_unique_table(expert_forest* forest) const
 {
   return forest->unique;
@@ -16,6 +16,8 @@
 #include "lowest_memory_reordering.h"
 #include "random_reordering.h"
 #include "larc_reordering.h"
+#include "sifting_reordering.h"
+#include "window_reordering.h"
 
 namespace MEDDLY {
 
@@ -47,6 +49,10 @@ inline std::unique_ptr<reordering_base> reordering_factory::create(forest::polic
     return std::unique_ptr<reordering_base>(new random_reordering());
   case forest::policies::reordering_type::LARC:
     return std::unique_ptr<reordering_base>(new larc_reordering());
+  case forest::policies::reordering_type::SIFTING:
+    return std::unique_ptr<reordering_base>(new sifting_reordering());
+  case forest::policies::reordering_type::WINDOW:
+    return std::unique_ptr<reordering_base>(new window_reordering());
   default:
     throw error(error::INVALID_ARGUMENT, __FILE__, __LINE__);
   }
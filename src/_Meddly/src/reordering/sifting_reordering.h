@@ -0,0 +1,131 @@
+
+#ifndef SIFTING_REORDERING_H
+#define SIFTING_REORDERING_H
+
+#include <algorithm>
+#include <vector>
+
+#include "../timer.h"
+#include "../unique_table.h"
+
+namespace MEDDLY{
+
+/*
+ * Rudell's sifting.
+ *
+ * Each variable, from the one with the most nodes to the one with the
+ * fewest, is moved through all levels and left where the forest was
+ * smallest.  A variable stops moving in one direction when the forest
+ * grows past policy reorderMaxGrowth times the smallest size seen, or
+ * when it has used up reorderVarSeconds.
+ *
+ * Reordering to a given order is done as in sink_down_reordering.
+ */
+class sifting_reordering : public sink_down_reordering
+{
+protected:
+  // Microseconds spent on the current variable
+  long used;
+  long budget;
+  timer watch;
+
+  inline void startClock(const expert_forest* forest)
+  {
+    watch.note_time();
+    used = 0;
+    budget = long(forest->getPolicies().reorderVarSeconds * 1000000);
+  }
+
+  inline bool outOfTime()
+  {
+    if (budget <= 0) return false;
+    watch.note_time();
+    used += watch.get_last_interval();
+    return used > budget;
+  }
+
+  inline bool tooBig(const expert_forest* forest, long best)
+  {
+    return forest->getCurrentNumNodes()
+      > forest->getPolicies().reorderMaxGrowth * best;
+  }
+
+  /*
+   * Move the variable at level, one level at a time, to level end,
+   * noting the best level seen.  Returns the level reached.
+   */
+  int sift(expert_forest* forest, int level, int end,
+    long &best, int &best_level)
+  {
+    while (level != end) {
+      if (level > end) {
+        forest->swapAdjacentVariables(level - 1);
+        level--;
+      } else {
+        forest->swapAdjacentVariables(level);
+        level++;
+      }
+      long size = forest->getCurrentNumNodes();
+      if (size < best) {
+        best = size;
+        best_level = level;
+      }
+      if (tooBig(forest, best) || outOfTime()) break;
+    }
+    return level;
+  }
+
+  void siftVariable(expert_forest* forest, int var)
+  {
+    const int top = forest->getNumVariables();
+    int level = forest->getLevelByVar(var);
+    long best = forest->getCurrentNumNodes();
+    int best_level = level;
+
+    startClock(forest);
+
+    // Closest end first
+    if (level - 1 < top - level) {
+      level = sift(forest, level, 1, best, best_level);
+      if (!outOfTime()) level = sift(forest, level, top, best, best_level);
+    } else {
+      level = sift(forest, level, top, best, best_level);
+      if (!outOfTime()) level = sift(forest, level, 1, best, best_level);
+    }
+
+    // Back to the best level, ignoring the limits
+    while (level > best_level) {
+      forest->swapAdjacentVariables(level - 1);
+      level--;
+    }
+    while (level < best_level) {
+      forest->swapAdjacentVariables(level);
+      level++;
+    }
+  }
+
+public:
+  virtual void improveOrder(expert_forest* forest)
+  {
+    const int size = forest->getNumVariables();
+    const unique_table* ut = get_unique_table(forest);
+
+    // Largest variables first
+    std::vector< std::pair<long, int> > vars;
+    vars.reserve(size);
+    for (int v = 1; v <= size; v++) {
+      long n = ut->getNumEntries(v);
+      if (forest->isForRelations()) n += ut->getNumEntries(-v);
+      vars.push_back(std::make_pair(-n, v));
+    }
+    std::sort(vars.begin(), vars.end());
+
+    for (unsigned i = 0; i < vars.size(); i++) {
+      siftVariable(forest, vars[i].second);
+    }
+  }
+};
+
+}
+
+#endif
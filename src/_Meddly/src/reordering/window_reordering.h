@@ -0,0 +1,76 @@
+
+#ifndef WINDOW_REORDERING_H
+#define WINDOW_REORDERING_H
+
+namespace MEDDLY{
+
+/*
+ * Window permutation.
+ *
+ * For each window of policy reorderWindow (2 or 3) adjacent levels,
+ * from the bottom up, try every order of the variables in the window
+ * and keep the one where the forest is smallest.  Passes are repeated
+ * while they shrink the forest.  The growth and time limits of
+ * sifting_reordering apply to each window.
+ */
+class window_reordering : public sifting_reordering
+{
+protected:
+  /*
+   * Try the orders of the window starting at level,
+   * using the given sequence of adjacent swaps (offsets from level).
+   * Returns true if the forest shrank.
+   */
+  bool permuteWindow(expert_forest* forest, int level,
+    const int* swaps, int num_swaps)
+  {
+    const long start = forest->getCurrentNumNodes();
+    long best = start;
+    int best_step = 0;
+    int step = 0;
+
+    startClock(forest);
+    while (step < num_swaps) {
+      forest->swapAdjacentVariables(level + swaps[step]);
+      step++;
+      long size = forest->getCurrentNumNodes();
+      if (size < best) {
+        best = size;
+        best_step = step;
+      }
+      if (tooBig(forest, best) || outOfTime()) break;
+    }
+
+    // Undo the swaps after the best order
+    while (step > best_step) {
+      step--;
+      forest->swapAdjacentVariables(level + swaps[step]);
+    }
+    return best < start;
+  }
+
+public:
+  virtual void improveOrder(expert_forest* forest)
+  {
+    // Adjacent swaps that visit every permutation of the window
+    static const int swaps2[] = { 0 };
+    static const int swaps3[] = { 0, 1, 0, 1, 0 };
+
+    const int size = forest->getNumVariables();
+    const int window = MIN(size, forest->getPolicies().reorderWindow >= 3 ? 3 : 2);
+    const int* swaps = (3 == window) ? swaps3 : swaps2;
+    const int num_swaps = (3 == window) ? 5 : 1;
+
+    bool shrank = true;
+    while (shrank) {
+      shrank = false;
+      for (int level = 1; level + window - 1 <= size; level++) {
+        if (permuteWindow(forest, level, swaps, num_swaps)) shrank = true;
+      }
+    }
+  }
+};
+
+}
+
+#endif
@@ -448,7 +448,61 @@ inline void dataToDown(const unsigned char* d, int bytes, INT& L)
   }
 }
 
+// ******************************************************************
+// *                                                                *
+// *            Variable-length integers, 7 bits per byte           *
+// *                                                                *
+// ******************************************************************
 
+/// Map signed integers to unsigned ones, so small magnitudes stay small.
+inline unsigned long zigzagEncode(long a)
+{
+  return (a < 0) ? ((~((unsigned long) a)) << 1) | 1 : ((unsigned long) a) << 1;
+}
 
-#endif  // include guard
+inline long zigzagDecode(unsigned long u)
+{
+  return (u & 1) ? ~((long) (u >> 1)) : (long) (u >> 1);
+}
 
+/**
+    Write an unsigned integer, least significant 7 bits first;
+    the high bit of each byte is set if more bytes follow.
+      @param  a   Value to write.
+      @param  d   Destination; must have room for 10 bytes.
+      @return     Number of bytes written.
+*/
+inline int varintToData(unsigned long a, unsigned char* d)
+{
+  int b = 0;
+  while (a >= 0x80) {
+    d[b++] = (unsigned char) (a | 0x80);
+    a >>= 7;
+  }
+  d[b++] = (unsigned char) a;
+  return b;
+}
+
+/**
+    Read an unsigned integer written by varintToData().
+      @param  d     Data to read.
+      @param  end   End of the available data.
+      @param  a     (Output) the value.
+      @return       Pointer just past the value, or 0 if the
+                    data ends early or the value is too large.
+*/
+inline const unsigned char* dataToVarint(const unsigned char* d,
+  const unsigned char* end, unsigned long &a)
+{
+  a = 0;
+  for (int shift = 0; d < end && shift < 64; shift += 7) {
+    unsigned char c = *d++;
+    a |= ((unsigned long) (c & 0x7f)) << shift;
+    if (0 == (c & 0x80)) return d;
+  }
+  return 0;
+}
+
+
+
+#endif  // include guard
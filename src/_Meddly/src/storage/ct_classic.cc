@@ -22,6 +22,7 @@
 
 #include <map>  // for operation_map
 #include <limits.h>
+#include <atomic>   // for monolithic_lossy
 
 // #define DEBUG_SLOW
 // #define DEBUG_CT
@@ -50,6 +51,8 @@ namespace MEDDLY {
   class monolithic_unchained;
   class operation_unchained;
 
+  class monolithic_lossy;
+
   class base_map;
 }
 
@@ -257,6 +260,8 @@ class MEDDLY::base_table : public compute_table {
     base_table(const ct_initializer::settings &s);
     virtual ~base_table();
 
+    virtual unsigned long getMemoryUsed() const;
+
   protected:
     old_temp_entry currEntry;
     
@@ -270,6 +275,8 @@ class MEDDLY::base_table : public compute_table {
       if (c>perf.maxSearchLength) perf.maxSearchLength = c;
     }
     int newEntry(int size);
+    /// Release the entry array; every entry must have been recycled.
+    void releaseEntries();
     inline void recycleEntry(int h, int size) {
 #ifdef DEBUG_CTALLOC
       fprintf(stderr, "Recycling entry %d size %d\n", h, size);
@@ -297,8 +304,11 @@ class MEDDLY::base_table : public compute_table {
     }
 
     // M is 1 if we need a slot for the operation index, 0 otherwise.
-    static inline search_key* init(operation* op, int M) {
-      old_search_key* key = new old_search_key(op);
+    // key may be given, if a derived key class is needed.
+    static inline search_key* init(operation* op, int M, 
+      old_search_key* key = 0) 
+    {
+      if (0==key) key = new old_search_key(op);
       MEDDLY_DCASSERT(0==key->data);
       key->data = new int[op->getKeyLength()+M];
       key->killData = true;
@@ -355,8 +365,8 @@ class MEDDLY::base_table : public compute_table {
 
     unsigned long currMemory;
     unsigned long peakMemory;
-  private:
     static const int maxEntrySize = 15;
+  private:
     static const int maxEntryBytes = sizeof(int) * maxEntrySize;
     int* freeList;
 };
@@ -452,6 +462,24 @@ int MEDDLY::base_table::newEntry(int size)
   return h;
 }
 
+void MEDDLY::base_table::releaseEntries()
+{
+  MEDDLY_DCASSERT(0==perf.numEntries);
+  for (int i=0; i<=maxEntrySize; i++) freeList[i] = 0;
+  entriesSize = 1;
+  if (entriesAlloc <= 1024) return;
+  int* ne = (int*) realloc(entries, 1024 * sizeof(int));
+  if (0==ne) return;  // keep the larger array
+  currMemory -= (entriesAlloc - 1024) * sizeof(int);
+  entries = ne;
+  entriesAlloc = 1024;
+}
+
+unsigned long MEDDLY::base_table::getMemoryUsed() const
+{
+  return currMemory;
+}
+
 void MEDDLY::base_table::dumpInternal(output &s, int verbLevel) const
 {
   if (verbLevel < 1) return;
@@ -534,6 +562,8 @@ class MEDDLY::base_hash : public base_table {
       int initTex);
     virtual ~base_hash();
 
+    virtual void shrink();
+
   protected:
     inline unsigned hash(const int* k, int length) const {
       return raw_hash(k, length) % tableSize;
@@ -553,6 +583,9 @@ class MEDDLY::base_hash : public base_table {
     unsigned int tableExpand;
     unsigned int tableShrink;
   private:
+    unsigned int initSize;
+    unsigned int initExpand;
+
     static inline unsigned rot(unsigned x, int k) {
         return (((x)<<(k)) | ((x)>>(32-(k))));
     }
@@ -573,6 +606,7 @@ class MEDDLY::base_hash : public base_table {
         b ^= a; b -= rot(a,14);
         c ^= b; c -= rot(b,24);
     }
+  public:
     static unsigned raw_hash(const int* k, int length);
 };
 
@@ -586,6 +620,8 @@ class MEDDLY::base_hash : public base_table {
 MEDDLY::base_hash::base_hash(const ct_initializer::settings &s, 
   int initTsz, int initTex) : base_table(s)
 {
+  initSize = initTsz;
+  initExpand = initTex;
   tableSize = initTsz;
   tableExpand = initTex;
   tableShrink = 0;
@@ -602,6 +638,22 @@ MEDDLY::base_hash::~base_hash()
   free(table);
 }
 
+void MEDDLY::base_hash::shrink()
+{
+  removeAll();
+  if (tableSize > initSize) {
+    int* nt = (int*) realloc(table, initSize * sizeof(int));
+    if (nt) {
+      currMemory -= (tableSize - initSize) * sizeof(int);
+      table = nt;
+      tableSize = initSize;
+      tableExpand = initExpand;
+      tableShrink = 0;
+    }
+  }
+  releaseEntries();
+}
+
 void MEDDLY::base_hash::dumpInternal(output &s, int verbLevel) const
 {
   if (verbLevel < 1) return;
@@ -1643,6 +1695,25 @@ class MEDDLY::base_unchained : public base_hash {
       }
     }
     template <int M>
+    inline bool scanSomeStales(unsigned slots) {
+      if (staleCursor >= tableSize) staleCursor = 0;
+      unsigned stop = (slots < tableSize - staleCursor)
+        ? staleCursor + slots : tableSize;
+      for (; staleCursor<stop; staleCursor++) {
+        if (0==table[staleCursor]) continue;
+#ifndef USE_NODE_STATUS
+        checkStale<M>(staleCursor, table[staleCursor]);
+#else
+        if (MEDDLY::forest::node_status::ACTIVE != getEntryStatus<M>(staleCursor)) {
+          discardEntry<M>(staleCursor);
+        }
+#endif
+      }
+      if (staleCursor < tableSize) return false;
+      staleCursor = 0;
+      return true;
+    }
+    template <int M>
     inline void rehashTable(int* oldT, unsigned oldS) {
       for (unsigned i=0; i<oldS; i++) {
         int curr = oldT[i];
@@ -1784,6 +1855,8 @@ class MEDDLY::base_unchained : public base_hash {
     static const int maxCollisionSearch = 2;
     long collisions;
     operation* global_op;
+    /// Next slot to scan, for removeSomeStales().
+    unsigned staleCursor;
 };
 
 
@@ -1800,6 +1873,7 @@ MEDDLY::base_unchained
 {
   collisions = 0;
   global_op = 0;
+  staleCursor = 0;
 }
 
 MEDDLY::base_unchained::~base_unchained()
@@ -1869,6 +1943,7 @@ class MEDDLY::monolithic_unchained : public base_unchained {
     virtual entry_builder& startNewEntry(search_key *key);
     virtual void addEntry();
     virtual void removeStales();
+    virtual bool removeSomeStales(unsigned slots);
     virtual void removeAll();
   protected:
     virtual void showTitle(output &s) const;
@@ -1980,6 +2055,11 @@ void MEDDLY::monolithic_unchained::removeStales()
 {
   removeStalesT<1>();
 }
+
+bool MEDDLY::monolithic_unchained::removeSomeStales(unsigned slots)
+{
+  return scanSomeStales<1>(slots);
+}
    
 void MEDDLY::monolithic_unchained::removeAll()
 {
@@ -2027,6 +2107,7 @@ class MEDDLY::operation_unchained : public base_unchained {
     virtual entry_builder& startNewEntry(search_key *key);
     virtual void addEntry();
     virtual void removeStales();
+    virtual bool removeSomeStales(unsigned slots);
     virtual void removeAll();
   protected:
     virtual void showTitle(output &s) const;
@@ -2077,13 +2158,17 @@ void MEDDLY::operation_unchained::removeStales()
 {
   removeStalesT<0>();
 }
+
+bool MEDDLY::operation_unchained::removeSomeStales(unsigned slots)
+{
+  return scanSomeStales<0>(slots);
+}
    
 void MEDDLY::operation_unchained::removeAll()
 {
   for (unsigned i=0; i<tableSize; i++) {
     if (0==table[i]) continue;
-    remove<0>(table[i]);
-    table[i] = 0;
+    remove<0>(i);
   }
 }
 
@@ -2480,6 +2565,437 @@ void MEDDLY::operation_map<K>::show(output &s, int verbLevel)
 
 
 
+// **********************************************************************
+// *                                                                    *
+// *                                                                    *
+// *                       monolithic_lossy class                       *
+// *                                                                    *
+// *                                                                    *
+// **********************************************************************
+
+/*
+    One fixed-size hash table, with no chaining and no rehashing,
+    that may be searched and updated by several threads at once.
+
+    Each slot is a cache line: a sequence word followed by the entry,
+    laid out as for monolithic_unchained (operation index, then payload).
+    The sequence word works as a seqlock:
+      bit 0:  the slot is being written;
+      bit 1:  the slot holds an entry;
+      others: incremented on every write.
+    Readers copy the entry into their search key, and check that the sequence word did not
+    change.  Writers lock a slot with a compare-and-swap, and simply
+    give up (dropping the new entry) if another thread holds it.
+    The table never grows, so memory use is known in advance.
+
+    Only the table is made safe for concurrent use; entries still
+    refer to forest nodes, and adding or discarding an entry updates
+    their cache counts.  removeStales(), removeAll() and show()
+    require exclusive access, as they are called during garbage
+    collection and library cleanup.
+*/
+class MEDDLY::monolithic_lossy : public base_table {
+  public:
+    monolithic_lossy(const ct_initializer::settings &s);
+    virtual ~monolithic_lossy();
+
+    // required functions
+
+    virtual bool isOperationTable() const   { return false; }
+    virtual bool isThreadSafe() const       { return true; }
+    virtual search_key* initializeSearchKey(operation* op);
+    virtual search_result& find(search_key *key);
+    virtual entry_builder& startNewEntry(search_key *key);
+    virtual void addEntry();
+    virtual void removeStales();
+    virtual void removeAll();
+    virtual void show(output &s, int verbLevel = 0);
+
+  protected:
+    /// Keys carry their own result, so searches need no shared state.
+    class lossy_key : public old_search_key {
+        friend class MEDDLY::monolithic_lossy;
+        old_search_result ans;
+        node_handle buf[maxEntrySize];
+      public:
+        lossy_key(operation* op) : old_search_key(op) { }
+    };
+
+    class lossy_entry : public compute_table::entry_builder {
+          friend class MEDDLY::monolithic_lossy;
+          node_handle entry[maxEntrySize];
+          int length;
+          unsigned hash_value;
+          unsigned resSlot;
+        public:
+          lossy_entry() { }
+          virtual ~lossy_entry() { }
+
+          virtual void writeResultNH(node_handle nh)
+          {
+            MEDDLY_DCASSERT(resSlot < unsigned(length));
+            entry[resSlot++] = nh;
+          }
+          virtual void writeResult(int i)
+          {
+            MEDDLY_DCASSERT(resSlot < unsigned(length));
+            entry[resSlot++] = i;
+          }
+          virtual void writeResult(float f)
+          {
+            MEDDLY_DCASSERT(resSlot < unsigned(length));
+            float* x = (float*) (entry + resSlot);
+            x[0] = f;
+            resSlot++;
+          }
+        protected:
+          inline void writeResult(void* data, size_t slots)
+          {
+            MEDDLY_DCASSERT(slots>0);
+            MEDDLY_DCASSERT(resSlot+slots<=unsigned(length));
+            memcpy(entry+resSlot, data, slots * sizeof(node_handle));
+            resSlot += slots;
+          }
+        public:
+          virtual void writeResult(long L)
+          {
+            writeResult(&L, sizeof(long) / sizeof(node_handle));
+          }
+          virtual void writeResult(double D)
+          {
+            writeResult(&D, sizeof(double) / sizeof(node_handle));
+          }
+          virtual void writeResult(void* P)
+          {
+            writeResult(&P, sizeof(void*) / sizeof(node_handle));
+          }
+    };
+
+    struct slot {
+      std::atomic<unsigned> seq;
+      std::atomic<node_handle> data[maxEntrySize];
+    };
+
+    static const unsigned WRITING = 0x01;
+    static const unsigned FULL = 0x02;
+    static const unsigned STEP = 0x04;
+
+    /// Entry being built by this thread.
+    static inline lossy_entry& builder() {
+      static thread_local lossy_entry B;
+      return B;
+    }
+
+    inline static unsigned lengthOf(const operation* op) {
+      return 1 + op->getCacheEntryLength();
+    }
+    /// Copy out the entry in a slot (caller must hold the slot).
+    inline static void copyEntry(const slot &sl, node_handle* buf) {
+      operation* op = operation::getOpWithIndex(sl.data[0].load(std::memory_order_relaxed));
+      MEDDLY_DCASSERT(op);
+      buf[0] = op->getIndex();
+      unsigned len = lengthOf(op);
+      for (unsigned i=1; i<len; i++) {
+        buf[i] = sl.data[i].load(std::memory_order_relaxed);
+      }
+    }
+    inline bool lock(slot &sl, unsigned &s) {
+      s = sl.seq.load(std::memory_order_relaxed);
+      if (s & WRITING) return false;
+      if (!sl.seq.compare_exchange_strong(s, s | WRITING, 
+          std::memory_order_acquire, std::memory_order_relaxed)) return false;
+      std::atomic_thread_fence(std::memory_order_release);
+      return true;
+    }
+    inline void unlock(slot &sl, unsigned s, bool full) {
+      s = (s & ~(WRITING | FULL)) + STEP;
+      if (full) s |= FULL;
+      sl.seq.store(s, std::memory_order_release);
+    }
+    /// Discard the entry in a locked slot; returns false if it was empty.
+    inline bool discard(slot &sl, unsigned s) {
+      if (0==(s & FULL)) return false;
+      node_handle buf[maxEntrySize];
+      copyEntry(sl, buf);
+      operation* op = operation::getOpWithIndex(buf[0]);
+#ifdef DEBUG_CT
+      printf("Removing CT entry ");
+      op->showEntry(stdout, buf+1);
+      printf("\n");
+#endif
+      op->discardEntry(buf+1);
+      numEntries--;
+      return true;
+    }
+    /// Is a copied entry stale?
+    inline static bool isStale(const node_handle* buf, bool dead_only) {
+      operation* op = operation::getOpWithIndex(buf[0]);
+#ifndef USE_NODE_STATUS
+      return op->isEntryStale(buf+1);
+#else
+      MEDDLY::forest::node_status st = op->getEntryStatus(buf+1);
+      return dead_only 
+        ? (MEDDLY::forest::node_status::DEAD == st)
+        : (MEDDLY::forest::node_status::ACTIVE != st);
+#endif
+    }
+    /// Copy the counters into perf; requires exclusive access.
+    void updateStats();
+
+  private:
+    slot* table;
+    unsigned tableSize;
+    unsigned tableMask;
+
+    std::atomic<long> numEntries;
+    std::atomic<long> pings;
+    std::atomic<long> hits;
+    std::atomic<long> evictions;
+    std::atomic<long> dropped;
+};
+
+// **********************************************************************
+// *                                                                    *
+// *                      monolithic_lossy methods                      *
+// *                                                                    *
+// **********************************************************************
+
+MEDDLY::monolithic_lossy
+::monolithic_lossy(const ct_initializer::settings &s)
+ : base_table(s)
+{
+  //
+  // A slot is 16 integers, so maxSize/16 slots take
+  // as many bytes as maxSize integers.
+  // At least 1024 slots, and always a power of two so we can mask the hash.
+  //
+  tableSize = 1024;
+  while (tableSize < s.maxSize / 16 && tableSize < 0x80000000u) tableSize *= 2;
+  tableMask = tableSize-1;
+
+  // calloc: zero bytes are an empty, unlocked slot.
+  table = (slot*) calloc(tableSize, sizeof(slot));
+  if (0==table) {
+    fprintf(stderr,
+        "Error in allocating array of size %lu at %s, line %d\n",
+        tableSize * sizeof(slot), __FILE__, __LINE__);
+    throw error(error::INSUFFICIENT_MEMORY, __FILE__, __LINE__);
+  }
+  currMemory += tableSize * sizeof(slot);
+  peakMemory = currMemory;
+
+  numEntries = 0;
+  pings = 0;
+  hits = 0;
+  evictions = 0;
+  dropped = 0;
+}
+
+MEDDLY::monolithic_lossy::~monolithic_lossy()
+{
+  free(table);
+}
+
+MEDDLY::compute_table::search_key* 
+MEDDLY::monolithic_lossy::initializeSearchKey(operation* op)
+{
+  return init(op, 1, new lossy_key(op));
+}
+
+MEDDLY::compute_table::search_result&
+MEDDLY::monolithic_lossy::find(search_key *k)
+{
+  lossy_key* key = smart_cast <lossy_key*>(k);
+  MEDDLY_DCASSERT(key);
+  old_search_result &ANS = key->ans;
+  node_handle* buf = key->buf;
+  pings.fetch_add(1, std::memory_order_relaxed);
+  operation* op = key->getOp();
+  const int* kd = key->rawData();
+  const int klen = key->dataLength();
+  const unsigned len = lengthOf(op);
+  const unsigned h = base_hash::raw_hash(kd, klen) & tableMask;
+  ANS.setInvalid();
+
+  // An entry may live in either slot of an aligned pair.
+  for (unsigned c=0; c<2; c++) {
+    slot &sl = table[h ^ c];
+    unsigned s1 = sl.seq.load(std::memory_order_acquire);
+    if ((s1 & WRITING) || (0==(s1 & FULL))) continue;
+    if (sl.data[0].load(std::memory_order_relaxed) != kd[0]) continue;
+    for (unsigned i=1; i<len; i++) {
+      buf[i] = sl.data[i].load(std::memory_order_relaxed);
+    }
+    buf[0] = kd[0];
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (sl.seq.load(std::memory_order_relaxed) != s1) continue;
+    if (!equal_sw(buf, kd, klen)) continue;
+
+    if (op->shouldStaleCacheHitsBeDiscarded() && isStale(buf, true)) {
+      // The match is stale; remove it, unless someone beat us to it.
+      unsigned s;
+      if (lock(sl, s)) {
+        if (s == s1) {
+          discard(sl, s);
+          unlock(sl, s, false);
+        } else {
+          unlock(sl, s, s & FULL);
+        }
+      }
+      break;
+    }
+    // "Hit"
+    hits.fetch_add(1, std::memory_order_relaxed);
+#ifdef DEBUG_CT
+    printf("Found CT entry ");
+    op->showEntry(stdout, buf + 1);
+    printf("\n");
+#endif
+    ANS.setResult(buf + klen, op->getAnsLength());
+    break;
+  }
+  return ANS;
+}
+
+MEDDLY::compute_table::entry_builder& 
+MEDDLY::monolithic_lossy::startNewEntry(search_key *k)
+{
+  old_search_key* key = smart_cast <old_search_key*>(k);
+  MEDDLY_DCASSERT(key);
+  operation* op = key->getOp();
+  MEDDLY_DCASSERT(op);
+  lossy_entry &E = builder();
+  E.length = lengthOf(op);
+  if (E.length > maxEntrySize) {
+    fprintf(stderr, "MEDDLY error: request for compute table entry larger than max size\n");
+    throw error(error::MISCELLANEOUS, __FILE__, __LINE__);  // best we can do
+  }
+  memcpy(E.entry, key->rawData(), key->dataLength() * sizeof(node_handle));
+  E.hash_value = base_hash::raw_hash(key->rawData(), key->dataLength());
+  E.resSlot = key->dataLength();
+  op->doneCTkey(key);
+  return E;
+}
+
+void MEDDLY::monolithic_lossy::addEntry()
+{
+  lossy_entry &E = builder();
+  MEDDLY_DCASSERT(E.resSlot == unsigned(E.length));
+  operation* op = operation::getOpWithIndex(E.entry[0]);
+  MEDDLY_DCASSERT(op);
+
+#ifdef DEBUG_CT
+  printf("Adding CT entry ");
+  op->showEntry(stdout, E.entry+1);
+  printf("\n");
+#endif
+
+  //
+  // Use an empty slot of the pair if there is one,
+  // otherwise replace the entry in our "home" slot.
+  //
+  unsigned h = E.hash_value & tableMask;
+  if ( (table[h].seq.load(std::memory_order_relaxed) & FULL) &&
+      !(table[h^1].seq.load(std::memory_order_relaxed) & FULL) ) h ^= 1;
+
+  slot &sl = table[h];
+  unsigned s;
+  if (!lock(sl, s)) {
+    // Another thread is writing this slot; forget the new entry.
+    dropped.fetch_add(1, std::memory_order_relaxed);
+    op->discardEntry(E.entry+1);
+    return;
+  }
+  if (discard(sl, s)) {
+    evictions.fetch_add(1, std::memory_order_relaxed);
+  }
+  for (int i=0; i<E.length; i++) {
+    sl.data[i].store(E.entry[i], std::memory_order_relaxed);
+  }
+  numEntries++;
+  unlock(sl, s, true);
+}
+
+void MEDDLY::monolithic_lossy::removeStales()
+{
+#ifdef DEBUG_SLOW
+  fprintf(stdout, "Removing stales in CT (size %u, entries %ld)\n", 
+    tableSize, numEntries.load()
+  );
+#endif
+  node_handle buf[maxEntrySize];
+  for (unsigned i=0; i<tableSize; i++) {
+    unsigned s;
+    if (0==(table[i].seq.load(std::memory_order_relaxed) & FULL)) continue;
+    if (!lock(table[i], s)) continue;
+    if (s & FULL) copyEntry(table[i], buf);
+    if ((s & FULL) && isStale(buf, false)) {
+      discard(table[i], s);
+      unlock(table[i], s, false);
+    } else {
+      unlock(table[i], s, s & FULL);
+    }
+  }
+  updateStats();
+}
+
+void MEDDLY::monolithic_lossy::removeAll()
+{
+  for (unsigned i=0; i<tableSize; i++) {
+    unsigned s;
+    if (0==(table[i].seq.load(std::memory_order_relaxed) & FULL)) continue;
+    if (!lock(table[i], s)) continue;
+    discard(table[i], s);
+    unlock(table[i], s, false);
+  }
+  updateStats();
+}
+
+void MEDDLY::monolithic_lossy::show(output &s, int verbLevel)
+{
+  if (verbLevel < 1) return;
+  updateStats();
+  s << "Lossy monolithic compute table\n";
+  s.put("", 6);
+  s << "Current CT memory :\t" << long(currMemory) << " bytes\n";
+  s.put("", 6);
+  s << "Peak    CT memory :\t" << long(peakMemory) << " bytes\n";
+  s.put("", 6);
+  s << "Hash table size   :\t" << long(tableSize) << "\n";
+  s.put("", 6);
+  s << "Number of entries :\t" << long(perf.numEntries) << "\n";
+  s.put("", 6);
+  s << "Evictions         :\t" << evictions.load() << "\n";
+  s.put("", 6);
+  s << "Dropped (busy)    :\t" << dropped.load() << "\n";
+  if (--verbLevel < 1) return;
+  s.put("", 6);
+  s << "Pings             :\t" << long(perf.pings) << "\n";
+  s.put("", 6);
+  s << "Hits              :\t" << long(perf.hits) << "\n";
+  if (--verbLevel < 1) return;
+
+  s << "\nHash table:\n";
+  node_handle buf[maxEntrySize];
+  for (unsigned i=0; i<tableSize; i++) {
+    if (0==(table[i].seq.load(std::memory_order_relaxed) & FULL)) continue;
+    copyEntry(table[i], buf);
+    s.put('\t');
+    s.put(long(i), 9);
+    s << ": ";
+    operation::getOpWithIndex(buf[0])->showEntry(s, buf + 1);
+    s.put('\n');
+  }
+}
+
+void MEDDLY::monolithic_lossy::updateStats()
+{
+  perf.numEntries = numEntries.load();
+  perf.pings = pings.load();
+  perf.hits = hits.load();
+}
+
+
 // **********************************************************************
 // *                                                                    *
 // *                  monolithic_chained_style methods                  *
@@ -2523,6 +3039,28 @@ bool MEDDLY::monolithic_unchained_style::usesMonolithic() const
   return true;
 }
 
+// **********************************************************************
+// *                                                                    *
+// *                   monolithic_lossy_style methods                   *
+// *                                                                    *
+// **********************************************************************
+
+
+MEDDLY::monolithic_lossy_style::monolithic_lossy_style() 
+{ 
+}
+
+MEDDLY::compute_table* 
+MEDDLY::monolithic_lossy_style::create(const ct_initializer::settings &s) const 
+{
+  return new monolithic_lossy(s);
+}
+
+bool MEDDLY::monolithic_lossy_style::usesMonolithic() const 
+{
+  return true;
+}
+
 // **********************************************************************
 // *                                                                    *
 // *                  operation_chained_style  methods                  *
@@ -34,6 +34,7 @@
 namespace MEDDLY {
   class monolithic_chained_style;
   class monolithic_unchained_style;
+  class monolithic_lossy_style;
   class operation_chained_style;
   class operation_unchained_style;
   class operation_map_style;
@@ -65,6 +66,19 @@ class MEDDLY::monolithic_unchained_style : public compute_table_style {
     virtual bool usesMonolithic() const;
 };
 
+// **********************************************************************
+// *                                                                    *
+// *                    monolithic_lossy_style class                    *
+// *                                                                    *
+// **********************************************************************
+
+class MEDDLY::monolithic_lossy_style : public compute_table_style {
+  public:
+    monolithic_lossy_style();
+    virtual compute_table* create(const ct_initializer::settings &s) const;
+    virtual bool usesMonolithic() const;
+};
+
 // **********************************************************************
 // *                                                                    *
 // *                   operation_chained_style  class                   *
@@ -128,6 +128,7 @@ class MEDDLY::simple_separated : public node_storage {
         node_storage_flags opt);
 
     virtual void unlinkDownAndRecycle(node_address addr);
+    virtual bool reserveNodes(int count, int size, bool grow);
 
     virtual bool areDuplicates(node_address addr, const unpacked_node &nr) const;
     virtual void fillUnpacked(unpacked_node &nr, node_address addr, unpacked_node::storage_style) const;
@@ -454,6 +455,14 @@ void MEDDLY::simple_separated::unlinkDownAndRecycle(node_address addr)
 }
 
 
+bool MEDDLY::simple_separated::reserveNodes(int count, int size, bool grow)
+{
+  MEDDLY_DCASSERT(MM);
+  // A sparse node with every edge is the largest possible
+  return MM->reserveChunks(size_t(count) * slotsForNode(size, true), grow);
+}
+
+
 
 bool MEDDLY::simple_separated
 ::areDuplicates(node_address addr, const unpacked_node &n) const
@@ -0,0 +1,334 @@
+/*
+    Meddly: Multi-terminal and Edge-valued Decision Diagram LibrarY.
+    Copyright (C) 2009, Iowa State University Research Foundation, Inc.
+
+    This library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "thread_pool.h"
+
+// ******************************************************************
+// *                                                                *
+// *                      thread_pool  statics                      *
+// *                                                                *
+// ******************************************************************
+
+thread_local int MEDDLY::thread_pool::me = 0;
+MEDDLY::thread_pool* MEDDLY::thread_pool::pool = 0;
+int MEDDLY::thread_pool::num_threads = 1;
+bool MEDDLY::thread_pool::active = false;
+
+// ******************************************************************
+
+void MEDDLY::thread_pool::setNumThreads(int n)
+{
+  if (n<1) throw error(error::INVALID_ASSIGNMENT, __FILE__, __LINE__);
+  if (active) throw error(error::INVALID_OPERATION, __FILE__, __LINE__);
+  num_threads = n;
+}
+
+int MEDDLY::thread_pool::getNumThreads()
+{
+  return num_threads;
+}
+
+// ******************************************************************
+
+MEDDLY::thread_pool* MEDDLY::thread_pool::start(expert_forest* f1,
+  expert_forest* f2, expert_forest* f3)
+{
+  if (num_threads < 2) return 0;
+  if (active) return 0;
+  if (!operation::computeTablesAreThreadSafe()) return 0;
+
+  if (0==pool || pool->nthreads != num_threads) {
+    delete pool;
+    pool = new thread_pool(num_threads);
+  }
+
+  //
+  // Share each forest once
+  //
+  expert_forest* F[3] = { f1, f2, f3 };
+  if (F[1] == F[0]) F[1] = 0;
+  if (F[2] == F[0] || F[2] == F[1]) F[2] = 0;
+  for (int i=0; i<3; i++) {
+    if (0==F[i]) continue;
+    if (F[i]->startSharing(pool)) continue;
+    for (int j=0; j<i; j++) {
+      if (F[j]) F[j]->stopSharing();
+    }
+    return 0;
+  }
+  for (int i=0; i<3; i++) pool->forests[i] = F[i];
+
+  active = true;
+  operation::concurrent = true;
+  std::lock_guard<std::mutex> L(pool->M);
+  pool->running++;
+  return pool;
+}
+
+// ******************************************************************
+
+void MEDDLY::thread_pool::finish(thread_pool* P)
+{
+  if (0==P) return;
+  MEDDLY_DCASSERT(P == pool);
+  MEDDLY_DCASSERT(active);
+  {
+    std::lock_guard<std::mutex> L(P->M);
+    P->running--;
+  }
+  //
+  // Every task has finished, so the forests are ours again
+  //
+  for (int i=0; i<3; i++) {
+    if (P->forests[i]) P->forests[i]->stopSharing();
+    P->forests[i] = 0;
+  }
+  operation::concurrent = false;
+  active = false;
+}
+
+// ******************************************************************
+
+void MEDDLY::thread_pool::shutdown()
+{
+  MEDDLY_DCASSERT(!active);
+  delete pool;
+  pool = 0;
+}
+
+// ******************************************************************
+// *                                                                *
+// *                      thread_pool  methods                      *
+// *                                                                *
+// ******************************************************************
+
+MEDDLY::thread_pool::thread_pool(int n)
+ : queued(0), sleepers(0), stopping(false)
+{
+  nthreads = n;
+  queues = new queue[n];
+  running = 0;
+  quit = false;
+  for (int i=0; i<3; i++) forests[i] = 0;
+  for (int i=1; i<n; i++) {
+    threads.push_back(std::thread(&thread_pool::work, this, i));
+  }
+}
+
+MEDDLY::thread_pool::~thread_pool()
+{
+  {
+    std::lock_guard<std::mutex> L(M);
+    quit = true;
+  }
+  CV.notify_all();
+  for (unsigned i=0; i<threads.size(); i++) threads[i].join();
+  delete[] queues;
+}
+
+// ******************************************************************
+
+void MEDDLY::thread_pool::forEach(int n, const std::function<void(int)> &f)
+{
+  if (n<1) return;
+  if (1==n || queued.load() >= nthreads) {
+    //
+    // Nothing to split, or enough work queued already
+    // to keep everyone busy; don't bother.
+    //
+    for (int i=0; i<n; i++) f(i);
+    return;
+  }
+
+  group g;
+  g.f = &f;
+  g.pending = n-1;
+
+  //
+  // Queue calls 1..n-1, so that we take them (from the back)
+  // in order, and thieves take them (from the front) in reverse.
+  //
+  queue &Q = queues[me];
+  {
+    std::lock_guard<std::mutex> L(Q.lock);
+    for (int i=n-1; i>0; i--) {
+      task t = { &g, i };
+      Q.tasks.push_back(t);
+    }
+    queued += n-1;
+  }
+  wake();
+
+  try {
+    f(0);
+  }
+  catch (...) {
+    std::lock_guard<std::mutex> L(g.lock);
+    if (!g.error) g.error = std::current_exception();
+  }
+
+  //
+  // Help out until our calls are done
+  //
+  while (g.pending.load() > 0) {
+    task t;
+    if (grab(t)) {
+      run(t);
+    } else {
+      std::this_thread::yield();
+    }
+    safepoint();
+  }
+  if (g.error) std::rethrow_exception(g.error);
+}
+
+// ******************************************************************
+
+void MEDDLY::thread_pool::exclusive(const std::function<void()> &fn)
+{
+  std::unique_lock<std::mutex> L(M);
+  park(L);
+  stopping = true;
+  running--;
+  CV.wait(L, [this]() { return 0==running; });
+  try {
+    fn();
+  }
+  catch (...) {
+    stopping = false;
+    running++;
+    CV.notify_all();
+    throw;
+  }
+  stopping = false;
+  running++;
+  CV.notify_all();
+}
+
+// ******************************************************************
+
+bool MEDDLY::thread_pool::grab(task &t)
+{
+  if (0==queued.load()) return false;
+
+  // Newest task from our own queue
+  queue &Q = queues[me];
+  {
+    std::lock_guard<std::mutex> L(Q.lock);
+    if (!Q.tasks.empty()) {
+      t = Q.tasks.back();
+      Q.tasks.pop_back();
+      queued--;
+      return true;
+    }
+  }
+
+  // Oldest task from someone else's
+  for (int i=1; i<nthreads; i++) {
+    queue &V = queues[(me+i) % nthreads];
+    std::lock_guard<std::mutex> L(V.lock);
+    if (!V.tasks.empty()) {
+      t = V.tasks.front();
+      V.tasks.pop_front();
+      queued--;
+      return true;
+    }
+  }
+  return false;
+}
+
+// ******************************************************************
+
+void MEDDLY::thread_pool::run(const task &t)
+{
+  group* g = t.g;
+  try {
+    (*g->f)(t.index);
+  }
+  catch (...) {
+    std::lock_guard<std::mutex> L(g->lock);
+    if (!g->error) g->error = std::current_exception();
+  }
+  // After this, g may be gone
+  g->pending--;
+}
+
+// ******************************************************************
+
+void MEDDLY::thread_pool::wake()
+{
+  if (0==sleepers.load()) return;
+  //
+  // A worker checks for tasks while holding M, so taking M here
+  // makes sure it is either waiting (and will be notified)
+  // or has not yet looked (and will see our tasks).
+  //
+  { std::lock_guard<std::mutex> L(M); }
+  CV.notify_all();
+}
+
+// ******************************************************************
+
+void MEDDLY::thread_pool::work(int id)
+{
+  me = id;
+  std::unique_lock<std::mutex> L(M);
+  for (;;) {
+    sleepers++;
+    CV.wait(L, [this]() {
+      return quit || (!stopping.load() && queued.load() > 0);
+    });
+    sleepers--;
+    if (quit) break;
+
+    running++;
+    L.unlock();
+    //
+    // Tasks come in bursts, so keep looking
+    // for a while before going back to sleep.
+    //
+    for (int idle=0; idle<SPINS; ) {
+      task t;
+      if (grab(t)) {
+        run(t);
+        idle = 0;
+      } else {
+        idle++;
+        std::this_thread::yield();
+      }
+      safepoint();
+    }
+    L.lock();
+    running--;
+    CV.notify_all();
+  }
+  L.unlock();
+  unpacked_node::freeRecycled();
+}
+
+// ******************************************************************
+
+void MEDDLY::thread_pool::park(std::unique_lock<std::mutex> &L)
+{
+  while (stopping.load()) {
+    running--;
+    CV.notify_all();
+    CV.wait(L, [this]() { return !stopping.load(); });
+    running++;
+  }
+}
@@ -0,0 +1,190 @@
+/*
+    Meddly: Multi-terminal and Edge-valued Decision Diagram LibrarY.
+    Copyright (C) 2009, Iowa State University Research Foundation, Inc.
+
+    This library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include "defines.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace MEDDLY {
+  class thread_pool;
+};
+
+/**
+    Work-stealing pool of threads, for parallel saturation.
+
+    An operation that can run in parallel calls start() with its
+    forests; if that returns a pool, the forests are shared (see
+    expert_forest::startSharing()) and the operation may use forEach()
+    until it calls finish().  Otherwise, it should run sequentially.
+
+    Each thread has a queue of tasks.  A thread adds and takes tasks
+    at the back of its own queue, and when that is empty it steals
+    from the front of the others.  A thread waiting for its tasks
+    keeps running tasks, so the calling thread is one of the workers.
+
+    Anything that moves nodes in memory (growing the node storage or
+    the handle list) must run in exclusive(), which waits until every
+    other thread is parked in safepoint().  Threads reach a safepoint
+    between tasks, and before building a node.
+*/
+class MEDDLY::thread_pool {
+  public:
+    /// Number of threads to use; 1 means no parallelism.
+    static void setNumThreads(int n);
+    static int getNumThreads();
+
+    /** Start a parallel region for an operation.
+        Fails if there is only one thread, if the compute tables are
+        not thread safe, if a region is already running, or if any
+        of the given forests cannot be shared.
+          @param  f1  A forest used by the operation, or 0.
+          @param  f2  A forest used by the operation, or 0.
+          @param  f3  A forest used by the operation, or 0.
+          @return     The pool, or 0 on failure.
+    */
+    static thread_pool* start(expert_forest* f1, expert_forest* f2,
+      expert_forest* f3);
+
+    /// End the region begun by start(); P may be 0.
+    static void finish(thread_pool* P);
+
+    /// Stop all threads; called during library cleanup.
+    static void shutdown();
+
+  public:
+    /** Call f(0), ..., f(n-1), maybe in parallel, and wait for all.
+        If any call throws, the first exception is rethrown
+        once every call has finished.
+    */
+    void forEach(int n, const std::function<void(int)> &f);
+
+    /// Park the calling thread here, if another needs exclusive access.
+    void safepoint();
+
+    /** Run fn while every other thread of the pool is parked.
+        If another thread is already waiting for exclusive access,
+        we wait for it first.  fn must not use the pool.
+    */
+    void exclusive(const std::function<void()> &fn);
+
+    /// Lock for node handles and node memory, over all forests.
+    std::mutex& allocLock();
+
+    /// Nodes each shared forest must be able to build without moving memory.
+    int nodeMargin() const;
+
+  private:
+    thread_pool(int n);
+    ~thread_pool();
+
+    struct group {
+      const std::function<void(int)>* f;
+      std::atomic<int> pending;
+      std::mutex lock;
+      std::exception_ptr error;
+    };
+    struct task {
+      group* g;
+      int index;
+    };
+    struct queue {
+      std::mutex lock;
+      std::deque<task> tasks;
+    };
+
+    /// Take a task from our queue, or steal one.
+    bool grab(task &t);
+    /// Run a task, and count it as done.
+    void run(const task &t);
+    /// Wake up sleeping workers, if any.
+    void wake();
+    /// Main loop of worker threads.
+    void work(int id);
+    /// Wait (holding M) until no thread wants exclusive access.
+    void park(std::unique_lock<std::mutex> &L);
+
+  private:
+    /// Times an idle worker looks for tasks, before it sleeps.
+    static const int SPINS = 1000;
+
+    int nthreads;
+    queue* queues;
+    std::vector<std::thread> threads;
+
+    /// Number of tasks in all queues.
+    std::atomic<int> queued;
+    /// Number of workers waiting for tasks.
+    std::atomic<int> sleepers;
+    /// Does a thread want exclusive access.
+    std::atomic<bool> stopping;
+
+    /// Protects running and quit, and is used with CV.
+    std::mutex M;
+    std::condition_variable CV;
+    /// Number of threads that are neither asleep nor parked.
+    int running;
+    /// Should workers exit.
+    bool quit;
+
+    std::mutex alloc;
+
+    /// Forests shared during the current region.
+    expert_forest* forests[3];
+
+    /// Index of the calling thread; 0 for the thread that started us.
+    static thread_local int me;
+
+    static thread_pool* pool;
+    static int num_threads;
+    static bool active;
+};
+
+// ******************************************************************
+// *                                                                *
+// *                   inlined thread_pool methods                  *
+// *                                                                *
+// ******************************************************************
+
+inline std::mutex& MEDDLY::thread_pool::allocLock()
+{
+  return alloc;
+}
+
+inline int MEDDLY::thread_pool::nodeMargin() const
+{
+  return 2*nthreads;
+}
+
+inline void MEDDLY::thread_pool::safepoint()
+{
+  if (!stopping.load()) return;
+  std::unique_lock<std::mutex> L(M);
+  park(L);
+}
+
+#endif
@@ -22,42 +22,40 @@
 #include <limits.h>
 
 MEDDLY::unique_table::unique_table(expert_forest* ef)
-: parent(ef)
+: parent(ef), tables(0), otables(0), locks(0)
 {
   int num_vars=parent->getNumVariables();
-  if(parent->isForRelations()){
-    tables = new subtable[2*num_vars+1];
-    if(tables==0){
-      fprintf(stderr, "Error in allocating array of size %lu at %s, line %d\n",
-          (2*num_vars+1)*sizeof(subtable), __FILE__, __LINE__);
-      throw error(error::INSUFFICIENT_MEMORY, __FILE__, __LINE__);
-    }
-    tables += num_vars;
-
-    for(int i=1; i<=num_vars; i++){
-      tables[i].init(parent);
-      tables[-i].init(parent);
-    }
+  // relations have tables for primed variables, at negative indexes
+  int lo = parent->isForRelations() ? -num_vars : 0;
+  bool open = (forest::policies::unique_table_type::OPEN_ADDRESSING
+                == parent->getPolicies().unique);
+  if (open) {
+    otables = new open_subtable[num_vars+1-lo];
+    otables -= lo;
+  } else {
+    tables = new subtable[num_vars+1-lo];
+    tables -= lo;
   }
-  else{
-    tables = new subtable[num_vars+1];
-    if(tables==0){
-      throw error(error::INSUFFICIENT_MEMORY, __FILE__, __LINE__);
-    }
-
-    for(int i=1; i<=num_vars; i++){
+  locks = new std::mutex[num_vars+1-lo];
+  locks -= lo;
+
+  for (int i=1; i<=num_vars; i++) {
+    if (open) {
+      otables[i].init(parent);
+      if (lo) otables[-i].init(parent);
+    } else {
       tables[i].init(parent);
+      if (lo) tables[-i].init(parent);
     }
   }
 }
 
 MEDDLY::unique_table::~unique_table()
 {
-  if(parent->isForRelations()){
-    tables -= parent->getNumVariables();
-  }
-
-  delete[] tables;
+  int lo = parent->isForRelations() ? -parent->getNumVariables() : 0;
+  if (tables)   delete[] (tables + lo);
+  if (otables)  delete[] (otables + lo);
+  delete[] (locks + lo);
 }
 
 unsigned MEDDLY::unique_table::getSize() const
@@ -66,13 +64,13 @@ unsigned MEDDLY::unique_table::getSize() const
   int num_vars = parent->getNumVariables();
   if (parent->isForRelations()) {
     for(int i = 1; i <= num_vars; i++){
-      num += tables[i].getSize();
-      num += tables[-i].getSize();
+      num += getSize(i);
+      num += getSize(-i);
     }
   }
   else {
     for (int i = 1; i <= num_vars; i++) {
-      num += tables[i].getSize();
+      num += getSize(i);
     }
   }
   return num;
@@ -84,13 +82,13 @@ unsigned MEDDLY::unique_table::getNumEntries() const
   int num_vars = parent->getNumVariables();
   if (parent->isForRelations()) {
     for (int i = 1; i <= num_vars; i++) {
-      num += tables[i].getNumEntries();
-      num += tables[-i].getNumEntries();
+      num += getNumEntries(i);
+      num += getNumEntries(-i);
     }
   }
   else {
     for (int i = 1; i <= num_vars; i++) {
-      num += tables[i].getNumEntries();
+      num += getNumEntries(i);
     }
   }
   return num;
@@ -102,13 +100,13 @@ unsigned MEDDLY::unique_table::getMemUsed() const
   int num_vars = parent->getNumVariables();
   if (parent->isForRelations()) {
     for (int i = 1; i <= num_vars; i++) {
-      num += tables[i].getMemUsed();
-      num += tables[-i].getMemUsed();
+      num += getMemUsed(i);
+      num += getMemUsed(-i);
     }
   }
   else {
     for (int i = 1; i <= num_vars; i++) {
-      num += tables[i].getMemUsed();
+      num += getMemUsed(i);
     }
   }
   return num;
@@ -129,15 +127,15 @@ void MEDDLY::unique_table::show(output &s) const
   if (parent->isForRelations()) {
     for (int i = 1; i <= num_vars; i++) {
       s << "Unique table (Var " << i << "):\n";
-      tables[i].show(s);
+      if (tables) tables[i].show(s); else otables[i].show(s);
       s << "Unique table (Var " << -i << "):\n";
-      tables[-i].show(s);
+      if (tables) tables[-i].show(s); else otables[-i].show(s);
     }
   }
   else {
     for (int i = 1; i <= num_vars; i++) {
       s << "Unique table (Var " << i << "):\n";
-      tables[i].show(s);
+      if (tables) tables[i].show(s); else otables[i].show(s);
     }
   }
   s.flush();
@@ -349,3 +347,211 @@ void MEDDLY::unique_table::subtable::shrink()
   else                 next_shrink = size / 2;
   buildFromList(ptr);
 }
+
+// ******************************************************************
+// *                                                                *
+// *                 unique_table::open_subtable                    *
+// *                                                                *
+// ******************************************************************
+
+MEDDLY::unique_table::open_subtable::open_subtable()
+: parent(nullptr), table(nullptr), old_table(nullptr)
+{
+}
+
+MEDDLY::unique_table::open_subtable::~open_subtable()
+{
+  free(table);
+  free(old_table);
+}
+
+void MEDDLY::unique_table::open_subtable::reportStats(output &s, const char* pad, unsigned flags) const
+{
+  if (flags & expert_forest::UNIQUE_TABLE_STATS) {
+    s << pad << "Unique table stats:\n";
+    s << pad << "    " << long(getSize()) << " current size\n";
+    s << pad << "    " << long(getNumEntries()) << " current entries\n";
+  }
+}
+
+void MEDDLY::unique_table::open_subtable::show(output &s) const
+{
+  for (unsigned i=0; i < size; i++) {
+    if (table[i].item) {
+      s << "[" << long(i) << "] : " << long(table[i].item) << "\n";
+    }
+  }
+  for (unsigned i=old_next; i < old_size; i++) {
+    if (old_table[i].item > 0) {
+      s << "[old " << long(i) << "] : " << long(old_table[i].item) << "\n";
+    }
+  }
+  s.flush();
+}
+
+void MEDDLY::unique_table::open_subtable::init(expert_forest *ef)
+{
+  parent = ef;
+  bits = MIN_BITS;
+  size = 1u << bits;
+  num_entries = 0;
+
+  table = static_cast<slot*>(calloc(size, sizeof(slot)));
+  if (table == nullptr) {
+    throw error(error::INSUFFICIENT_MEMORY, __FILE__, __LINE__);
+  }
+
+  old_table = nullptr;
+  old_size = 0;
+  old_bits = 0;
+  old_next = 0;
+}
+
+void MEDDLY::unique_table::open_subtable::add(unsigned hash, node_handle item)
+{
+  MEDDLY_DCASSERT(item>0);
+
+  if (old_table) {
+    migrate();
+  } else if (2*(num_entries+1) > size && bits < MAX_BITS) {
+    startResize(bits+1);
+  }
+  insert(hash, item);
+  num_entries++;
+
+  // No chain, but the memory managers expect a non-negative
+  // "next" slot in every node that is not a hole.
+  parent->setNext(item, 0);
+}
+
+MEDDLY::node_handle MEDDLY::unique_table::open_subtable::remove(unsigned hash, node_handle item)
+{
+  if (old_table) migrate();
+
+  //
+  // Current table: linear probing, so fill the hole by shifting
+  // back any later entries of the cluster that may use it.
+  //
+  const unsigned mask = size-1;
+  for (unsigned i = home(hash, bits); table[i].item; i = (i+1) & mask) {
+    if (table[i].item != item) continue;
+    for (unsigned j = (i+1) & mask; table[j].item; j = (j+1) & mask) {
+      unsigned k = home(table[j].hash, bits);
+      // can the entry at j move to i?
+      bool fits = (i <= j) ? (k <= i || k > j) : (k <= i && k > j);
+      if (fits) {
+        table[i] = table[j];
+        i = j;
+      }
+    }
+    table[i].item = 0;
+    num_entries--;
+    if (0==old_table && bits > MIN_BITS && 8*num_entries < size) {
+      startResize(bits-1);
+    }
+    return item;
+  }
+
+  //
+  // Old table: leave a marker so searches keep going.
+  //
+  if (old_table) {
+    const unsigned omask = old_size-1;
+    for (unsigned i = home(hash, old_bits); old_table[i].item; i = (i+1) & omask) {
+      if (old_table[i].item != item) continue;
+      old_table[i].item = MOVED;
+      num_entries--;
+      return item;
+    }
+  }
+  MEDDLY_DCASSERT(false);
+  return 0;
+}
+
+void MEDDLY::unique_table::open_subtable::clear()
+{
+  if (parent != 0) {
+    free(table);
+    free(old_table);
+    init(parent);
+  }
+}
+
+int MEDDLY::unique_table::open_subtable::getItems(node_handle* items, int sz) const
+{
+  int k = 0;
+  for (unsigned i = 0; i < size; i++) {
+    if (0==table[i].item) continue;
+    items[k++] = table[i].item;
+    if (k == sz) return k;
+  }
+  for (unsigned i = old_next; i < old_size; i++) {
+    if (old_table[i].item <= 0) continue;
+    items[k++] = old_table[i].item;
+    if (k == sz) return k;
+  }
+
+  MEDDLY_DCASSERT(k == num_entries);
+  return k;
+}
+
+//
+// Helpers (private)
+//
+
+void MEDDLY::unique_table::open_subtable::insert(unsigned hash, node_handle item)
+{
+  const unsigned mask = size-1;
+  unsigned i = home(hash, bits);
+  while (table[i].item) i = (i+1) & mask;
+  table[i].hash = hash;
+  table[i].item = item;
+}
+
+void MEDDLY::unique_table::open_subtable::startResize(unsigned b)
+{
+  MEDDLY_DCASSERT(0==old_table);
+#ifdef DEBUG_SLOW
+  fprintf(stderr, "Resizing unique table (current size: %u, new size %u)\n", 
+    size, 1u << b);
+#endif
+  slot* temp = static_cast<slot*>(calloc(1u << b, sizeof(slot)));
+  if (0==temp) {
+    fprintf(stderr, "Error in allocating array of size %lu at %s, line %d\n",
+        (1ul << b) * sizeof(slot), __FILE__, __LINE__);
+    throw error(error::INSUFFICIENT_MEMORY, __FILE__, __LINE__);
+  }
+  old_table = table;
+  old_size = size;
+  old_bits = bits;
+  old_next = 0;
+
+  table = temp;
+  bits = b;
+  size = 1u << b;
+
+  migrate();
+}
+
+void MEDDLY::unique_table::open_subtable::migrate()
+{
+  //
+  // Each call moves MIGRATE_STEP slots.  A resize starts with the
+  // current table at most half full (growing) or 1/8 full (shrinking),
+  // so the move is complete well before the new table is half full.
+  //
+  unsigned stop = old_next + MIGRATE_STEP;
+  if (stop > old_size) stop = old_size;
+  for (; old_next < stop; old_next++) {
+    slot &s = old_table[old_next];
+    if (s.item > 0) insert(s.hash, s.item);
+    if (s.item) s.item = MOVED;
+  }
+  if (old_next < old_size) return;
+
+  free(old_table);
+  old_table = nullptr;
+  old_size = 0;
+  old_bits = 0;
+  old_next = 0;
+}
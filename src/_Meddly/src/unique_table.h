@@ -22,6 +22,7 @@
 #define UNIQUE_TABLE_H
 
 #include "defines.h"
+#include <mutex>
 
 namespace MEDDLY {
 class unique_table;
@@ -114,6 +115,104 @@ private:
     static const unsigned MIN_SIZE = 8;
   };
 
+  /**
+      Sub table using open addressing with linear probing.
+      Each slot keeps the node hash next to the node handle,
+      so most mismatches are rejected without looking at the node.
+      Resizing is incremental: the previous table is kept and
+      a few of its slots are moved by every add or remove,
+      and searches look in both tables until the move is done.
+   */
+  class open_subtable {
+  public:
+    open_subtable();
+    ~open_subtable();
+
+    inline unsigned getSize() const         { return size + old_size; }
+    inline unsigned getNumEntries() const   { return num_entries; }
+    inline unsigned getMemUsed() const      { return getSize() * sizeof(slot); }
+
+    void reportStats(output &s, const char* pad, unsigned flags) const;
+
+    /// For debugging
+    void show(output& s) const;
+
+    /**
+     * Initialize the sub table. Must be called before use.
+     */
+    void init(expert_forest *ef);
+
+    /** If table contains key, return it; otherwise return 0.
+            Class T must have the following methods:
+              unsigned hash():    return the hash value for this item.
+     */
+    template <typename T>
+    int find(const T &key) const;
+
+    /** Add the item.
+            Used when we KNOW that the item is not in the unique table already.
+     */
+    void add(unsigned hash, node_handle item);
+
+    /** If table contains key, remove it and return it.
+          I.e., the exact key.
+          Otherwise, return 0.
+     */
+    int remove(unsigned hash, node_handle item);
+
+    /**
+     * Remove all the items in the table and reset the state.
+     */
+    void clear();
+
+    /// Same as subtable::getItems().
+    int getItems(node_handle* items, int sz) const;
+
+  private:
+    struct slot {
+      unsigned hash;
+      node_handle item;
+    };
+
+    /// Marks a slot of the old table whose item has been moved.
+    static const node_handle MOVED = -1;
+
+    /// Home slot for a hash, in a table with 2^b slots.
+    static inline unsigned home(unsigned hash, unsigned b) {
+      return unsigned(hash * 2654435769u) >> (32 - b);
+    }
+
+    template <typename T>
+    inline int findIn(const slot* t, unsigned b, const T &key, unsigned h) const;
+
+    /// Add to the current table; does not check for duplicates or resize.
+    void insert(unsigned hash, node_handle item);
+
+    /// Start moving everything into a table with 2^b slots.
+    void startResize(unsigned b);
+
+    /// Move a few slots from the old table.
+    void migrate();
+
+  private:
+    expert_forest* parent;
+    slot* table;
+    unsigned size;
+    unsigned bits;
+    unsigned num_entries;
+
+    /// Table being emptied, or null.
+    slot* old_table;
+    unsigned old_size;
+    unsigned old_bits;
+    /// Slots of the old table before this one have been moved.
+    unsigned old_next;
+
+    static const unsigned MAX_BITS = 30;
+    static const unsigned MIN_BITS = 3;
+    static const unsigned MIGRATE_STEP = 8;
+  };
+
 public:
   unique_table(expert_forest *ef);
   ~unique_table();
@@ -167,24 +266,48 @@ public:
    */
   int getItems(int var, node_handle* items, int sz) const;
 
+  /** Lock the table of the given variable.
+      Needed only when several threads use the table at once;
+      they must hold the lock across find() and add().
+   */
+  void lock(int var);
+
+  /// Unlock the table of the given variable.
+  void unlock(int var);
+
 private:
   expert_forest* parent;
+  /// Chained sub tables, or null.
   subtable* tables;
+  /// Open addressing sub tables, or null.
+  open_subtable* otables;
+  /// One lock per sub table.
+  std::mutex* locks;
 };
 
 inline unsigned MEDDLY::unique_table::getSize(int var) const
 {
-  return tables[var].getSize();
+  return tables ? tables[var].getSize() : otables[var].getSize();
 }
 
 inline unsigned MEDDLY::unique_table::getNumEntries(int var) const
 {
-  return tables[var].getNumEntries();
+  return tables ? tables[var].getNumEntries() : otables[var].getNumEntries();
 }
 
 inline unsigned MEDDLY::unique_table::getMemUsed(int var) const
 {
-  return tables[var].getMemUsed();
+  return tables ? tables[var].getMemUsed() : otables[var].getMemUsed();
+}
+
+inline void MEDDLY::unique_table::lock(int var)
+{
+  locks[var].lock();
+}
+
+inline void MEDDLY::unique_table::unlock(int var)
+{
+  locks[var].unlock();
 }
 
 template <typename T>
@@ -212,33 +335,57 @@ MEDDLY::node_handle MEDDLY::unique_table::subtable::find(const T &key) const
   return 0;
 }
 
+template <typename T>
+inline MEDDLY::node_handle MEDDLY::unique_table::open_subtable
+::findIn(const slot* t, unsigned b, const T &key, unsigned h) const
+{
+  const unsigned mask = (1u << b) - 1;
+  for (unsigned i = home(h, b); t[i].item; i = (i+1) & mask) {
+    if (t[i].hash != h) continue;
+    if (t[i].item < 0) continue;   // MOVED
+    if (parent->areDuplicates(t[i].item, key)) return t[i].item;
+  }
+  return 0;
+}
+
+template <typename T>
+MEDDLY::node_handle MEDDLY::unique_table::open_subtable::find(const T &key) const
+{
+  unsigned h = key.hash();
+  node_handle p = findIn(table, bits, key, h);
+  if (p || 0==old_table) return p;
+  return findIn(old_table, old_bits, key, h);
+}
+
 template <typename T>
 inline MEDDLY::node_handle MEDDLY::unique_table::find(const T &key, int var) const
 {
-  return tables[var].find(key);
+  return tables ? tables[var].find(key) : otables[var].find(key);
 }
 
 inline void MEDDLY::unique_table::add(unsigned hash, node_handle item)
 {
   int level = parent->getNodeLevel(item);
   int var = parent->getVarByLevel(level);
-  tables[var].add(hash, item);
+  if (tables) tables[var].add(hash, item);
+  else        otables[var].add(hash, item);
 }
 
 inline MEDDLY::node_handle MEDDLY::unique_table::remove(unsigned hash, node_handle item)
 {
   int var = parent->getVarByLevel(parent->getNodeLevel(item));
-  return tables[var].remove(hash, item);
+  return tables ? tables[var].remove(hash, item) : otables[var].remove(hash, item);
 }
 
 inline void MEDDLY::unique_table::clear(int var)
 {
-  return tables[var].clear();
+  if (tables) tables[var].clear();
+  else        otables[var].clear();
 }
 
 inline int MEDDLY::unique_table::getItems(int var, node_handle* items, int sz) const
 {
-  return tables[var].getItems(items, sz);
+  return tables ? tables[var].getItems(items, sz) : otables[var].getItems(items, sz);
 }
 
 #endif
@@ -170,15 +170,16 @@ bool impl_xA_check(dd_edge &x, const dd_edge &P)
   return true;
 }
 
-bool expl_xA_check(const dd_edge &ss, const dd_edge &P)
+bool expl_xA_check(const dd_edge &ss, const dd_edge &P, 
+  const numerical_opname* op, int split)
 {
   int i;
   double p[3];
   double q[3];
   double q_alt[3];
   p[0] = 0; p[1] = 1; p[2] = 0;
-  printf("xA multiplications (explicit):\n");
-  specialized_operation* VM = EXPLVECT_MATR_MULT->buildOperation(ss, P, ss);
+  printf("xA multiplications (explicit, split %d):\n", split);
+  specialized_operation* VM = op->buildOperation(ss, P, ss, split);
   for (i=0; i<9; i++) {
     printf("p%d: [%lf, %lf, %lf]\n", i, p[0], p[1], p[2]);
     q[0] = q[1] = q[2] = 0;
@@ -241,15 +242,16 @@ bool impl_Ax_check(dd_edge &x, const dd_edge &P)
   return true;
 }
 
-bool expl_Ax_check(const dd_edge &ss, const dd_edge &P)
+bool expl_Ax_check(const dd_edge &ss, const dd_edge &P,
+  const numerical_opname* op, int split)
 {
   int i;
   double p[3];
   double q[3];
   double q_alt[3];
   p[0] = 0; p[1] = 1; p[2] = 0;
-  printf("Ax multiplications (explicit):\n");
-  specialized_operation* MV = MATR_EXPLVECT_MULT->buildOperation(ss, P, ss);
+  printf("Ax multiplications (explicit, split %d):\n", split);
+  specialized_operation* MV = op->buildOperation(ss, P, ss, split);
   for (i=0; i<9; i++) {
     printf("p%d: [%lf, %lf, %lf]\n", i, p[0], p[1], p[2]);
     q[0] = q[1] = q[2] = 0;
@@ -291,12 +293,18 @@ int main(int argc, const char** argv)
 
   if (!build_oz(evpmdds, mtmxds, ss, P)) return 1;
 
-  if (!expl_xA_check(ss, P)) return 1;
+  if (!expl_xA_check(ss, P, EXPLVECT_MATR_MULT, 0)) return 1;
   if (!impl_xA_check(x, P)) return 1;
 
-  if (!expl_Ax_check(ss, P)) return 1;
+  if (!expl_Ax_check(ss, P, MATR_EXPLVECT_MULT, 0)) return 1;
   if (!impl_Ax_check(x, P)) return 1;
 
+  // Hybrid, for each possible split level
+  for (int split=0; split<=3; split++) {
+    if (!expl_xA_check(ss, P, HYBRID_EXPLVECT_MATR_MULT, split)) return 1;
+    if (!expl_Ax_check(ss, P, HYBRID_MATR_EXPLVECT_MULT, split)) return 1;
+  }
+
   // Avoid active node warning
   ss.clear();
   P.clear();
@@ -0,0 +1,453 @@
+
+/*
+    Meddly: Multi-terminal and Edge-valued Decision Diagram LibrarY.
+    Copyright (C) 2011, Iowa State University Research Foundation, Inc.
+
+    This library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published 
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <cstdlib>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+
+#include "../src/meddly.h"
+#include "simple_model.h"
+
+// #define DEBUG_FILE
+
+const char* kanban[] = {
+  "X-+..............",  // Tin1
+  "X.-+.............",  // Tr1
+  "X.+-.............",  // Tb1
+  "X.-.+............",  // Tg1
+  "X.....-+.........",  // Tr2
+  "X.....+-.........",  // Tb2
+  "X.....-.+........",  // Tg2
+  "X+..--+..-+......",  // Ts1_23
+  "X.........-+.....",  // Tr3
+  "X.........+-.....",  // Tb3
+  "X.........-.+....",  // Tg3
+  "X....+..-+..--+..",  // Ts23_4
+  "X.............-+.",  // Tr4
+  "X.............+-.",  // Tb4
+  "X............+..-",  // Tout4
+  "X.............-.+"   // Tg4
+};
+
+long expected[] = { 
+  1, 160, 4600, 58400, 454475, 2546432, 11261376, 
+  41644800, 133865325, 384392800, 1005927208 
+};
+
+using namespace MEDDLY;
+
+
+// Build the domain
+inline domain* buildKanbanDomain(int N)
+{
+  int sizes[16];
+  for (int i=15; i>=0; i--) sizes[i] = N+1;
+  return createDomainBottomUp(sizes, 16);
+}
+
+// Build the initial state
+inline void buildInitial(int N, forest* mdd, dd_edge &init_state)
+{
+  int initial[17];
+  for (int i=16; i; i--) initial[i] = 0;
+  initial[1] = initial[5] = initial[9] = initial[13] = N;
+  int* initptr = initial;
+  mdd->createEdge(&initptr, 1, init_state);
+}
+
+/*
+    Generate transition relation, reachability set for given N,
+    and write them to a file, in binary.
+*/
+long writeReachset(FILE* s, int N)
+{
+  // Build domain
+  domain* d = buildKanbanDomain(N);
+
+  // Build initial state
+  forest* mdd = d->createForest(0, forest::BOOLEAN, forest::MULTI_TERMINAL);
+  dd_edge init_state(mdd);
+  buildInitial(N, mdd, init_state);
+
+  // Build next-state function
+  forest* mxd = d->createForest(1, forest::BOOLEAN, forest::MULTI_TERMINAL);
+  dd_edge nsf(mxd);
+  buildNextStateFunction(kanban, 16, mxd, nsf); 
+
+  // Build reachable states
+  dd_edge reachable(mdd);
+  apply(REACHABLE_STATES_DFS, init_state, nsf, reachable);
+
+  // Build index set for reachable states
+  forest* evmdd = d->createForest(0, forest::INTEGER, forest::INDEX_SET);
+  dd_edge reach_index(evmdd);
+  apply(CONVERT_TO_INDEX_SET, reachable, reach_index);
+
+  long c;
+  apply(CARDINALITY, reachable, c);
+
+  FILE_output mys(s);
+  mxd->writeEdgesBinary(mys, &nsf, 1);
+
+  dd_edge list[2];
+  list[0] = init_state;
+  list[1] = reachable;
+  mdd->writeEdgesBinary(mys, list, 2);
+
+  evmdd->writeEdgesBinary(mys, &reach_index, 1);
+
+  destroyDomain(d);
+  
+  return c;
+}
+
+
+/*
+    Generate transition relation, reachability set for given N,
+    then read from a stream and check for equality.
+*/
+bool generateAndRead(FILE* s, int N)
+{
+  // Build domain
+  domain* d = buildKanbanDomain(N);
+
+  // Build initial state
+  forest* mdd = d->createForest(0, forest::BOOLEAN, forest::MULTI_TERMINAL);
+  dd_edge init_state(mdd);
+  buildInitial(N, mdd, init_state);
+
+  // Build next-state function
+  forest* mxd = d->createForest(1, forest::BOOLEAN, forest::MULTI_TERMINAL);
+  dd_edge nsf(mxd);
+  buildNextStateFunction(kanban, 16, mxd, nsf); 
+
+  // Build reachable states
+  dd_edge reachable(mdd);
+  apply(REACHABLE_STATES_DFS, init_state, nsf, reachable);
+
+  // Build index set for reachable states
+  forest* evmdd = d->createForest(0, forest::INTEGER, forest::INDEX_SET);
+  dd_edge reach_index(evmdd);
+  apply(CONVERT_TO_INDEX_SET, reachable, reach_index);
+
+  // Now, read from the file and verify
+  FILE_input mys(s);
+
+  dd_edge list[2];
+  mxd->readEdgesBinary(mys, list, 1);
+  if (list[0] != nsf) {
+    printf("Failed to generate and read MXD\n");
+    return false;
+  }
+
+  mdd->readEdgesBinary(mys, list, 2);
+  if (list[0] != init_state) {
+    printf("Failed to generate and read initial state\n");
+    return false;
+  }
+  if (list[1] != reachable) {
+    printf("Failed to generate and read reachable states\n");
+    return false;
+  }
+
+  evmdd->readEdgesBinary(mys, list, 1);
+  if (list[0] != reach_index) {
+    printf("Failed to generate and read reachable state indexes\n");
+    return false;
+  }
+
+  destroyDomain(d);
+  return true;
+}
+
+
+/*
+    Read the transition relation, reachability set from memory,
+    then generate them for a given N and check for equality.
+    Advances data and len past the blocks read.
+*/
+bool readAndGenerate(const unsigned char* &data, size_t &len, int N)
+{
+  // Build domain
+  domain* d = buildKanbanDomain(N);
+
+  // Build (empty) forests
+  forest* mdd = d->createForest(0, forest::BOOLEAN, forest::MULTI_TERMINAL);
+  forest* mxd = d->createForest(1, forest::BOOLEAN, forest::MULTI_TERMINAL);
+  forest* evmdd = d->createForest(0, forest::INTEGER, forest::INDEX_SET);
+
+  dd_edge mxdfile;
+  dd_edge mddfile[2];
+  dd_edge indexfile;
+
+  // Read from memory
+  size_t used;
+  used = mxd->readEdgesBinary(data, len, &mxdfile, 1);
+  data += used;
+  len -= used;
+  used = mdd->readEdgesBinary(data, len, mddfile, 2);
+  data += used;
+  len -= used;
+  used = evmdd->readEdgesBinary(data, len, &indexfile, 1);
+  data += used;
+  len -= used;
+
+  // Build initial state
+  dd_edge init_state(mdd);
+  buildInitial(N, mdd, init_state);
+
+  // Build next-state function
+  dd_edge nsf(mxd);
+  buildNextStateFunction(kanban, 16, mxd, nsf); 
+
+  // Build reachable states
+  dd_edge reachable(mdd);
+  apply(REACHABLE_STATES_DFS, init_state, nsf, reachable);
+
+  // Build index set for reachable states
+  dd_edge reach_index(evmdd);
+  apply(CONVERT_TO_INDEX_SET, reachable, reach_index);
+
+  // Verify
+  if (mxdfile != nsf) {
+    printf("Failed to read and generate MXD\n");
+    return false;
+  }
+  if (mddfile[0] != init_state) {
+    printf("Failed to generate and read initial state\n");
+    return false;
+  }
+  if (mddfile[1] != reachable) {
+    printf("Failed to generate and read reachable states\n");
+    return false;
+  }
+  if (indexfile != reach_index) {
+    printf("Failed to generate and read reachable state indexes\n");
+    return false;
+  }
+
+  destroyDomain(d);
+  return true;
+}
+
+
+/*
+    Blocks written for a larger domain must be rejected.
+*/
+bool rejectLarger(const unsigned char* data, size_t len, int N)
+{
+  domain* d = buildKanbanDomain(N);
+  forest* mxd = d->createForest(1, forest::BOOLEAN, forest::MULTI_TERMINAL);
+  dd_edge mxdfile;
+  bool rejected = false;
+  try {
+    mxd->readEdgesBinary(data, len, &mxdfile, 1);
+  }
+  catch (MEDDLY::error e) {
+    rejected = (MEDDLY::error::INVALID_FILE == e.getCode());
+  }
+  destroyDomain(d);
+  return rejected;
+}
+
+
+/*
+    A block cut short anywhere in its body must be rejected,
+    and the nodes read before the cut must all be reclaimed.
+*/
+bool rejectTruncated(const unsigned char* data, size_t len, int N)
+{
+  // header: 4 byte magic, version, then the body length as a varint
+  if (len < 6) return false;
+  unsigned long body_len = 0;
+  size_t hlen = 5;
+  for (int shift=0; hlen < len; shift += 7) {
+    body_len |= (unsigned long) (data[hlen] & 0x7f) << shift;
+    if (0 == (data[hlen++] & 0x80)) break;
+  }
+  if (hlen + body_len > len) return false;
+
+  domain* d = buildKanbanDomain(N);
+  forest* mxd = d->createForest(1, forest::BOOLEAN, forest::MULTI_TERMINAL);
+  unsigned char* block = new unsigned char[16 + body_len];
+  memcpy(block, data, 5);
+  bool rejected = true;
+  for (unsigned long cut=0; rejected && cut<body_len; cut++) {
+    // same header and the first cut bytes of the body
+    size_t blen = 5;
+    for (unsigned long x = cut; ; x >>= 7) {
+      block[blen++] = (x & 0x7f) | (x > 0x7f ? 0x80 : 0);
+      if (x <= 0x7f) break;
+    }
+    memcpy(block+blen, data+hlen, cut);
+    blen += cut;
+
+    dd_edge mxdfile;
+    rejected = false;
+    try {
+      mxd->readEdgesBinary(block, blen, &mxdfile, 1);
+    }
+    catch (MEDDLY::error e) {
+      rejected = (MEDDLY::error::INVALID_FILE == e.getCode());
+    }
+    mxd->garbageCollect();
+    if (mxd->getCurrentNumNodes()) {
+      printf("%ld nodes left after a failed read\n", mxd->getCurrentNumNodes());
+      rejected = false;
+    }
+  }
+  delete[] block;
+  destroyDomain(d);
+  return rejected;
+}
+
+
+
+/*
+    Main program, of course
+*/
+int main()
+{
+  const int N = 11;
+  MEDDLY::initialize();
+
+  char filename[20];
+  strcpy(filename, "kan_bin.data.XXXXXX");
+  mktemp(filename);
+#ifdef DEBUG_FILE
+  printf("Creating file %s\n", filename);
+#endif
+
+  FILE* s = fopen(filename, "wb");
+  if (0==s) {
+    printf("Couldn't open file %s for writing\n", filename);
+    return 2;
+  }
+
+  try {
+    printf("Saving dds to file...\n");
+    for (int n=1; n<N; n++) {
+      printf("N=%2d:  ", n);
+      fflush(stdout);
+      long c = writeReachset(s, n);
+      printf("%12ld states\n", c);
+      if (c !=expected[n]) {
+        printf("Wrong number of states!\n");
+        throw 1;
+      }
+    }
+    fclose(s);
+
+    // read back the file into already built forest
+
+    s = fopen(filename, "rb");
+    if (0==s) {
+      printf("Couldn't open file %s for reading\n", filename);
+      throw 2;
+    }
+
+    printf("Generate and read...\n");
+    for (int n=1; n<N; n++) {
+      printf("N=%2d:  ", n);
+      fflush(stdout);
+      if (!generateAndRead(s, n)) throw 3;
+      printf("%19s\n", "verified");
+    }
+    fclose(s);
+
+    // map the file and then build up forest
+
+    int fd = open(filename, O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st)) {
+      printf("Couldn't open file %s for reading\n", filename);
+      throw 2;
+    }
+    size_t len = st.st_size;
+    void* map = mmap(0, len, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (MAP_FAILED == map) {
+      printf("Couldn't map file %s\n", filename);
+      throw 2;
+    }
+
+    printf("Read and generate...\n");
+    const unsigned char* data = (const unsigned char*) map;
+    size_t left = len;
+    for (int n=1; n<N; n++) {
+      printf("N=%2d:  ", n);
+      fflush(stdout);
+      if (n==2 && !rejectLarger(data, left, 1)) {
+        printf("Accepted a block for a larger domain\n");
+        throw 5;
+      }
+      if (n==3 && !rejectTruncated(data, left, 3)) {
+        printf("Accepted a truncated block\n");
+        throw 5;
+      }
+      if (!readAndGenerate(data, left, n)) throw 4;
+      printf("%19s\n", "verified");
+    }
+    munmap(map, len);
+    if (left) {
+      printf("Unread bytes at end of file\n");
+      throw 6;
+    }
+
+  
+    // Cleanup
+#ifndef DEBUG_FILE
+    remove(filename);
+#endif
+    MEDDLY::cleanup();
+    printf("Done\n");
+    return 0;
+  }
+  catch (int e) {
+    // cleanup
+#ifndef DEBUG_FILE
+    remove(filename);
+#endif
+    MEDDLY::cleanup();
+    printf("\nError %d\n", e);
+    return e;
+  }
+  catch (MEDDLY::error e) {
+    // cleanup
+#ifndef DEBUG_FILE
+    remove(filename);
+#endif
+    MEDDLY::cleanup();
+    printf("\nError: %s\n", e.getName());
+    return 1;
+  }
+  catch (...) {
+    // cleanup
+#ifndef DEBUG_FILE
+    remove(filename);
+#endif
+    MEDDLY::cleanup();
+    printf("\nFailed (caught exception)\n");
+    return 1;
+  }
+}
+
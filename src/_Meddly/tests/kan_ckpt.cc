@@ -0,0 +1,243 @@
+
+/*
+    Meddly: Multi-terminal and Edge-valued Decision Diagram LibrarY.
+    Copyright (C) 2011, Iowa State University Research Foundation, Inc.
+
+    This library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published 
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <cstdlib>
+#include <string.h>
+
+#include "../src/meddly.h"
+#include "../src/meddly_expert.h"
+#include "simple_model.h"
+
+const char* kanban[] = {
+  "X-+..............",  // Tin1
+  "X.-+.............",  // Tr1
+  "X.+-.............",  // Tb1
+  "X.-.+............",  // Tg1
+  "X.....-+.........",  // Tr2
+  "X.....+-.........",  // Tb2
+  "X.....-.+........",  // Tg2
+  "X+..--+..-+......",  // Ts1_23
+  "X.........-+.....",  // Tr3
+  "X.........+-.....",  // Tb3
+  "X.........-.+....",  // Tg3
+  "X....+..-+..--+..",  // Ts23_4
+  "X.............-+.",  // Tr4
+  "X.............+-.",  // Tb4
+  "X............+..-",  // Tout4
+  "X.............-.+"   // Tg4
+};
+
+long expected[] = { 
+  1, 160, 4600, 58400, 454475, 2546432, 11261376, 
+  41644800, 133865325, 384392800, 1005927208 
+};
+
+const int nstart = 1;
+const int nstop = 6;
+
+using namespace MEDDLY;
+
+/*
+    Keeps every partial result, and asks for one
+    on every few calls.
+*/
+class keep_all : public forest::checkpointer {
+    int calls;
+    int every;
+  public:
+    dd_edge* saved;
+    int num_saved;
+
+    keep_all(int e) {
+      calls = 0;
+      every = e;
+      saved = new dd_edge[1024];
+      num_saved = 0;
+    }
+    virtual ~keep_all() {
+      delete[] saved;
+    }
+    virtual bool due() {
+      calls++;
+      return (0 == calls % every) && (num_saved < 1024);
+    }
+    virtual void save(const dd_edge &partial) {
+      saved[num_saved++] = partial;
+    }
+};
+
+/*
+    Piece of an implicit relation: add delta tokens to a place.
+*/
+class delta_node : public satimpl_opname::relation_node {
+    long delta;
+  public:
+    delta_node(int level, rel_node_handle down, long d)
+      : relation_node(d+2, level, down), delta(d) { }
+    virtual long nextOf(long i) {
+      return (i+delta >= 0) ? i+delta : -1;
+    }
+};
+
+/*
+    Build the kanban relation, one chain of delta_nodes per event.
+*/
+satimpl_opname::implicit_relation* buildImplicitKanban(forest* mdd)
+{
+  satimpl_opname::implicit_relation* T 
+    = new satimpl_opname::implicit_relation(mdd, mdd);
+  for (int e=0; e<16; e++) {
+    int top = 16;
+    while ('.' == kanban[e][top]) top--;
+    rel_node_handle down = 1;
+    for (int k=1; k<=top; k++) {
+      if ('.' == kanban[e][k]) continue;
+      long d = ('+' == kanban[e][k]) ? 1 : -1;
+      down = T->registerNode(k == top, new delta_node(k, down, d));
+    }
+  }
+  return T;
+}
+
+const int TRADITIONAL = 0;
+const int SATURATION = 1;
+const int IMPLICIT = 2;
+
+const char* method_names[] = {
+  "traditional iteration", "saturation", "implicit saturation"
+};
+
+/*
+    Build the reachability set with the given method.
+*/
+void generate(int method, const dd_edge &init, const dd_edge &nsf,
+  satimpl_opname::implicit_relation* T, dd_edge &reachable)
+{
+  if (IMPLICIT == method) {
+    specialized_operation* sat = SATURATION_IMPL_FORWARD->buildOperation(T);
+    sat->compute(init, reachable);
+    destroyOperation(sat);
+  } else {
+    apply(SATURATION == method ? REACHABLE_STATES_DFS : REACHABLE_STATES_BFS,
+      init, nsf, reachable);
+  }
+}
+
+/*
+    Build the reachability set, with checkpoints.
+    Check that every checkpoint is between the initial states
+    and the reachability set, and that generation resumed from
+    the last checkpoint gives the same reachability set.
+    Returns the number of reachable states, or -1 on error.
+*/
+long buildReachset(int N, int method, int &checkpoints)
+{
+  int sizes[16];
+
+  for (int i=15; i>=0; i--) sizes[i] = N+1;
+  domain* d = createDomainBottomUp(sizes, 16);
+
+  // Build initial state
+  int* initial = new int[17];
+  for (int i=16; i; i--) initial[i] = 0;
+  initial[1] = initial[5] = initial[9] = initial[13] = N;
+  forest* mdd = d->createForest(0, forest::BOOLEAN, forest::MULTI_TERMINAL);
+  dd_edge init_state(mdd);
+  mdd->createEdge(&initial, 1, init_state);
+  delete[] initial;
+
+  // Build next-state function
+  forest* mxd = d->createForest(1, forest::BOOLEAN, forest::MULTI_TERMINAL);
+  dd_edge nsf(mxd);
+  buildNextStateFunction(kanban, 16, mxd, nsf); 
+
+  satimpl_opname::implicit_relation* T = 0;
+  if (IMPLICIT == method) {
+    T = buildImplicitKanban(mdd);
+    T->setAutoDestroy(false);  // we use it twice
+  }
+
+  keep_all* ckpt = new keep_all(TRADITIONAL == method ? 3 : 1);
+  mdd->setCheckpointer(ckpt);
+  dd_edge reachable(mdd);
+  generate(method, init_state, nsf, T, reachable);
+  mdd->setCheckpointer(0);
+
+  long c;
+  apply(CARDINALITY, reachable, c);
+
+  checkpoints = ckpt->num_saved;
+  for (int i=0; i<ckpt->num_saved; i++) {
+    dd_edge tmp(mdd);
+    apply(DIFFERENCE, ckpt->saved[i], reachable, tmp);
+    if (tmp.getNode()) {
+      printf("\nCheckpoint %d has unreachable states\n", i);
+      c = -1;
+    }
+    apply(DIFFERENCE, init_state, ckpt->saved[i], tmp);
+    if (tmp.getNode()) {
+      printf("\nCheckpoint %d is missing initial states\n", i);
+      c = -1;
+    }
+  }
+
+  if (ckpt->num_saved) {
+    dd_edge resumed(mdd);
+    generate(method, ckpt->saved[ckpt->num_saved-1], nsf, T, resumed);
+    if (resumed != reachable) {
+      printf("\nResumed generation gives a different set\n");
+      c = -1;
+    }
+  }
+
+  delete ckpt;
+  delete T;
+  destroyDomain(d);
+  
+  return c;
+}
+
+int main()
+{
+  MEDDLY::initialize();
+
+  for (int m=IMPLICIT; m>=TRADITIONAL; m--) {
+    printf("Building Kanban reachability sets with checkpoints, using %s\n",
+      method_names[m]);
+    for (int n=nstart; n<=nstop; n++) {
+      printf("N=%2d:  ", n);
+      fflush(stdout);
+      int ckpts;
+      long c = buildReachset(n, m, ckpts);
+      printf("%12ld states, %3d checkpoints\n", c, ckpts);
+      if (c != expected[n]) {
+        printf("Wrong number of states!\n");
+        return 1;
+      }
+      if (0==ckpts) {
+        printf("No checkpoints written!\n");
+        return 1;
+      }
+    }
+  }
+
+  MEDDLY::cleanup();
+  printf("Done\n");
+  return 0;
+}
@@ -0,0 +1,159 @@
+
+/*
+    Meddly: Multi-terminal and Edge-valued Decision Diagram LibrarY.
+    Copyright (C) 2011, Iowa State University Research Foundation, Inc.
+
+    This library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published 
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <cstdlib>
+#include <string.h>
+
+#include "../src/meddly.h"
+#include "../src/meddly_expert.h"
+#include "simple_model.h"
+
+const char* kanban[] = {
+  "X-+..............",  // Tin1
+  "X.-+.............",  // Tr1
+  "X.+-.............",  // Tb1
+  "X.-.+............",  // Tg1
+  "X.....-+.........",  // Tr2
+  "X.....+-.........",  // Tb2
+  "X.....-.+........",  // Tg2
+  "X+..--+..-+......",  // Ts1_23
+  "X.........-+.....",  // Tr3
+  "X.........+-.....",  // Tb3
+  "X.........-.+....",  // Tg3
+  "X....+..-+..--+..",  // Ts23_4
+  "X.............-+.",  // Tr4
+  "X.............+-.",  // Tb4
+  "X............+..-",  // Tout4
+  "X.............-.+"   // Tg4
+};
+
+long expected[] = { 
+  1, 160, 4600, 58400, 454475, 2546432, 11261376, 
+  41644800, 133865325, 384392800, 1005927208 
+};
+
+const int nstart = 1;
+const int nstop = 6;
+
+using namespace MEDDLY;
+
+/*
+    Build the reachability set with the given garbage collection
+    policies, and small triggers so that collections happen.
+    Returns the number of reachable states.
+*/
+long buildReachset(int N, bool useSat, bool pessimistic,
+  int increment, long memory, long &collections)
+{
+  int sizes[16];
+
+  for (int i=15; i>=0; i--) sizes[i] = N+1;
+  domain* d = createDomainBottomUp(sizes, 16);
+
+  int* initial = new int[17];
+  for (int i=16; i; i--) initial[i] = 0;
+  initial[1] = initial[5] = initial[9] = initial[13] = N;
+
+  forest::policies pmdd(false);
+  forest::policies pmxd(true);
+  if (pessimistic) {
+    pmdd.setPessimistic();
+    pmxd.setPessimistic();
+  } else {
+    pmdd.setOptimistic();
+    pmxd.setOptimistic();
+  }
+  pmdd.zombieTrigger = pmdd.orphanTrigger = 100;
+  pmdd.gcIncrement = increment;
+  pmdd.memoryTrigger = memory;
+  pmxd.gcIncrement = increment;
+
+  forest* mdd = d->createForest(0, forest::BOOLEAN, forest::MULTI_TERMINAL, pmdd);
+  forest* mxd = d->createForest(1, forest::BOOLEAN, forest::MULTI_TERMINAL, pmxd);
+  dd_edge init_state(mdd);
+  mdd->createEdge(&initial, 1, init_state);
+  delete[] initial;
+  dd_edge nsf(mxd);
+  buildNextStateFunction(kanban, 16, mxd, nsf); 
+
+  dd_edge reachable(mdd);
+  apply(useSat ? REACHABLE_STATES_DFS : REACHABLE_STATES_BFS, 
+    init_state, nsf, reachable);
+
+  // Finish any collection under way
+  static_cast<expert_forest*>(mdd)->garbageCollect();
+  collections = mdd->getStats().garbage_collections;
+
+  long c;
+  apply(CARDINALITY, reachable, c);
+
+  destroyDomain(d);
+  return c;
+}
+
+bool runTests(const char* tables)
+{
+  const int increments[] = { 0, 64, 1, 64 };
+  const long memories[] = { 0, 0, 0, 16384 };
+
+  for (int g=0; g<4; g++) {
+    for (int p=1; p>=0; p--) {
+      for (int s=1; s>=0; s--) {
+        printf("Building Kanban reachability sets, %s tables, %s deletion,\n",
+          tables, p ? "pessimistic" : "optimistic");
+        printf("    gc increment %d, memory trigger %ld, using %s\n",
+          increments[g], memories[g],
+          s ? "saturation" : "traditional iteration");
+        for (int n=nstart; n<=nstop; n++) {
+          printf("N=%2d:  ", n);
+          fflush(stdout);
+          long gcs;
+          long c = buildReachset(n, s, p, increments[g], memories[g], gcs);
+          printf("%12ld states, %6ld collections\n", c, gcs);
+          if (c != expected[n]) {
+            printf("Wrong number of states!\n");
+            return false;
+          }
+          // Plenty of zombies with traditional iteration
+          if (p && 0==s && n == nstop && gcs < 2) {
+            printf("Too few garbage collections!\n");
+            return false;
+          }
+        }
+      }
+    }
+  }
+  return true;
+}
+
+int main()
+{
+  MEDDLY::initialize();
+  if (!runTests("monolithic")) return 1;
+  MEDDLY::cleanup();
+
+  initializer_list* L = defaultInitializerList(0);
+  ct_initializer::setBuiltinStyle(ct_initializer::OperationUnchainedHash);
+  MEDDLY::initialize(L);
+  if (!runTests("per-operation")) return 1;
+  MEDDLY::cleanup();
+
+  printf("Done\n");
+  return 0;
+}
@@ -0,0 +1,137 @@
+/*
+    Meddly: Multi-terminal and Edge-valued Decision Diagram LibrarY.
+    Copyright (C) 2011, Iowa State University Research Foundation, Inc.
+
+    This library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <cstdlib>
+#include <string.h>
+
+#include "../src/meddly.h"
+#include "../src/meddly_expert.h"
+#include "simple_model.h"
+
+const char* kanban[] = {
+  "X-+..............",  // Tin1
+  "X.-+.............",  // Tr1
+  "X.+-.............",  // Tb1
+  "X.-.+............",  // Tg1
+  "X.....-+.........",  // Tr2
+  "X.....+-.........",  // Tb2
+  "X.....-.+........",  // Tg2
+  "X+..--+..-+......",  // Ts1_23
+  "X.........-+.....",  // Tr3
+  "X.........+-.....",  // Tb3
+  "X.........-.+....",  // Tg3
+  "X....+..-+..--+..",  // Ts23_4
+  "X.............-+.",  // Tr4
+  "X.............+-.",  // Tb4
+  "X............+..-",  // Tout4
+  "X.............-.+"   // Tg4
+};
+
+long expected[] = {
+  1, 160, 4600, 58400, 454475, 2546432, 11261376,
+  41644800, 133865325, 384392800, 1005927208
+};
+
+const int nstart = 1;
+const int nstop = 6;
+
+using namespace MEDDLY;
+
+/*
+    Switch compute table styles, throwing away all entries.
+*/
+void useTables(ct_initializer::builtinCTstyle style, unsigned size)
+{
+  ct_initializer::setBuiltinStyle(style);
+  ct_initializer::setMaxSize(size);
+  ct_initializer::rebuildTables();
+}
+
+/*
+    Build the reachability set of kanban with the default compute table,
+    then again with the lossy one (large, then tiny so that entries
+    are replaced all the time), and make sure we get the same set.
+*/
+bool checkReachset(int N, bool useSat)
+{
+  int sizes[16];
+
+  for (int i=15; i>=0; i--) sizes[i] = N+1;
+  domain* d = createDomainBottomUp(sizes, 16);
+
+  int* initial = new int[17];
+  for (int i=16; i; i--) initial[i] = 0;
+  initial[1] = initial[5] = initial[9] = initial[13] = N;
+
+  forest* mdd = d->createForest(0, forest::BOOLEAN, forest::MULTI_TERMINAL);
+  forest* mxd = d->createForest(1, forest::BOOLEAN, forest::MULTI_TERMINAL);
+  dd_edge init_state(mdd);
+  mdd->createEdge(&initial, 1, init_state);
+  delete[] initial;
+  dd_edge nsf(mxd);
+  buildNextStateFunction(kanban, 16, mxd, nsf);
+
+  const unsigned sizes_lossy[] = { 16777216, 1024 };
+  const binary_opname* rs
+    = useSat ? REACHABLE_STATES_DFS : REACHABLE_STATES_BFS;
+
+  useTables(ct_initializer::MonolithicUnchainedHash, 16777216);
+  dd_edge reachable(mdd);
+  apply(rs, init_state, nsf, reachable);
+
+  long c;
+  apply(CARDINALITY, reachable, c);
+  printf("%12ld states", c);
+  bool ok = (c == expected[N]);
+  if (!ok) printf("\nWrong number of states!\n");
+
+  for (int s=0; ok && s<2; s++) {
+    useTables(ct_initializer::MonolithicLossyHash, sizes_lossy[s]);
+    dd_edge lossy(mdd);
+    apply(rs, init_state, nsf, lossy);
+    if (lossy != reachable) {
+      printf("\nLossy table with %u slots gives a different set!\n",
+        sizes_lossy[s]);
+      ok = false;
+    }
+  }
+  if (ok) printf(", same with lossy tables\n");
+
+  useTables(ct_initializer::MonolithicUnchainedHash, 16777216);
+  destroyDomain(d);
+  return ok;
+}
+
+int main()
+{
+  MEDDLY::initialize();
+
+  for (int s=1; s>=0; s--) {
+    printf("Building Kanban reachability sets using %s\n",
+      s ? "saturation" : "traditional iteration");
+    for (int n=nstart; n<=nstop; n++) {
+      printf("N=%2d:  ", n);
+      fflush(stdout);
+      if (!checkReachset(n, s)) return 1;
+    }
+  }
+
+  MEDDLY::cleanup();
+  printf("Done\n");
+  return 0;
+}
@@ -0,0 +1,186 @@
+/*
+    Meddly: Multi-terminal and Edge-valued Decision Diagram LibrarY.
+    Copyright (C) 2011, Iowa State University Research Foundation, Inc.
+
+    This library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published 
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <cstdlib>
+#include <string.h>
+
+#include "../src/meddly.h"
+#include "../src/meddly_expert.h"
+#include "simple_model.h"
+
+const char* kanban[] = {
+  "X-+..............",  // Tin1
+  "X.-+.............",  // Tr1
+  "X.+-.............",  // Tb1
+  "X.-.+............",  // Tg1
+  "X.....-+.........",  // Tr2
+  "X.....+-.........",  // Tb2
+  "X.....-.+........",  // Tg2
+  "X+..--+..-+......",  // Ts1_23
+  "X.........-+.....",  // Tr3
+  "X.........+-.....",  // Tb3
+  "X.........-.+....",  // Tg3
+  "X....+..-+..--+..",  // Ts23_4
+  "X.............-+.",  // Tr4
+  "X.............+-.",  // Tb4
+  "X............+..-",  // Tout4
+  "X.............-.+"   // Tg4
+};
+
+const int N = 6;
+const long expected = 11261376;
+
+using namespace MEDDLY;
+
+/*
+    Build the reachability set by traditional iteration,
+    with the given memory limit for the MDD forest.
+    Returns the number of reachable states, or -1 if
+    we ran out of memory.
+*/
+long buildReachset(bool pessimistic, long limit, long &peak, long &sheds)
+{
+  int sizes[16];
+
+  for (int i=15; i>=0; i--) sizes[i] = N+1;
+  domain* d = createDomainBottomUp(sizes, 16);
+
+  int* initial = new int[17];
+  for (int i=16; i; i--) initial[i] = 0;
+  initial[1] = initial[5] = initial[9] = initial[13] = N;
+
+  forest::policies pmdd(false);
+  forest::policies pmxd(true);
+  if (pessimistic) {
+    pmdd.setPessimistic();
+    pmxd.setPessimistic();
+  } else {
+    pmdd.setOptimistic();
+    pmxd.setOptimistic();
+  }
+  pmdd.memoryLimit = limit;
+
+  forest* mdd = d->createForest(0, forest::BOOLEAN, forest::MULTI_TERMINAL, pmdd);
+  forest* mxd = d->createForest(1, forest::BOOLEAN, forest::MULTI_TERMINAL, pmxd);
+
+  long c = -1;
+  try {
+    dd_edge init_state(mdd);
+    mdd->createEdge(&initial, 1, init_state);
+    dd_edge nsf(mxd);
+    buildNextStateFunction(kanban, 16, mxd, nsf); 
+
+    dd_edge reachable(mdd);
+    apply(REACHABLE_STATES_BFS, init_state, nsf, reachable);
+    apply(CARDINALITY, reachable, c);
+  }
+  catch (MEDDLY::error e) {
+    if (e.getCode() != error::INSUFFICIENT_MEMORY) throw e;
+  }
+  delete[] initial;
+  peak = mdd->getStats().peak_memory_used;
+  sheds = mdd->getStats().memory_sheds;
+
+  destroyDomain(d);
+  return c;
+}
+
+bool runTests(const char* tables)
+{
+  for (int p=1; p>=0; p--) {
+    printf("Building Kanban reachability sets, %s tables, %s deletion\n",
+      tables, p ? "pessimistic" : "optimistic");
+
+    long peak, sheds;
+    long c = buildReachset(p, 0, peak, sheds);
+    printf("    no limit:      %12ld states, %8ld peak bytes\n", c, peak);
+    if (c != expected) {
+      printf("Wrong number of states!\n");
+      return false;
+    }
+
+    // Half the memory: should shed the compute tables and still finish
+    long limit = peak / 2;
+    c = buildReachset(p, limit, peak, sheds);
+    printf("    limit %8ld: %12ld states, %8ld peak bytes, %ld sheds\n",
+      limit, c, peak, sheds);
+    if (c != expected) {
+      printf("Wrong number of states!\n");
+      return false;
+    }
+    if (0==sheds) {
+      printf("Memory limit never reached!\n");
+      return false;
+    }
+
+    // Hopeless
+    limit = 1024;
+    c = buildReachset(p, limit, peak, sheds);
+    printf("    limit %8ld: %12ld states\n", limit, c);
+    if (c >= 0) {
+      printf("Memory limit not enforced!\n");
+      return false;
+    }
+  }
+  return true;
+}
+
+/*
+    Build the reachability set under a global memory limit.
+*/
+bool runGlobalTest(long limit, bool expectSuccess)
+{
+  initializer_list* L = defaultInitializerList(0);
+  ct_initializer::setMemoryLimit(limit);
+  MEDDLY::initialize(L);
+
+  long peak, sheds;
+  long c = buildReachset(true, 0, peak, sheds);
+  printf("Global limit %8ld: %12ld states, %ld sheds\n", limit, c, sheds);
+  MEDDLY::cleanup();
+
+  if (!expectSuccess) {
+    if (c < 0) return true;
+    printf("Memory limit not enforced!\n");
+    return false;
+  }
+  if (c != expected) {
+    printf("Wrong number of states!\n");
+    return false;
+  }
+  return true;
+}
+
+int main()
+{
+  MEDDLY::initialize();
+  if (!runTests("monolithic")) return 1;
+  MEDDLY::cleanup();
+
+  initializer_list* L = defaultInitializerList(0);
+  ct_initializer::setBuiltinStyle(ct_initializer::OperationUnchainedHash);
+  MEDDLY::initialize(L);
+  if (!runTests("per-operation")) return 1;
+  MEDDLY::cleanup();
+
+  if (!runGlobalTest(64*1024*1024, true)) return 1;
+  if (!runGlobalTest(16*1024, false)) return 1;
+
+  printf("Done\n");
+  return 0;
+}
@@ -0,0 +1,199 @@
+/*
+    Meddly: Multi-terminal and Edge-valued Decision Diagram LibrarY.
+    Copyright (C) 2011, Iowa State University Research Foundation, Inc.
+
+    This library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <cstdlib>
+#include <string.h>
+
+#include "../src/meddly.h"
+#include "../src/meddly_expert.h"
+#include "simple_model.h"
+
+const char* kanban[] = {
+  "X-+..............",  // Tin1
+  "X.-+.............",  // Tr1
+  "X.+-.............",  // Tb1
+  "X.-.+............",  // Tg1
+  "X.....-+.........",  // Tr2
+  "X.....+-.........",  // Tb2
+  "X.....-.+........",  // Tg2
+  "X+..--+..-+......",  // Ts1_23
+  "X.........-+.....",  // Tr3
+  "X.........+-.....",  // Tb3
+  "X.........-.+....",  // Tg3
+  "X....+..-+..--+..",  // Ts23_4
+  "X.............-+.",  // Tr4
+  "X.............+-.",  // Tb4
+  "X............+..-",  // Tout4
+  "X.............-.+"   // Tg4
+};
+
+long expected[] = {
+  1, 160, 4600, 58400, 454475, 2546432, 11261376,
+  41644800, 133865325, 384392800, 1005927208
+};
+
+const int nstart = 1;
+const int nstop = 6;
+
+using namespace MEDDLY;
+
+/*
+    Forests for kanban, using the given unique table,
+    with small triggers so that collections happen.
+*/
+void buildForests(domain* d, bool open, bool pessimistic,
+  forest* &mdd, forest* &mxd)
+{
+  forest::policies pmdd(false);
+  forest::policies pmxd(true);
+  if (pessimistic) {
+    pmdd.setPessimistic();
+    pmxd.setPessimistic();
+  } else {
+    pmdd.setOptimistic();
+    pmxd.setOptimistic();
+  }
+  if (open) {
+    pmdd.setOpenUniqueTable();
+    pmxd.setOpenUniqueTable();
+  } else {
+    pmdd.setChainedUniqueTable();
+    pmxd.setChainedUniqueTable();
+  }
+  pmdd.zombieTrigger = pmdd.orphanTrigger = 100;
+  pmxd.zombieTrigger = pmxd.orphanTrigger = 100;
+
+  mdd = d->createForest(0, forest::BOOLEAN, forest::MULTI_TERMINAL, pmdd);
+  mxd = d->createForest(1, forest::BOOLEAN, forest::MULTI_TERMINAL, pmxd);
+}
+
+/*
+    Build the reachability set both ways, and make sure they are
+    the same node (so the unique table finds what it holds).
+    Returns the number of nodes in the set, or -1 on failure.
+*/
+long buildReachset(int N, forest* mdd, forest* mxd, dd_edge &reachable)
+{
+  int* initial = new int[17];
+  for (int i=16; i; i--) initial[i] = 0;
+  initial[1] = initial[5] = initial[9] = initial[13] = N;
+  dd_edge init_state(mdd);
+  mdd->createEdge(&initial, 1, init_state);
+  delete[] initial;
+
+  dd_edge nsf(mxd);
+  buildNextStateFunction(kanban, 16, mxd, nsf);
+
+  dd_edge bfs(mdd);
+  apply(REACHABLE_STATES_BFS, init_state, nsf, bfs);
+  apply(REACHABLE_STATES_DFS, init_state, nsf, reachable);
+  if (bfs != reachable) {
+    printf("\nSaturation and traditional iteration differ!\n");
+    return -1;
+  }
+
+  long c;
+  apply(CARDINALITY, reachable, c);
+  if (c != expected[N]) {
+    printf("\nWrong number of states!\n");
+    return -1;
+  }
+  return reachable.getNodeCount();
+}
+
+/*
+    Number of nodes left once everything is collected.
+*/
+long collect(forest* f)
+{
+  static_cast<expert_forest*>(f)->garbageCollect();
+  return f->getCurrentNumNodes();
+}
+
+/*
+    Build kanban with chained and open addressing unique tables,
+    and compare.  The sets are then thrown away and built again,
+    so the open tables grow, shrink (as nodes are deleted) and grow.
+*/
+bool checkReachset(int N, bool pessimistic)
+{
+  int sizes[16];
+
+  for (int i=15; i>=0; i--) sizes[i] = N+1;
+  domain* d = createDomainBottomUp(sizes, 16);
+
+  forest *cmdd, *cmxd, *omdd, *omxd;
+  buildForests(d, false, pessimistic, cmdd, cmxd);
+  buildForests(d, true, pessimistic, omdd, omxd);
+
+  dd_edge chained(cmdd);
+  long cn = buildReachset(N, cmdd, cmxd, chained);
+  if (cn < 0) return false;
+  printf("%12ld states, %6ld nodes", expected[N], cn);
+
+  bool ok = true;
+  for (int pass=0; ok && pass<2; pass++) {
+    dd_edge open(omdd);
+    long on = buildReachset(N, omdd, omxd, open);
+    if (on < 0) return false;
+    if (on != cn) {
+      printf("\nOpen addressing gives %ld nodes!\n", on);
+      ok = false;
+    }
+    dd_edge copy(cmdd);
+    apply(COPY, open, copy);
+    if (copy != chained) {
+      printf("\nOpen addressing gives a different set!\n");
+      ok = false;
+    }
+    // Optimistic forests keep whatever the compute tables still use
+    if (ok && pessimistic && collect(omdd) != collect(cmdd)) {
+      printf("\nOpen addressing keeps a different number of nodes!\n");
+      ok = false;
+    }
+    open.clear();
+    long left = collect(omdd) + collect(omxd);
+    if (ok && pessimistic && left) {
+      printf("\n%ld nodes left after deleting everything!\n", left);
+      ok = false;
+    }
+  }
+  if (ok) printf(", same with open addressing\n");
+
+  destroyDomain(d);
+  return ok;
+}
+
+int main()
+{
+  MEDDLY::initialize();
+
+  for (int p=1; p>=0; p--) {
+    printf("Building Kanban reachability sets, %s deletion\n",
+      p ? "pessimistic" : "optimistic");
+    for (int n=nstart; n<=nstop; n++) {
+      printf("N=%2d:  ", n);
+      fflush(stdout);
+      if (!checkReachset(n, p)) return 1;
+    }
+  }
+
+  MEDDLY::cleanup();
+  printf("Done\n");
+  return 0;
+}
@@ -0,0 +1,168 @@
+/*
+    Meddly: Multi-terminal and Edge-valued Decision Diagram LibrarY.
+    Copyright (C) 2011, Iowa State University Research Foundation, Inc.
+
+    This library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <cstdlib>
+#include <string.h>
+
+#include "../src/meddly.h"
+#include "../src/meddly_expert.h"
+#include "simple_model.h"
+
+const char* kanban[] = {
+  "X-+..............",  // Tin1
+  "X.-+.............",  // Tr1
+  "X.+-.............",  // Tb1
+  "X.-.+............",  // Tg1
+  "X.....-+.........",  // Tr2
+  "X.....+-.........",  // Tb2
+  "X.....-.+........",  // Tg2
+  "X+..--+..-+......",  // Ts1_23
+  "X.........-+.....",  // Tr3
+  "X.........+-.....",  // Tb3
+  "X.........-.+....",  // Tg3
+  "X....+..-+..--+..",  // Ts23_4
+  "X.............-+.",  // Tr4
+  "X.............+-.",  // Tb4
+  "X............+..-",  // Tout4
+  "X.............-.+"   // Tg4
+};
+
+long expected[] = {
+  1, 160, 4600, 58400, 454475, 2546432, 11261376,
+  41644800, 133865325, 384392800, 1005927208
+};
+
+const int nstart = 1;
+const int nstop = 5;
+
+using namespace MEDDLY;
+
+/*
+    Build the forward and backward reachability sets, with every kind
+    of saturation that may run in parallel, using the given number of
+    threads.  The results are left in fwd (for the monolithic relation),
+    evt (for the relation by events) and bwd.
+*/
+void buildReachsets(forest* mdd, forest* mxd, const dd_edge &init,
+  const dd_edge &nsf, satpregen_opname::pregen_relation* ensf,
+  int threads, dd_edge &fwd, dd_edge &evt, dd_edge &bwd)
+{
+  setNumThreads(threads);
+
+  apply(REACHABLE_STATES_DFS, init, nsf, fwd);
+  apply(REVERSE_REACHABLE_DFS, init, nsf, bwd);
+
+  specialized_operation* sat = SATURATION_FORWARD->buildOperation(ensf);
+  sat->compute(init, evt);
+  destroyOperation(sat);
+}
+
+bool checkReachsets(int N, bool pessimistic)
+{
+  int sizes[16];
+
+  for (int i=15; i>=0; i--) sizes[i] = N+1;
+  domain* d = createDomainBottomUp(sizes, 16);
+
+  int* initial = new int[17];
+  for (int i=16; i; i--) initial[i] = 0;
+  initial[1] = initial[5] = initial[9] = initial[13] = N;
+
+  forest::policies pmdd(false);
+  forest::policies pmxd(true);
+  if (pessimistic) {
+    pmdd.setPessimistic();
+    pmxd.setPessimistic();
+  } else {
+    pmdd.setOptimistic();
+    pmxd.setOptimistic();
+  }
+  forest* mdd = d->createForest(0, forest::BOOLEAN, forest::MULTI_TERMINAL, pmdd);
+  forest* mxd = d->createForest(1, forest::BOOLEAN, forest::MULTI_TERMINAL, pmxd);
+  dd_edge init_state(mdd);
+  mdd->createEdge(&initial, 1, init_state);
+  delete[] initial;
+
+  dd_edge nsf(mxd);
+  buildNextStateFunction(kanban, 16, mxd, nsf);
+
+  satpregen_opname::pregen_relation* ensf
+    = new satpregen_opname::pregen_relation(mdd, mxd, mdd, 16);
+  ensf->setAutoDestroy(false);  // we use it twice
+  for (int e=0; e<16; e++) {
+    dd_edge event(mxd);
+    buildNextStateFunction(kanban+e, 1, mxd, event);
+    ensf->addToRelation(event);
+  }
+  ensf->finalize();
+
+  dd_edge fwd1(mdd), evt1(mdd), bwd1(mdd);
+  buildReachsets(mdd, mxd, init_state, nsf, ensf, 1, fwd1, evt1, bwd1);
+
+  dd_edge fwd4(mdd), evt4(mdd), bwd4(mdd);
+  buildReachsets(mdd, mxd, init_state, nsf, ensf, 4, fwd4, evt4, bwd4);
+  setNumThreads(1);
+
+  long c;
+  apply(CARDINALITY, fwd4, c);
+  printf("%12ld states\n", c);
+
+  bool ok = true;
+  if (c != expected[N]) {
+    printf("Wrong number of states!\n");
+    ok = false;
+  }
+  if (fwd1 != fwd4 || evt1 != evt4 || bwd1 != bwd4) {
+    printf("Parallel and sequential saturation differ!\n");
+    ok = false;
+  }
+  if (fwd4 != evt4) {
+    printf("Saturation by events differs!\n");
+    ok = false;
+  }
+
+  delete ensf;
+  destroyDomain(d);
+  return ok;
+}
+
+int main()
+{
+  //
+  // Parallel saturation needs a compute table
+  // that is safe to use from several threads.
+  //
+  initializer_list* L = defaultInitializerList(0);
+  ct_initializer::setBuiltinStyle(ct_initializer::MonolithicLossyHash);
+  MEDDLY::initialize(L);
+
+  for (int p=1; p>=0; p--) {
+    printf("Building Kanban reachability sets, %s deletion,\n",
+      p ? "pessimistic" : "optimistic");
+    printf("    using 1 and 4 threads\n");
+    for (int n=nstart; n<=nstop; n++) {
+      printf("N=%2d:  ", n);
+      fflush(stdout);
+      if (!checkReachsets(n, p)) return 1;
+    }
+  }
+
+  MEDDLY::cleanup();
+  printf("Done\n");
+  return 0;
+}
@@ -0,0 +1,196 @@
+
+/*
+    Meddly: Multi-terminal and Edge-valued Decision Diagram LibrarY.
+    Copyright (C) 2011, Iowa State University Research Foundation, Inc.
+
+    This library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published 
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <cstdlib>
+#include <string.h>
+
+#include "../src/meddly.h"
+#include "../src/meddly_expert.h"
+#include "simple_model.h"
+
+const char* kanban[] = {
+  "X-+..............",  // Tin1
+  "X.-+.............",  // Tr1
+  "X.+-.............",  // Tb1
+  "X.-.+............",  // Tg1
+  "X.....-+.........",  // Tr2
+  "X.....+-.........",  // Tb2
+  "X.....-.+........",  // Tg2
+  "X+..--+..-+......",  // Ts1_23
+  "X.........-+.....",  // Tr3
+  "X.........+-.....",  // Tb3
+  "X.........-.+....",  // Tg3
+  "X....+..-+..--+..",  // Ts23_4
+  "X.............-+.",  // Tr4
+  "X.............+-.",  // Tb4
+  "X............+..-",  // Tout4
+  "X.............-.+"   // Tg4
+};
+
+long expected[] = { 
+  1, 160, 4600, 58400, 454475, 2546432, 11261376, 
+  41644800, 133865325, 384392800, 1005927208 
+};
+
+const int nstart = 1;
+const int nstop = 6;
+
+using namespace MEDDLY;
+
+/*
+    Sift the variables of forest f, and give forest g the same order.
+*/
+void reorderBoth(forest* f, forest* g)
+{
+  expert_forest* ef = static_cast<expert_forest*>(f);
+  expert_forest* eg = static_cast<expert_forest*>(g);
+  ef->autoReorderVariables();
+  int* order = new int[ef->getNumVariables()+1];
+  ef->getVariableOrder(order);
+  eg->reorderVariables(order);
+  delete[] order;
+}
+
+/*
+    Build the reachability set, with automatic reordering
+    (triggered at a small number of nodes), and check that
+    it matches the set built without reordering, once the
+    original variable order is restored.
+    Returns the number of reachable states, or -1 on error.
+*/
+long buildReachset(int N, bool useSat,
+  forest::policies::reordering_type how, int &reorders)
+{
+  int sizes[16];
+
+  for (int i=15; i>=0; i--) sizes[i] = N+1;
+  domain* d = createDomainBottomUp(sizes, 16);
+
+  int* initial = new int[17];
+  for (int i=16; i; i--) initial[i] = 0;
+  initial[1] = initial[5] = initial[9] = initial[13] = N;
+
+  forest::policies pmdd(false);
+  pmdd.reorderTrigger = 64;
+  pmdd.reorder = how;
+  forest::policies pmxd(true);
+  pmxd.reorderTrigger = 64;
+  pmxd.reorder = how;
+
+  // Forests with automatic reordering
+  forest* mdd = d->createForest(0, forest::BOOLEAN, forest::MULTI_TERMINAL, pmdd);
+  forest* mxd = d->createForest(1, forest::BOOLEAN, forest::MULTI_TERMINAL, pmxd);
+  dd_edge init_state(mdd);
+  mdd->createEdge(&initial, 1, init_state);
+  dd_edge nsf(mxd);
+  buildNextStateFunction(kanban, 16, mxd, nsf); 
+
+  // Forests without
+  forest* mdd0 = d->createForest(0, forest::BOOLEAN, forest::MULTI_TERMINAL);
+  forest* mxd0 = d->createForest(1, forest::BOOLEAN, forest::MULTI_TERMINAL);
+  dd_edge init_state0(mdd0);
+  mdd0->createEdge(&initial, 1, init_state0);
+  dd_edge nsf0(mxd0);
+  buildNextStateFunction(kanban, 16, mxd0, nsf0); 
+  delete[] initial;
+
+  const binary_opname* reach = useSat 
+    ? REACHABLE_STATES_DFS : REACHABLE_STATES_BFS;
+
+  expert_forest* emdd = static_cast<expert_forest*>(mdd);
+  expert_forest* emxd = static_cast<expert_forest*>(mxd);
+  reorders = 0;
+  dd_edge reachable(mdd);
+  dd_edge start(init_state);
+  for (;;) {
+    apply(reach, start, nsf, reachable);
+    if (emdd->reorderingDue()) {
+      reorderBoth(mdd, mxd);
+    } else if (emxd->reorderingDue()) {
+      reorderBoth(mxd, mdd);
+    } else {
+      break;
+    }
+    reorders++;
+    start = reachable;
+  }
+
+  long c;
+  apply(CARDINALITY, reachable, c);
+
+  dd_edge reachable0(mdd0);
+  apply(reach, init_state0, nsf0, reachable0);
+
+  // Restore the original order and compare
+  int* order = new int[17];
+  for (int i=16; i>=0; i--) order[i] = i;
+  emdd->reorderVariables(order);
+  emxd->reorderVariables(order);
+  delete[] order;
+
+  if (reachable.getNodeCount() != reachable0.getNodeCount()) {
+    printf("\nReordered set has %u nodes, expected %u\n",
+      reachable.getNodeCount(), reachable0.getNodeCount());
+    c = -1;
+  }
+  double c0;
+  apply(CARDINALITY, reachable0, c0);
+  if (c != long(c0)) {
+    printf("\nReordered set has %ld states, expected %ld\n", c, long(c0));
+    c = -1;
+  }
+
+  destroyDomain(d);
+  
+  return c;
+}
+
+int main()
+{
+  MEDDLY::initialize();
+
+  const forest::policies::reordering_type how[] = {
+    forest::policies::reordering_type::SINK_DOWN,
+    forest::policies::reordering_type::SIFTING,
+    forest::policies::reordering_type::WINDOW
+  };
+  const char* how_name[] = { "forest sifting", "sifting", "window" };
+
+  for (int h=0; h<3; h++) {
+    for (int s=1; s>=0; s--) {
+      printf("Building Kanban reachability sets with %s reordering, using %s\n",
+        how_name[h], s ? "saturation" : "traditional iteration");
+      for (int n=nstart; n<=nstop; n++) {
+        printf("N=%2d:  ", n);
+        fflush(stdout);
+        int reorders;
+        long c = buildReachset(n, s, how[h], reorders);
+        printf("%12ld states, %3d reorderings\n", c, reorders);
+        if (c != expected[n]) {
+          printf("Wrong number of states!\n");
+          return 1;
+        }
+      }
+    }
+  }
+
+  MEDDLY::cleanup();
+  printf("Done\n");
+  return 0;
+}
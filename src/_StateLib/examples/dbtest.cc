@@ -27,11 +27,12 @@ void PrintState(FILE* out, int* state, int size)
 
 int Usage(char* name)
 {
-  printf("\nUsage: %s [-h|-i] [-r|-s|-t]\n", name);
+  printf("\nUsage: %s [-h|-i] [-f|-r|-s|-t]\n", name);
   puts("\nDatabase testing utility.");
   puts("\nOptions:");
   puts("\t-h:\tUse handles to identify states");
   puts("\t-i:\tUse indexes to identify states (default)\n");
+  puts("\t-f:\tUse open-addressing (flat) hash table");
   puts("\t-r:\tUse red-black tree");
   puts("\t-s:\tUse splay tree (default)");
   puts("\t-t:\tUse hash table\n");
@@ -47,9 +48,12 @@ int main(int argc, char** argv)
   char* name = argv[0];
   int ch;
   for (;;) {
-    ch = getopt(argc, argv, "hirst");
+    ch = getopt(argc, argv, "fhirst");
     if (ch<0) break;
     switch (ch) {
+      case 'f':
+        which = SDBT_Flat;
+        break;
       case 'h':
         use_index = false;
         break;
@@ -79,6 +83,7 @@ int main(int argc, char** argv)
     case SDBT_RedBlack:   fprintf(stderr, "Using red-black tree ");  break;
     case SDBT_Splay:      fprintf(stderr, "Using splay tree ");    break;
     case SDBT_Hash:       fprintf(stderr, "Using hash table ");    break;
+    case SDBT_Flat:       fprintf(stderr, "Using flat hash table ");  break;
     default:              fprintf(stderr, "Using unknown data structure ");
   }
   if (use_index)  fprintf(stderr, "with indexes\n"); 
@@ -0,0 +1,607 @@
+
+#include "flat_db.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <thread>
+#include <mutex>
+
+// ******************************************************************
+// *                                                                *
+// *                       flat_coll  methods                       *
+// *                                                                *
+// ******************************************************************
+
+inline int bytesFor(int x)
+{
+  if ((x >= -128) && (x <= 127))  return 1;
+  if ((x >= -32768) && (x <= 32767))  return 2;
+  return 4;
+}
+
+inline void putValue(unsigned char* enc, int bytes, int x)
+{
+  switch (bytes) {
+    case 1: {
+        int8_t y = x;
+        memcpy(enc, &y, 1);
+        return;
+    }
+    case 2: {
+        int16_t y = x;
+        memcpy(enc, &y, 2);
+        return;
+    }
+    default: {
+        int32_t y = x;
+        memcpy(enc, &y, 4);
+    }
+  }
+}
+
+inline int getValue(const unsigned char* enc, int bytes)
+{
+  switch (bytes) {
+    case 1: {
+        int8_t y;
+        memcpy(&y, enc, 1);
+        return y;
+    }
+    case 2: {
+        int16_t y;
+        memcpy(&y, enc, 2);
+        return y;
+    }
+    default: {
+        int32_t y;
+        memcpy(&y, enc, 4);
+        return y;
+    }
+  }
+}
+
+inline int flat_coll::Decode(const unsigned char* enc, int v, int &off) const
+{
+  int x = getValue(enc + off, var_bytes[v]);
+  off += var_bytes[v];
+  return x;
+}
+
+flat_coll::flat_coll() : state_coll()
+{
+  num_vars = -1;
+  var_bytes = 0;
+  width = 0;
+  for (int c=0; c<MAX_CHUNKS; c++) chunk[c] = 0;
+  next_index = 0;
+}
+
+flat_coll::~flat_coll()
+{
+  for (int c=0; c<MAX_CHUNKS; c++) free(chunk[c].load());
+  delete[] var_bytes;
+}
+
+bool flat_coll::Encode(const int* state, int size, unsigned char* buf) const
+{
+  if (size != num_vars) return false;
+  for (int v=0; v<num_vars; v++) {
+    if (bytesFor(state[v]) > var_bytes[v]) return false;
+    putValue(buf, var_bytes[v], state[v]);
+    buf += var_bytes[v];
+  }
+  return true;
+}
+
+void flat_coll::Widen(const int* state, int size)
+{
+  if (num_vars < 0) {
+    num_vars = size;
+    var_bytes = new unsigned char[num_vars];
+    width = 0;
+    for (int v=0; v<num_vars; v++) {
+      var_bytes[v] = bytesFor(state[v]);
+      width += var_bytes[v];
+    }
+    return;
+  }
+  if (size != num_vars) throw StateLib::error(StateLib::error::SizeMismatch);
+
+  unsigned char* new_bytes = new unsigned char[num_vars];
+  int new_width = 0;
+  for (int v=0; v<num_vars; v++) {
+    new_bytes[v] = MAX(int(var_bytes[v]), bytesFor(state[v]));
+    new_width += new_bytes[v];
+  }
+  if (new_width == width) {
+    delete[] new_bytes;
+    return;
+  }
+
+  // Re-encode every chunk that holds states
+  long claimed = next_index.load();
+  long base = 0;
+  for (int c=0; c<MAX_CHUNKS && base<claimed; c++) {
+    unsigned char* old = chunk[c].load();
+    if (0==old) break;
+    unsigned char* fresh = (unsigned char*) malloc(ChunkStates(c) * new_width);
+    if (0==fresh) {
+      delete[] new_bytes;
+      throw StateLib::error(StateLib::error::NoMemory);
+    }
+    long n = MIN(ChunkStates(c), claimed - base);
+    const unsigned char* src = old;
+    unsigned char* dest = fresh;
+    for (long i=0; i<n; i++) {
+      for (int v=0; v<num_vars; v++) {
+        putValue(dest, new_bytes[v], getValue(src, var_bytes[v]));
+        src += var_bytes[v];
+        dest += new_bytes[v];
+      }
+    }
+    free(old);
+    chunk[c] = fresh;
+    base += ChunkStates(c);
+  }
+  // Chunks beyond the claimed states are simply discarded
+  for (int c=0; c<MAX_CHUNKS; c++) {
+    if (ChunkStates(0) * ((1L << c) - 1) < claimed) continue;
+    free(chunk[c].load());
+    chunk[c] = 0;
+  }
+
+  delete[] var_bytes;
+  var_bytes = new_bytes;
+  width = new_width;
+}
+
+long flat_coll::Claim()
+{
+  long i = next_index.fetch_add(1);
+  int c;
+  Locate(i, c);
+  if (0==chunk[c].load(std::memory_order_acquire)) {
+    unsigned char* fresh = (unsigned char*) malloc(ChunkStates(c) * MAX(width, 1));
+    if (0==fresh) throw StateLib::error(StateLib::error::NoMemory);
+    unsigned char* expected = 0;
+    if (!chunk[c].compare_exchange_strong(expected, fresh)) {
+      // someone else beat us to it
+      free(fresh);
+    }
+  }
+  return i;
+}
+
+void flat_coll::Store(long i, const unsigned char* buf)
+{
+  int c;
+  long off = Locate(i, c);
+  memcpy(chunk[c].load(std::memory_order_acquire) + off * width, buf, width);
+}
+
+unsigned long flat_coll::HashEncoding(const unsigned char* buf) const
+/*
+  Multiply-xorshift over 64-bit words, with the finalizer
+  from MurmurHash3 (Austin Appleby, public domain), so that
+  both the low bits (table position) and the high bits
+  (slot tag) are well mixed.
+*/
+{
+  const uint64_t m = 0xff51afd7ed558ccdULL;
+  uint64_t h = 0x9e3779b97f4a7c15ULL ^ width;
+  int i = 0;
+  for (; i+8 <= width; i+=8) {
+    uint64_t k;
+    memcpy(&k, buf+i, 8);
+    k *= m;
+    k ^= k >> 33;
+    h = (h ^ k) * 0xc4ceb9fe1a85ec53ULL;
+  }
+  if (i < width) {
+    uint64_t k = 0;
+    memcpy(&k, buf+i, width-i);
+    k *= m;
+    k ^= k >> 33;
+    h = (h ^ k) * 0xc4ceb9fe1a85ec53ULL;
+  }
+  h ^= h >> 33;
+  h *= m;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ULL;
+  h ^= h >> 33;
+  return h;
+}
+
+bool flat_coll::StateSizesAreStored() const
+{
+  return false;
+}
+
+bool flat_coll::StateHandlesAreIndexes() const
+{
+  return true;
+}
+
+void flat_coll::Clear()
+{
+  next_index = 0;
+  numstates = 0;
+}
+
+long flat_coll::AddState(const int* state, int size)
+{
+  unsigned char* buf = new unsigned char[MAX(width, size*4)];
+  if (!Encode(state, size, buf)) {
+    Widen(state, size);
+    Encode(state, size, buf);
+  }
+  long i = Claim();
+  Store(i, buf);
+  delete[] buf;
+  Publish(i+1);
+  return i;
+}
+
+bool flat_coll::PopLast(long hndl)
+{
+  if (hndl != next_index.load()-1) return false;
+  if (hndl < 0) return false;
+  next_index = hndl;
+  numstates = hndl;
+  return true;
+}
+
+long flat_coll::GetStateKnown(long hndl, int* state, int size) const
+{
+  if ((hndl < 0) || (hndl >= numstates)) return -1;
+  const unsigned char* enc = Encoding(hndl);
+  int off = 0;
+  int v;
+  for (v=0; v<num_vars && v<size; v++) state[v] = Decode(enc, v, off);
+  for (; v<size; v++) state[v] = 0;
+  return (hndl+1 < numstates) ? hndl+1 : 0;
+}
+
+int flat_coll::GetStateUnknown(long hndl, int* state, int size) const
+{
+  if ((hndl < 0) || (hndl >= numstates)) return -1;
+  const unsigned char* enc = Encoding(hndl);
+  int off = 0;
+  for (int v=0; v<num_vars && v<size; v++) state[v] = Decode(enc, v, off);
+  return num_vars;
+}
+
+const unsigned char* flat_coll::GetRawState(long hndl, long &bytes) const
+{
+  if ((hndl < 0) || (hndl >= numstates)) return 0;
+  bytes = width;
+  return Encoding(hndl);
+}
+
+long flat_coll::FirstHandle() const
+{
+  return numstates ? 0 : -1;
+}
+
+long flat_coll::NextHandle(long hndl) const
+{
+  return (hndl+1 < numstates) ? hndl+1 : -1;
+}
+
+int flat_coll::CompareHH(long h1, long h2) const
+{
+  if ((h1 < 0) || (h1 >= numstates)) return 0;
+  if ((h2 < 0) || (h2 >= numstates)) return 0;
+  return memcmp(Encoding(h1), Encoding(h2), width);
+}
+
+int flat_coll::CompareHF(long hndl, int size, const int* state) const
+{
+  if ((hndl < 0) || (hndl >= numstates)) return 0;
+  const unsigned char* enc = Encoding(hndl);
+  int off = 0;
+  for (int v=0; v<num_vars; v++) {
+    int x = Decode(enc, v, off);
+    int y = (v<size) ? state[v] : 0;
+    if (x != y) return (x < y) ? -1 : 1;
+  }
+  for (int v=num_vars; v<size; v++) {
+    if (state[v]) return (state[v] > 0) ? -1 : 1;
+  }
+  return 0;
+}
+
+unsigned long flat_coll::Hash(long hndl, int bits) const
+{
+  if ((hndl < 0) || (hndl >= numstates)) return 0;
+  if (0==bits) return 0;
+  return HashEncoding(Encoding(hndl)) & ((1UL << bits) - 1);
+}
+
+long* flat_coll::RemoveIndexHandles()
+{
+  // Handles are indexes, and stay that way
+  long* answer = (long*) malloc(MAX(numstates, 1L) * sizeof(long));
+  if (0==answer) throw StateLib::error(StateLib::error::NoMemory);
+  for (long i=0; i<numstates; i++) answer[i] = i;
+  return answer;
+}
+
+int flat_coll::NumEncodingMethods() const
+{
+  return 1;
+}
+
+const char* flat_coll::EncodingMethod(int m) const
+{
+  if (0==m) return "Fixed width";
+  return NULL;
+}
+
+long flat_coll::ReportEncodingCount(int m) const
+{
+  return (0==m) ? numstates : 0;
+}
+
+long flat_coll::ReportMemTotal() const
+{
+  long mem = MAX(num_vars, 0);
+  for (int c=0; c<MAX_CHUNKS; c++) {
+    if (chunk[c].load()) mem += ChunkStates(c) * MAX(width, 1);
+  }
+  return mem;
+}
+
+// ******************************************************************
+// *                                                                *
+// *                     flat_hash_db  methods                      *
+// *                                                                *
+// ******************************************************************
+
+/*
+  Guards for the table.  Any number of readers (searches and
+  insertions) may be active, unless a writer (table growth or
+  encoding change) is active; then there are no readers.
+*/
+class flat_reader {
+  flat_hash_db &db;
+public:
+  flat_reader(flat_hash_db &d) : db(d) {
+    for (;;) {
+      while (db.resizing.load()) std::this_thread::yield();
+      db.active++;
+      if (!db.resizing.load()) return;
+      db.active--;
+    }
+  }
+  ~flat_reader() {
+    db.active--;
+  }
+};
+
+class flat_writer {
+  flat_hash_db &db;
+public:
+  flat_writer(flat_hash_db &d) : db(d) {
+    db.resize_lock.lock();
+    db.resizing = true;
+    while (db.active.load()) std::this_thread::yield();
+  }
+  ~flat_writer() {
+    db.resizing = false;
+    db.resize_lock.unlock();
+  }
+};
+
+
+flat_hash_db::flat_hash_db() : state_db()
+{
+  states = new flat_coll;
+  hash_bits = 10;
+  table = new std::atomic<unsigned long>[size()];
+  for (long i=size()-1; i>=0; i--) table[i] = EMPTY;
+  published = 0;
+  active = 0;
+  resizing = false;
+}
+
+flat_hash_db::~flat_hash_db()
+{
+  delete[] table;
+  delete states;
+}
+
+void flat_hash_db::SetMaximumStackSize(long max_stack)
+{
+  // no stack required for hashing
+}
+
+long flat_hash_db::GetMaximumStackSize() const
+{
+  return 0;
+}
+
+void flat_hash_db::Clear()
+{
+  for (long i=size()-1; i>=0; i--) table[i] = EMPTY;
+  states->Clear();
+  num_states = 0;
+  published = 0;
+}
+
+void flat_hash_db::ConvertToStatic(bool)
+{
+  // The table is still needed by FindState()
+  is_static = true;
+}
+
+void flat_hash_db::ConvertToDynamic(bool)
+{
+  is_static = false;
+}
+
+const StateLib::state_coll* flat_hash_db::GetStateCollection() const
+{
+  return states;
+}
+
+StateLib::state_coll* flat_hash_db::TakeStateCollection()
+{
+  StateLib::state_coll* ans = states;
+  states = new flat_coll;
+  for (long i=size()-1; i>=0; i--) table[i] = EMPTY;
+  num_states = 0;
+  published = 0;
+  return ans;
+}
+
+long flat_hash_db::ReportMemTotal() const
+{
+  long memsize = size() * sizeof(unsigned long);
+  if (states) memsize += states->ReportMemTotal();
+  return memsize;
+}
+
+long flat_hash_db::InsertState(const int* s, int np)
+{
+  unsigned char local[256];
+  unsigned char* buf = (np*4 <= 256) ? local : new unsigned char[np*4];
+  long answer = -1;
+  try {
+    for (;;) {
+      {
+        flat_reader guard(*this);
+        if (!needToExpand() && states->Encode(s, np, buf)) {
+          answer = probe(buf, !is_static);
+          break;
+        }
+      }
+      flat_writer guard(*this);
+      if (is_static) break;
+      if (needToExpand()) expand();
+      if (!states->Encode(s, np, buf)) {
+        states->Widen(s, np);
+        rehash();
+      }
+    }
+  }
+  catch (...) {
+    if (buf != local) delete[] buf;
+    throw;
+  }
+  if (buf != local) delete[] buf;
+  if (answer < 0) throw StateLib::error(StateLib::error::Static);
+  return answer;
+}
+
+long flat_hash_db::FindState(const int* s, int np)
+{
+  unsigned char local[256];
+  unsigned char* buf = (np*4 <= 256) ? local : new unsigned char[np*4];
+  long answer = -1;
+  {
+    flat_reader guard(*this);
+    // A state that cannot be encoded has never been inserted
+    if (states->Encode(s, np, buf)) answer = probe(buf, false);
+  }
+  if (buf != local) delete[] buf;
+  return answer;
+}
+
+long flat_hash_db::GetStateKnown(long index, int* state, int size) const
+{
+  return states->GetStateKnown(index, state, size);
+}
+
+int flat_hash_db::GetStateUnknown(long index, int* state, int size) const
+{
+  return states->GetStateUnknown(index, state, size);
+}
+
+const unsigned char* flat_hash_db::GetRawState(long index, long &bytes) const
+{
+  return states->GetRawState(index, bytes);
+}
+
+void flat_hash_db::DumpDot(FILE* out)
+{
+  fprintf(out, "digraph hash {\n\trankdir=LR;\n");
+  fprintf(out, "\tnode [shape=record, width=.1, height=.1];\n\n");
+  fprintf(out, "\ttable [label = \"<f0>0");
+  for (long i=1; i<size(); i++) {
+    fprintf(out, "|<f%ld>%ld", i, i);
+  }
+  fprintf(out, "\"];\n\n\tnode [width=0.5];\n");
+  for (long i=0; i<num_states; i++) {
+    fprintf(out, "\tnode%ld [label= \"<n> %ld\"];\n", i, i);
+  }
+  fprintf(out, "\n");
+  for (long i=0; i<size(); i++) {
+    unsigned long e = table[i].load();
+    if (EMPTY == e || BUSY == e) continue;
+    fprintf(out, "\ttable:f%ld -> node%ld:n;\n", i, long(e & INDEX_MASK) - 1);
+  }
+  fprintf(out, "\n}\n");
+}
+
+void flat_hash_db::expand()
+{
+  delete[] table;
+  table = 0;
+  hash_bits++;
+  table = new std::atomic<unsigned long>[size()];
+  rehash();
+}
+
+void flat_hash_db::rehash()
+{
+  for (long i=size()-1; i>=0; i--) table[i] = EMPTY;
+  unsigned long mask = size()-1;
+  // no duplicates, and no other threads
+  for (long i=0; i<states->Claimed(); i++) {
+    unsigned long h = states->HashEncoding(states->Encoding(i));
+    unsigned long p = h & mask;
+    while (table[p].load(std::memory_order_relaxed) != EMPTY) p = (p+1) & mask;
+    table[p].store(tagOf(h) | (i+1), std::memory_order_relaxed);
+  }
+}
+
+long flat_hash_db::probe(const unsigned char* buf, bool insert)
+{
+  const unsigned long h = states->HashEncoding(buf);
+  const unsigned long tag = tagOf(h);
+  const unsigned long mask = size()-1;
+  const int w = states->Width();
+  unsigned long p = h & mask;
+  for (;;) {
+    unsigned long e = table[p].load(std::memory_order_acquire);
+    if (EMPTY == e) {
+      if (!insert) return -1;
+      if (!table[p].compare_exchange_weak(e, BUSY)) continue;
+      // This slot is ours; fill it
+      long i = states->Claim();
+      DCASSERT(i+1 < long(INDEX_MASK));
+      states->Store(i, buf);
+      table[p].store(tag | (i+1), std::memory_order_release);
+      // Make states visible in index order
+      while (published.load(std::memory_order_acquire) != i) {
+        std::this_thread::yield();
+      }
+      states->Publish(i+1);
+      num_states = i+1;
+      published.store(i+1, std::memory_order_release);
+      return i;
+    }
+    if (BUSY == e) {
+      // Another thread is filling this slot; wait and look again
+      std::this_thread::yield();
+      continue;
+    }
+    if (tagOf(e) == tag) {
+      long i = long(e & INDEX_MASK) - 1;
+      if (0==memcmp(states->Encoding(i), buf, w)) return i;
+    }
+    p = (p+1) & mask;
+  }
+}
@@ -0,0 +1,217 @@
+
+#ifndef FLAT_DB_H
+#define FLAT_DB_H
+
+#include <stdio.h>
+#include <atomic>
+#include <mutex>
+
+#include "statelib.h"
+#include "../include/defines.h"
+
+// ======================================================================
+// |                                                                    |
+// |                   Fixed-width state collections                    |
+// |                                                                    |
+// ======================================================================
+
+/** State collection where every state has the same number of
+    state variables, and is stored in the same number of bytes.
+
+    Each state variable is stored in 1, 2 or 4 bytes (signed);
+    the width of a variable is chosen as small as possible and is
+    increased, for all states at once, when a state is added whose
+    value does not fit.  The encoded states are kept in an array of
+    chunks, where chunk c holds (FIRST_CHUNK << c) states; chunks
+    are never moved, so a pointer to an encoded state remains valid
+    until the encoding changes.
+
+    Handles are always indexes.
+    Methods Claim() and Store() may be called concurrently with each
+    other and with Encoding(); everything else requires exclusive access.
+*/
+class flat_coll : public StateLib::state_coll {
+  static const int FIRST_BITS = 10;
+  static const long FIRST_CHUNK = 1L << FIRST_BITS;
+  static const int MAX_CHUNKS = 48;
+
+  /// Number of state variables, or -1 before the first state.
+  int num_vars;
+  /// Bytes used for each state variable.
+  unsigned char* var_bytes;
+  /// Bytes per encoded state.
+  int width;
+  /// Storage for encoded states.
+  std::atomic<unsigned char*> chunk[MAX_CHUNKS];
+  /// Next index to hand out.
+  std::atomic<long> next_index;
+public:
+  flat_coll();
+  virtual ~flat_coll();
+
+  /// Bytes per encoded state; 0 before the first state.
+  inline int Width() const { return width; }
+
+  /** Encode a full state.
+        @param  state   The state.
+        @param  size    Size of the state.
+        @param  buf     (Output) encoding; must hold Width() bytes.
+        @return true,   if every value fits the current widths;
+                false,  if the size is wrong or a value does not fit;
+                        then Widen() must be called first.
+  */
+  bool Encode(const int* state, int size, unsigned char* buf) const;
+
+  /** Increase variable widths (and re-encode stored states)
+      so that the given state can be encoded.
+      Also fixes the number of variables, on the first call.
+      Throws a SizeMismatch error if the size differs from
+      the size of the states already stored.
+  */
+  void Widen(const int* state, int size);
+
+  /// Pointer to the encoding of state with index i.
+  inline const unsigned char* Encoding(long i) const {
+    CHECK_RANGE(0, i, next_index.load());
+    int c;
+    long off = Locate(i, c);
+    return chunk[c].load(std::memory_order_acquire) + off * width;
+  }
+
+  /** Reserve the next index.
+      Storage for the index is allocated if necessary;
+      the encoding must be written with Store() before
+      it is accessed by anyone else.
+  */
+  long Claim();
+
+  /// Write the encoding of a claimed index.
+  void Store(long i, const unsigned char* buf);
+
+  /// Make the first n claimed states visible through Size().
+  inline void Publish(long n) { numstates = n; }
+
+  /// Number of claimed indexes.
+  inline long Claimed() const { return next_index.load(); }
+
+  /// Hash of an encoding.
+  unsigned long HashEncoding(const unsigned char* buf) const;
+
+  // required interface
+  virtual bool StateSizesAreStored() const;
+  virtual bool StateHandlesAreIndexes() const;
+  virtual void Clear();
+  virtual long AddState(const int* state, int size);
+  virtual bool PopLast(long hndl);
+  virtual long GetStateKnown(long hndl, int* state, int size) const;
+  virtual int GetStateUnknown(long hndl, int* state, int size) const;
+  virtual const unsigned char* GetRawState(long hndl, long &bytes) const;
+  virtual long FirstHandle() const;
+  virtual long NextHandle(long hndl) const;
+  virtual int CompareHH(long h1, long h2) const;
+  virtual int CompareHF(long hndl, int size, const int* state) const;
+  virtual unsigned long Hash(long hndl, int bits) const;
+  virtual long* RemoveIndexHandles();
+  virtual int NumEncodingMethods() const;
+  virtual const char* EncodingMethod(int m) const;
+  virtual long ReportEncodingCount(int m) const;
+  virtual long ReportMemTotal() const;
+
+protected:
+  /// Chunk number and offset within the chunk for index i.
+  static inline long Locate(long i, int &c) {
+    unsigned long q = (i >> FIRST_BITS) + 1;
+    c = 0;
+    while (q >>= 1) c++;
+    return i - FIRST_CHUNK * ((1L << c) - 1);
+  }
+  static inline long ChunkStates(int c) {
+    return FIRST_CHUNK << c;
+  }
+  /// Decode variable v of an encoding.
+  inline int Decode(const unsigned char* enc, int v, int &off) const;
+};
+
+// ======================================================================
+// |                                                                    |
+// |                   Open-addressing hash databases                   |
+// |                                                                    |
+// ======================================================================
+
+/** Hash table with linear probing, for states of fixed size.
+
+    Each table slot is a single 64-bit word holding the state index
+    and some high bits of the state hash, so most mismatches are
+    detected without touching the state.  States live in a flat_coll.
+
+    InsertState() and FindState() may be called by several threads
+    at once: empty slots are claimed with a compare-and-swap, and
+    other threads are held off only while the table grows or
+    the state encoding widens.  All other methods (including Size())
+    must not overlap with insertions.
+*/
+class flat_hash_db : public StateLib::state_db {
+  static const int INDEX_BITS = 40;
+  static const unsigned long INDEX_MASK = (1UL << INDEX_BITS) - 1;
+  static const unsigned long EMPTY = 0;
+  static const unsigned long BUSY = ~0UL;
+
+  flat_coll* states;
+  std::atomic<unsigned long>* table;
+  int hash_bits;
+  /// Number of indexes whose states are visible through Size().
+  std::atomic<long> published;
+  /// Number of threads inside InsertState() or FindState().
+  std::atomic<int> active;
+  /// Set while the table or the encoding is being changed.
+  std::atomic<bool> resizing;
+  std::mutex resize_lock;
+
+  friend class flat_reader;
+  friend class flat_writer;
+public:
+  flat_hash_db();
+  virtual ~flat_hash_db();
+
+  virtual void SetMaximumStackSize(long max_stack);
+  virtual long GetMaximumStackSize() const;
+
+  virtual void Clear();
+  virtual void ConvertToStatic(bool);
+  virtual void ConvertToDynamic(bool);
+  virtual const StateLib::state_coll* GetStateCollection() const;
+  virtual StateLib::state_coll* TakeStateCollection();
+  virtual long ReportMemTotal() const;
+
+  virtual long InsertState(const int* state, int size);
+  virtual long FindState(const int* state, int size);
+
+  virtual long  GetStateKnown(long index, int* state, int size) const;
+  virtual int GetStateUnknown(long index, int* state, int size) const;
+  virtual const unsigned char* GetRawState(long hndl, long &bytes) const;
+
+  virtual void DumpDot(FILE*);
+protected:
+  inline long size() const {
+    return 1L << hash_bits;
+  }
+  inline bool needToExpand() const {
+    return 4 * states->Claimed() >= 3 * size();
+  }
+  inline static unsigned long tagOf(unsigned long h) {
+    return h >> INDEX_BITS << INDEX_BITS;
+  }
+  /// Encode, widening under the exclusive lock if needed.
+  void encode(const int* state, int size, unsigned char* buf);
+  /// Double the table; caller must hold the exclusive lock.
+  void expand();
+  /// Rebuild the table from the stored states; same requirement.
+  void rehash();
+  /** Search (and optionally insert) an encoded state.
+      Caller must hold the shared lock.
+        @return index, or -1 if not found and not inserted.
+  */
+  long probe(const unsigned char* buf, bool insert);
+};
+
+#endif
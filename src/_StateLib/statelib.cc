@@ -7,6 +7,7 @@
 #include "splaydb.h"
 #include "rb_db.h"
 #include "hash_db.h"
+#include "flat_db.h"
 
 const int MAJOR_VERSION = 2;  // interface changes
 const int MINOR_VERSION = 0;  // (significant) backend algorithm changes
@@ -110,6 +111,10 @@ StateLib::CreateStateDB(state_db_type which, bool useindices, bool storesize)
         if (useindices)   return new hash_index_db(storesize);
         return NULL;
 
+    case SDBT_Flat:
+        if (useindices && !storesize)   return new flat_hash_db;
+        return NULL;
+
   }
   return NULL;
 }
@@ -545,7 +545,13 @@ namespace StateLib {
   enum state_db_type {
     SDBT_Splay,
     SDBT_RedBlack,
-    SDBT_Hash
+    SDBT_Hash,
+    /** Open-addressing hash table, with states of a fixed size
+        stored inline at fixed width.  Requires indexes, and
+        does not store state sizes.  InsertState() and FindState()
+        may be called concurrently.
+    */
+    SDBT_Flat
   };
 
 